@@ -31,9 +31,13 @@
 
 #include "file.h"
 #include "resly.h"
+#include "wzconfig.h"
 
 #include <list>
 #include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 // Local prototypes
 static std::list<RES_TYPE *> psResTypes;
@@ -51,6 +55,9 @@ static void ResetResourceFile();
 // callback to resload screen.
 static RESLOAD_CALLBACK resLoadCallback = nullptr;
 
+// while set, resLoadFile() only records the JSON files it would load, instead of loading them
+static std::vector<std::string> *resCollectedJSONFiles = nullptr;
+
 
 /* next four used in HashPJW */
 #define	BITS_IN_int		32
@@ -184,19 +191,14 @@ void resSetBaseDir(const char *pResDir)
 	sstrcpy(aResDir, pResDir);
 }
 
-/* Parse the res file */
-bool resLoad(const char *pResFile, SDWORD blockID)
+/* Parse the res file, calling resLoadFile() for every file in it */
+static bool resParseFile(const char *pResFile)
 {
 	bool retval = true;
 	lexerinput_t input;
 
 	sstrcpy(aCurrResDir, aResDir);
 
-	// Note the block id number
-	resBlockID = blockID;
-
-	debug(LOG_WZ, "resLoad: loading [directory: %s] %s", WZ_PHYSFS_getRealDir_String(pResFile).c_str(), pResFile);
-
 	// Load the RES file; allocate memory for a wrf, and load it
 	input.type = LEXINPUT_PHYSFS;
 	input.input.physfsfile = openLoadFile(pResFile, true);
@@ -220,6 +222,38 @@ bool resLoad(const char *pResFile, SDWORD blockID)
 	return retval;
 }
 
+/* Load the res file */
+bool resLoad(const char *pResFile, SDWORD blockID)
+{
+	// Note the block id number
+	resBlockID = blockID;
+
+	debug(LOG_WZ, "resLoad: loading [directory: %s] %s", WZ_PHYSFS_getRealDir_String(pResFile).c_str(), pResFile);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	// Read and parse all JSON files of the res file concurrently first, then load everything in order
+	std::vector<std::string> jsonFiles;
+	resCollectedJSONFiles = &jsonFiles;
+	bool retval = resParseFile(pResFile);
+	resCollectedJSONFiles = nullptr;
+	if (!retval)
+	{
+		return false;
+	}
+	WzConfig::preparseFiles(jsonFiles);
+	const auto parsedTime = std::chrono::steady_clock::now();
+
+	retval = resParseFile(pResFile);
+	WzConfig::clearPreparsedFiles();
+
+	const auto endTime = std::chrono::steady_clock::now();
+	debug(LOG_WZ, "resLoad: %s took %d ms (parsing %zu JSON files: %d ms)", pResFile,
+	      static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()), jsonFiles.size(),
+	      static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(parsedTime - startTime).count()));
+
+	return retval;
+}
+
 
 /* Allocate a RES_TYPE structure */
 static RES_TYPE *resAlloc(const char *pType)
@@ -513,6 +547,16 @@ bool resLoadFile(const char *pType, const char *pFile)
 
 	makeLocaleFile(aFileName, sizeof(aFileName));  // check for translated file
 
+	if (resCollectedJSONFiles != nullptr)
+	{
+		size_t len = strlen(aFileName);
+		if (psT->fileLoad && len > 5 && strcasecmp(aFileName + len - 5, ".json") == 0)
+		{
+			resCollectedJSONFiles->push_back(aFileName);
+		}
+		return true;
+	}
+
 	SetLastResourceFilename(pFile); // Save the filename in case any routines need it
 
 	// load the resource
@@ -0,0 +1,211 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file parallel_for.cpp
+ *  Runs independent jobs on a pool of worker threads.
+ *
+ *  The workers are started on first use and sleep while there is nothing to do.
+ *  Only one wzParallelFor() runs on the pool at a time; concurrent callers wait their turn.
+ *  On Emscripten, jobs always run serially on the calling thread.
+ */
+
+#include "parallel_for.h"
+#include "frame.h"
+#include "wzapp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <vector>
+
+#if !defined(__EMSCRIPTEN__)
+
+namespace
+{
+
+thread_local bool insideParallelFor = false;
+
+/// Sets insideParallelFor for the current scope
+struct InsideParallelForScope
+{
+	InsideParallelForScope() { insideParallelFor = true; }
+	~InsideParallelForScope() { insideParallelFor = false; }
+};
+
+struct ParallelJob
+{
+	const std::function<void (size_t)> *func = nullptr;
+	size_t count = 0;
+	std::atomic<size_t> next{0};
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception;  ///< The first exception thrown by func (written only by the thread that set failed)
+
+	/// Runs calls until there are none left. Doesn't throw: if func throws, the remaining calls are skipped.
+	void run()
+	{
+		try
+		{
+			for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed))
+			{
+				(*func)(i);
+			}
+		}
+		catch (...)
+		{
+			next.store(count, std::memory_order_relaxed);
+			if (!failed.exchange(true))
+			{
+				exception = std::current_exception();
+			}
+		}
+	}
+};
+
+class WorkerPool
+{
+public:
+	explicit WorkerPool(unsigned numWorkers)
+		: jobAvailable(wzSemaphoreCreate(0))
+		, jobDone(wzSemaphoreCreate(0))
+	{
+		for (unsigned i = 0; i < numWorkers; ++i)
+		{
+			workers.emplace_back([this] { workerLoop(); });
+		}
+	}
+
+	~WorkerPool()
+	{
+		stop = true;
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			wzSemaphorePost(jobAvailable);
+		}
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+		wzSemaphoreDestroy(jobAvailable);
+		wzSemaphoreDestroy(jobDone);
+	}
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator =(const WorkerPool &) = delete;
+
+	/// Runs job on the calling thread and up to `helpers` workers
+	void run(ParallelJob &job, size_t helpers)
+	{
+		helpers = std::min(helpers, workers.size());
+		callMutex.lock();
+		currentJob = &job;
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			wzSemaphorePost(jobAvailable);
+		}
+
+		job.run();
+
+		// The job belongs to the caller, so every worker that was woken must be done with it before returning
+		for (size_t i = 0; i < helpers; ++i)
+		{
+			wzSemaphoreWait(jobDone);
+		}
+		currentJob = nullptr;
+		callMutex.unlock();
+	}
+
+private:
+	void workerLoop()
+	{
+		insideParallelFor = true;
+		while (true)
+		{
+			wzSemaphoreWait(jobAvailable);  // Wait until needed.
+			if (stop)
+			{
+				return;
+			}
+			currentJob->run();
+			wzSemaphorePost(jobDone);
+		}
+	}
+
+	std::vector<wz::thread> workers;
+	wz::mutex callMutex;
+	WZ_SEMAPHORE *jobAvailable;
+	WZ_SEMAPHORE *jobDone;
+	ParallelJob *currentJob = nullptr;  ///< Written before jobAvailable is posted, so the woken workers see it
+	bool stop = false;
+};
+
+WorkerPool &workerPool()
+{
+	static WorkerPool pool(wzParallelForThreadCount() - 1);
+	return pool;
+}
+
+} // anonymous namespace
+
+#endif // !defined(__EMSCRIPTEN__)
+
+unsigned wzParallelForThreadCount()
+{
+#if defined(__EMSCRIPTEN__)
+	return 1;
+#else
+	static const unsigned threads = std::max<unsigned>(1, wzGetLogicalCPUCount());
+	return threads;
+#endif
+}
+
+void wzParallelFor(size_t count, const std::function<void (size_t)> &func, unsigned maxThreads)
+{
+#if defined(__EMSCRIPTEN__)
+	(void)maxThreads;
+	const bool serial = true;
+#else
+	if (maxThreads == 0)
+	{
+		maxThreads = wzParallelForThreadCount();
+	}
+	const bool serial = count <= 1 || maxThreads <= 1 || insideParallelFor;
+#endif
+	if (serial)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+#if !defined(__EMSCRIPTEN__)
+	ParallelJob job;
+	job.func = &func;
+	job.count = count;
+	{
+		InsideParallelForScope scope;
+		workerPool().run(job, std::min<size_t>(maxThreads, count) - 1);
+	}
+	if (job.exception)
+	{
+		std::rethrow_exception(job.exception);
+	}
+#endif
+}
@@ -0,0 +1,39 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file parallel_for.h
+ *  Runs independent jobs on a pool of worker threads.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_PARALLEL_FOR_H__
+#define __INCLUDED_LIB_FRAMEWORK_PARALLEL_FOR_H__
+
+#include <stddef.h>
+#include <functional>
+
+/// Calls func(i) for every i in [0, count), spread over the calling thread and up to `maxThreads - 1`
+/// worker threads (0 = one thread per hardware thread). Returns once all calls have finished.
+/// func must be safe to call concurrently for different i. Calls from within func run serially.
+/// If func throws, the calls that haven't started yet are skipped, and the first exception is rethrown once all threads are done.
+void wzParallelFor(size_t count, const std::function<void (size_t)> &func, unsigned maxThreads = 0);
+
+/// The number of threads wzParallelFor() uses by default (including the calling thread).
+unsigned wzParallelForThreadCount();
+
+#endif // __INCLUDED_LIB_FRAMEWORK_PARALLEL_FOR_H__
@@ -0,0 +1,427 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file physfs_fileview.cpp
+ *  Zero-copy read access to files in the PhysFS search path.
+ *
+ *  PhysFS doesn't expose where a file is stored, so this asks it which directory or archive
+ *  (PHYSFS_getRealDir) provides the file, and maps that directly: plain files are mapped
+ *  whole, and zip archives are mapped whole once and indexed, so their stored entries can be
+ *  handed out as pointers into the mapping.
+ *
+ *  Nothing in the write dir is mapped: the game itself overwrites files there (saves, downloaded
+ *  maps, ...), and reading a mapping of a file that was truncated meanwhile crashes with SIGBUS.
+ */
+
+#include "physfs_fileview.h"
+#include "frame.h"
+#include "file.h"
+#include "physfs_ext.h"
+#include "string_ext.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(WZ_OS_WIN)
+# define WZ_FILEVIEW_MMAP
+#elif !defined(__EMSCRIPTEN__)
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define WZ_FILEVIEW_MMAP
+#endif
+
+#if defined(WZ_FILEVIEW_MMAP)
+
+namespace
+{
+
+#if defined(WZ_OS_WIN)
+std::wstring utf8ToWide(const std::string &str)
+{
+	int wstr_len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, NULL, 0);
+	if (wstr_len <= 0)
+	{
+		return std::wstring();
+	}
+	std::vector<wchar_t> wstr(wstr_len, 0);
+	if (MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &wstr[0], wstr_len) == 0)
+	{
+		return std::wstring();
+	}
+	return std::wstring(wstr.data());
+}
+#endif
+
+bool isNativeDirectory(const std::string &nativePath)
+{
+#if defined(WZ_OS_WIN)
+	DWORD attributes = GetFileAttributesW(utf8ToWide(nativePath).c_str());
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+	struct stat st;
+	return stat(nativePath.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/// A whole file, mapped read-only
+class MappedFile
+{
+public:
+	~MappedFile()
+	{
+#if defined(WZ_OS_WIN)
+		UnmapViewOfFile(base);
+#else
+		munmap(base, length);
+#endif
+	}
+
+	static std::shared_ptr<MappedFile> map(const std::string &nativePath)
+	{
+		void *base = nullptr;
+		size_t length = 0;
+#if defined(WZ_OS_WIN)
+		HANDLE file = CreateFileW(utf8ToWide(nativePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+		{
+			CloseHandle(file);
+			return nullptr;
+		}
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr)
+		{
+			return nullptr;
+		}
+		base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);  // the view keeps the mapping alive
+		if (base == nullptr)
+		{
+			return nullptr;
+		}
+		length = static_cast<size_t>(fileSize.QuadPart);
+#else
+		int fd = open(nativePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return nullptr;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 || static_cast<uint64_t>(st.st_size) > SIZE_MAX)
+		{
+			close(fd);
+			return nullptr;
+		}
+		length = static_cast<size_t>(st.st_size);
+		base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);  // the mapping stays valid
+		if (base == MAP_FAILED)
+		{
+			return nullptr;
+		}
+#endif
+		auto result = std::make_shared<MappedFile>();
+		result->base = base;
+		result->length = length;
+		return result;
+	}
+
+	const char *data() const { return static_cast<const char *>(base); }
+	size_t size() const { return length; }
+
+private:
+	void *base = nullptr;
+	size_t length = 0;
+};
+
+struct StoredEntry
+{
+	size_t dataOffset;
+	size_t size;
+};
+
+/// A mapped zip archive, and where its uncompressed entries are
+struct MappedArchive
+{
+	std::shared_ptr<MappedFile> file;
+	std::unordered_map<std::string, StoredEntry> storedEntries;
+};
+
+inline uint16_t readLE16(const unsigned char *p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t readLE32(const unsigned char *p)
+{
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/// Finds the stored (uncompressed, unencrypted) entries of a zip archive. Zip64 archives aren't supported.
+bool indexZipArchive(const unsigned char *data, size_t size, std::unordered_map<std::string, StoredEntry> &storedEntries)
+{
+	const size_t eocdSize = 22;
+	if (size < eocdSize)
+	{
+		return false;
+	}
+	// The end of central directory record is followed by a comment of up to 65535 bytes
+	const size_t searchEnd = (size - eocdSize > 0xFFFF) ? size - eocdSize - 0xFFFF : 0;
+	size_t eocd = size - eocdSize;
+	while (readLE32(data + eocd) != 0x06054b50)
+	{
+		if (eocd == searchEnd)
+		{
+			return false;
+		}
+		--eocd;
+	}
+	const unsigned char *p = data + eocd;
+	const uint16_t entriesOnDisk = readLE16(p + 8);
+	const uint16_t totalEntries = readLE16(p + 10);
+	const uint32_t cdSize = readLE32(p + 12);
+	const uint32_t cdOffset = readLE32(p + 16);
+	if (entriesOnDisk != totalEntries || totalEntries == 0xFFFF || cdOffset == 0xFFFFFFFF || static_cast<uint64_t>(cdOffset) + cdSize > eocd)
+	{
+		return false;  // multi-disk, zip64, or data prepended to the archive
+	}
+
+	size_t pos = cdOffset;
+	const size_t cdEnd = static_cast<size_t>(cdOffset) + cdSize;
+	for (uint16_t i = 0; i < totalEntries; ++i)
+	{
+		if (pos + 46 > cdEnd || readLE32(data + pos) != 0x02014b50)
+		{
+			return false;
+		}
+		p = data + pos;
+		const uint16_t flags = readLE16(p + 8);
+		const uint16_t method = readLE16(p + 10);
+		const uint32_t compressedSize = readLE32(p + 20);
+		const uint32_t uncompressedSize = readLE32(p + 24);
+		const uint16_t nameLength = readLE16(p + 28);
+		const uint16_t extraLength = readLE16(p + 30);
+		const uint16_t commentLength = readLE16(p + 32);
+		const uint32_t localHeaderOffset = readLE32(p + 42);
+		if (pos + 46 + nameLength > cdEnd)
+		{
+			return false;
+		}
+		std::string name(reinterpret_cast<const char *>(p + 46), nameLength);
+		pos += 46 + static_cast<size_t>(nameLength) + extraLength + commentLength;
+
+		if (method != 0 || (flags & 1) != 0 || compressedSize != uncompressedSize || compressedSize == 0xFFFFFFFF
+			|| localHeaderOffset == 0xFFFFFFFF || name.empty() || name.back() == '/')
+		{
+			continue;  // compressed, encrypted, zip64 or a directory
+		}
+		// The local header may have a different extra field than the central directory entry
+		const size_t localHeader = localHeaderOffset;
+		if (localHeader + 30 > size || readLE32(data + localHeader) != 0x04034b50)
+		{
+			continue;
+		}
+		const size_t dataOffset = localHeader + 30 + readLE16(data + localHeader + 26) + readLE16(data + localHeader + 28);
+		if (dataOffset > size || size - dataOffset < uncompressedSize)
+		{
+			continue;
+		}
+		storedEntries[std::move(name)] = StoredEntry{dataOffset, uncompressedSize};
+	}
+	return true;
+}
+
+std::mutex archivesMutex;
+std::unordered_map<std::string, std::shared_ptr<MappedArchive>> mappedArchives;  // nullptr if the archive can't be mapped
+
+std::shared_ptr<MappedArchive> mappedArchive(const std::string &nativePath)
+{
+	std::lock_guard<std::mutex> lock(archivesMutex);
+	auto it = mappedArchives.find(nativePath);
+	if (it != mappedArchives.end())
+	{
+		return it->second;
+	}
+
+	std::shared_ptr<MappedArchive> archive;
+	auto file = MappedFile::map(nativePath);
+	if (file != nullptr)
+	{
+		archive = std::make_shared<MappedArchive>();
+		archive->file = std::move(file);
+		if (indexZipArchive(reinterpret_cast<const unsigned char *>(archive->file->data()), archive->file->size(), archive->storedEntries))
+		{
+			debug(LOG_WZ, "Mapped %s (%zu stored entries)", nativePath.c_str(), archive->storedEntries.size());
+		}
+		else
+		{
+			archive.reset();
+		}
+	}
+	mappedArchives[nativePath] = archive;
+	return archive;
+}
+
+struct MappedData
+{
+	std::shared_ptr<const void> owner;
+	const char *data = nullptr;
+	size_t size = 0;
+};
+
+/// Whether nativePath is the write dir, or inside it
+bool isInWriteDir(const std::string &nativePath)
+{
+	const char *writeDirPtr = PHYSFS_getWriteDir();
+	if (writeDirPtr == nullptr)
+	{
+		return false;
+	}
+	std::string writeDir = writeDirPtr;
+	const std::string separator = PHYSFS_getDirSeparator();
+	if (strEndsWith(writeDir, separator))
+	{
+		writeDir.erase(writeDir.size() - separator.size());
+	}
+	return nativePath.compare(0, writeDir.size(), writeDir) == 0
+		&& (nativePath.size() == writeDir.size() || nativePath.compare(writeDir.size(), separator.size(), separator) == 0);
+}
+
+bool mapPhysFSFile(const char *fileName, MappedData &output)
+{
+	const char *realDirPtr = PHYSFS_getRealDir(fileName);
+	if (realDirPtr == nullptr)
+	{
+		return false;
+	}
+	const std::string realDir = realDirPtr;
+	if (isInWriteDir(realDir))
+	{
+		return false;
+	}
+	const char *mountPointPtr = PHYSFS_getMountPoint(realDir.c_str());
+	if (mountPointPtr == nullptr)
+	{
+		return false;
+	}
+
+	// The path of the file within realDir
+	std::string mountPoint = mountPointPtr;
+	mountPoint.erase(0, mountPoint.find_first_not_of('/'));
+	std::string relativePath = fileName;
+	relativePath.erase(0, relativePath.find_first_not_of('/'));
+	if (relativePath.compare(0, mountPoint.size(), mountPoint) != 0)
+	{
+		return false;
+	}
+	relativePath.erase(0, mountPoint.size());
+
+	if (isNativeDirectory(realDir))
+	{
+		std::string nativePath = realDir;
+		const std::string separator = PHYSFS_getDirSeparator();
+		if (!strEndsWith(nativePath, separator))
+		{
+			nativePath += separator;
+		}
+		for (char c : relativePath)
+		{
+			if (c == '/')
+			{
+				nativePath += separator;
+			}
+			else
+			{
+				nativePath += c;
+			}
+		}
+		auto file = MappedFile::map(nativePath);
+		if (file == nullptr)
+		{
+			return false;
+		}
+		output.data = file->data();
+		output.size = file->size();
+		output.owner = std::move(file);
+		return true;
+	}
+
+	auto archive = mappedArchive(realDir);
+	if (archive == nullptr)
+	{
+		return false;
+	}
+	auto it = archive->storedEntries.find(relativePath);
+	if (it == archive->storedEntries.end())
+	{
+		return false;
+	}
+	output.data = archive->file->data() + it->second.dataOffset;
+	output.size = it->second.size;
+	output.owner = std::move(archive);
+	return true;
+}
+
+} // anonymous namespace
+
+#endif // defined(WZ_FILEVIEW_MMAP)
+
+std::unique_ptr<WzFileView> WZ_PHYSFS_openFileView(const char *fileName)
+{
+	auto view = std::make_unique<WzFileView>();
+#if defined(WZ_FILEVIEW_MMAP)
+	MappedData mapped;
+	if (mapPhysFSFile(fileName, mapped))
+	{
+		view->owner = std::move(mapped.owner);
+		view->pData = mapped.data;
+		view->length = mapped.size;
+		view->mapped = true;
+		return view;
+	}
+#endif
+
+	auto buffer = std::make_shared<std::vector<char>>();
+	if (!loadFileToBufferVector(fileName, *buffer, false, false))
+	{
+		return nullptr;
+	}
+	view->pData = buffer->data();
+	view->length = buffer->size();
+	view->owner = std::move(buffer);
+	return view;
+}
+
+void WZ_PHYSFS_releaseArchiveMappings()
+{
+#if defined(WZ_FILEVIEW_MMAP)
+	std::lock_guard<std::mutex> lock(archivesMutex);
+	mappedArchives.clear();
+#endif
+}
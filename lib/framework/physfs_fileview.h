@@ -0,0 +1,61 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file physfs_fileview.h
+ *  Zero-copy read access to files in the PhysFS search path.
+ *
+ *  Plain files in mounted directories and uncompressed (stored) entries of mounted zip archives
+ *  are memory-mapped; everything else (compressed entries, other archive types, platforms without
+ *  memory mapping, anything in the write dir) is read into a buffer, so callers don't have to care
+ *  which one they get.
+ *
+ *  Views should be short-lived: the file must not be modified while a view of it exists.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_PHYSFS_FILEVIEW_H__
+#define __INCLUDED_LIB_FRAMEWORK_PHYSFS_FILEVIEW_H__
+
+#include <stddef.h>
+#include <memory>
+
+/// A read-only view of the contents of a file. The data is NOT null-terminated.
+class WzFileView
+{
+public:
+	const char *data() const { return pData; }
+	size_t size() const { return length; }
+	bool isMemoryMapped() const { return mapped; }
+
+private:
+	friend std::unique_ptr<WzFileView> WZ_PHYSFS_openFileView(const char *fileName);
+
+	std::shared_ptr<const void> owner;  // the mapping or buffer that holds the data
+	const char *pData = nullptr;
+	size_t length = 0;
+	bool mapped = false;
+};
+
+/// Returns a view of the contents of `fileName`, or nullptr if it can't be read. Safe to call from any thread.
+std::unique_ptr<WzFileView> WZ_PHYSFS_openFileView(const char *fileName);
+
+/// Drops the cached mappings of zip archives (views that are still open stay valid).
+/// Call this when archives are unmounted, so they aren't kept open.
+void WZ_PHYSFS_releaseArchiveMappings();
+
+#endif // __INCLUDED_LIB_FRAMEWORK_PHYSFS_FILEVIEW_H__
@@ -29,10 +29,14 @@
 #include <cstddef>
 #include <memory>
 #include <type_traits>
-#include <unordered_set>
 
 /// <summary>
 /// STL-compatible allocator that uses MemoryPool for memory management.
+///
+/// The allocator only holds a reference to the pool, so it is cheap to copy (containers
+/// copy their allocators on every move). Whether a block came from the pool or from the
+/// default allocator is decided purely by the requested size, which is the same for the
+/// matching `allocate()` / `deallocate()` calls.
 /// </summary>
 template <typename T, typename PoolT = MemoryPool>
 class PoolAllocator
@@ -53,16 +57,12 @@ public:
 	explicit PoolAllocator(PoolT& pool) noexcept : pool_(pool) {}
 
 	PoolAllocator(const PoolAllocator& other) noexcept
-		: pool_(other.pool_),
-		defaultAlloc_(other.defaultAlloc_),
-		oversizedAllocs_(other.oversizedAllocs_)
+		: pool_(other.pool_)
 	{}
 
 	template <typename U>
 	PoolAllocator(const PoolAllocator<U, PoolT>& other) noexcept
-		: pool_(other.pool_),
-		defaultAlloc_(other.defaultAlloc_),
-		oversizedAllocs_(other.oversizedAllocs_)
+		: pool_(other.pool_)
 	{}
 
 	pointer allocate(size_type n)
@@ -70,9 +70,7 @@ public:
 		if (pool_.largest_supported_block_size() < std::max(n * sizeof(T), alignof(T)))
 		{
 			// Allocate via default new-delete allocator if there's no suitable block size available in the memory pool.
-			T* ret = defaultAlloc_.allocate(n);
-			oversizedAllocs_.emplace(ret);
-			return ret;
+			return defaultAlloc_.allocate(n);
 		}
 		T* ret = static_cast<pointer>(pool_.allocate(n * sizeof(T), alignof(T)));
 		if (!ret)
@@ -88,13 +86,7 @@ public:
 	{
 		if (pool_.largest_supported_block_size() < std::max(n * sizeof(T), alignof(T)))
 		{
-			auto oversizedIt = oversizedAllocs_.find(p);
-			ASSERT(oversizedIt != oversizedAllocs_.end(), "Block %p not allocated by the current allocator.", static_cast<void*>(p));
-			if (oversizedIt != oversizedAllocs_.end())
-			{
-				oversizedAllocs_.erase(oversizedIt);
-				defaultAlloc_.deallocate(p, n);
-			}
+			defaultAlloc_.deallocate(p, n);
 			return;
 		}
 		pool_.deallocate(static_cast<void*>(p), n * sizeof(T), alignof(T));
@@ -118,5 +110,4 @@ public:
 
 	PoolT& pool_;
 	std::allocator<T> defaultAlloc_;
-	std::unordered_set<void*> oversizedAllocs_;
 };
@@ -0,0 +1,990 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file savesnapshot.cpp
+ *  Binary save game snapshots.
+ *
+ *  File layout (all integers little-endian):
+ *    "WZSS", u32 format version, u32 section count
+ *    (version 2+) u32 base name length, base name (empty if no section refers to a base snapshot)
+ *    table of contents, per section: u32 name length, name, u32 schema version, u32 encoding,
+ *                                    u64 offset (from start of file), u64 size, u32 crc,
+ *                                    (version 2+) u32 crc of the base snapshot's section
+ *    section data
+ *
+ *  Incremental snapshots refer to a base snapshot (a file named SNAPSHOT_BASE_PREFIX...) in the
+ *  parent directory of the save game, which is shared by all incremental snapshots in that directory.
+ *  Every incremental snapshot is a single step away from its base, so removing one never breaks another.
+ *  Each entry of an object section (usually one game object) is hashed. Entries that are unchanged
+ *  are not stored at all, and entries that are equal to another entry of the base's section (as
+ *  happens when the numbering of the objects shifts) are only referenced by key. Once the differences grow too large,
+ *  a new base is written. Bases that are no longer referenced are removed after each incremental write,
+ *  and when a save game is deleted (saveSnapshotRemoveUnusedBases()).
+ */
+
+#include <nlohmann/json.hpp> // Must come before WZ includes
+
+#include "frame.h"
+#include "savesnapshot.h"
+#include "file.h"
+#include "crc.h"
+#include "physfs_ext.h"
+#include "wzapp.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define SNAPSHOT_MAGIC "WZSS"
+#define SNAPSHOT_BASE_PREFIX "snapshot-base-"
+static const uint32_t snapshotFormatVersion = 2;
+
+enum SnapshotEncoding : uint32_t
+{
+	SNAPSHOT_ENCODING_CBOR = 1,
+	SNAPSHOT_ENCODING_CBOR_ZLIB = 2,  ///< u64 size of the CBOR data, followed by the zlib stream
+	SNAPSHOT_ENCODING_BASE = 3,       ///< No data: the section is the same as the base snapshot's section
+	SNAPSHOT_ENCODING_DELTA = 4,      ///< Like CBOR_ZLIB, of the changes to the base snapshot's (object) section:
+	                                  ///< {"remove": [key], "move": {key: key in the base section}, "set": {key: value}}
+};
+
+/// Write a new base once the differences to it are larger than this fraction of its size
+static const uint64_t snapshotRebaseDivisor = 2;
+
+struct SnapshotSection
+{
+	std::string name;
+	uint32_t schemaVersion = 0;
+	uint32_t encoding = 0;
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	uint32_t crc = 0;
+	uint32_t baseCrc = 0;
+};
+
+struct PendingSection
+{
+	std::string name;
+	nlohmann::json json;        ///< Only kept until encoded, for asynchronous and incremental snapshots
+	std::function<nlohmann::json ()> buildJSON; ///< Builds json on the background thread, for asynchronous snapshots
+	uint32_t encoding = 0;
+	std::vector<uint8_t> data;
+	uint32_t baseCrc = 0;
+};
+
+/// The snapshot currently being written.
+struct PendingSnapshot
+{
+	bool active = false;
+	bool async = false;
+	bool incremental = false;
+	std::string dir;
+	uint32_t schemaVersion = 0;
+	std::vector<PendingSection> sections;
+	std::chrono::steady_clock::duration encodeTime {0};
+};
+
+/// The most recently read snapshot. Loading a save game reads many sections of the same snapshot.
+struct LoadedSnapshot
+{
+	std::string path;
+	PHYSFS_sint64 modTime = -1;
+	std::vector<char> data;
+	std::string baseName;
+	std::unordered_map<std::string, SnapshotSection> toc;
+};
+
+/// What incremental snapshots need to know about a section of their base snapshot.
+struct BaseSectionInfo
+{
+	uint32_t crc = 0;
+	uint64_t hash = 0;
+	bool isObject = false;
+	std::unordered_map<std::string, uint64_t> keys;     ///< key of each entry -> its hash
+	std::unordered_map<uint64_t, std::string> entries;  ///< hash of each entry -> its key
+};
+
+/// The base snapshot of the incremental snapshots written by this process.
+/// Only accessed while writing a snapshot (which never happens on two threads at once).
+struct SnapshotBase
+{
+	std::string dir;
+	std::string name;
+	uint64_t dataSize = 0;
+	std::unordered_map<std::string, BaseSectionInfo> sections;
+};
+
+/// Hashes of the contents of a section, and of each entry of an object section (in the order of the section's items).
+struct SectionHashes
+{
+	uint64_t hash = 0;
+	std::vector<uint64_t> entries;
+};
+
+static PendingSnapshot pendingSnapshot;
+static LoadedSnapshot loadedSnapshot;
+static LoadedSnapshot loadedBaseSnapshot;
+static SnapshotBase snapshotBase;
+static WZ_THREAD *writeThread = nullptr;
+
+static bool splitSavePath(const char *pFileName, std::string &dir, std::string &name)
+{
+	const char *sep = strrchr(pFileName, '/');
+	if (sep == nullptr || sep == pFileName || sep[1] == '\0')
+	{
+		return false;
+	}
+	dir.assign(pFileName, sep);
+	name.assign(sep + 1);
+	return true;
+}
+
+static std::string snapshotPath(const std::string &dir)
+{
+	return dir + "/" SAVE_SNAPSHOT_FILENAME;
+}
+
+static void putU32(std::vector<uint8_t> &out, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+static void putU64(std::vector<uint8_t> &out, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+static void patchU64(std::vector<uint8_t> &out, size_t pos, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+	{
+		out[pos + i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+static bool getU32(const std::vector<char> &in, size_t &pos, uint32_t &value)
+{
+	if (in.size() < 4 || pos > in.size() - 4)
+	{
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		value |= static_cast<uint32_t>(static_cast<uint8_t>(in[pos++])) << (8 * i);
+	}
+	return true;
+}
+
+static bool getU64(const std::vector<char> &in, size_t &pos, uint64_t &value)
+{
+	if (in.size() < 8 || pos > in.size() - 8)
+	{
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < 8; ++i)
+	{
+		value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos++])) << (8 * i);
+	}
+	return true;
+}
+
+static bool compressCBOR(const std::vector<uint8_t> &cbor, std::vector<uint8_t> &data, const std::string &name)
+{
+	uLongf compressedSize = compressBound(static_cast<uLong>(cbor.size()));
+	data.clear();
+	putU64(data, cbor.size());
+	data.resize(8 + compressedSize);
+	int result = compress2(data.data() + 8, &compressedSize, cbor.data(), static_cast<uLong>(cbor.size()), Z_BEST_SPEED);
+	if (result != Z_OK)
+	{
+		debug(LOG_ERROR, "Failed to compress %s (%d)", name.c_str(), result);
+		return false;
+	}
+	data.resize(8 + compressedSize);
+	return true;
+}
+
+static bool encodeSection(PendingSection &section, SnapshotEncoding encoding, bool releaseJSON = true)
+{
+	std::vector<uint8_t> cbor;
+	try {
+		cbor = nlohmann::json::to_cbor(section.json);
+	}
+	catch (const std::exception &e) {
+		ASSERT(false, "Failed to encode %s with error: %s", section.name.c_str(), e.what());
+		return false;
+	}
+	if (enabled_debug[LOG_SAVE])
+	{
+		// Only measured while debugging, as dumping the JSON costs as much as saving it
+		debug(LOG_SAVE, "Snapshot section %s: %zu bytes (%zu bytes as JSON)", section.name.c_str(), cbor.size(), section.json.dump(4).size());
+	}
+	if (releaseJSON)
+	{
+		section.json = nlohmann::json();
+	}
+
+	section.encoding = encoding;
+	section.baseCrc = 0;
+	if (encoding == SNAPSHOT_ENCODING_CBOR)
+	{
+		section.data = std::move(cbor);
+		return true;
+	}
+	return compressCBOR(cbor, section.data, section.name);
+}
+
+static bool writeSnapshotFile(const std::string &path, const std::string &baseName, uint32_t schemaVersion, const std::vector<PendingSection> &sections, size_t &fileSize)
+{
+	size_t dataSize = 0;
+	size_t tocSize = 16 + baseName.size();
+	for (const auto &section : sections)
+	{
+		dataSize += section.data.size();
+		tocSize += 4 + section.name.size() + 4 + 4 + 8 + 8 + 4 + 4;
+	}
+
+	std::vector<uint8_t> buffer;
+	buffer.reserve(tocSize + dataSize);
+	buffer.insert(buffer.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 4);
+	putU32(buffer, snapshotFormatVersion);
+	putU32(buffer, static_cast<uint32_t>(sections.size()));
+	putU32(buffer, static_cast<uint32_t>(baseName.size()));
+	buffer.insert(buffer.end(), baseName.begin(), baseName.end());
+	std::vector<size_t> offsetPositions;
+	for (const auto &section : sections)
+	{
+		putU32(buffer, static_cast<uint32_t>(section.name.size()));
+		buffer.insert(buffer.end(), section.name.begin(), section.name.end());
+		putU32(buffer, schemaVersion);
+		putU32(buffer, section.encoding);
+		offsetPositions.push_back(buffer.size());
+		putU64(buffer, 0);  // offset, patched below
+		putU64(buffer, section.data.size());
+		putU32(buffer, wz::crc_update(wz::crc_init(), section.data.data(), section.data.size()));
+		putU32(buffer, section.baseCrc);
+	}
+	for (size_t i = 0; i < sections.size(); ++i)
+	{
+		patchU64(buffer, offsetPositions[i], buffer.size());
+		const auto &data = sections[i].data;
+		buffer.insert(buffer.end(), data.begin(), data.end());
+	}
+
+	ASSERT_OR_RETURN(false, buffer.size() <= static_cast<size_t>(std::numeric_limits<UDWORD>::max()), "Snapshot %s is too large (%zu bytes)", path.c_str(), buffer.size());
+	fileSize = buffer.size();
+	return saveFile(path.c_str(), reinterpret_cast<const char *>(buffer.data()), static_cast<UDWORD>(buffer.size()));
+}
+
+static uint64_t hashBytes(const void *data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+	// FNV-1a
+	const uint8_t *bytes = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+static bool hashSection(const PendingSection &section, SectionHashes &hashes)
+{
+	try {
+		if (!section.json.is_object())
+		{
+			const auto cbor = nlohmann::json::to_cbor(section.json);
+			hashes.hash = hashBytes(cbor.data(), cbor.size());
+			return true;
+		}
+		hashes.hash = hashBytes("{", 1);
+		hashes.entries.reserve(section.json.size());
+		for (const auto &it : section.json.items())
+		{
+			const auto cbor = nlohmann::json::to_cbor(it.value());
+			const uint64_t entryHash = hashBytes(cbor.data(), cbor.size());
+			hashes.entries.push_back(entryHash);
+			hashes.hash = hashBytes(it.key().c_str(), it.key().size() + 1, hashes.hash);
+			hashes.hash = hashBytes(&entryHash, sizeof(entryHash), hashes.hash);
+		}
+	}
+	catch (const std::exception &e) {
+		ASSERT(false, "Failed to encode %s with error: %s", section.name.c_str(), e.what());
+		return false;
+	}
+	return true;
+}
+
+/// Store only the entries of `section` that differ from the base snapshot's section
+static bool encodeDeltaSection(PendingSection &section, const SectionHashes &hashes, const BaseSectionInfo &base)
+{
+	auto remove = nlohmann::json::array();
+	auto move = nlohmann::json::object();
+	auto set = nlohmann::json::object();
+	for (const auto &baseKey : base.keys)
+	{
+		if (!section.json.contains(baseKey.first))
+		{
+			remove.push_back(baseKey.first);
+		}
+	}
+	size_t i = 0;
+	for (const auto &it : section.json.items())
+	{
+		const uint64_t entryHash = hashes.entries[i++];
+		auto baseKey = base.keys.find(it.key());
+		if (baseKey != base.keys.end() && baseKey->second == entryHash)
+		{
+			continue;
+		}
+		auto baseEntry = base.entries.find(entryHash);
+		if (baseEntry != base.entries.end())
+		{
+			move[it.key()] = baseEntry->second;
+		}
+		else
+		{
+			set[it.key()] = it.value();
+		}
+	}
+	nlohmann::json delta = nlohmann::json::object();
+	delta["remove"] = std::move(remove);
+	delta["move"] = std::move(move);
+	delta["set"] = std::move(set);
+
+	std::vector<uint8_t> cbor;
+	try {
+		cbor = nlohmann::json::to_cbor(delta);
+	}
+	catch (const std::exception &e) {
+		ASSERT(false, "Failed to encode %s with error: %s", section.name.c_str(), e.what());
+		return false;
+	}
+	section.encoding = SNAPSHOT_ENCODING_DELTA;
+	section.baseCrc = base.crc;
+	return compressCBOR(cbor, section.data, section.name);
+}
+
+/// Write all sections of `snapshot` to a new base snapshot in `dir`, and make it the current base
+static bool writeSnapshotBase(PendingSnapshot &snapshot, const std::vector<SectionHashes> &hashes, const std::string &dir)
+{
+	std::string name;
+	const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	for (unsigned attempt = 0; name.empty() || PHYSFS_exists((dir + "/" + name).c_str()); ++attempt)
+	{
+		name = SNAPSHOT_BASE_PREFIX + std::to_string(now) + (attempt > 0 ? "-" + std::to_string(attempt) : "") + ".wzs";
+	}
+
+	SnapshotBase base;
+	base.dir = dir;
+	base.name = name;
+	std::vector<PendingSection> sections(snapshot.sections.size());
+	for (size_t i = 0; i < sections.size(); ++i)
+	{
+		BaseSectionInfo &info = base.sections[snapshot.sections[i].name];
+		info.hash = hashes[i].hash;
+		info.isObject = snapshot.sections[i].json.is_object();
+		if (info.isObject)
+		{
+			size_t entry = 0;
+			for (const auto &it : snapshot.sections[i].json.items())
+			{
+				info.keys.emplace(it.key(), hashes[i].entries[entry]);
+				info.entries.emplace(hashes[i].entries[entry], it.key());  // keeps the first of equal entries
+				++entry;
+			}
+		}
+		// (the snapshot itself will only refer to the base, so it doesn't need the JSON anymore)
+		sections[i].name = snapshot.sections[i].name;
+		sections[i].json = std::move(snapshot.sections[i].json);
+		if (!encodeSection(sections[i], SNAPSHOT_ENCODING_CBOR_ZLIB))
+		{
+			return false;
+		}
+		info.crc = wz::crc_update(wz::crc_init(), sections[i].data.data(), sections[i].data.size());
+		base.dataSize += sections[i].data.size();
+	}
+
+	size_t fileSize = 0;
+	if (!writeSnapshotFile(dir + "/" + name, std::string(), snapshot.schemaVersion, sections, fileSize))
+	{
+		return false;
+	}
+	debug(LOG_SAVE, "Saved new snapshot base %s/%s (%zu bytes)", dir.c_str(), name.c_str(), fileSize);
+	snapshotBase = std::move(base);
+	return true;
+}
+
+/// Encode the sections of an incremental snapshot, writing a new base snapshot if needed
+static bool encodeIncrementalSections(PendingSnapshot &snapshot, const std::string &baseDir)
+{
+	std::vector<SectionHashes> hashes(snapshot.sections.size());
+	for (size_t i = 0; i < snapshot.sections.size(); ++i)
+	{
+		if (!hashSection(snapshot.sections[i], hashes[i]))
+		{
+			return false;
+		}
+	}
+
+	bool rebase = snapshotBase.dir != baseDir || snapshotBase.name.empty() || !PHYSFS_exists((baseDir + "/" + snapshotBase.name).c_str());
+	uint64_t deltaSize = 0;
+	size_t unchanged = 0, deltas = 0;
+	for (size_t i = 0; i < snapshot.sections.size() && !rebase; ++i)
+	{
+		PendingSection &section = snapshot.sections[i];
+		auto base = snapshotBase.sections.find(section.name);
+		if (base != snapshotBase.sections.end() && base->second.hash == hashes[i].hash)
+		{
+			section.encoding = SNAPSHOT_ENCODING_BASE;
+			section.baseCrc = base->second.crc;
+			section.data.clear();
+			++unchanged;
+			continue;
+		}
+		bool encoded = (base != snapshotBase.sections.end() && base->second.isObject && section.json.is_object())
+			? encodeDeltaSection(section, hashes[i], base->second)
+			: encodeSection(section, SNAPSHOT_ENCODING_CBOR_ZLIB, false);
+		if (!encoded)
+		{
+			return false;
+		}
+		deltas += (section.encoding == SNAPSHOT_ENCODING_DELTA) ? 1 : 0;
+		deltaSize += section.data.size();
+		rebase = deltaSize > snapshotBase.dataSize / snapshotRebaseDivisor;
+	}
+
+	if (rebase)
+	{
+		if (!writeSnapshotBase(snapshot, hashes, baseDir))
+		{
+			return false;
+		}
+		for (auto &section : snapshot.sections)
+		{
+			section.encoding = SNAPSHOT_ENCODING_BASE;
+			section.baseCrc = snapshotBase.sections[section.name].crc;
+			section.data.clear();
+		}
+	}
+	else
+	{
+		debug(LOG_SAVE, "Incremental snapshot: %zu sections unchanged, %zu stored as differences, %zu stored in full (%zu bytes, base is %zu bytes)",
+		      unchanged, deltas, snapshot.sections.size() - unchanged - deltas, static_cast<size_t>(deltaSize), static_cast<size_t>(snapshotBase.dataSize));
+	}
+	for (auto &section : snapshot.sections)
+	{
+		section.json = nlohmann::json();
+	}
+	return true;
+}
+
+/// Returns the name of the base snapshot the snapshot at `path` refers to (if any)
+static std::string readSnapshotBaseName(const std::string &path)
+{
+	PHYSFS_file *fileHandle = PHYSFS_openRead(path.c_str());
+	if (fileHandle == nullptr)
+	{
+		return std::string();
+	}
+	std::vector<char> header(16);
+	std::string baseName;
+	size_t pos = 4;
+	uint32_t formatVersion = 0, count = 0, nameLength = 0;
+	if (WZ_PHYSFS_readBytes(fileHandle, header.data(), static_cast<PHYSFS_uint32>(header.size())) == static_cast<PHYSFS_sint64>(header.size())
+		&& memcmp(header.data(), SNAPSHOT_MAGIC, 4) == 0 && getU32(header, pos, formatVersion) && formatVersion >= 2
+		&& getU32(header, pos, count) && getU32(header, pos, nameLength) && nameLength <= PATH_MAX)
+	{
+		baseName.resize(nameLength);
+		if (nameLength > 0 && WZ_PHYSFS_readBytes(fileHandle, &baseName[0], nameLength) != static_cast<PHYSFS_sint64>(nameLength))
+		{
+			baseName.clear();
+		}
+	}
+	PHYSFS_close(fileHandle);
+	return baseName;
+}
+
+/// Remove the base snapshots in `dir` that no save game in it refers to anymore.
+/// The current base is kept if `keepCurrentBase` is set (it's about to be referenced by the snapshot being written).
+static void removeUnusedSnapshotBases(const std::string &dir, bool keepCurrentBase)
+{
+	const bool currentBaseInDir = !snapshotBase.name.empty() && snapshotBase.dir == dir;
+	std::vector<std::string> bases;
+	WZ_PHYSFS_enumerateFiles(dir.c_str(), [&](const char *file) {
+		if (strncmp(file, SNAPSHOT_BASE_PREFIX, strlen(SNAPSHOT_BASE_PREFIX)) == 0 && !(keepCurrentBase && currentBaseInDir && file == snapshotBase.name))
+		{
+			bases.push_back(file);
+		}
+		return true;
+	});
+	if (bases.empty())
+	{
+		return;
+	}
+	WZ_PHYSFS_enumerateFolders(dir, [&](const char *folder) {
+		const std::string baseName = readSnapshotBaseName(dir + "/" + folder + "/" SAVE_SNAPSHOT_FILENAME);
+		bases.erase(std::remove(bases.begin(), bases.end(), baseName), bases.end());
+		return true;
+	});
+	for (const auto &base : bases)
+	{
+		const std::string basePath = dir + "/" + base;
+		debug(LOG_SAVE, "Removing unused snapshot base %s", basePath.c_str());
+		PHYSFS_delete(basePath.c_str());
+		if (loadedBaseSnapshot.path == basePath)
+		{
+			loadedBaseSnapshot = LoadedSnapshot();
+		}
+		if (currentBaseInDir && base == snapshotBase.name)
+		{
+			// the next incremental snapshot writes a new base
+			snapshotBase = SnapshotBase();
+		}
+	}
+}
+
+static bool writeSnapshot(PendingSnapshot &snapshot)
+{
+	const SnapshotEncoding encoding = snapshot.async ? SNAPSHOT_ENCODING_CBOR_ZLIB : SNAPSHOT_ENCODING_CBOR;
+	const std::string path = snapshotPath(snapshot.dir);
+
+	// incremental snapshots share a base with the other save games in the parent directory
+	std::string baseDir, leafName;
+	const bool incremental = snapshot.incremental && splitSavePath(snapshot.dir.c_str(), baseDir, leafName);
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto &section : snapshot.sections)
+	{
+		if (section.buildJSON)
+		{
+			section.json = section.buildJSON();
+			section.buildJSON = nullptr;
+		}
+	}
+	if (incremental)
+	{
+		if (!encodeIncrementalSections(snapshot, baseDir))
+		{
+			debug(LOG_ERROR, "Failed to save %s", path.c_str());
+			return false;
+		}
+	}
+	else
+	{
+		for (auto &section : snapshot.sections)
+		{
+			if (section.data.empty() && !encodeSection(section, encoding))
+			{
+				debug(LOG_ERROR, "Failed to save %s", path.c_str());
+				return false;
+			}
+		}
+	}
+	snapshot.encodeTime += std::chrono::steady_clock::now() - start;
+
+	size_t fileSize = 0;
+	if (!writeSnapshotFile(path, incremental ? snapshotBase.name : std::string(), snapshot.schemaVersion, snapshot.sections, fileSize))
+	{
+		return false;
+	}
+
+	// Files saved as JSON by an earlier save would take precedence over the snapshot's sections.
+	for (const auto &section : snapshot.sections)
+	{
+		const std::string filePath = snapshot.dir + "/" + section.name;
+		if (PHYSFS_exists(filePath.c_str()))
+		{
+			PHYSFS_delete(filePath.c_str());
+		}
+	}
+	if (incremental)
+	{
+		removeUnusedSnapshotBases(baseDir, true);
+	}
+	debug(LOG_SAVE, "Saved %zu sections (%zu bytes) to %s, encoding took %u ms%s", snapshot.sections.size(), fileSize, path.c_str(),
+	      static_cast<unsigned>(std::chrono::duration_cast<std::chrono::milliseconds>(snapshot.encodeTime).count()), snapshot.async ? " (in the background)" : "");
+	return true;
+}
+
+static int snapshotWriteThreadFunc(void *data)
+{
+	std::unique_ptr<PendingSnapshot> snapshot(static_cast<PendingSnapshot *>(data));
+	return writeSnapshot(*snapshot) ? 0 : 1;
+}
+
+void saveSnapshotWaitForPendingWrites()
+{
+	if (writeThread != nullptr)
+	{
+		wzThreadJoin(writeThread);
+		writeThread = nullptr;
+		loadedSnapshot = LoadedSnapshot();
+		loadedBaseSnapshot = LoadedSnapshot();
+	}
+}
+
+void saveSnapshotBegin(const char *dir, uint32_t schemaVersion, bool async, bool incremental)
+{
+	ASSERT(!pendingSnapshot.active, "Snapshot of %s was never finished", pendingSnapshot.dir.c_str());
+	saveSnapshotWaitForPendingWrites();
+	pendingSnapshot = PendingSnapshot();
+	pendingSnapshot.active = true;
+	pendingSnapshot.async = async;
+	pendingSnapshot.incremental = incremental;
+	pendingSnapshot.dir = dir;
+	pendingSnapshot.schemaVersion = schemaVersion;
+}
+
+void saveSnapshotAbort()
+{
+	pendingSnapshot = PendingSnapshot();
+}
+
+bool saveSnapshotEnd()
+{
+	ASSERT_OR_RETURN(false, pendingSnapshot.active, "No snapshot is being written");
+	auto snapshot = std::unique_ptr<PendingSnapshot>(new PendingSnapshot(std::move(pendingSnapshot)));
+	pendingSnapshot = PendingSnapshot();
+	loadedSnapshot = LoadedSnapshot();
+	loadedBaseSnapshot = LoadedSnapshot();
+
+	if (snapshot->async)
+	{
+		ASSERT(writeThread == nullptr, "Failed to release prior thread");
+		writeThread = wzThreadCreate(snapshotWriteThreadFunc, snapshot.release(), "snapshotWriteThread");
+		wzThreadStart(writeThread);
+		return true;
+	}
+	return writeSnapshot(*snapshot);
+}
+
+void saveSnapshotRemove(const char *dir)
+{
+	saveSnapshotWaitForPendingWrites();
+	const std::string path = snapshotPath(dir);
+	if (PHYSFS_exists(path.c_str()))
+	{
+		PHYSFS_delete(path.c_str());
+	}
+	if (loadedSnapshot.path == path)
+	{
+		loadedSnapshot = LoadedSnapshot();
+	}
+}
+
+void saveSnapshotRemoveUnusedBases(const char *dir)
+{
+	saveSnapshotWaitForPendingWrites();
+	removeUnusedSnapshotBases(dir, false);
+}
+
+bool saveSnapshotCollects(const char *pFileName)
+{
+	if (!pendingSnapshot.active)
+	{
+		return false;
+	}
+	std::string dir, name;
+	return splitSavePath(pFileName, dir, name) && dir == pendingSnapshot.dir;
+}
+
+static PendingSection *pendingSection(const char *pFileName)
+{
+	std::string dir, name;
+	ASSERT_OR_RETURN(nullptr, saveSnapshotCollects(pFileName) && splitSavePath(pFileName, dir, name), "%s is not part of the snapshot", pFileName);
+
+	for (auto &existing : pendingSnapshot.sections)
+	{
+		if (existing.name == name)
+		{
+			return &existing;
+		}
+	}
+	pendingSnapshot.sections.emplace_back();
+	PendingSection *section = &pendingSnapshot.sections.back();
+	section->name = std::move(name);
+	return section;
+}
+
+void saveSnapshotWriteJSON(const char *pFileName, nlohmann::json obj)
+{
+	PendingSection *section = pendingSection(pFileName);
+	if (section == nullptr)
+	{
+		return;
+	}
+	section->json = std::move(obj);
+	section->buildJSON = nullptr;
+	section->data.clear();
+
+	// incremental snapshots need the JSON to compare it with their base
+	if (!pendingSnapshot.async && !pendingSnapshot.incremental)
+	{
+		auto start = std::chrono::steady_clock::now();
+		encodeSection(*section, SNAPSHOT_ENCODING_CBOR);
+		pendingSnapshot.encodeTime += std::chrono::steady_clock::now() - start;
+	}
+}
+
+void saveSnapshotWriteDeferredJSON(const char *pFileName, std::function<nlohmann::json ()> build)
+{
+	if (!pendingSnapshot.async)
+	{
+		saveSnapshotWriteJSON(pFileName, build());
+		return;
+	}
+	PendingSection *section = pendingSection(pFileName);
+	if (section == nullptr)
+	{
+		return;
+	}
+	section->json = nlohmann::json();
+	section->buildJSON = std::move(build);
+	section->data.clear();
+}
+
+static bool parseSnapshot(LoadedSnapshot &snapshot)
+{
+	const auto &data = snapshot.data;
+	size_t pos = 4;
+	uint32_t formatVersion = 0, count = 0;
+	if (data.size() < 12 || memcmp(data.data(), SNAPSHOT_MAGIC, 4) != 0 || !getU32(data, pos, formatVersion) || !getU32(data, pos, count))
+	{
+		debug(LOG_ERROR, "%s is not a save snapshot", snapshot.path.c_str());
+		return false;
+	}
+	if (formatVersion > snapshotFormatVersion)
+	{
+		debug(LOG_ERROR, "%s has unsupported snapshot version %u", snapshot.path.c_str(), formatVersion);
+		return false;
+	}
+	if (formatVersion >= 2)
+	{
+		uint32_t baseNameLength = 0;
+		if (!getU32(data, pos, baseNameLength) || baseNameLength > data.size() - pos)
+		{
+			debug(LOG_ERROR, "%s has a truncated header", snapshot.path.c_str());
+			return false;
+		}
+		snapshot.baseName.assign(data.data() + pos, baseNameLength);
+		pos += baseNameLength;
+	}
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		SnapshotSection section;
+		uint32_t nameLength = 0;
+		if (!getU32(data, pos, nameLength) || nameLength > data.size() - pos)
+		{
+			debug(LOG_ERROR, "%s has a truncated table of contents", snapshot.path.c_str());
+			return false;
+		}
+		section.name.assign(data.data() + pos, nameLength);
+		pos += nameLength;
+		if (!getU32(data, pos, section.schemaVersion) || !getU32(data, pos, section.encoding) || !getU64(data, pos, section.offset)
+			|| !getU64(data, pos, section.size) || !getU32(data, pos, section.crc)
+			|| (formatVersion >= 2 && !getU32(data, pos, section.baseCrc))
+			|| section.offset > data.size() || section.size > data.size() - section.offset)
+		{
+			debug(LOG_ERROR, "%s has a truncated table of contents", snapshot.path.c_str());
+			return false;
+		}
+		snapshot.toc[section.name] = std::move(section);
+	}
+	return true;
+}
+
+/// Loads the snapshot at `path` into `snapshot` (unless it's already there). Returns nullptr if there is none.
+static const LoadedSnapshot *loadSnapshotFile(LoadedSnapshot &snapshot, const std::string &path)
+{
+	if (!PHYSFS_exists(path.c_str()))
+	{
+		return nullptr;
+	}
+	PHYSFS_sint64 modTime = WZ_PHYSFS_getLastModTime(path.c_str());
+	if (snapshot.path == path && snapshot.modTime == modTime)
+	{
+		return snapshot.toc.empty() ? nullptr : &snapshot;
+	}
+
+	snapshot = LoadedSnapshot();
+	snapshot.path = path;
+	snapshot.modTime = modTime;
+	if (!loadFileToBufferVector(path.c_str(), snapshot.data, false, false) || !parseSnapshot(snapshot))
+	{
+		snapshot.data.clear();
+		snapshot.toc.clear();
+		return nullptr;
+	}
+	debug(LOG_SAVE, "Loaded %s (%zu sections)", path.c_str(), snapshot.toc.size());
+	return &snapshot;
+}
+
+/// Returns the snapshot in `dir`, or nullptr if there is none.
+static const LoadedSnapshot *loadSnapshot(const std::string &dir)
+{
+	saveSnapshotWaitForPendingWrites();
+	return loadSnapshotFile(loadedSnapshot, snapshotPath(dir));
+}
+
+static const SnapshotSection *findSection(const char *pFileName, const LoadedSnapshot *&snapshot)
+{
+	std::string dir, name;
+	if (!splitSavePath(pFileName, dir, name))
+	{
+		return nullptr;
+	}
+	snapshot = loadSnapshot(dir);
+	if (snapshot == nullptr)
+	{
+		return nullptr;
+	}
+	auto it = snapshot->toc.find(name);
+	return it != snapshot->toc.end() ? &it->second : nullptr;
+}
+
+/// Decodes the data of `section` (which must not refer to a base snapshot's section)
+static bool decodeSectionData(const LoadedSnapshot &snapshot, const SnapshotSection &section, const char *pFileName, nlohmann::json &obj)
+{
+	const char *begin = snapshot.data.data() + section.offset;
+	ASSERT_OR_RETURN(false, wz::crc_update(wz::crc_init(), begin, section.size) == section.crc, "%s: corrupted snapshot section", pFileName);
+	const uint8_t *cborBegin = reinterpret_cast<const uint8_t *>(begin);
+	size_t cborSize = section.size;
+	std::vector<uint8_t> uncompressed;
+	if (section.encoding == SNAPSHOT_ENCODING_CBOR_ZLIB || section.encoding == SNAPSHOT_ENCODING_DELTA)
+	{
+		uint64_t size = 0;
+		size_t pos = section.offset;
+		ASSERT_OR_RETURN(false, section.size >= 8 && getU64(snapshot.data, pos, size) && size <= std::numeric_limits<uLong>::max(), "%s: corrupted snapshot section", pFileName);
+		uncompressed.resize(size);
+		uLongf uncompressedSize = static_cast<uLongf>(size);
+		int result = uncompress(uncompressed.data(), &uncompressedSize, cborBegin + 8, static_cast<uLong>(section.size - 8));
+		ASSERT_OR_RETURN(false, result == Z_OK && uncompressedSize == size, "%s: failed to decompress snapshot section (%d)", pFileName, result);
+		cborBegin = uncompressed.data();
+		cborSize = uncompressed.size();
+	}
+	else
+	{
+		ASSERT_OR_RETURN(false, section.encoding == SNAPSHOT_ENCODING_CBOR, "%s: unknown encoding %u", pFileName, section.encoding);
+	}
+	try {
+		obj = nlohmann::json::from_cbor(cborBegin, cborBegin + cborSize);
+	}
+	catch (const std::exception &e) {
+		ASSERT(false, "Snapshot section %s is invalid: %s", pFileName, e.what());
+		return false;
+	}
+	return true;
+}
+
+/// Decodes the base snapshot's section that `section` refers to
+static bool readBaseSection(const LoadedSnapshot &snapshot, const SnapshotSection &section, const char *pFileName, nlohmann::json &obj)
+{
+	std::string dir, baseDir, name;
+	ASSERT_OR_RETURN(false, !snapshot.baseName.empty() && splitSavePath(snapshot.path.c_str(), dir, name) && splitSavePath(dir.c_str(), baseDir, name),
+	                 "%s: snapshot section refers to a missing base", pFileName);
+	const std::string basePath = baseDir + "/" + snapshot.baseName;
+	const LoadedSnapshot *base = loadSnapshotFile(loadedBaseSnapshot, basePath);
+	ASSERT_OR_RETURN(false, base != nullptr, "%s: snapshot base %s can't be read", pFileName, basePath.c_str());
+	auto it = base->toc.find(section.name);
+	ASSERT_OR_RETURN(false, it != base->toc.end() && it->second.crc == section.baseCrc, "%s: snapshot base %s doesn't match", pFileName, basePath.c_str());
+	return decodeSectionData(*base, it->second, pFileName, obj);
+}
+
+bool saveSnapshotReadJSON(const char *pFileName, nlohmann::json &obj)
+{
+	const LoadedSnapshot *snapshot = nullptr;
+	const SnapshotSection *section = findSection(pFileName, snapshot);
+	if (section == nullptr)
+	{
+		return false;
+	}
+	if (section->encoding == SNAPSHOT_ENCODING_BASE)
+	{
+		if (!readBaseSection(*snapshot, *section, pFileName, obj))
+		{
+			return false;
+		}
+	}
+	else if (section->encoding == SNAPSHOT_ENCODING_DELTA)
+	{
+		nlohmann::json base, delta;
+		if (!decodeSectionData(*snapshot, *section, pFileName, delta) || !readBaseSection(*snapshot, *section, pFileName, base))
+		{
+			return false;
+		}
+		try {
+			// moved entries are copied before anything is removed or replaced
+			std::vector<std::pair<std::string, nlohmann::json>> moved;
+			for (const auto &move : delta.at("move").items())
+			{
+				moved.emplace_back(move.key(), base.at(move.value().get<std::string>()));
+			}
+			for (const auto &key : delta.at("remove"))
+			{
+				base.erase(key.get<std::string>());
+			}
+			for (auto &move : moved)
+			{
+				base[move.first] = std::move(move.second);
+			}
+			for (auto &set : delta.at("set").items())
+			{
+				base[set.key()] = std::move(set.value());
+			}
+			obj = std::move(base);
+		}
+		catch (const std::exception &e) {
+			ASSERT(false, "Snapshot section %s is invalid: %s", pFileName, e.what());
+			return false;
+		}
+	}
+	else if (!decodeSectionData(*snapshot, *section, pFileName, obj))
+	{
+		return false;
+	}
+	debug(LOG_SAVE, "Read %s from snapshot (schema version %u)", pFileName, section->schemaVersion);
+	return true;
+}
+
+bool saveSnapshotFileExists(const char *pFileName)
+{
+	if (PHYSFS_exists(pFileName))
+	{
+		return true;
+	}
+	const LoadedSnapshot *snapshot = nullptr;
+	return findSection(pFileName, snapshot) != nullptr;
+}
@@ -0,0 +1,80 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+/** @file savesnapshot.h
+ *  Binary save game snapshots.
+ *
+ *  A snapshot stores all JSON files of a save game directory as sections of a single binary
+ *  file (SAVE_SNAPSHOT_FILENAME), each encoded as CBOR (compressed with zlib for asynchronous
+ *  snapshots) and tagged with its schema version.
+ *  The file starts with a table of contents, so single sections can be decoded without
+ *  touching the others.
+ *
+ *  While a snapshot is being written, WzConfig and saveJSONToFile() store files in that
+ *  directory as sections instead of writing them. When reading, WzConfig and parseJsonFile()
+ *  fall back to the snapshot for files that don't exist, so the JSON loaders don't need to
+ *  know about snapshots.
+ *
+ *  Asynchronous snapshots only keep the JSON trees on the calling thread. Encoding, compressing
+ *  and writing them happens on a background thread, which is waited for before the next snapshot
+ *  is accessed. Sections written with saveSnapshotWriteDeferredJSON() even build their JSON tree
+ *  on that thread, from plain copies of the game state taken by the caller.
+ *
+ *  Incremental snapshots (used for autosaves) share a base snapshot with the other save games in the
+ *  parent directory, and only store the entries of each section that differ from it.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_SAVESNAPSHOT_H__
+#define __INCLUDED_LIB_FRAMEWORK_SAVESNAPSHOT_H__
+
+#include <stdint.h>
+#include <functional>
+#include <nlohmann/json_fwd.hpp>
+
+#define SAVE_SNAPSHOT_FILENAME "snapshot.wzs"
+
+/// Start collecting the JSON files written to `dir` into a snapshot.
+/// If `incremental` is set, the snapshot only stores what differs from the base snapshot in the parent directory of `dir`.
+void saveSnapshotBegin(const char *dir, uint32_t schemaVersion, bool async = false, bool incremental = false);
+/// Write the collected snapshot, and remove any files it replaces.
+/// For asynchronous snapshots, this only starts the background write.
+bool saveSnapshotEnd();
+/// Discard the collected snapshot without writing anything.
+void saveSnapshotAbort();
+/// Remove the snapshot in `dir` (if any), so it can't shadow files that are saved as JSON.
+void saveSnapshotRemove(const char *dir);
+/// Remove the base snapshots of incremental snapshots in `dir` that no save game in it refers to anymore.
+/// Call this after deleting a save game from `dir`.
+void saveSnapshotRemoveUnusedBases(const char *dir);
+/// Wait until the background write of an asynchronous snapshot (if any) has finished.
+void saveSnapshotWaitForPendingWrites();
+
+/// Returns true if `pFileName` is in the directory of the snapshot being written.
+bool saveSnapshotCollects(const char *pFileName);
+/// Store `obj` as the section for `pFileName` in the snapshot being written.
+void saveSnapshotWriteJSON(const char *pFileName, nlohmann::json obj);
+/// Like saveSnapshotWriteJSON(), but for asynchronous snapshots `build` is only called on the background thread.
+/// It must not access the game state, so everything it needs has to be copied into it.
+void saveSnapshotWriteDeferredJSON(const char *pFileName, std::function<nlohmann::json ()> build);
+/// If the snapshot in the directory of `pFileName` has a section for it, decode it into `obj` and return true.
+bool saveSnapshotReadJSON(const char *pFileName, nlohmann::json &obj);
+/// Like PHYSFS_exists, but also finds files stored in a snapshot.
+bool saveSnapshotFileExists(const char *pFileName);
+
+#endif // __INCLUDED_LIB_FRAMEWORK_SAVESNAPSHOT_H__
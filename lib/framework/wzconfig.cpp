@@ -29,12 +29,21 @@
 #include <sstream>
 #include <limits>
 #include "physfs_ext.h"
+#include "savesnapshot.h"
+#include "parallel_for.h"
+#include <unordered_map>
 
 WzConfig::~WzConfig()
 {
 	if (mWarning == ReadAndWrite)
 	{
 		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %zu.", mObjStack.size());
+		if (saveSnapshotCollects(mFilename.toUtf8().c_str()))
+		{
+			debug(LOG_SAVE, "Saving %s to snapshot", mFilename.toUtf8().c_str());
+			saveSnapshotWriteJSON(mFilename.toUtf8().c_str(), std::move(mRoot));
+			return;
+		}
 		std::ostringstream stream;
 		stream << mRoot.dump(4) << std::endl;
 		std::string jsonString = stream.str();
@@ -68,6 +77,77 @@ static nlohmann::json jsonMerge(nlohmann::json original, const nlohmann::json& o
 	return original;
 }
 
+// JSON files parsed ahead of time by WzConfig::preparseFiles(), by path
+static std::unordered_map<std::string, nlohmann::json> preparsedFiles;
+
+// Moves the preparsed tree of `path` (if any) into `obj`
+static bool takePreparsedFile(const std::string &path, nlohmann::json &obj)
+{
+	auto it = preparsedFiles.find(path);
+	if (it == preparsedFiles.end())
+	{
+		return false;
+	}
+	obj = std::move(it->second);
+	preparsedFiles.erase(it);
+	return true;
+}
+
+void WzConfig::preparseFiles(const std::vector<std::string> &fileNames)
+{
+	// Also parse the diffs of every file, which are merged in order by the constructor
+	std::vector<std::string> paths;
+	std::vector<std::string> diffDirs;
+	WZ_PHYSFS_enumerateFolders("diffs", [&](const char *i) -> bool {
+		diffDirs.push_back(std::string("diffs/") + i + "/");
+		return true; // continue
+	});
+	for (const auto &fileName : fileNames)
+	{
+		if (preparsedFiles.count(fileName) != 0 || !PHYSFS_exists(fileName.c_str()))
+		{
+			continue;
+		}
+		paths.push_back(fileName);
+		for (const auto &diffDir : diffDirs)
+		{
+			std::string diffPath = diffDir + fileName;
+			if (PHYSFS_exists(diffPath.c_str()))
+			{
+				paths.push_back(std::move(diffPath));
+			}
+		}
+	}
+
+	// Files that fail to load or parse are left out, so the constructor reports the error as usual
+	std::vector<nlohmann::json> results(paths.size());
+	wzParallelFor(paths.size(), [&](size_t i) {
+		std::vector<char> data;
+		if (!loadFileToBufferVector(paths[i].c_str(), data, false, false))
+		{
+			return;
+		}
+		try {
+			results[i] = nlohmann::json::parse(data.begin(), data.end());
+		}
+		catch (...) {
+			results[i] = nlohmann::json();
+		}
+	});
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		if (results[i].is_object())
+		{
+			preparsedFiles[paths[i]] = std::move(results[i]);
+		}
+	}
+}
+
+void WzConfig::clearPreparsedFiles()
+{
+	preparsedFiles.clear();
+}
+
 WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 : mArray(nlohmann::json::array())
 {
@@ -81,6 +161,17 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 
 	if (!PHYSFS_exists(name.toUtf8().c_str()))
 	{
+		if (saveSnapshotReadJSON(name.toUtf8().c_str(), mRoot))
+		{
+			pCurrentObj = &mRoot;
+			if (!mRoot.is_object())
+			{
+				ASSERT(false, "JSON document from %s is not an object", name.toUtf8().c_str());
+				mRoot = nlohmann::json::object();
+				mStatus = false;
+			}
+			return;
+		}
 		if (warning == ReadOnly)
 		{
 			mStatus = false;
@@ -96,36 +187,45 @@ WzConfig::WzConfig(const WzString &name, WzConfig::warning warning)
 			return;
 		}
 	}
-	if (!loadFile(name.toUtf8().c_str(), &data, &size))
+	if (!takePreparsedFile(name.toUtf8(), mRoot))
 	{
-		mStatus = false;
-		debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
-		return;
-	}
-	ASSERT_OR_RETURN(, data != nullptr, "Null data?");
+		if (!loadFile(name.toUtf8().c_str(), &data, &size))
+		{
+			mStatus = false;
+			debug(LOG_FATAL, "Could not open \"%s\"", name.toUtf8().c_str());
+			return;
+		}
+		ASSERT_OR_RETURN(, data != nullptr, "Null data?");
 
-	try {
-		mRoot = nlohmann::json::parse(data, data + size);
-	}
-	catch (const std::exception &e) {
-		ASSERT(false, "JSON document from %s is invalid: %s", name.toUtf8().c_str(), e.what());
-	}
-	catch (...) {
-		debug(LOG_FATAL, "Unexpected exception parsing JSON %s", name.toUtf8().c_str());
-	}
-	pCurrentObj = &mRoot;
-	ASSERT(!mRoot.is_null(), "JSON document from %s is null", name.toUtf8().c_str());
-	if (!mRoot.is_object())
-	{
-		ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
-		mRoot = nlohmann::json::object();
-		mStatus = false;
+		try {
+			mRoot = nlohmann::json::parse(data, data + size);
+		}
+		catch (const std::exception &e) {
+			ASSERT(false, "JSON document from %s is invalid: %s", name.toUtf8().c_str(), e.what());
+		}
+		catch (...) {
+			debug(LOG_FATAL, "Unexpected exception parsing JSON %s", name.toUtf8().c_str());
+		}
+		ASSERT(!mRoot.is_null(), "JSON document from %s is null", name.toUtf8().c_str());
+		if (!mRoot.is_object())
+		{
+			ASSERT(mRoot.is_object(), "JSON document from %s is not an object. Read: \n%s", name.toUtf8().c_str(), data);
+			mRoot = nlohmann::json::object();
+			mStatus = false;
+			free(data);
+			return;
+		}
 		free(data);
-		return;
 	}
-	free(data);
+	pCurrentObj = &mRoot;
 	WZ_PHYSFS_enumerateFolders("diffs", [&](const char *i) -> bool {
 		std::string str(std::string("diffs/") + i + std::string("/") + name.toUtf8().c_str());
+		nlohmann::json preparsedDiff;
+		if (takePreparsedFile(str, preparsedDiff))
+		{
+			mRoot = jsonMerge(mRoot, preparsedDiff);
+			return true; // continue;
+		}
 		if (!PHYSFS_exists(str.c_str()))
 		{
 			return true; // continue;
@@ -114,6 +114,12 @@ public:
 	WzConfig(const WzString &name, WzConfig::warning warning);
 	~WzConfig();
 
+	/// Reads and parses the given JSON files (and their diffs) concurrently, so the WzConfig
+	/// instances that open them later don't have to. Files that fail to parse are skipped.
+	static void preparseFiles(const std::vector<std::string> &fileNames);
+	/// Discards the preparsed files that were not opened.
+	static void clearPreparsedFiles();
+
 	Vector3f vector3f(const WzString &name);
 	void setVector3f(const WzString &name, const Vector3f &v);
 	Vector3i vector3i(const WzString &name);
@@ -30,6 +30,7 @@
 #include "gtime.h"
 #include "src/multiplay.h"
 #include "lib/netplay/netplay.h"
+#include "lib/netplay/nettelemetry.h"
 
 
 #include <time.h>
@@ -57,6 +58,7 @@ static uint32_t gameQueueTime[MAX_GAMEQUEUE_SLOTS];
 static uint32_t gameQueueCheckTime[MAX_GAMEQUEUE_SLOTS];
 static uint32_t gameQueueCheckCrc[MAX_GAMEQUEUE_SLOTS];
 static bool     crcError = false;
+static SyncCheckStats syncCheckStats;
 
 static uint32_t updateReadyTime = 0;
 static uint32_t updateWantedTime = 0;
@@ -120,6 +122,7 @@ void gameTimeInit(void)
 
 	// Don't let syncDebug from previous games cause a desynch dump at gameTime 102.
 	crcError = false;
+	syncCheckStats = SyncCheckStats();
 	resetSyncDebug();
 }
 
@@ -425,6 +428,7 @@ void sendPlayerGameTime()
 		NETuint16_t(w, wantedLatency);
 		NETend(w);
 	}
+	NETtelemetryRecordGameTimeSent(checkTime);
 
 	debugVerboseLogSyncIfNeeded();
 }
@@ -468,11 +472,21 @@ void recvPlayerGameTime(NETQUEUE queue)
 	gameQueueCheckTime[queue.index] = checkTime;
 	gameQueueCheckCrc[queue.index] = checkCrc;
 
+	if (queue.index != selectedPlayer)
+	{
+		NETtelemetryRecordGameTimeReceived(queue.index, checkTime);
+	}
+
 	if (shouldCheckDebugSyncForPlayerSlot(queue.index))
 	{
 		syncDebug("GAME_GAME_TIME p%d;lat%u,ct%u,crc%04X,wlat%u", queue.index, latencyTicks, checkTime, checkCrc, wantedLatencies[queue.index]);
+		++syncCheckStats.checks;
 		if (!checkDebugSync(checkTime, checkCrc))
 		{
+			if (syncCheckStats.errors++ == 0)
+			{
+				syncCheckStats.firstErrorGameTime = checkTime;
+			}
 			debug(LOG_ERROR, "Found CRC error when receiving GAME_GAME_TIME for player: %" PRIu8 " (checkTime: %" PRIu32 ", checkCrc: %" PRIu16 ")", queue.index, checkTime, checkCrc);
 			crcError = true;
 			if (NetPlay.players[queue.index].allocated)
@@ -488,6 +502,11 @@ void recvPlayerGameTime(NETQUEUE queue)
 	}
 }
 
+SyncCheckStats getSyncCheckStats()
+{
+	return syncCheckStats;
+}
+
 bool checkPlayerGameTime(unsigned player)
 {
 	unsigned begin = player, end = player + 1;
@@ -200,6 +200,14 @@ static inline Vector3i gameTimeAdjustedAverage(Vector3i numerator, int denominat
 
 void sendPlayerGameTime();                                ///< Sends a GAME_GAME_TIME message with gameTime plus latency to our game queues.
 void recvPlayerGameTime(NETQUEUE queue);                  ///< Processes a GAME_GAME_TIME message.
+
+struct SyncCheckStats
+{
+	uint32_t checks = 0;              ///< Number of GAME_GAME_TIME CRCs checked against our own syncDebug CRCs.
+	uint32_t errors = 0;              ///< Number of those checks that failed.
+	uint32_t firstErrorGameTime = 0;  ///< checkTime of the first failed check.
+};
+SyncCheckStats getSyncCheckStats();                       ///< Returns the sync check counters since the last gameTimeInit().
 bool checkPlayerGameTime(unsigned player);                ///< Checks that we are not waiting for a GAME_GAME_TIME message from this player. (player can be NET_ALL_PLAYERS.)
 void setPlayerGameTime(unsigned player, uint32_t time);   ///< Sets the player's time.
 
@@ -17,11 +17,21 @@
 	along with Warzone 2100; if not, write to the Free Software
 	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 */
+
 #include "culling.h"
 #include <array>
 #include <glm/glm.hpp>
 #include <algorithm>
-#include <functional>
+
+#if defined(WZ_CULLING_NO_SIMD)
+// (only the scalar code, to compare against - see tests/cullingbench.cpp)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define WZ_CULLING_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define WZ_CULLING_NEON
+#endif
 
 BoundingBox transformBoundingBox(const glm::mat4& worldViewProjectionMatrix, const BoundingBox& worldSpaceBoundingBox)
 {
@@ -35,20 +45,209 @@ BoundingBox transformBoundingBox(const glm::mat4& worldViewProjectionMatrix, con
 	return bboxInClipSpace;
 }
 
+ViewFrustum ViewFrustum::fromBox(float x0, float x1, float y0, float y1, float z0, float z1, bool yAxisInverted)
+{
+	const float ySign = yAxisInverted ? -1.f : 1.f;
+	ViewFrustum frustum;
+	frustum.planes = {
+		glm::vec4(1.f, 0.f, 0.f, -x0),
+		glm::vec4(-1.f, 0.f, 0.f, x1),
+		glm::vec4(0.f, ySign, 0.f, -y0),
+		glm::vec4(0.f, -ySign, 0.f, y1),
+		glm::vec4(0.f, 0.f, 1.f, -z0),
+		glm::vec4(0.f, 0.f, -1.f, z1)
+	};
+	return frustum;
+}
+
+void BoundingBoxArray::clear()
+{
+	minX.clear(); minY.clear(); minZ.clear();
+	maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void BoundingBoxArray::reserve(size_t count)
+{
+	minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+	maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+}
+
+void BoundingBoxArray::push_back(const glm::vec3& min, const glm::vec3& max)
+{
+	minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+	maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+void BoundingBoxArray::push_back(const BoundingBox& points)
+{
+	glm::vec3 min = points[0];
+	glm::vec3 max = points[0];
+	for (const auto& point : points)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+	push_back(min, max);
+}
+
+void BoundingSphereArray::clear()
+{
+	x.clear(); y.clear(); z.clear(); radius.clear();
+}
+
+void BoundingSphereArray::reserve(size_t count)
+{
+	x.reserve(count); y.reserve(count); z.reserve(count); radius.reserve(count);
+}
+
+void BoundingSphereArray::push_back(const glm::vec3& centre, float sphereRadius)
+{
+	x.push_back(centre.x); y.push_back(centre.y); z.push_back(centre.z); radius.push_back(sphereRadius);
+}
+
+// 4 wide operations (the scalar code below handles the remaining elements, and everything if there is no SIMD support)
+#if defined(WZ_CULLING_SSE2)
+#define WZ_CULLING_SIMD
+typedef __m128 Float4;
+typedef __m128 Mask4;
+static inline Float4 load4(const float *p) { return _mm_loadu_ps(p); }
+static inline Float4 splat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Mask4 lessThan4(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+static inline Mask4 or4(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+static inline Mask4 noneMask4() { return _mm_setzero_ps(); }
+static inline unsigned maskBits4(Mask4 m) { return static_cast<unsigned>(_mm_movemask_ps(m)); }
+#elif defined(WZ_CULLING_NEON)
+#define WZ_CULLING_SIMD
+typedef float32x4_t Float4;
+typedef uint32x4_t Mask4;
+static inline Float4 load4(const float *p) { return vld1q_f32(p); }
+static inline Float4 splat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+static inline Float4 mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Mask4 lessThan4(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+static inline Mask4 or4(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+static inline Mask4 noneMask4() { return vdupq_n_u32(0); }
+static inline unsigned maskBits4(Mask4 m)
+{
+	return (vgetq_lane_u32(m, 0) & 1) | ((vgetq_lane_u32(m, 1) & 1) << 1) | ((vgetq_lane_u32(m, 2) & 1) << 2) | ((vgetq_lane_u32(m, 3) & 1) << 3);
+}
+#endif
+
+#if defined(WZ_CULLING_SIMD)
+static inline void storeVisible4(Mask4 outside, uint8_t *visible)
+{
+	const unsigned bits = maskBits4(outside);
+	visible[0] = (bits & 1) ? 0 : 1;
+	visible[1] = (bits & 2) ? 0 : 1;
+	visible[2] = (bits & 4) ? 0 : 1;
+	visible[3] = (bits & 8) ? 0 : 1;
+}
+#endif
 
-bool isBBoxInClipSpace(const IntersectionOfHalfSpace& intersectionOfHalfSpace, const BoundingBox& points)
+void cullBoxes(const ViewFrustum& frustum, const BoundingBoxArray& boxes, std::vector<uint8_t>& visible)
 {
-	// We test against the complement of the half space
-	// If all points lies in the complement a half space, it can't be part of the intersection
-	auto CheckAllPointsInSpace = [&points](const HalfSpaceCheck& predicate)
+	const size_t count = boxes.size();
+	visible.resize(count);
+
+	// Only the corner furthest along the plane normal needs to be tested against each plane
+	struct PlaneCorner
+	{
+		glm::vec4 plane;
+		const float *x, *y, *z;
+	};
+	std::array<PlaneCorner, 6> planeCorners;
+	for (size_t p = 0; p < planeCorners.size(); ++p)
+	{
+		const glm::vec4& plane = frustum.planes[p];
+		planeCorners[p] = PlaneCorner{plane,
+			(plane.x >= 0.f) ? boxes.maxX.data() : boxes.minX.data(),
+			(plane.y >= 0.f) ? boxes.maxY.data() : boxes.minY.data(),
+			(plane.z >= 0.f) ? boxes.maxZ.data() : boxes.minZ.data()};
+	}
+
+	size_t i = 0;
+#if defined(WZ_CULLING_SIMD)
+	const Float4 zero = splat4(0.f);
+	for (; i + 4 <= count; i += 4)
+	{
+		Mask4 outside = noneMask4();
+		for (const auto& corner : planeCorners)
 		{
-			return std::all_of(points.begin(), points.end(), [&predicate](const auto& v) { return !predicate(v); });
-		};
+			Float4 dist = add4(add4(mul4(splat4(corner.plane.x), load4(corner.x + i)), mul4(splat4(corner.plane.y), load4(corner.y + i))),
+				add4(mul4(splat4(corner.plane.z), load4(corner.z + i)), splat4(corner.plane.w)));
+			outside = or4(outside, lessThan4(dist, zero));
+		}
+		storeVisible4(outside, &visible[i]);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		bool outside = false;
+		for (const auto& corner : planeCorners)
+		{
+			outside |= corner.plane.x * corner.x[i] + corner.plane.y * corner.y[i] + corner.plane.z * corner.z[i] + corner.plane.w < 0.f;
+		}
+		visible[i] = outside ? 0 : 1;
+	}
+}
 
-	for (const auto& predicate : intersectionOfHalfSpace)
+void cullSpheres(const ViewFrustum& frustum, const BoundingSphereArray& spheres, std::vector<uint8_t>& visible)
+{
+	const size_t count = spheres.size();
+	visible.resize(count);
+
+	size_t i = 0;
+#if defined(WZ_CULLING_SIMD)
+	const Float4 zero = splat4(0.f);
+	for (; i + 4 <= count; i += 4)
+	{
+		const Float4 x = load4(&spheres.x[i]), y = load4(&spheres.y[i]), z = load4(&spheres.z[i]), radius = load4(&spheres.radius[i]);
+		Mask4 outside = noneMask4();
+		for (const auto& plane : frustum.planes)
+		{
+			Float4 dist = add4(add4(mul4(splat4(plane.x), x), mul4(splat4(plane.y), y)), add4(mul4(splat4(plane.z), z), splat4(plane.w)));
+			outside = or4(outside, lessThan4(add4(dist, radius), zero));
+		}
+		storeVisible4(outside, &visible[i]);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		bool outside = false;
+		for (const auto& plane : frustum.planes)
+		{
+			outside |= plane.x * spheres.x[i] + plane.y * spheres.y[i] + plane.z * spheres.z[i] + plane.w + spheres.radius[i] < 0.f;
+		}
+		visible[i] = outside ? 0 : 1;
+	}
+}
+
+void cullSpheresByDistance(const glm::vec3& centre, float maxDistance, const BoundingSphereArray& spheres, std::vector<uint8_t>& visible)
+{
+	const size_t count = spheres.size();
+	visible.resize(count);
+
+	size_t i = 0;
+#if defined(WZ_CULLING_SIMD)
+	const Float4 centreX = splat4(centre.x), centreY = splat4(centre.y), centreZ = splat4(centre.z), distance = splat4(maxDistance);
+	for (; i + 4 <= count; i += 4)
+	{
+		const Float4 dx = sub4(load4(&spheres.x[i]), centreX);
+		const Float4 dy = sub4(load4(&spheres.y[i]), centreY);
+		const Float4 dz = sub4(load4(&spheres.z[i]), centreZ);
+		const Float4 limit = add4(distance, load4(&spheres.radius[i]));
+		const Float4 squaredDistance = add4(add4(mul4(dx, dx), mul4(dy, dy)), mul4(dz, dz));
+		storeVisible4(lessThan4(mul4(limit, limit), squaredDistance), &visible[i]);
+	}
+#endif
+	for (; i < count; ++i)
 	{
-		if (CheckAllPointsInSpace(predicate))
-			return false;
+		const float dx = spheres.x[i] - centre.x, dy = spheres.y[i] - centre.y, dz = spheres.z[i] - centre.z;
+		const float limit = maxDistance + spheres.radius[i];
+		visible[i] = (limit * limit < dx * dx + dy * dy + dz * dz) ? 0 : 1;
 	}
-	return true;
 }
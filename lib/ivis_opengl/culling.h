@@ -22,17 +22,54 @@
 
 #include <array>
 #include <glm/glm.hpp>
-#include <algorithm>
-#include <functional>
+#include <stdint.h>
+#include <vector>
 
 using BoundingBox = std::array<glm::vec3, 8>;
 
 /// Project a bounding box in clip space
 BoundingBox transformBoundingBox(const glm::mat4& worldViewProjectionMatrix, const BoundingBox& worldSpaceBoundingBox);
 
-/// Define a half space
-using HalfSpaceCheck = std::function<bool(const glm::vec3&)>;
-/// Define a view frustum (as an intersection of half space
-using IntersectionOfHalfSpace = std::array< HalfSpaceCheck, 6>;
+/// A view frustum, as the intersection of 6 half spaces.
+/// A point p is inside the half space of a plane if dot(plane.xyz, p) + plane.w >= 0.
+struct ViewFrustum
+{
+	std::array<glm::vec4, 6> planes;
 
-bool isBBoxInClipSpace(const IntersectionOfHalfSpace& intersectionOfHalfSpace, const BoundingBox& points);
+	/// The frustum of [x0, x1] x [y0, y1] x [z0, z1]. If yAxisInverted, y is negated first.
+	static ViewFrustum fromBox(float x0, float x1, float y0, float y1, float z0, float z1, bool yAxisInverted = false);
+};
+
+/// Axis aligned bounding boxes, stored as one array per component so they can be culled in batches
+struct BoundingBoxArray
+{
+	std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+	size_t size() const { return minX.size(); }
+	void clear();
+	void reserve(size_t count);
+	void push_back(const glm::vec3& min, const glm::vec3& max);
+	/// Adds the axis aligned box around the points
+	void push_back(const BoundingBox& points);
+};
+
+/// Bounding spheres, stored as one array per component so they can be culled in batches
+struct BoundingSphereArray
+{
+	std::vector<float> x, y, z, radius;
+
+	size_t size() const { return x.size(); }
+	void clear();
+	void reserve(size_t count);
+	void push_back(const glm::vec3& centre, float sphereRadius);
+};
+
+/// Sets visible[i] to 1 if box i intersects the frustum, 0 otherwise (visible is resized to boxes.size()).
+/// The test is exact for planes parallel to the axes, and conservative (never hides a visible box) for others.
+void cullBoxes(const ViewFrustum& frustum, const BoundingBoxArray& boxes, std::vector<uint8_t>& visible);
+
+/// Sets visible[i] to 1 if sphere i intersects the frustum (conservatively, at the corners), 0 otherwise
+void cullSpheres(const ViewFrustum& frustum, const BoundingSphereArray& spheres, std::vector<uint8_t>& visible);
+
+/// Sets visible[i] to 1 if sphere i is within maxDistance of centre, 0 otherwise
+void cullSpheresByDistance(const glm::vec3& centre, float maxDistance, const BoundingSphereArray& spheres, std::vector<uint8_t>& visible);
@@ -22,7 +22,9 @@
 #include "gfx_api_null.h"
 #include "gfx_api_image_compress_priv.h"
 #include "gfx_api_image_basis_priv.h"
+#include "gfx_api_texture_cache_priv.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/parallel_for.h"
 #include <unordered_map>
 #include <algorithm>
 
@@ -236,21 +238,6 @@ optional<gfx_api::max_texture_compression_level> gfx_api::getMaxTextureCompressi
 
 #include "png_util.h"
 
-static gfx_api::texture* loadImageTextureFromFile_PNG(const std::string& filename, gfx_api::texture_type textureType, int maxWidth /*= -1*/, int maxHeight /*= -1*/, bool quiet)
-{
-	iV_Image loadedUncompressedImage;
-
-	// 1.) Load the PNG into an iV_Image
-	bool forceRGB = (textureType == gfx_api::texture_type::game_texture) || (textureType == gfx_api::texture_type::user_interface);
-	if (!iV_loadImage_PNG2(filename.c_str(), loadedUncompressedImage, forceRGB, quiet))
-	{
-		// Failed to load the image
-		return nullptr;
-	}
-
-	return gfx_api::context::get().loadTextureFromUncompressedImage(std::move(loadedUncompressedImage), textureType, filename, maxWidth, maxHeight);
-}
-
 #if defined(BASIS_ENABLED)
 const WzString wz_png_extension = WzString(".png");
 #endif
@@ -329,7 +316,13 @@ gfx_api::texture* gfx_api::context::loadTextureFromFile(const char *filename, gf
 #endif
 	if (imageLoadFilename.endsWith(".png"))
 	{
-		return loadImageTextureFromFile_PNG(imageLoadFilename.toUtf8(), textureType, maxWidth, maxHeight, quiet);
+		// (goes through the compressed texture cache, if the texture is compressed at run-time)
+		auto prepared = gfx_api::prepareTextureFromFile(imageLoadFilename.toUtf8().c_str(), textureType, maxWidth, maxHeight, quiet);
+		if (!prepared)
+		{
+			return nullptr;
+		}
+		return createTextureFromPreparedImage(*prepared, imageLoadFilename.toUtf8());
 	}
 	else
 	{
@@ -439,8 +432,8 @@ static std::vector<std::unique_ptr<iV_Image>> generateMipMapsFromUncompressedIma
 	return results;
 }
 
-// Takes an iv_Image and texture_type and loads a texture as appropriate / possible
-gfx_api::texture* gfx_api::context::loadTextureFromUncompressedImage(iV_Image&& image, gfx_api::texture_type textureType, const std::string& filename, int maxWidth /*= -1*/, int maxHeight /*= -1*/)
+// Takes an iv_Image and texture_type and prepares everything needed to upload it to a texture, as appropriate / possible
+std::unique_ptr<gfx_api::prepared_texture> gfx_api::prepareTextureFromUncompressedImage(iV_Image&& image, gfx_api::texture_type textureType, const std::string& filename, int maxWidth /*= -1*/, int maxHeight /*= -1*/)
 {
 	// 1.) Convert to expected # of channels based on textureType
 	if (!uncompressedPNGImageConvertChannels(image, gfx_api::pixel_format_target::texture_2d, textureType, filename))
@@ -458,7 +451,7 @@ gfx_api::texture* gfx_api::context::loadTextureFromUncompressedImage(iV_Image&&
 	// 4.) Extend channels, if needed, to a supported uncompressed format
 	auto channels = image.channels();
 	// Verify that the gfx backend supports this format
-	auto closestSupportedChannels = getClosestSupportedUncompressedImageFormatChannels(gfx_api::pixel_format_target::texture_2d, channels);
+	auto closestSupportedChannels = gfx_api::context::get().getClosestSupportedUncompressedImageFormatChannels(gfx_api::pixel_format_target::texture_2d, channels);
 	ASSERT_OR_RETURN(nullptr, closestSupportedChannels.has_value(), "Exhausted all possible uncompressed formats??");
 	for (auto i = image.channels(); i < closestSupportedChannels; ++i)
 	{
@@ -480,57 +473,101 @@ gfx_api::texture* gfx_api::context::loadTextureFromUncompressedImage(iV_Image&&
 		}
 	}
 
-	// 5.) Create a new compatible gpu texture object
-	std::unique_ptr<gfx_api::texture> pTexture = std::unique_ptr<gfx_api::texture>(gfx_api::context::get().create_texture(mipmap_levels, image.width(), image.height(), uploadFormat, filename));
+	auto result = std::make_unique<gfx_api::prepared_texture>();
+	result->uploadFormat = uploadFormat;
+	result->width = image.width();
+	result->height = image.height();
 
-	// 6.) Upload initial (full) level
-	if (uploadFormat == image.pixel_format())
+	// 5.) Generate mipmaps (if needed), and compress all levels (if needed)
+	auto miplevels = generateMipMapsFromUncompressedImage(image, mipmap_levels, textureType);
+	result->mipLevels.push_back(std::make_unique<iV_Image>(std::move(image)));
+	result->mipLevels.insert(result->mipLevels.end(), std::make_move_iterator(miplevels.begin()), std::make_move_iterator(miplevels.end()));
+	if (uploadFormat != result->mipLevels.front()->pixel_format())
 	{
-		bool uploadResult = pTexture->upload(0, image);
-		ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
+		for (auto& level : result->mipLevels)
+		{
+			// Run-time compression
+			auto compressedImage = gfx_api::compressImage(*static_cast<const iV_Image*>(level.get()), uploadFormat);
+			ASSERT_OR_RETURN(nullptr, compressedImage != nullptr, "Failed to compress image to format: %zu", static_cast<size_t>(uploadFormat));
+			level = std::move(compressedImage);
+		}
 	}
-	else
+
+	return result;
+}
+
+std::unique_ptr<gfx_api::prepared_texture> gfx_api::prepareTextureFromFile(const char *filename, gfx_api::texture_type textureType, int maxWidth /*= -1*/, int maxHeight /*= -1*/, bool quiet /*= false*/)
+{
+	auto imageLoadFilename = imageLoadFilenameFromInputFilename(filename);
+	if (!imageLoadFilename.endsWith(".png"))
 	{
-		// Run-time compression
-		auto compressedImage = gfx_api::compressImage(image, uploadFormat);
-		ASSERT_OR_RETURN(nullptr, compressedImage != nullptr, "Failed to compress image to format: %zu", static_cast<size_t>(uploadFormat));
-		bool uploadResult = pTexture->upload(0, *compressedImage);
-		ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
+		return nullptr;
 	}
 
-	// 7.) Generate and upload mipmaps (if needed)
-	for (size_t i = 1; i < mipmap_levels; i++)
+	// If the texture will be compressed at run-time, try the compressed texture cache first
+	optional<std::string> cacheKey;
+	if (gfx_api::bestRealTimeCompressionFormat(gfx_api::pixel_format_target::texture_2d, textureType).has_value())
 	{
-		optional<int> alphaChannelOverride;
-		if (textureType == gfx_api::texture_type::alpha_mask)
+		auto compressionLevelOverride = gfx_api::getMaxTextureCompressionLevelOverride(imageLoadFilename.toUtf8());
+		std::string settings = gfx_api::describeRealTimeCompressionFormats(gfx_api::pixel_format_target::texture_2d);
+		settings += " override=" + ((compressionLevelOverride.has_value()) ? std::to_string(static_cast<int>(compressionLevelOverride.value())) : std::string("none"));
+		cacheKey = gfx_api::compressedTextureCacheKey(imageLoadFilename.toUtf8(), gfx_api::pixel_format_target::texture_2d, textureType, maxWidth, maxHeight, settings);
+		if (cacheKey.has_value())
 		{
-			alphaChannelOverride = 0;
+			auto cachedLevels = gfx_api::loadCompressedTextureFromCache(cacheKey.value());
+			if (!cachedLevels.empty())
+			{
+				auto result = std::make_unique<gfx_api::prepared_texture>();
+				result->uploadFormat = cachedLevels.front()->pixel_format();
+				result->width = cachedLevels.front()->width();
+				result->height = cachedLevels.front()->height();
+				result->mipLevels = std::move(cachedLevels);
+				return result;
+			}
 		}
+	}
 
-		unsigned int output_w = std::max<unsigned int>(1, image.width() >> 1);
-		unsigned int output_h = std::max<unsigned int>(1, image.height() >> 1);
-
-		bool resizeResult = image.resize(output_w, output_h, alphaChannelOverride);
-		ASSERT_OR_RETURN(nullptr, resizeResult, "Failed to resize image mipmap [%zu] to output size (%u x %u): %s", i, output_w, output_h, filename.c_str());
-
-		if (uploadFormat == image.pixel_format())
-		{
-			bool uploadResult = pTexture->upload(i, image);
-			ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
-		}
-		else
-		{
-			// Run-time compression
-			auto compressedImage = gfx_api::compressImage(image, uploadFormat);
-			ASSERT_OR_RETURN(nullptr, compressedImage != nullptr, "Failed to compress image to format: %zu", static_cast<size_t>(uploadFormat));
-			bool uploadResult = pTexture->upload(i, *compressedImage);
-			ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
-		}
+	iV_Image loadedUncompressedImage;
+	bool forceRGB = (textureType == gfx_api::texture_type::game_texture) || (textureType == gfx_api::texture_type::user_interface);
+	if (!iV_loadImage_PNG2(imageLoadFilename.toUtf8().c_str(), loadedUncompressedImage, forceRGB, quiet))
+	{
+		// Failed to load the image
+		return nullptr;
+	}
+	auto result = prepareTextureFromUncompressedImage(std::move(loadedUncompressedImage), textureType, imageLoadFilename.toUtf8(), maxWidth, maxHeight);
+	if (result && cacheKey.has_value())
+	{
+		// (does nothing if the texture ended up uncompressed)
+		gfx_api::storeCompressedTextureInCache(cacheKey.value(), result->mipLevels);
 	}
+	return result;
+}
 
+// Creates a new gpu texture object for a prepared image, and uploads all of its levels
+gfx_api::texture* gfx_api::context::createTextureFromPreparedImage(const gfx_api::prepared_texture& prepared, const std::string& filename)
+{
+	ASSERT_OR_RETURN(nullptr, !prepared.mipLevels.empty(), "No image levels: %s", filename.c_str());
+	std::unique_ptr<gfx_api::texture> pTexture = std::unique_ptr<gfx_api::texture>(create_texture(prepared.mipLevels.size(), prepared.width, prepared.height, prepared.uploadFormat, filename));
+	ASSERT_OR_RETURN(nullptr, pTexture != nullptr, "Failed to create texture: %s", filename.c_str());
+	for (size_t i = 0; i < prepared.mipLevels.size(); i++)
+	{
+		bool uploadResult = pTexture->upload(i, *prepared.mipLevels[i]);
+		ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
+	}
 	return pTexture.release();
 }
 
+// Takes an iv_Image and texture_type and loads a texture as appropriate / possible
+gfx_api::texture* gfx_api::context::loadTextureFromUncompressedImage(iV_Image&& image, gfx_api::texture_type textureType, const std::string& filename, int maxWidth /*= -1*/, int maxHeight /*= -1*/)
+{
+	auto prepared = gfx_api::prepareTextureFromUncompressedImage(std::move(image), textureType, filename, maxWidth, maxHeight);
+	if (!prepared)
+	{
+		return nullptr;
+	}
+	return createTextureFromPreparedImage(*prepared, filename);
+}
+
 std::unique_ptr<iV_Image> gfx_api::loadUncompressedImageFromFile(const char *filename, gfx_api::pixel_format_target target, gfx_api::texture_type textureType, int maxWidth /*= -1*/, int maxHeight /*= -1*/, bool forceRGBA8 /*= false*/)
 {
 	auto imageLoadFilename = imageLoadFilenameFromInputFilename(filename);
@@ -998,55 +1035,139 @@ gfx_api::texture_array* gfx_api::context::loadTextureArrayFromFiles(const std::v
 		return &defaultTextureMips;
 	};
 
-	std::unique_ptr<gfx_api::texture_array> texture_array = nullptr;
-	unsigned int width = 0;
-	unsigned int height = 0;
-	size_t mipmap_levels = 0;
-	size_t layers_count = imageLoadFilenames.size();
-
-	for (size_t layer = 0; layer < layers_count; ++layer)
+	// The files of a batch of layers are loaded, mip-mapped and compressed on worker threads, and then uploaded on this thread.
+	// (Batches keep the number of decoded images held at once bounded.)
+	struct PreparedLayer
 	{
-		const WzString& imageLoadFilename = imageLoadFilenames[layer];
-
-		// load the file to an array of base images
-		std::vector<std::unique_ptr<iV_BaseImage>> loadedImagesForLayer;
-		std::vector<std::unique_ptr<iV_BaseImage>>* pImagesForLayer = nullptr;
+		std::vector<std::unique_ptr<iV_BaseImage>> images;
+		unsigned int width = 0;
+		unsigned int height = 0;
+		bool compressed = false; // images are already in uploadFormat
+		bool unsupported = false;
+	};
+	auto prepareLayer = [&](const WzString& imageLoadFilename, PreparedLayer& prepared) {
 		if (imageLoadFilename.isEmpty())
 		{
-			pImagesForLayer = getDefaultTextureMipsP(layer, width, height, mipmap_levels, desiredImageExtractionFormat);
-			ASSERT_OR_RETURN(nullptr, pImagesForLayer != nullptr, "Failed to generate matching default texture");
+			return;
 		}
-		else if (uncompressedExtractionFormat || imageLoadFilename.endsWith(".png"))
+		const bool runTimeCompression = (uploadFormat != desiredImageExtractionFormat && uncompressedExtractionFormat);
+		optional<std::string> cacheKey;
+		if (runTimeCompression)
 		{
-			// load into an uncompressed format
-			loadedImagesForLayer = loadUncompressedImageWithMips(imageLoadFilename.toUtf8(), textureType, maxWidth, maxHeight, desiredImageExtractionFormat == gfx_api::pixel_format::FORMAT_RGBA8_UNORM_PACK8);
-			if (!loadedImagesForLayer.empty())
+			std::string settings = std::string("format=") + gfx_api::format_to_str(uploadFormat);
+			settings += (desiredImageExtractionFormat == gfx_api::pixel_format::FORMAT_RGBA8_UNORM_PACK8) ? " rgba8" : "";
+			cacheKey = gfx_api::compressedTextureCacheKey(imageLoadFilename.toUtf8(), gfx_api::pixel_format_target::texture_2d_array, textureType, maxWidth, maxHeight, settings);
+			if (cacheKey.has_value())
 			{
-				pImagesForLayer = &loadedImagesForLayer;
-			}
-			else
-			{
-				// failed to load image
-				debug(LOG_INFO, "Using default texture generator for failed image: %s", imageLoadFilename.toUtf8().c_str());
-				pImagesForLayer = getDefaultTextureMipsP(layer, width, height, mipmap_levels, desiredImageExtractionFormat);
+				prepared.images = gfx_api::loadCompressedTextureFromCache(cacheKey.value());
+				if (!prepared.images.empty() && prepared.images.front()->pixel_format() == uploadFormat)
+				{
+					prepared.width = prepared.images.front()->width();
+					prepared.height = prepared.images.front()->height();
+					prepared.compressed = true;
+					return;
+				}
+				prepared.images.clear();
 			}
 		}
+		if (uncompressedExtractionFormat || imageLoadFilename.endsWith(".png"))
+		{
+			// load into an uncompressed format
+			prepared.images = loadUncompressedImageWithMips(imageLoadFilename.toUtf8(), textureType, maxWidth, maxHeight, desiredImageExtractionFormat == gfx_api::pixel_format::FORMAT_RGBA8_UNORM_PACK8);
+		}
 		else
 		{
 			// load directly into a compressed format
 #if defined(BASIS_ENABLED)
 			if (imageLoadFilename.endsWith(".ktx2"))
 			{
-				loadedImagesForLayer = gfx_api::loadiVImagesFromFile_Basis(imageLoadFilename.toUtf8(), textureType, gfx_api::pixel_format_target::texture_2d_array, desiredImageExtractionFormat, std::max(0, maxWidth), std::max(0, maxHeight));
-				pImagesForLayer = &loadedImagesForLayer;
+				prepared.images = gfx_api::loadiVImagesFromFile_Basis(imageLoadFilename.toUtf8(), textureType, gfx_api::pixel_format_target::texture_2d_array, desiredImageExtractionFormat, std::max(0, maxWidth), std::max(0, maxHeight));
 			}
 			else
 #endif
 			{
-				debug(LOG_ERROR, "Unable to load image file: %s", imageLoadFilename.toUtf8().c_str());
-				return {};
+				prepared.unsupported = true;
+				return;
+			}
+		}
+		if (prepared.images.empty())
+		{
+			return;
+		}
+		prepared.width = prepared.images.front()->width();
+		prepared.height = prepared.images.front()->height();
+		if (runTimeCompression)
+		{
+			// Run-time compression (for each mip level)
+			for (auto& level : prepared.images)
+			{
+				const iV_Image* image = dynamic_cast<iV_Image*>(level.get());
+				auto compressedImage = (image) ? gfx_api::compressImage(*image, uploadFormat) : nullptr;
+				if (!compressedImage)
+				{
+					debug(LOG_ERROR, "Failed to compress image to format: %zu: %s", static_cast<size_t>(uploadFormat), imageLoadFilename.toUtf8().c_str());
+					prepared.images.clear();
+					return;
+				}
+				level = std::move(compressedImage);
+			}
+			prepared.compressed = true;
+			if (cacheKey.has_value())
+			{
+				gfx_api::storeCompressedTextureInCache(cacheKey.value(), prepared.images);
 			}
 		}
+	};
+
+	std::unique_ptr<gfx_api::texture_array> texture_array = nullptr;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	size_t mipmap_levels = 0;
+	size_t layers_count = imageLoadFilenames.size();
+	const size_t batchSize = wzParallelForThreadCount();
+	std::vector<PreparedLayer> preparedLayers;
+
+	for (size_t layer = 0; layer < layers_count; ++layer)
+	{
+		const WzString& imageLoadFilename = imageLoadFilenames[layer];
+
+		size_t batchIdx = layer % batchSize;
+		if (batchIdx == 0)
+		{
+			size_t batchEnd = std::min(layer + batchSize, layers_count);
+			preparedLayers.clear();
+			preparedLayers.resize(batchEnd - layer);
+			wzParallelFor(preparedLayers.size(), [&](size_t i) {
+				prepareLayer(imageLoadFilenames[layer + i], preparedLayers[i]);
+			});
+		}
+		PreparedLayer& prepared = preparedLayers[batchIdx];
+
+		// get the array of base images for this layer
+		std::vector<std::unique_ptr<iV_BaseImage>>* pImagesForLayer = nullptr;
+		bool imagesAreInUploadFormat = (uploadFormat == desiredImageExtractionFormat);
+		if (prepared.unsupported)
+		{
+			debug(LOG_ERROR, "Unable to load image file: %s", imageLoadFilename.toUtf8().c_str());
+			return {};
+		}
+		else if (!prepared.images.empty())
+		{
+			pImagesForLayer = &prepared.images;
+			imagesAreInUploadFormat = imagesAreInUploadFormat || prepared.compressed;
+		}
+		else
+		{
+			if (!imageLoadFilename.isEmpty())
+			{
+				// failed to load image
+				debug(LOG_INFO, "Using default texture generator for failed image: %s", imageLoadFilename.toUtf8().c_str());
+			}
+			pImagesForLayer = getDefaultTextureMipsP(layer, width, height, mipmap_levels, desiredImageExtractionFormat);
+			ASSERT_OR_RETURN(nullptr, pImagesForLayer != nullptr, "Failed to generate matching default texture");
+			prepared.width = pImagesForLayer->empty() ? 0 : pImagesForLayer->front()->width();
+			prepared.height = pImagesForLayer->empty() ? 0 : pImagesForLayer->front()->height();
+		}
 
 		if (progressCallback)
 		{
@@ -1057,8 +1178,8 @@ gfx_api::texture_array* gfx_api::context::loadTextureArrayFromFiles(const std::v
 
 		if (layer == 0)
 		{
-			width = pImagesForLayer->front()->width();
-			height = pImagesForLayer->front()->height();
+			width = prepared.width;
+			height = prepared.height;
 			mipmap_levels = pImagesForLayer->size();
 
 			texture_array = std::unique_ptr<gfx_api::texture_array>(gfx_api::context::get().create_texture_array(mipmap_levels, layers_count, width, height, uploadFormat, debugName));
@@ -1066,14 +1187,14 @@ gfx_api::texture_array* gfx_api::context::loadTextureArrayFromFiles(const std::v
 		}
 		else
 		{
-			ASSERT_OR_RETURN(nullptr, width == pImagesForLayer->front()->width() && height == pImagesForLayer->front()->height(), "Unexpected image dimensions (%u x %u) does not match the first image dimensions (%u x %u): %s", pImagesForLayer->front()->width(), pImagesForLayer->front()->height(), width, height, imageLoadFilename.toUtf8().c_str());
+			ASSERT_OR_RETURN(nullptr, width == prepared.width && height == prepared.height, "Unexpected image dimensions (%u x %u) does not match the first image dimensions (%u x %u): %s", prepared.width, prepared.height, width, height, imageLoadFilename.toUtf8().c_str());
 			ASSERT_OR_RETURN(nullptr, pImagesForLayer->size() == mipmap_levels, "Unexpected number of mip levels (%zu; expected: %zu): %s", pImagesForLayer->size(), mipmap_levels, imageLoadFilename.toUtf8().c_str());
 		}
 
 		// upload the layer
 
 		// If already in the uploadFormat
-		if (uploadFormat == desiredImageExtractionFormat)
+		if (imagesAreInUploadFormat)
 		{
 			// just load directly
 			bool uploadSuccess = gfx_api::context::get().loadTextureArrayLayerFromBaseImages(*texture_array, layer, *pImagesForLayer, imageLoadFilename.toUtf8(), width, height);
@@ -1095,6 +1216,9 @@ gfx_api::texture_array* gfx_api::context::loadTextureArrayFromFiles(const std::v
 				ASSERT_OR_RETURN(nullptr, uploadResult, "Failed to upload buffer to image");
 			}
 		}
+
+		// free the decoded images as soon as they are uploaded
+		prepared.images.clear();
 	}
 
 	if (texture_array)
@@ -343,6 +343,8 @@ namespace gfx_api
 		}
 	};
 
+	struct prepared_texture;
+
 	struct context
 	{
 		enum class buffer_storage_hint
@@ -446,6 +448,7 @@ namespace gfx_api
 		// High-level API for getting a texture object from file / uncompressed bitmap
 		gfx_api::texture* loadTextureFromFile(const char *filename, gfx_api::texture_type textureType, int maxWidth = -1, int maxHeight = -1, bool quiet = false);
 		gfx_api::texture* loadTextureFromUncompressedImage(iV_Image&& image, gfx_api::texture_type textureType, const std::string& filename, int maxWidth = -1, int maxHeight = -1);
+		gfx_api::texture* createTextureFromPreparedImage(const prepared_texture& prepared, const std::string& filename);
 		typedef std::function<std::unique_ptr<iV_Image> (int width, int height, int channels)> GenerateDefaultTextureFunc;
 		gfx_api::texture_array* loadTextureArrayFromFiles(const std::vector<WzString>& filenames, gfx_api::texture_type textureType, int maxWidth = -1, int maxHeight = -1, const GenerateDefaultTextureFunc& defaultTextureGenerator = nullptr, const std::function<void ()>& progressCallback = nullptr, const std::string& debugName = "");
 
@@ -461,6 +464,19 @@ namespace gfx_api
 		virtual bool _initialize(const backend_Impl_Factory& impl, int32_t antialiasing, swap_interval_mode mode, optional<float> mipLodBias, uint32_t depthMapResolution) = 0;
 	};
 
+	// An image that has been decoded, mip-mapped and (if possible) compressed, so it only has to be uploaded.
+	// Preparing it does not use the backend's resources, so it can be done on any thread.
+	struct prepared_texture
+	{
+		std::vector<std::unique_ptr<iV_BaseImage>> mipLevels; // in uploadFormat
+		gfx_api::pixel_format uploadFormat = gfx_api::pixel_format::invalid;
+		unsigned int width = 0;
+		unsigned int height = 0;
+	};
+	std::unique_ptr<prepared_texture> prepareTextureFromUncompressedImage(iV_Image&& image, gfx_api::texture_type textureType, const std::string& filename, int maxWidth = -1, int maxHeight = -1);
+	// Returns nullptr if the file can't be loaded, or isn't a format that is prepared this way (use context::loadTextureFromFile() instead)
+	std::unique_ptr<prepared_texture> prepareTextureFromFile(const char *filename, gfx_api::texture_type textureType, int maxWidth = -1, int maxHeight = -1, bool quiet = false);
+
 	// High-level API for getting an uncompressed image (iV_Image) from a file
 	std::unique_ptr<iV_Image> loadUncompressedImageFromFile(const char *filename, gfx_api::pixel_format_target target, gfx_api::texture_type textureType, int maxWidth = -1, int maxHeight = -1, bool forceRGBA8 = false);
 
@@ -471,6 +487,20 @@ namespace gfx_api
 	bool loadTextureCompressionOverrides();
 	optional<max_texture_compression_level> getMaxTextureCompressionLevelOverride(const std::string& filename);
 
+	// Compressed texture cache (keeps the results of run-time texture compression on disk)
+	struct texture_cache_stats
+	{
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t stores = 0;
+	};
+	void setCompressedTextureCacheEnabled(bool enabled);
+	bool getCompressedTextureCacheEnabled();
+	texture_cache_stats getCompressedTextureCacheStats();
+	void resetCompressedTextureCacheStats();
+	// Removes the oldest entries that haven't been used since the game started, if the cache has grown too large
+	void trimCompressedTextureCache();
+
 	template<std::size_t id, vertex_attribute_type type, std::size_t offset>
 	struct vertex_attribute_description
 	{
@@ -390,6 +390,19 @@ optional<gfx_api::pixel_format> gfx_api::bestRealTimeCompressionFormat(gfx_api::
 	return nullopt;
 }
 
+// Describes the live compression formats chosen for the target (for use in cache keys)
+std::string gfx_api::describeRealTimeCompressionFormats(gfx_api::pixel_format_target target)
+{
+	size_t target_idx = static_cast<size_t>(target);
+	const auto& rgba = bestAvailableCompressionFormat_GameTextureRGBA[target_idx];
+	const auto& rgb = bestAvailableCompressionFormat_GameTextureRGB[target_idx];
+	std::string result = "rgba=";
+	result += (rgba.has_value()) ? gfx_api::format_to_str(rgba.value()) : "none";
+	result += " rgb=";
+	result += (rgb.has_value()) ? gfx_api::format_to_str(rgb.value()) : "none";
+	return result;
+}
+
 // Compresses an iV_Image to the desired compressed image format (if possible)
 std::unique_ptr<iV_BaseImage> gfx_api::compressImage(const iV_Image& image, gfx_api::pixel_format desiredFormat)
 {
@@ -23,6 +23,7 @@
 #include "gfx_api_formats_def.h"
 
 #include <memory>
+#include <string>
 
 #include <nonstd/optional.hpp>
 using nonstd::optional;
@@ -36,6 +37,9 @@ namespace gfx_api
 	optional<gfx_api::pixel_format> bestRealTimeCompressionFormatForImage(gfx_api::pixel_format_target target, const iV_Image& image, gfx_api::texture_type textureType);
 	optional<gfx_api::pixel_format> bestRealTimeCompressionFormat(gfx_api::pixel_format_target target, gfx_api::texture_type textureType);
 
+	// Describes the live compression formats chosen for the target (for use in cache keys)
+	std::string describeRealTimeCompressionFormats(gfx_api::pixel_format_target target);
+
 	// Compresses an iV_Image to the desired compressed image format (if possible)
 	std::unique_ptr<iV_BaseImage> compressImage(const iV_Image& image, gfx_api::pixel_format desiredFormat);
 }
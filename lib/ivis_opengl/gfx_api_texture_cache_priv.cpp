@@ -0,0 +1,276 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "gfx_api_texture_cache_priv.h"
+#include "gfx_api_image_compress_priv.h"
+#include "gfx_api.h"
+
+#include "lib/framework/frame.h"
+#include "lib/framework/file.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/framework/physfs_fileview.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+#define TEXTURE_CACHE_DIR "cache/textures"
+// trimCompressedTextureCache() keeps the cache below this size: each texture size or compression setting that was used gets entries of its own
+#define TEXTURE_CACHE_MAX_SIZE (uint64_t(1024) * 1024 * 1024)
+static const char textureCacheMagic[4] = {'W', 'Z', 'T', 'C'};
+// Increase this whenever the compressors or their settings change, so old entries are ignored
+static const uint32_t textureCacheVersion = 1;
+
+static std::atomic<bool> textureCacheEnabled{true};
+static std::atomic<size_t> textureCacheHits{0};
+static std::atomic<size_t> textureCacheMisses{0};
+static std::atomic<size_t> textureCacheStores{0};
+static std::mutex textureCacheWriteMutex;
+static std::unordered_set<std::string> textureCacheUsedFiles; // entries read or written since the game started, guarded by textureCacheWriteMutex
+
+void gfx_api::setCompressedTextureCacheEnabled(bool enabled)
+{
+	textureCacheEnabled = enabled;
+}
+
+bool gfx_api::getCompressedTextureCacheEnabled()
+{
+	return textureCacheEnabled;
+}
+
+gfx_api::texture_cache_stats gfx_api::getCompressedTextureCacheStats()
+{
+	gfx_api::texture_cache_stats stats;
+	stats.hits = textureCacheHits;
+	stats.misses = textureCacheMisses;
+	stats.stores = textureCacheStores;
+	return stats;
+}
+
+void gfx_api::resetCompressedTextureCacheStats()
+{
+	textureCacheHits = 0;
+	textureCacheMisses = 0;
+	textureCacheStores = 0;
+}
+
+static std::string textureCachePath(const std::string& key)
+{
+	return TEXTURE_CACHE_DIR "/" + sha256Sum(key.data(), key.size()).toString() + ".wztc";
+}
+
+void gfx_api::trimCompressedTextureCache()
+{
+	if (!WZ_PHYSFS_isDirectory(TEXTURE_CACHE_DIR))
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(textureCacheWriteMutex);
+	struct CacheFile
+	{
+		std::string path;
+		PHYSFS_sint64 modtime;
+		uint64_t size;
+	};
+	std::vector<CacheFile> removable;
+	uint64_t totalSize = 0;
+	WZ_PHYSFS_enumerateFiles(TEXTURE_CACHE_DIR, [&removable, &totalSize](const char *file) -> bool {
+		std::string path = TEXTURE_CACHE_DIR "/" + std::string(file);
+		PHYSFS_Stat metaData;
+		if (!filenameEndWithExtension(file, ".wztc") || PHYSFS_stat(path.c_str(), &metaData) == 0 || metaData.filetype != PHYSFS_FILETYPE_REGULAR)
+		{
+			return true;
+		}
+		const uint64_t size = static_cast<uint64_t>(std::max<PHYSFS_sint64>(0, metaData.filesize));
+		totalSize += size;
+		// keep the textures used since the game started
+		if (textureCacheUsedFiles.count(path) == 0)
+		{
+			removable.push_back(CacheFile{std::move(path), metaData.modtime, size});
+		}
+		return true;
+	});
+
+	// remove the entries written longest ago first
+	std::sort(removable.begin(), removable.end(), [](const CacheFile& a, const CacheFile& b) { return a.modtime < b.modtime; });
+	for (const auto& file : removable)
+	{
+		if (totalSize <= TEXTURE_CACHE_MAX_SIZE)
+		{
+			break;
+		}
+		if (PHYSFS_delete(file.path.c_str()) == 0)
+		{
+			debug(LOG_WARNING, "Failed to delete old texture cache entry: %s", file.path.c_str());
+			continue;
+		}
+		totalSize -= file.size;
+	}
+}
+
+optional<std::string> gfx_api::compressedTextureCacheKey(const std::string& imageLoadFilename, gfx_api::pixel_format_target target, gfx_api::texture_type textureType, int maxWidth, int maxHeight, const std::string& settings)
+{
+	if (!textureCacheEnabled)
+	{
+		return nullopt;
+	}
+	auto fileView = WZ_PHYSFS_openFileView(imageLoadFilename.c_str());
+	if (!fileView)
+	{
+		return nullopt;
+	}
+	Sha256 sourceHash = sha256Sum(fileView->data(), fileView->size());
+
+	std::string key = sourceHash.toString();
+	key += " target=" + std::to_string(static_cast<int>(target));
+	key += " type=" + std::to_string(static_cast<int>(textureType));
+	key += " max=" + std::to_string(maxWidth) + "x" + std::to_string(maxHeight);
+	key += " " + settings;
+	return key;
+}
+
+// The cached data is stored in native byte order (it's a local cache)
+template <typename T>
+static void appendValue(std::vector<char>& output, const T& value)
+{
+	const char *bytes = reinterpret_cast<const char *>(&value);
+	output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool readValue(const char *&pos, const char *end, T& value)
+{
+	if (sizeof(T) > static_cast<size_t>(end - pos))
+	{
+		return false;
+	}
+	memcpy(&value, pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+std::vector<std::unique_ptr<iV_BaseImage>> gfx_api::loadCompressedTextureFromCache(const std::string& key)
+{
+	const std::string cachePath = textureCachePath(key);
+	std::vector<char> data;
+	if (!PHYSFS_exists(cachePath.c_str()) || !loadFileToBufferVector(cachePath.c_str(), data, false, false))
+	{
+		++textureCacheMisses;
+		return {};
+	}
+
+	const char *pos = data.data();
+	const char *end = data.data() + data.size();
+	char magic[4] = {};
+	uint32_t version = 0, keyLength = 0, format = 0, levels = 0;
+	bool valid = readValue(pos, end, magic) && memcmp(magic, textureCacheMagic, sizeof(magic)) == 0
+		&& readValue(pos, end, version) && version == textureCacheVersion
+		&& readValue(pos, end, keyLength) && keyLength <= static_cast<size_t>(end - pos)
+		&& key.compare(0, std::string::npos, pos, keyLength) == 0;
+	if (valid)
+	{
+		pos += keyLength;
+		valid = readValue(pos, end, format) && format <= static_cast<uint32_t>(gfx_api::MAX_PIXEL_FORMAT)
+			&& !gfx_api::is_uncompressed_format(static_cast<gfx_api::pixel_format>(format))
+			&& readValue(pos, end, levels) && levels > 0;
+	}
+
+	std::vector<std::unique_ptr<iV_BaseImage>> results;
+	for (uint32_t level = 0; valid && level < levels; ++level)
+	{
+		uint32_t width = 0, height = 0;
+		uint64_t size = 0;
+		valid = readValue(pos, end, width) && readValue(pos, end, height) && readValue(pos, end, size) && size <= static_cast<uint64_t>(end - pos)
+			&& size == gfx_api::format_memory_size(static_cast<gfx_api::pixel_format>(format), width, height);
+		if (!valid)
+		{
+			break;
+		}
+		auto image = std::make_unique<iV_CompressedImage>();
+		valid = image->allocate(static_cast<gfx_api::pixel_format>(format), static_cast<size_t>(size), (width + 3) & ~3u, (height + 3) & ~3u, width, height, false);
+		if (valid)
+		{
+			memcpy(image->uint64_w(), pos, static_cast<size_t>(size));
+			pos += size;
+			results.push_back(std::move(image));
+		}
+	}
+	if (!valid || pos != end)
+	{
+		debug(LOG_WARNING, "Ignoring invalid texture cache entry: %s", cachePath.c_str());
+		++textureCacheMisses;
+		return {};
+	}
+
+	++textureCacheHits;
+	{
+		std::lock_guard<std::mutex> lock(textureCacheWriteMutex);
+		textureCacheUsedFiles.insert(cachePath);
+	}
+	return results;
+}
+
+void gfx_api::storeCompressedTextureInCache(const std::string& key, const std::vector<std::unique_ptr<iV_BaseImage>>& mipLevels)
+{
+	if (mipLevels.empty() || !textureCacheEnabled)
+	{
+		return;
+	}
+	const gfx_api::pixel_format format = mipLevels.front()->pixel_format();
+	if (gfx_api::is_uncompressed_format(format))
+	{
+		return;
+	}
+
+	std::vector<char> data;
+	data.insert(data.end(), textureCacheMagic, textureCacheMagic + sizeof(textureCacheMagic));
+	appendValue(data, textureCacheVersion);
+	appendValue(data, static_cast<uint32_t>(key.size()));
+	data.insert(data.end(), key.begin(), key.end());
+	appendValue(data, static_cast<uint32_t>(format));
+	appendValue(data, static_cast<uint32_t>(mipLevels.size()));
+	for (const auto& level : mipLevels)
+	{
+		ASSERT_OR_RETURN(, level->pixel_format() == format, "Mip levels have different formats");
+		ASSERT_OR_RETURN(, level->data_size() == gfx_api::format_memory_size(format, level->width(), level->height()), "Unexpected compressed image size");
+		appendValue(data, static_cast<uint32_t>(level->width()));
+		appendValue(data, static_cast<uint32_t>(level->height()));
+		appendValue(data, static_cast<uint64_t>(level->data_size()));
+		const char *bytes = reinterpret_cast<const char *>(level->data());
+		data.insert(data.end(), bytes, bytes + level->data_size());
+	}
+
+	// the same texture may be stored by several threads at once (if several files have the same contents)
+	std::lock_guard<std::mutex> lock(textureCacheWriteMutex);
+	if (!WZ_PHYSFS_isDirectory(TEXTURE_CACHE_DIR) && PHYSFS_mkdir(TEXTURE_CACHE_DIR) == 0)
+	{
+		debug(LOG_WARNING, "Could not create %s, disabling the texture cache: %s", TEXTURE_CACHE_DIR, WZ_PHYSFS_getLastError());
+		textureCacheEnabled = false;
+		return;
+	}
+	const std::string cachePath = textureCachePath(key);
+	if (saveFile(cachePath.c_str(), data.data(), static_cast<UDWORD>(data.size())))
+	{
+		++textureCacheStores;
+		textureCacheUsedFiles.insert(cachePath);
+	}
+}
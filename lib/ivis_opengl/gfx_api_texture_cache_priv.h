@@ -0,0 +1,50 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include "pietypes.h"
+#include "gfx_api_formats_def.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nonstd/optional.hpp>
+using nonstd::optional;
+using nonstd::nullopt;
+
+// Compressed texture cache
+//
+// Stores the mip chains produced by run-time texture compression in the write directory, so later launches can
+// upload them without decoding and compressing the source image again.
+// All functions are safe to call from any thread.
+namespace gfx_api
+{
+	// Returns the cache key for compressing `imageLoadFilename` with the given settings, or nullopt if the cache is
+	// disabled or the file can't be read. The key includes the hash of the file contents, so it changes with the file.
+	// `settings` must describe everything else the result depends on (such as the target pixel format, if known).
+	optional<std::string> compressedTextureCacheKey(const std::string& imageLoadFilename, gfx_api::pixel_format_target target, gfx_api::texture_type textureType, int maxWidth, int maxHeight, const std::string& settings);
+
+	// Returns the cached mip levels (all in the same compressed format) for `key`, or an empty vector if there are none
+	std::vector<std::unique_ptr<iV_BaseImage>> loadCompressedTextureFromCache(const std::string& key);
+
+	// Stores compressed mip levels in the cache (does nothing if they aren't all in the same compressed format)
+	void storeCompressedTextureInCache(const std::string& key, const std::vector<std::unique_ptr<iV_BaseImage>>& mipLevels);
+}
@@ -22,6 +22,7 @@
 
 #include "lib/framework/wzstring.h"
 #include <functional>
+#include <vector>
 
 struct iIMDShape;
 struct iIMDBaseShape;
@@ -67,6 +68,16 @@ const WzString &modelName(const iIMDShape *model);
 
 iIMDBaseShape *modelGet(const WzString &filename);
 
+/// Load all of the given models that aren't loaded yet, so modelGet() finds them.
+/// The PIE files are parsed on worker threads, and the GPU buffers are created afterwards on the calling thread.
+void modelPreload(const std::vector<WzString> &filenames);
+
+/// Whether parsed models are stored in (and loaded from) the binary model cache in the write directory (off by default).
+void modelSetBinaryCacheEnabled(bool enabled);
+bool modelGetBinaryCacheEnabled();
+/// Removes the oldest entries of the binary model cache that haven't been used since the game started, if it has too many.
+void modelTrimBinaryCache();
+
 void modelReloadAllModelTextures();
 
 bool debugReloadDisplayModelsForBaseModel(iIMDBaseShape& baseModel);
@@ -24,17 +24,25 @@
  * Load IMD (.pie) files
  */
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <array>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
 
 #include "lib/framework/frame.h"
 #include "lib/framework/string_ext.h"
 #include "lib/framework/frameresource.h"
 #include "lib/framework/fixedpoint.h"
 #include "lib/framework/file.h"
+#include "lib/framework/crc.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/physfs_fileview.h"
+#include "lib/framework/parallel_for.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/pienormalize.h"
 #include "lib/ivis_opengl/piestate.h"
@@ -61,12 +69,43 @@ typedef std::unordered_map<std::string, std::unique_ptr<iIMDBaseShape>> ModelMap
 static ModelMap models;
 static size_t currentTilesetIdx = 0;
 
-static size_t modelLoadingErrors = 0;
+static std::atomic<size_t> modelLoadingErrors{0};
 static size_t modelTextureLoadingFailures = 0;
 
-static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const char **ppFileData, const char *FileDataEnd, bool skipGPUData, bool skipDuplicateLoadChecks = false);
+// The directories modelGet() looks for models in, in order
+static const char *const modelSearchPaths[] = {
+	"structs/", "misc/", "effects/", "components/prop/", "components/weapons/", "components/bodies/", "features/",
+	"misc/micnum/", "misc/minum/", "misc/mivnum/", "misc/researchimds/"
+};
+
+// The parts of loading a model that can't be done on a worker thread, and are left for the main thread by modelPreload()
+struct DeferredModelData
+{
+	struct LevelBuffers
+	{
+		iIMDShape *shape = nullptr;
+		std::vector<gfx_api::gfxFloat> vertices;
+		std::vector<gfx_api::gfxFloat> normals;
+		std::vector<gfx_api::gfxFloat> texcoords;
+		std::vector<gfx_api::gfxFloat> tangents;
+		std::vector<uint16_t> indices;
+	};
+	std::vector<LevelBuffers> levelBuffers; // GPU buffers to upload
+	std::array<std::string, ANIM_EVENT_COUNT> animEventModels; // EVENT models to look up
+};
+
+// The texture types of the files returned by _imd_get_level_texture_files()
+static const std::array<gfx_api::texture_type, 4> levelTextureTypes = {
+	gfx_api::texture_type::game_texture, gfx_api::texture_type::alpha_mask, gfx_api::texture_type::normal_map, gfx_api::texture_type::specular_map
+};
+
+static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const char **ppFileData, const char *FileDataEnd, bool skipGPUData, bool skipDuplicateLoadChecks, DeferredModelData &deferred);
 static bool _imd_load_level_textures(const iIMDShape& s, size_t tilesetIdx, iIMDShapeTextures& output);
-static std::unique_ptr<iIMDShape> tryLoadDisplayModelInternal(const WzString &path, const WzString &filename, bool skipGPUupload, bool skipDuplicateLoadChecks = false);
+static std::array<std::string, 4> _imd_get_level_texture_files(const iIMDShape& s, size_t tilesetIdx);
+static std::unique_ptr<iIMDShape> tryLoadDisplayModelInternal(const WzString &path, const WzString &filename, bool skipGPUupload, bool skipDuplicateLoadChecks = false, DeferredModelData *deferred = nullptr);
+static void _imd_upload_level_buffers(iIMDShape &s, const std::vector<gfx_api::gfxFloat> &vertices, const std::vector<gfx_api::gfxFloat> &normals,
+	const std::vector<gfx_api::gfxFloat> &texcoords, const std::vector<gfx_api::gfxFloat> &tangents, const std::vector<uint16_t> &indices);
+static void _imd_calc_shadow_edges(iIMDShape &s);
 
 iIMDShape::~iIMDShape()
 {
@@ -103,6 +142,8 @@ iIMDShape& iIMDShape::operator=(iIMDShape&& other) noexcept
 		std::swap(animInterval, other.animInterval);
 		std::swap(shadowEdgeList, other.shadowEdgeList);
 		std::swap(nShadowEdges, other.nShadowEdges);
+		std::swap(shadowEdgeGroups, other.shadowEdgeGroups);
+		std::swap(shadowEdgePolys, other.shadowEdgePolys);
 		std::swap(points, other.points);
 		std::swap(polys, other.polys);
 		std::swap(altShadowPoints, other.altShadowPoints);
@@ -339,44 +380,425 @@ void enumerateLoadedModels(const std::function<void (const std::string& modelNam
 	}
 }
 
-static std::unique_ptr<iIMDShape> tryLoadDisplayModelInternal(const WzString &path, const WzString &filename, bool skipGPUupload, bool skipDuplicateLoadChecks)
+static void finishDeferredModelData(DeferredModelData &deferred)
+{
+	for (const auto &level : deferred.levelBuffers)
+	{
+		_imd_upload_level_buffers(*level.shape, level.vertices, level.normals, level.texcoords, level.tangents, level.indices);
+	}
+	deferred.levelBuffers.clear();
+}
+
+static void resolveAnimEventModels(iIMDShape &shape, const DeferredModelData &deferred)
 {
-	if (PHYSFS_exists(path + filename))
+	for (int i = 0; i < ANIM_EVENT_COUNT; i++)
 	{
-		char *pFileData = nullptr, *fileEnd;
-		UDWORD size = 0;
-		if (!loadFile(WzString(path + filename).toUtf8().c_str(), &pFileData, &size))
+		if (!deferred.animEventModels[i].empty())
 		{
-			debug(LOG_ERROR, "Failed to load model file: %s", WzString(path + filename).toUtf8().c_str());
-			return nullptr;
+			shape.objanimpie[i] = modelGet(WzString::fromUtf8(deferred.animEventModels[i]));
 		}
-		fileEnd = pFileData + size;
-		const char *pFileDataPt = pFileData;
-		auto result = iV_ProcessIMD(filename, (const char **)&pFileDataPt, fileEnd, skipGPUupload, skipDuplicateLoadChecks);
-		free(pFileData);
-		return result;
 	}
-	return nullptr;
 }
 
-bool tryLoad(const WzString &path, const WzString &filename)
+/*
+ * Binary model cache
+ *
+ * Parsed models are stored in cache/models/<sha256 of the .pie file>.wzmc, together with the GPU buffer
+ * contents, so loading an unchanged model takes a single read and no text parsing.
+ * The file layout is native (it's a local cache), and the entry is ignored if the layout of the structs differs.
+ * The cache is off by default. modelTrimBinaryCache() limits it to MODEL_CACHE_MAX_FILES entries, removing the
+ * least recently written entries that haven't been used since the game started.
+ */
+
+#define MODEL_CACHE_DIR "cache/models"
+#define MODEL_CACHE_MAX_FILES 4096 // a few times the number of models in the base game and its mods
+static const char modelCacheMagic[4] = {'W', 'Z', 'M', 'C'};
+// Increase this whenever the parser or the cached data changes, so old entries are ignored
+static const uint32_t modelCacheVersion = 1;
+
+static_assert(std::is_trivially_copyable<iIMDPoly>::value, "iIMDPoly is stored in the model cache as-is");
+static_assert(std::is_trivially_copyable<ANIMFRAME>::value, "ANIMFRAME is stored in the model cache as-is");
+
+static std::atomic<bool> modelBinaryCacheEnabled{false};
+static std::mutex modelCacheWriteMutex;
+static std::unordered_set<std::string> modelCacheUsedFiles; // entries read or written since the game started, guarded by modelCacheWriteMutex
+
+void modelSetBinaryCacheEnabled(bool enabled)
+{
+	modelBinaryCacheEnabled = enabled;
+}
+
+bool modelGetBinaryCacheEnabled()
+{
+	return modelBinaryCacheEnabled;
+}
+
+static std::string modelCachePath(const Sha256 &contentHash)
+{
+	return MODEL_CACHE_DIR "/" + contentHash.toString() + ".wzmc";
+}
+
+static void markModelCacheFileUsed(const std::string &cachePath)
+{
+	std::lock_guard<std::mutex> lock(modelCacheWriteMutex);
+	modelCacheUsedFiles.insert(cachePath);
+}
+
+void modelTrimBinaryCache()
+{
+	if (!WZ_PHYSFS_isDirectory(MODEL_CACHE_DIR))
+	{
+		return;
+	}
+	std::lock_guard<std::mutex> lock(modelCacheWriteMutex);
+	WZ_PHYSFS_cleanupOldFilesInFolder(MODEL_CACHE_DIR, ".wzmc", MODEL_CACHE_MAX_FILES, [](const char *fileName) {
+		if (modelCacheUsedFiles.count(fileName) != 0)
+		{
+			// keep the models used since the game started
+			return true;
+		}
+		if (PHYSFS_delete(fileName) == 0)
+		{
+			debug(LOG_WARNING, "Failed to delete old model cache entry: %s", fileName);
+			return false;
+		}
+		return true;
+	});
+}
+
+static uint32_t modelCacheLayout()
+{
+	return static_cast<uint32_t>((sizeof(iIMDPoly) << 24) | (sizeof(ANIMFRAME) << 16) | (sizeof(Vector3f) << 8) | sizeof(gfx_api::gfxFloat));
+}
+
+class ModelCacheWriter
+{
+public:
+	template <typename T>
+	void write(const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Can only write plain data");
+		append(&value, sizeof(T));
+	}
+
+	template <typename T>
+	void writeVector(const std::vector<T> &values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Can only write plain data");
+		write(static_cast<uint32_t>(values.size()));
+		append(values.data(), values.size() * sizeof(T));
+	}
+
+	void writeString(const std::string &str)
+	{
+		write(static_cast<uint32_t>(str.size()));
+		append(str.data(), str.size());
+	}
+
+	std::vector<char> data;
+
+private:
+	void append(const void *src, size_t size)
+	{
+		const char *bytes = static_cast<const char *>(src);
+		data.insert(data.end(), bytes, bytes + size);
+	}
+};
+
+class ModelCacheReader
+{
+public:
+	explicit ModelCacheReader(const std::vector<char> &data) : pos(data.data()), end(data.data() + data.size()) {}
+
+	template <typename T>
+	bool read(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Can only read plain data");
+		return take(&value, sizeof(T));
+	}
+
+	template <typename T>
+	bool readVector(std::vector<T> &values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Can only read plain data");
+		uint32_t size = 0;
+		if (!read(size) || size > static_cast<size_t>(end - pos) / sizeof(T))
+		{
+			return false;
+		}
+		values.resize(size);
+		return take(values.data(), size * sizeof(T));
+	}
+
+	bool readString(std::string &str)
+	{
+		uint32_t size = 0;
+		if (!read(size) || size > static_cast<size_t>(end - pos))
+		{
+			return false;
+		}
+		str.assign(pos, size);
+		pos += size;
+		return true;
+	}
+
+	bool atEnd() const { return pos == end; }
+
+private:
+	bool take(void *dst, size_t size)
+	{
+		if (size > static_cast<size_t>(end - pos))
+		{
+			return false;
+		}
+		memcpy(dst, pos, size);
+		pos += size;
+		return true;
+	}
+
+	const char *pos;
+	const char *end;
+};
+
+static bool readModelCacheLevel(ModelCacheReader &reader, iIMDShape &s, bool hasGPUData, DeferredModelData::LevelBuffers &levelBuffers)
+{
+	bool ok = reader.read(s.min) && reader.read(s.max) && reader.read(s.sradius) && reader.read(s.radius) && reader.read(s.ocen)
+		&& reader.readVector(s.connectors) && reader.read(s.flags) && reader.read(s.numFrames) && reader.read(s.animInterval)
+		&& reader.readVector(s.points) && reader.readVector(s.polys) && reader.readVector(s.altShadowPoints) && reader.readVector(s.altShadowPolys)
+		&& reader.read(s.vertexCount) && reader.readVector(s.objanimdata) && reader.read(s.objanimframes) && reader.read(s.objanimtime)
+		&& reader.read(s.objanimcycles) && reader.read(s.interpolate);
+	for (auto &files : s.tilesetTextureFiles)
+	{
+		ok = ok && reader.readString(files.texfile) && reader.readString(files.tcmaskfile) && reader.readString(files.normalfile) && reader.readString(files.specfile);
+	}
+	if (ok && hasGPUData)
+	{
+		ok = reader.readVector(levelBuffers.vertices) && reader.readVector(levelBuffers.normals) && reader.readVector(levelBuffers.texcoords)
+			&& reader.readVector(levelBuffers.tangents) && reader.readVector(levelBuffers.indices);
+	}
+	return ok;
+}
+
+static void writeModelCacheLevel(ModelCacheWriter &writer, const iIMDShape &s, const DeferredModelData::LevelBuffers *levelBuffers)
+{
+	writer.write(s.min);
+	writer.write(s.max);
+	writer.write(s.sradius);
+	writer.write(s.radius);
+	writer.write(s.ocen);
+	writer.writeVector(s.connectors);
+	writer.write(s.flags);
+	writer.write(s.numFrames);
+	writer.write(s.animInterval);
+	writer.writeVector(s.points);
+	writer.writeVector(s.polys);
+	writer.writeVector(s.altShadowPoints);
+	writer.writeVector(s.altShadowPolys);
+	writer.write(s.vertexCount);
+	writer.writeVector(s.objanimdata);
+	writer.write(s.objanimframes);
+	writer.write(s.objanimtime);
+	writer.write(s.objanimcycles);
+	writer.write(s.interpolate);
+	for (const auto &files : s.tilesetTextureFiles)
+	{
+		writer.writeString(files.texfile);
+		writer.writeString(files.tcmaskfile);
+		writer.writeString(files.normalfile);
+		writer.writeString(files.specfile);
+	}
+	if (levelBuffers)
+	{
+		writer.writeVector(levelBuffers->vertices);
+		writer.writeVector(levelBuffers->normals);
+		writer.writeVector(levelBuffers->texcoords);
+		writer.writeVector(levelBuffers->tangents);
+		writer.writeVector(levelBuffers->indices);
+	}
+}
+
+/// Loads a model from the binary cache, as iV_ProcessIMD() would have parsed it. Returns nullptr if it isn't cached.
+static std::unique_ptr<iIMDShape> readModelCache(const Sha256 &contentHash, const WzString &filename, bool skipGPUData, bool skipDuplicateLoadChecks, DeferredModelData &deferred)
+{
+	const std::string cachePath = modelCachePath(contentHash);
+	std::vector<char> data;
+	if (!PHYSFS_exists(cachePath.c_str()) || !loadFileToBufferVector(cachePath.c_str(), data, false, false))
+	{
+		return nullptr;
+	}
+
+	ModelCacheReader reader(data);
+	char magic[4] = {};
+	uint32_t version = 0, layout = 0, nlevels = 0;
+	uint8_t hasGPUData = 0;
+	if (!reader.read(magic) || memcmp(magic, modelCacheMagic, sizeof(magic)) != 0 || !reader.read(version) || version != modelCacheVersion
+		|| !reader.read(layout) || layout != modelCacheLayout() || !reader.read(hasGPUData) || !reader.read(nlevels) || nlevels == 0)
+	{
+		debug(LOG_WZ, "%s: Ignoring outdated model cache entry %s", filename.toUtf8().c_str(), cachePath.c_str());
+		return nullptr;
+	}
+	if (!hasGPUData && !skipGPUData)
+	{
+		return nullptr; // cached from a load that didn't need the GPU data - parse it again
+	}
+
+	DeferredModelData cached;
+	bool ok = true;
+	for (auto &animEventModel : cached.animEventModels)
+	{
+		ok = ok && reader.readString(animEventModel);
+	}
+
+	std::unique_ptr<iIMDShape> firstLevel;
+	iIMDShape *lastLevel = nullptr;
+	for (uint32_t level = 0; ok && level < nlevels; ++level)
+	{
+		std::string key = filename.toStdString();
+		if (level > 0)
+		{
+			key += "_" + std::to_string(level);
+		}
+		if (!skipDuplicateLoadChecks)
+		{
+			ASSERT(models.count(key) == 0, "Duplicate model load for %s!", key.c_str());
+		}
+		auto shape = std::make_unique<iIMDShape>();
+		shape->modelName = WzString::fromUtf8(key);
+		shape->modelLevel = level;
+
+		DeferredModelData::LevelBuffers levelBuffers;
+		ok = readModelCacheLevel(reader, *shape, hasGPUData != 0, levelBuffers);
+
+		bool altShadows = !shape->altShadowPolys.empty();
+		shape->pShadowPoints = altShadows ? &shape->altShadowPoints : &shape->points;
+		shape->pShadowPolys = altShadows ? &shape->altShadowPolys : &shape->polys;
+		_imd_calc_shadow_edges(*shape);
+		if (skipGPUData)
+		{
+			shape->vertexCount = 0;
+		}
+		else
+		{
+			levelBuffers.shape = shape.get();
+			cached.levelBuffers.push_back(std::move(levelBuffers));
+		}
+
+		iIMDShape *pShape = shape.get();
+		if (lastLevel)
+		{
+			lastLevel->next = std::move(shape);
+		}
+		else
+		{
+			firstLevel = std::move(shape);
+		}
+		lastLevel = pShape;
+	}
+	if (!ok || !reader.atEnd())
+	{
+		debug(LOG_WARNING, "%s: Ignoring corrupt model cache entry %s", filename.toUtf8().c_str(), cachePath.c_str());
+		return nullptr;
+	}
+
+	markModelCacheFileUsed(cachePath);
+	deferred = std::move(cached);
+	return firstLevel;
+}
+
+/// Stores a model that was just parsed by iV_ProcessIMD() in the binary cache. Safe to call from any thread.
+static void writeModelCache(const Sha256 &contentHash, const WzString &filename, const iIMDShape &shape, const DeferredModelData &deferred, bool hasGPUData)
+{
+	uint32_t nlevels = 0;
+	for (const iIMDShape *level = &shape; level != nullptr; level = level->next.get())
+	{
+		++nlevels;
+	}
+	ASSERT_OR_RETURN(, !hasGPUData || deferred.levelBuffers.size() == nlevels, "%s: Missing GPU data for some levels", filename.toUtf8().c_str());
+
+	ModelCacheWriter writer;
+	writer.write(modelCacheMagic);
+	writer.write(modelCacheVersion);
+	writer.write(modelCacheLayout());
+	writer.write(static_cast<uint8_t>(hasGPUData ? 1 : 0));
+	writer.write(nlevels);
+	for (const auto &animEventModel : deferred.animEventModels)
+	{
+		writer.writeString(animEventModel);
+	}
+	size_t levelIdx = 0;
+	for (const iIMDShape *level = &shape; level != nullptr; level = level->next.get(), ++levelIdx)
+	{
+		writeModelCacheLevel(writer, *level, hasGPUData ? &deferred.levelBuffers[levelIdx] : nullptr);
+	}
+
+	// the same model may be stored by several threads at once (if several files have the same contents)
+	std::lock_guard<std::mutex> lock(modelCacheWriteMutex);
+	if (!WZ_PHYSFS_isDirectory(MODEL_CACHE_DIR) && PHYSFS_mkdir(MODEL_CACHE_DIR) == 0)
+	{
+		debug(LOG_WARNING, "Could not create %s, disabling the model cache: %s", MODEL_CACHE_DIR, WZ_PHYSFS_getLastError());
+		modelBinaryCacheEnabled = false;
+		return;
+	}
+	const std::string cachePath = modelCachePath(contentHash);
+	if (saveFile(cachePath.c_str(), writer.data.data(), static_cast<UDWORD>(writer.data.size())))
+	{
+		modelCacheUsedFiles.insert(cachePath);
+	}
+}
+
+static std::unique_ptr<iIMDShape> tryLoadDisplayModelInternal(const WzString &path, const WzString &filename, bool skipGPUupload, bool skipDuplicateLoadChecks, DeferredModelData *deferred)
 {
 	if (!PHYSFS_exists(path + filename))
 	{
-		// base model does not exist
-		return false;
+		return nullptr;
+	}
+	// the parser only reads up to fileEnd, so it can work on the mapped file directly
+	auto fileView = WZ_PHYSFS_openFileView(WzString(path + filename).toUtf8().c_str());
+	if (!fileView)
+	{
+		debug(LOG_ERROR, "Failed to load model file: %s", WzString(path + filename).toUtf8().c_str());
+		return nullptr;
 	}
 
-	// first, try to load a graphics override - at the same path but with a prefix
-	auto graphics_override_model = tryLoadDisplayModelInternal(WZ_CURRENT_GRAPHICS_OVERRIDES_PREFIX "/" + path, filename, false);
+	DeferredModelData modelData;
+	std::unique_ptr<iIMDShape> shape;
+	const bool useCache = modelBinaryCacheEnabled;
+	Sha256 contentHash;
+	if (useCache)
+	{
+		contentHash = sha256Sum(fileView->data(), fileView->size());
+		shape = readModelCache(contentHash, filename, skipGPUupload, skipDuplicateLoadChecks, modelData);
+	}
+	if (!shape)
+	{
+		const char *pFileDataPt = fileView->data();
+		const char *fileEnd = pFileDataPt + fileView->size();
+		shape = iV_ProcessIMD(filename, &pFileDataPt, fileEnd, skipGPUupload, skipDuplicateLoadChecks, modelData);
+		if (!shape)
+		{
+			return nullptr;
+		}
+		if (useCache)
+		{
+			writeModelCache(contentHash, filename, *shape, modelData, !skipGPUupload);
+		}
+	}
 
-	// try to load base model
-	auto baseModel = tryLoadDisplayModelInternal(path, filename, (graphics_override_model != nullptr));
-	if (!baseModel)
+	if (deferred)
 	{
-		return false;
+		std::move(modelData.levelBuffers.begin(), modelData.levelBuffers.end(), std::back_inserter(deferred->levelBuffers));
+		deferred->animEventModels = std::move(modelData.animEventModels);
 	}
+	else
+	{
+		finishDeferredModelData(modelData);
+		resolveAnimEventModels(*shape, modelData);
+	}
+	return shape;
+}
 
+bool registerModel(const WzString &path, const WzString &filename, std::unique_ptr<iIMDShape> baseModel, std::unique_ptr<iIMDShape> graphics_override_model)
+{
 	// create BaseShape from full (base) model (first level)
 	// the iIMDBaseShape then "owns" the display model iIMDShape
 	auto modelName = baseModel->modelName;
@@ -395,6 +817,27 @@ bool tryLoad(const WzString &path, const WzString &filename)
 	return true;
 }
 
+bool tryLoad(const WzString &path, const WzString &filename)
+{
+	if (!PHYSFS_exists(path + filename))
+	{
+		// base model does not exist
+		return false;
+	}
+
+	// first, try to load a graphics override - at the same path but with a prefix
+	auto graphics_override_model = tryLoadDisplayModelInternal(WZ_CURRENT_GRAPHICS_OVERRIDES_PREFIX "/" + path, filename, false);
+
+	// try to load base model
+	auto baseModel = tryLoadDisplayModelInternal(path, filename, (graphics_override_model != nullptr));
+	if (!baseModel)
+	{
+		return false;
+	}
+
+	return registerModel(path, filename, std::move(baseModel), std::move(graphics_override_model));
+}
+
 const WzString &modelName(const iIMDShape *model)
 {
 	if (model != nullptr)
@@ -419,17 +862,111 @@ iIMDBaseShape *modelGet(const WzString &filename)
 	{
 		return it->second.get(); // cached
 	}
-	else if (tryLoad("structs/", name) || tryLoad("misc/", name) || tryLoad("effects/", name)
-	         || tryLoad("components/prop/", name) || tryLoad("components/weapons/", name)
-	         || tryLoad("components/bodies/", name) || tryLoad("features/", name)
-	         || tryLoad("misc/micnum/", name) || tryLoad("misc/minum/", name) || tryLoad("misc/mivnum/", name) || tryLoad("misc/researchimds/", name))
+	for (const char *path : modelSearchPaths)
 	{
-		return models.at(name.toStdString()).get();
+		if (tryLoad(path, name))
+		{
+			return models.at(name.toStdString()).get();
+		}
 	}
 	debug(LOG_ERROR, "Could not find: %s", name.toUtf8().c_str());
 	return nullptr;
 }
 
+void modelPreload(const std::vector<WzString> &filenames)
+{
+	struct PreloadJob
+	{
+		WzString name;
+		WzString path;
+		std::unique_ptr<iIMDShape> baseModel;
+		std::unique_ptr<iIMDShape> overrideModel;
+		DeferredModelData baseData;
+		DeferredModelData overrideData;
+	};
+	std::vector<PreloadJob> jobs;
+	std::unordered_set<std::string> queued;
+	for (const auto &filename : filenames)
+	{
+		WzString name = filename.toLower();
+		if (models.count(name.toStdString()) == 0 && queued.insert(name.toStdString()).second)
+		{
+			jobs.emplace_back();
+			jobs.back().name = std::move(name);
+		}
+	}
+
+	// Parse the PIE files on worker threads (does the same as tryLoad(), except for changing `models`)
+	wzParallelFor(jobs.size(), [&jobs](size_t i) {
+		PreloadJob &job = jobs[i];
+		for (const char *path : modelSearchPaths)
+		{
+			if (!PHYSFS_exists(WzString(path) + job.name))
+			{
+				continue;
+			}
+			job.path = path;
+			job.overrideData = DeferredModelData();
+			job.overrideModel = tryLoadDisplayModelInternal(WZ_CURRENT_GRAPHICS_OVERRIDES_PREFIX "/" + job.path, job.name, false, true, &job.overrideData);
+			job.baseModel = tryLoadDisplayModelInternal(job.path, job.name, (job.overrideModel != nullptr), true, &job.baseData);
+			if (job.baseModel)
+			{
+				return;
+			}
+		}
+		job.overrideModel.reset();
+	});
+
+	// Upload the GPU buffers and register the models on this thread
+	std::vector<std::pair<iIMDShape *, const DeferredModelData *>> displayModels;
+	for (auto &job : jobs)
+	{
+		if (!job.baseModel || models.count(job.name.toStdString()) != 0)
+		{
+			continue; // not found (modelGet() will complain if it's actually used)
+		}
+		finishDeferredModelData(job.baseData);
+		finishDeferredModelData(job.overrideData);
+		if (job.overrideModel)
+		{
+			displayModels.emplace_back(job.overrideModel.get(), &job.overrideData);
+		}
+		else
+		{
+			displayModels.emplace_back(job.baseModel.get(), &job.baseData);
+		}
+		if (!registerModel(job.path, job.name, std::move(job.baseModel), std::move(job.overrideModel)))
+		{
+			displayModels.pop_back();
+		}
+	}
+
+	// Animation models may be among the preloaded ones, so they're only looked up once all are registered
+	for (const auto &displayModel : displayModels)
+	{
+		resolveAnimEventModels(*displayModel.first, *displayModel.second);
+	}
+
+	// Load their textures now, so they're decoded in parallel rather than one by one when first drawn
+	std::vector<std::pair<std::string, gfx_api::texture_type>> textures;
+	for (const auto &displayModel : displayModels)
+	{
+		for (const iIMDShape *level = displayModel.first; level != nullptr; level = level->next.get())
+		{
+			const auto files = _imd_get_level_texture_files(*level, currentTilesetIdx);
+			for (size_t i = 0; i < files.size(); ++i)
+			{
+				if (!files[i].empty())
+				{
+					textures.emplace_back(files[i], levelTextureTypes[i]);
+				}
+			}
+		}
+	}
+	iV_PreloadTextures(textures);
+	debug(LOG_WZ, "Preloaded %zu models", displayModels.size());
+}
+
 struct IMD_Line
 {
 	std::string lineContents;
@@ -937,6 +1474,54 @@ static bool ReadPoints(const char **ppFileData, const char *FileDataEnd, iIMDSha
 	return true;
 }
 
+/// Groups the edges of the shadow polygons by the (unordered) pair of points they connect
+static void _imd_calc_shadow_edges(iIMDShape &s)
+{
+	struct EdgeOccurrence
+	{
+		uint64_t key;
+		uint32_t polyAndDirection;
+	};
+	std::vector<EdgeOccurrence> occurrences;
+	const std::vector<iIMDPoly> &shadowPolys = *s.pShadowPolys;
+	occurrences.reserve(shadowPolys.size() * 3);
+	for (size_t polyIdx = 0; polyIdx < shadowPolys.size(); ++polyIdx)
+	{
+		const iIMDPoly &poly = shadowPolys[polyIdx];
+		for (int n = 0; n < 3; ++n)
+		{
+			uint32_t from = poly.pindex[n];
+			uint32_t to = poly.pindex[(n + 1) % 3];
+			if (from == to)
+			{
+				continue; // degenerate edges always cancel themselves out
+			}
+			const uint32_t reversed = (from > to) ? 1 : 0;
+			if (reversed)
+			{
+				std::swap(from, to);
+			}
+			occurrences.push_back({static_cast<uint64_t>(from) << 32 | to, static_cast<uint32_t>(polyIdx << 1) | reversed});
+		}
+	}
+	std::sort(occurrences.begin(), occurrences.end(), [](const EdgeOccurrence &a, const EdgeOccurrence &b) { return a.key < b.key; });
+
+	s.shadowEdgeGroups.clear();
+	s.shadowEdgePolys.clear();
+	s.shadowEdgePolys.reserve(occurrences.size());
+	for (size_t i = 0; i < occurrences.size(); ++i)
+	{
+		if (i == 0 || occurrences[i].key != occurrences[i - 1].key)
+		{
+			const uint32_t from = static_cast<uint32_t>(occurrences[i].key >> 32);
+			const uint32_t to = static_cast<uint32_t>(occurrences[i].key & 0xFFFFFFFF);
+			s.shadowEdgeGroups.push_back({from, to, static_cast<uint32_t>(i), 0});
+		}
+		++s.shadowEdgeGroups.back().numPolys;
+		s.shadowEdgePolys.push_back(occurrences[i].polyAndDirection);
+	}
+}
+
 static void _imd_calc_bounds(iIMDShape &s, bool allLevels = false)
 {
 	int32_t xmax, ymax, zmax;
@@ -1211,77 +1796,81 @@ static void _imd_determine_tileset_texture_files(iIMDShape& s, const LevelSettin
 	}
 }
 
-static bool _imd_load_level_textures(const iIMDShape& s, size_t tilesetIdx, iIMDShapeTextures& output)
+// Returns the texture page, tcmask, normal map and specular map files of a level (empty if not used)
+static std::array<std::string, 4> _imd_get_level_texture_files(const iIMDShape& s, size_t tilesetIdx)
 {
 	const auto& defaultSettings = s.tilesetTextureFiles[0];
 	const auto& tilesetSettings = s.tilesetTextureFiles[tilesetIdx];
+	std::array<std::string, 4> files;
 
-	const WzString &filename = s.modelName;
 	const TilesetTextureFiles* pLevelSettingsToUseForTextures = (!tilesetSettings.texfile.empty()) ? &tilesetSettings : &defaultSettings;
-	if (!pLevelSettingsToUseForTextures->texfile.empty())
+	if (pLevelSettingsToUseForTextures->texfile.empty())
 	{
-		optional<size_t> texpage = iV_GetTexture(pLevelSettingsToUseForTextures->texfile.c_str(), gfx_api::texture_type::game_texture);
-		optional<size_t> tcmaskpage;
-		optional<size_t> normalpage;
-		optional<size_t> specpage;
+		return files;
+	}
+	files[0] = pLevelSettingsToUseForTextures->texfile;
 
-		ASSERT_OR_RETURN(false, texpage.has_value(), "%s could not load tex page %s", filename.toUtf8().c_str(), pLevelSettingsToUseForTextures->texfile.c_str());
+	const TilesetTextureFiles* pLevelSettingsToUseForTCMask = (!tilesetSettings.tcmaskfile.empty()) ? &tilesetSettings : &defaultSettings;
+	if (!pLevelSettingsToUseForTCMask->tcmaskfile.empty())
+	{
+		// explicitly specified tcmask file
+		files[1] = pLevelSettingsToUseForTCMask->tcmaskfile;
+	}
+	else if (s.flags & iV_IMD_TCMASK)
+	{
+		// BACKWARDS-COMPATIBILITY (PIE 2/3 compatibility)
+		// model should use team colour mask
+		files[1] = pie_MakeTexPageTCMaskName(pLevelSettingsToUseForTextures->texfile) + ".png";
+	}
 
-		const TilesetTextureFiles* pLevelSettingsToUseForTCMask = (!tilesetSettings.tcmaskfile.empty()) ? &tilesetSettings : &defaultSettings;
-		if (!pLevelSettingsToUseForTCMask->tcmaskfile.empty())
-		{
-			// load explicitly specified tcmask file
-			debug(LOG_TEXTURE, "Loading tcmask %s for %s", pLevelSettingsToUseForTCMask->tcmaskfile.c_str(), filename.toUtf8().c_str());
-			tcmaskpage = iV_GetTexture(pLevelSettingsToUseForTCMask->tcmaskfile.c_str(), gfx_api::texture_type::alpha_mask);
-			ASSERT_OR_RETURN(false, tcmaskpage.has_value(), "%s could not load tcmask %s", filename.toUtf8().c_str(), pLevelSettingsToUseForTCMask->tcmaskfile.c_str());
-		}
-		else
-		{
-			// BACKWARDS-COMPATIBILITY (PIE 2/3 compatibility)
-			// check if model should use team colour mask
-			if (s.flags & iV_IMD_TCMASK)
-			{
-				std::string tcmask_name = pie_MakeTexPageTCMaskName(pLevelSettingsToUseForTextures->texfile.c_str());
-				tcmask_name += ".png";
-				tcmaskpage = iV_GetTexture(tcmask_name.c_str(), gfx_api::texture_type::alpha_mask);
-				ASSERT_OR_RETURN(false, tcmaskpage.has_value(), "%s could not load tcmask %s", filename.toUtf8().c_str(), tcmask_name.c_str());
-			}
-		}
+	const TilesetTextureFiles* pLevelSettingsToUseForNormals = (!tilesetSettings.normalfile.empty()) ? &tilesetSettings : &defaultSettings;
+	files[2] = pLevelSettingsToUseForNormals->normalfile;
 
-		const TilesetTextureFiles* pLevelSettingsToUseForNormals = (!tilesetSettings.normalfile.empty()) ? &tilesetSettings : &defaultSettings;
-		if (!pLevelSettingsToUseForNormals->normalfile.empty())
-		{
-			debug(LOG_TEXTURE, "Loading normal map %s for %s", pLevelSettingsToUseForNormals->normalfile.c_str(), filename.toUtf8().c_str());
-			normalpage = iV_GetTexture(pLevelSettingsToUseForNormals->normalfile.c_str(), gfx_api::texture_type::normal_map);
-			ASSERT_OR_RETURN(false, normalpage.has_value(), "%s could not load tex page %s", filename.toUtf8().c_str(), pLevelSettingsToUseForNormals->normalfile.c_str());
-		}
+	const TilesetTextureFiles* pLevelSettingsToUseForSpecular = (!tilesetSettings.specfile.empty()) ? &tilesetSettings : &defaultSettings;
+	files[3] = pLevelSettingsToUseForSpecular->specfile;
 
-		const TilesetTextureFiles* pLevelSettingsToUseForSpecular = (!tilesetSettings.specfile.empty()) ? &tilesetSettings : &defaultSettings;
-		if (!pLevelSettingsToUseForSpecular->specfile.empty())
+	return files;
+}
+
+static bool _imd_load_level_textures(const iIMDShape& s, size_t tilesetIdx, iIMDShapeTextures& output)
+{
+	const WzString &filename = s.modelName;
+	const auto files = _imd_get_level_texture_files(s, tilesetIdx);
+	if (files[0].empty())
+	{
+		return true;
+	}
+
+	std::array<optional<size_t>, 4> pages;
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (files[i].empty())
 		{
-			debug(LOG_TEXTURE, "Loading specular map %s for %s", pLevelSettingsToUseForSpecular->specfile.c_str(), filename.toUtf8().c_str());
-			specpage = iV_GetTexture(pLevelSettingsToUseForSpecular->specfile.c_str(), gfx_api::texture_type::specular_map);
-			ASSERT_OR_RETURN(false, specpage.has_value(), "%s could not load tex page %s", filename.toUtf8().c_str(), pLevelSettingsToUseForSpecular->specfile.c_str());
+			continue;
 		}
-
-		// assign tex pages and flags for this level
-		output.texpage = texpage.value();
-		output.tcmaskpage = (tcmaskpage.has_value()) ? tcmaskpage.value() : iV_TEX_INVALID;
-		output.normalpage = (normalpage.has_value()) ? normalpage.value() : iV_TEX_INVALID;
-		output.specularpage = (specpage.has_value()) ? specpage.value() : iV_TEX_INVALID;
+		debug(LOG_TEXTURE, "Loading %s for %s", files[i].c_str(), filename.toUtf8().c_str());
+		pages[i] = iV_GetTexture(files[i].c_str(), levelTextureTypes[i]);
+		ASSERT_OR_RETURN(false, pages[i].has_value(), "%s could not load tex page %s", filename.toUtf8().c_str(), files[i].c_str());
 	}
 
+	// assign tex pages and flags for this level
+	output.texpage = pages[0].value();
+	output.tcmaskpage = (pages[1].has_value()) ? pages[1].value() : iV_TEX_INVALID;
+	output.normalpage = (pages[2].has_value()) ? pages[2].value() : iV_TEX_INVALID;
+	output.specularpage = (pages[3].has_value()) ? pages[3].value() : iV_TEX_INVALID;
+
 	return true;
 }
 
 // performance hack
-static std::vector<gfx_api::gfxFloat> vertices;
-static std::vector<gfx_api::gfxFloat> normals;
-static std::vector<gfx_api::gfxFloat> texcoords; // texcoords + texAnim
-static std::vector<gfx_api::gfxFloat> tangents;
-static std::vector<gfx_api::gfxFloat> bitangents;
-static std::vector<uint16_t> indices; // size is npolys * 3 * numFrames
-static uint16_t vertexCount = 0;
+// thread_local, as models are parsed on worker threads by modelPreload()
+static thread_local std::vector<gfx_api::gfxFloat> vertices;
+static thread_local std::vector<gfx_api::gfxFloat> normals;
+static thread_local std::vector<gfx_api::gfxFloat> texcoords; // texcoords + texAnim
+static thread_local std::vector<gfx_api::gfxFloat> tangents;
+static thread_local std::vector<gfx_api::gfxFloat> bitangents;
+static thread_local std::vector<uint16_t> indices; // size is npolys * 3 * numFrames
+static thread_local uint16_t vertexCount = 0;
 
 static bool ReadNormals(const char **ppFileData, const char *FileDataEnd, std::vector<Vector3f> &pie_level_normals, uint32_t num_normal_lines)
 {
@@ -1463,7 +2052,50 @@ void finishTangentsGeneration()
  * \post s allocated
  */
 static_assert(PATH_MAX >= 255, "PATH_MAX is insufficient!");
-static std::unique_ptr<iIMDShape> _imd_load_level(const WzString &filename, const char **ppFileData, const char *FileDataEnd, int pieVersion, uint32_t level, const LevelSettings &globalLevelSettings, bool skipGPUData, bool skipDuplicateLoadChecks)
+static void _imd_upload_level_buffers(iIMDShape &s, const std::vector<gfx_api::gfxFloat> &vertices, const std::vector<gfx_api::gfxFloat> &normals,
+	const std::vector<gfx_api::gfxFloat> &texcoords, const std::vector<gfx_api::gfxFloat> &tangents, const std::vector<uint16_t> &indices)
+{
+	if (!tangents.empty())
+	{
+		if (!s.buffers[VBO_TANGENT])
+			s.buffers[VBO_TANGENT] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "tangent buffer");
+		s.buffers[VBO_TANGENT]->upload(tangents.size() * sizeof(gfx_api::gfxFloat), tangents.data());
+	}
+
+	if (!s.buffers[VBO_VERTEX])
+		s.buffers[VBO_VERTEX] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "vertex buffer");
+	if (vertices.empty())
+	{
+		debug(LOG_ERROR, "_imd_load_level: file corrupt? - no vertices?: %s", s.modelName.toUtf8().c_str());
+	}
+	s.buffers[VBO_VERTEX]->upload(vertices.size() * sizeof(gfx_api::gfxFloat), vertices.data());
+
+	if (!s.buffers[VBO_NORMAL])
+		s.buffers[VBO_NORMAL] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "normals buffer");
+	if (normals.empty())
+	{
+		debug(LOG_ERROR, "_imd_load_level: file corrupt? - no normals?: %s", s.modelName.toUtf8().c_str());
+	}
+	s.buffers[VBO_NORMAL]->upload(normals.size() * sizeof(gfx_api::gfxFloat), normals.data());
+
+	if (!s.buffers[VBO_INDEX])
+		s.buffers[VBO_INDEX] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::index_buffer, gfx_api::context::buffer_storage_hint::static_draw, "index buffer");
+	if (indices.empty())
+	{
+		debug(LOG_ERROR, "_imd_load_level: file corrupt? - no indices?: %s", s.modelName.toUtf8().c_str());
+	}
+	s.buffers[VBO_INDEX]->upload(indices.size() * sizeof(uint16_t), indices.data());
+
+	if (!s.buffers[VBO_TEXCOORD])
+		s.buffers[VBO_TEXCOORD] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "tex coords buffer");
+	if (texcoords.empty())
+	{
+		debug(LOG_ERROR, "_imd_load_level: file corrupt? - no texcoords?: %s", s.modelName.toUtf8().c_str());
+	}
+	s.buffers[VBO_TEXCOORD]->upload(texcoords.size() * sizeof(gfx_api::gfxFloat), texcoords.data());
+}
+
+static std::unique_ptr<iIMDShape> _imd_load_level(const WzString &filename, const char **ppFileData, const char *FileDataEnd, int pieVersion, uint32_t level, const LevelSettings &globalLevelSettings, bool skipGPUData, bool skipDuplicateLoadChecks, DeferredModelData &deferred)
 {
 	const char *pFileData = *ppFileData;
 	char buffer[PATH_MAX] = {'\0'}; uint32_t value = 0;
@@ -1736,6 +2368,7 @@ static std::unique_ptr<iIMDShape> _imd_load_level(const WzString &filename, cons
 		s.altShadowPoints.clear();
 		s.altShadowPolys.clear();
 	}
+	_imd_calc_shadow_edges(s);
 
 	// FINALLY, massage the data into what can stream directly to GPU buffers
 	if (!skipGPUData)
@@ -1762,46 +2395,16 @@ static std::unique_ptr<iIMDShape> _imd_load_level(const WzString &filename, cons
 			for (size_t i = 0; i < indices.size(); i += 3)
 				calculateTangentsForTriangle(indices[i], indices[i+1], indices[i+2]);
 			finishTangentsGeneration();
-
-			if (!tangents.empty())
-			{
-				if (!s.buffers[VBO_TANGENT])
-					s.buffers[VBO_TANGENT] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "tangent buffer");
-				s.buffers[VBO_TANGENT]->upload(tangents.size() * sizeof(gfx_api::gfxFloat), tangents.data());
-			}
-		}
-
-		if (!s.buffers[VBO_VERTEX])
-			s.buffers[VBO_VERTEX] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "vertex buffer");
-		if (vertices.empty())
-		{
-			debug(LOG_ERROR, "_imd_load_level: file corrupt? - no vertices?: %s (key: %s)", filename.toUtf8().c_str(), key.c_str());
 		}
-		s.buffers[VBO_VERTEX]->upload(vertices.size() * sizeof(gfx_api::gfxFloat), vertices.data());
 
-		if (!s.buffers[VBO_NORMAL])
-			s.buffers[VBO_NORMAL] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "normals buffer");
-		if (normals.empty())
-		{
-			debug(LOG_ERROR, "_imd_load_level: file corrupt? - no normals?: %s (key: %s)", filename.toUtf8().c_str(), key.c_str());
-		}
-		s.buffers[VBO_NORMAL]->upload(normals.size() * sizeof(gfx_api::gfxFloat), normals.data());
-
-		if (!s.buffers[VBO_INDEX])
-			s.buffers[VBO_INDEX] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::index_buffer, gfx_api::context::buffer_storage_hint::static_draw, "index buffer");
-		if (indices.empty())
-		{
-			debug(LOG_ERROR, "_imd_load_level: file corrupt? - no indices?: %s (key: %s)", filename.toUtf8().c_str(), key.c_str());
-		}
-		s.buffers[VBO_INDEX]->upload(indices.size() * sizeof(uint16_t), indices.data());
-
-		if (!s.buffers[VBO_TEXCOORD])
-			s.buffers[VBO_TEXCOORD] = gfx_api::context::get().create_buffer_object(gfx_api::buffer::usage::vertex_buffer, gfx_api::context::buffer_storage_hint::static_draw, "tex coords buffer");
-		if (texcoords.empty())
-		{
-			debug(LOG_ERROR, "_imd_load_level: file corrupt? - no texcoords?: %s (key: %s)", filename.toUtf8().c_str(), key.c_str());
-		}
-		s.buffers[VBO_TEXCOORD]->upload(texcoords.size() * sizeof(gfx_api::gfxFloat), texcoords.data());
+		DeferredModelData::LevelBuffers levelBuffers;
+		levelBuffers.shape = &s;
+		levelBuffers.vertices = std::move(vertices);
+		levelBuffers.normals = std::move(normals);
+		levelBuffers.texcoords = std::move(texcoords);
+		levelBuffers.tangents = std::move(tangents);
+		levelBuffers.indices = std::move(indices);
+		deferred.levelBuffers.push_back(std::move(levelBuffers));
 	}
 
 	indices.resize(0);
@@ -1832,7 +2435,7 @@ static std::unique_ptr<iIMDShape> _imd_load_level(const WzString &filename, cons
  * \return The shape, constructed from the data read
  */
 // ppFileData is incremented to the end of the file on exit!
-static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const char **ppFileData, const char *FileDataEnd, bool skipGPUData, bool skipDuplicateLoadChecks)
+static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const char **ppFileData, const char *FileDataEnd, bool skipGPUData, bool skipDuplicateLoadChecks, DeferredModelData &deferred)
 {
 	const char *pFileData = *ppFileData;
 	char buffer[PATH_MAX] = {};
@@ -1840,7 +2443,6 @@ static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const
 	unsigned value = 0;
 	unsigned nlevels = 0;
 	int32_t imd_version;
-	iIMDBaseShape *objanimpie[ANIM_EVENT_COUNT];
 
 	IMD_Line lineToProcess;
 	if (!_imd_get_next_line(pFileData, FileDataEnd, lineToProcess) || sscanf(lineToProcess.lineContents.c_str(), "%255s %d", buffer, &imd_version) != 2)
@@ -1902,10 +2504,6 @@ static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const
 		return nullptr;
 	}
 
-	for (int i = 0; i < ANIM_EVENT_COUNT; i++)
-	{
-		objanimpie[i] = nullptr;
-	}
 	while (strncmp(buffer, "EVENT", 5) == 0)
 	{
 		char animpie[PATH_MAX];
@@ -1919,7 +2517,11 @@ static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const
 			return nullptr;
 		}
 
-		objanimpie[value] = modelGet(animpie);
+		// looked up later, as modelGet() must not be called from worker threads
+		if (value < ANIM_EVENT_COUNT)
+		{
+			deferred.animEventModels[value] = animpie;
+		}
 
 		/* Try -yet again- to read in LEVELS directive */
 		if (!getNextPossibleCommandLine())
@@ -1962,7 +2564,7 @@ static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const
 			return nullptr;
 		}
 
-		std::unique_ptr<iIMDShape> shape = _imd_load_level(filename, &lineToProcess.pNextLineBegin, FileDataEnd, imd_version, level, globalLevelSettings, skipGPUData, skipDuplicateLoadChecks);
+		std::unique_ptr<iIMDShape> shape = _imd_load_level(filename, &lineToProcess.pNextLineBegin, FileDataEnd, imd_version, level, globalLevelSettings, skipGPUData, skipDuplicateLoadChecks, deferred);
 		if (shape == nullptr)
 		{
 			debug(LOG_ERROR, "%s: Unsuccessful loading level %" PRIu32, filename.toUtf8().c_str(), (level + 1));
@@ -1987,12 +2589,6 @@ static std::unique_ptr<iIMDShape> iV_ProcessIMD(const WzString &filename, const
 
 	ASSERT_OR_RETURN(nullptr, firstLevel != nullptr, "%s: Has no levels?", filename.toUtf8().c_str());
 
-	// copy over model-wide animation information, stored only in the first level
-	for (int i = 0; i < ANIM_EVENT_COUNT; i++)
-	{
-		firstLevel->objanimpie[i] = objanimpie[i];
-	}
-
 	// TODO: once all levels have been loaded, re-calculate the bounds of the first level using all the levels' points?
 
 	*ppFileData = pFileData;
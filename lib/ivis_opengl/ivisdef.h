@@ -74,6 +74,13 @@ struct EDGE
 	uint64_t sort_key;
 };
 
+/// An edge shared by one or more shadow polygons (in either direction)
+struct SHADOW_EDGE_GROUP
+{
+	uint32_t from, to;  ///< from < to
+	uint32_t firstPoly, numPolys;  ///< range in iIMDShape::shadowEdgePolys
+};
+
 struct ANIMFRAME
 {
 	Vector3f scale = Vector3f(0.f, 0.f, 0.f);
@@ -144,7 +151,7 @@ struct iIMDBaseShape
 	// the display shape used for rendering (*NOT* for any game state calculations!)
 	inline const iIMDShape* displayModel() const { return m_displayModel.get(); }
 protected:
-	friend bool tryLoad(const WzString &path, const WzString &filename);
+	friend bool registerModel(const WzString &path, const WzString &filename, std::unique_ptr<iIMDShape> baseModel, std::unique_ptr<iIMDShape> graphics_override_model);
 	friend void modelUpdateTilesetIdx(size_t tilesetIdx);
 	friend void modelReloadAllModelTextures();
 	friend bool debugReloadDisplayModelsForBaseModel(iIMDBaseShape& baseModel);
@@ -202,6 +209,10 @@ struct iIMDShape
 	EDGE *shadowEdgeList = nullptr;
 	size_t nShadowEdges = 0;
 
+	// Edge adjacency of the shadow polygons, for finding the silhouette edges without sorting (calculated on load)
+	std::vector<SHADOW_EDGE_GROUP> shadowEdgeGroups;
+	std::vector<uint32_t> shadowEdgePolys;  ///< (index in *pShadowPolys << 1) | 1 if that polygon has the edge as (to, from)
+
 	// The old rendering data
 	std::vector<Vector3f> points; // NOTE: This is used to calculate some of the values above on imd load (in _imd_calc_bounds)
 	std::vector<iIMDPoly> polys;
@@ -27,6 +27,7 @@
 #include "lib/ivis_opengl/piedraw.h"
 #include "lib/framework/frame.h"
 #include "lib/framework/pool_allocator.h"
+#include "lib/framework/parallel_for.h"
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/piefunc.h"
@@ -35,6 +36,7 @@
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/piepalette.h"
 #include "lib/ivis_opengl/pieclip.h"
+#include "lib/ivis_opengl/pieparticles.h"
 #include "lib/ivis_opengl/pieblitfunc.h"
 #include "lib/ivis_opengl/pielight_convert.h"
 #include "piematrix.h"
@@ -50,16 +52,6 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-
-#if defined(__clang__)
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wtautological-constant-out-of-range-compare"
-#endif
-#include "3rdparty/ska_sort.hpp"
-#if defined(__clang__)
-#pragma clang diagnostic pop
-#endif
-
 #define BUFFER_OFFSET(i) (reinterpret_cast<char *>(i))
 #define SHADOW_END_DISTANCE (8000*8000) // Keep in sync with lighting.c:FOG_END
 
@@ -76,6 +68,7 @@ static ShadowMode shadowMode = ShadowMode::Shadow_Mapping;
 static uint32_t numShadowCascades = WZ_MAX_SHADOW_CASCADES;
 static gfx_api::gfxFloat lighting0[LIGHT_MAX][4];
 static gfx_api::gfxFloat lightingDefault[LIGHT_MAX][4];
+static bool parallelFramePreparation = true;
 
 /*
  * Function declarations
@@ -617,22 +610,11 @@ static templatedState pie_Draw3DShape2(const templatedState &lastState, ShaderOn
 	return currentState;
 }
 
-static inline bool edgeLessThan(EDGE const &e1, EDGE const &e2)
-{
-	return e1.sort_key < e2.sort_key;
-}
-
 static inline uint64_t edgeSortKey(uint32_t from, uint32_t to)
 {
 	return static_cast<uint64_t>(from) << 32 | to;
 }
 
-static inline void flipEdge(EDGE &e)
-{
-	std::swap(e.from, e.to);
-	e.sort_key = edgeSortKey(e.from, e.to);
-}
-
 /// scale the height according to the flags
 static inline float scale_y(float y, int flag, int flag_data)
 {
@@ -805,126 +787,70 @@ private:
 	std::vector<Vector3f> vertexes;
 };
 
-enum DrawShadowResult {
-	DRAW_SUCCESS_CACHED,
-	DRAW_SUCCESS_UNCACHED
-};
-
-/// Draw the shadow for a shape
-/// Prequisite:
-///		Caller must call the following before all calls to pie_DrawShadow():
-///			const auto &program = pie_ActivateShader(SHADER_GENERIC_COLOR, pie_PerspectiveGet(), glm::vec4());
-///			glEnableVertexAttribArray(program.locVertex);
-///		and must call the following after all calls to pie_DrawShadow():
-///			glDisableVertexAttribArray(program.locVertex);
-///			pie_DeactivateShader();
-///		The only place this is currently called is pie_ShadowDrawLoop(), which handles this properly.
-static inline DrawShadowResult pie_DrawShadow(ShadowCache &shadowCache, iIMDShape *shape, int flag, int flag_data, const glm::vec4 &light, const glm::mat4 &modelViewMatrix)
+/// Find the silhouette edges of a shape, as seen from the light: the edges of the shadow polygons facing the light
+/// that aren't shared with another polygon facing the light (in the opposite direction)
+static void pie_ShadowSilhouetteEdges(const iIMDShape *shape, int flag, int flag_data, const glm::vec4 &light, std::vector<uint8_t> &facingLight, std::vector<EDGE> &edges)
 {
-	static std::vector<EDGE> edgelist;  // Static, to save allocations.
-	static std::vector<EDGE> edgelistFlipped;  // Static, to save allocations.
-	static std::vector<EDGE> edgelistFiltered;  // Static, to save allocations.
-	EDGE *drawlist = nullptr;
-
-	size_t edge_count;
-	DrawShadowResult result;
-
-	// Find cached data (if available)
-	// Note: The modelViewMatrix is not used for calculating the sorted / filtered vertices, so it's not included
-	const ShadowCache::CachedShadowData *pCached = shadowCache.findCacheForShadowDraw(shape, flag, flag_data, light);
-	if (pCached == nullptr)
-	{
-		const Vector3f *pVertices = shape->pShadowPoints->data();
-		if (flag & pie_STATIC_SHADOW && shape->shadowEdgeList)
+	const Vector3f *pVertices = shape->pShadowPoints->data();
+	const std::vector<iIMDPoly> &shadowPolys = *(shape->pShadowPolys);
+	facingLight.resize(shadowPolys.size());
+	glm::vec3 p[3];
+	for (size_t i = 0; i < shadowPolys.size(); ++i)
+	{
+		const iIMDPoly &poly = shadowPolys[i];
+		for (int j = 0; j < 3; ++j)
 		{
-			drawlist = shape->shadowEdgeList;
-			edge_count = shape->nShadowEdges;
+			uint32_t current = poly.pindex[j];
+			p[j] = glm::vec3(pVertices[current].x, scale_y(pVertices[current].y, flag, flag_data), pVertices[current].z);
 		}
-		else
-		{
-			edgelist.clear();
-			glm::vec3 p[3];
-			for (const iIMDPoly &poly : *(shape->pShadowPolys))
-			{
-				for (int j = 0; j < 3; ++j)
-				{
-					uint32_t current = poly.pindex[j];
-					p[j] = glm::vec3(pVertices[current].x, scale_y(pVertices[current].y, flag, flag_data), pVertices[current].z);
-				}
-				if (glm::dot(glm::cross(p[2] - p[0], p[1] - p[0]), glm::vec3(light)) > 0.0f)
-				{
-					for (int n = 0; n < 3; ++n)
-					{
-						// Add the edges
-						uint32_t from = poly.pindex[n];
-						uint32_t to = poly.pindex[(n + 1)%3];
-						edgelist.push_back({from, to, edgeSortKey(from, to)});
-					}
-				}
-			}
-
-			// Remove duplicate pairs from the edge list. For example, in the list ((1 2), (2 6), (6 2), (3, 4)), remove (2 6) and (6 2).
-			edgelistFlipped = edgelist;
-			std::for_each(edgelistFlipped.begin(), edgelistFlipped.end(), flipEdge);
-			ska_sort(edgelist.begin(), edgelist.end(), [](const EDGE & edge)
-			{
-				return edge.sort_key;
-			});
-			ska_sort(edgelistFlipped.begin(), edgelistFlipped.end(), [](const EDGE & edge)
-			{
-				return edge.sort_key;
-			});
-			edgelistFiltered.resize(edgelist.size());
-			edgelistFiltered.erase(std::set_difference(edgelist.begin(), edgelist.end(), edgelistFlipped.begin(), edgelistFlipped.end(), edgelistFiltered.begin(), edgeLessThan), edgelistFiltered.end());
-
-			edge_count = edgelistFiltered.size();
-			drawlist = edgelistFiltered.data();
-			//debug(LOG_WARNING, "we have %i edges", edge_count);
+		facingLight[i] = (glm::dot(glm::cross(p[2] - p[0], p[1] - p[0]), glm::vec3(light)) > 0.0f) ? 1 : 0;
+	}
 
-			if (flag & pie_STATIC_SHADOW)
+	edges.clear();
+	for (const SHADOW_EDGE_GROUP &group : shape->shadowEdgeGroups)
+	{
+		// Edges in opposite directions cancel each other out
+		int balance = 0;
+		for (uint32_t i = group.firstPoly, end = group.firstPoly + group.numPolys; i < end; ++i)
+		{
+			const uint32_t polyAndDirection = shape->shadowEdgePolys[i];
+			if (facingLight[polyAndDirection >> 1])
 			{
-				// then store it in the imd
-				shape->nShadowEdges = edge_count;
-				if (edge_count > 0)
-				{
-					shape->shadowEdgeList = (EDGE *)realloc(shape->shadowEdgeList, sizeof(EDGE) * shape->nShadowEdges);
-					std::copy(drawlist, drawlist + edge_count, shape->shadowEdgeList);
-				}
+				balance += (polyAndDirection & 1) ? -1 : 1;
 			}
 		}
-
-		std::vector<Vector3f> vertexes;
-		vertexes.reserve(edge_count * 6);
-		for (size_t i = 0; i < edge_count; i++)
+		for (; balance > 0; --balance)
 		{
-			int a = drawlist[i].from, b = drawlist[i].to;
-
-			glm::vec3 v1(pVertices[b].x, scale_y(pVertices[b].y, flag, flag_data), pVertices[b].z);
-			glm::vec3 v3(pVertices[a].x + light[0], scale_y(pVertices[a].y, flag, flag_data) + light[1], pVertices[a].z + light[2]);
-
-			vertexes.push_back(v1);
-			vertexes.push_back(glm::vec3(pVertices[b].x + light[0], scale_y(pVertices[b].y, flag, flag_data) + light[1], pVertices[b].z + light[2])); //v2
-			vertexes.push_back(v3);
-
-			vertexes.push_back(v3);
-			vertexes.push_back(glm::vec3(pVertices[a].x, scale_y(pVertices[a].y, flag, flag_data), pVertices[a].z)); //v4
-			vertexes.push_back(v1);
+			edges.push_back({group.from, group.to, edgeSortKey(group.from, group.to)});
+		}
+		for (; balance < 0; ++balance)
+		{
+			edges.push_back({group.to, group.from, edgeSortKey(group.to, group.from)});
 		}
-
-		ShadowCache::CachedShadowData& cache = shadowCache.createCacheForShadowDraw(shape, flag, flag_data, light);
-		cache.vertexes = std::move(vertexes);
-		result = DRAW_SUCCESS_UNCACHED;
-		pCached = &cache;
 	}
-	else
+}
+
+/// Build the shadow volume of a shape (in model space)
+static void pie_ShadowVolume(const iIMDShape *shape, int flag, int flag_data, const glm::vec4 &light, const EDGE *drawlist, size_t edge_count, std::vector<Vector3f> &vertexes)
+{
+	const Vector3f *pVertices = shape->pShadowPoints->data();
+	vertexes.clear();
+	vertexes.reserve(edge_count * 6);
+	for (size_t i = 0; i < edge_count; i++)
 	{
-		result = DRAW_SUCCESS_CACHED;
-	}
+		int a = drawlist[i].from, b = drawlist[i].to;
 
-	// Aggregate the vertexes (pre-computed with the modelViewMatrix)
-	shadowCache.addPremultipliedVertexes(*pCached, modelViewMatrix);
+		glm::vec3 v1(pVertices[b].x, scale_y(pVertices[b].y, flag, flag_data), pVertices[b].z);
+		glm::vec3 v3(pVertices[a].x + light[0], scale_y(pVertices[a].y, flag, flag_data) + light[1], pVertices[a].z + light[2]);
 
-	return result;
+		vertexes.push_back(v1);
+		vertexes.push_back(glm::vec3(pVertices[b].x + light[0], scale_y(pVertices[b].y, flag, flag_data) + light[1], pVertices[b].z + light[2])); //v2
+		vertexes.push_back(v3);
+
+		vertexes.push_back(v3);
+		vertexes.push_back(glm::vec3(pVertices[a].x, scale_y(pVertices[a].y, flag, flag_data), pVertices[a].z)); //v4
+		vertexes.push_back(v1);
+	}
 }
 
 static bool canInstancedMeshRendererUseInstancedRendering(bool quiet /*= false*/)
@@ -1010,6 +936,8 @@ public:
 
 	// Queues a mesh for drawing
 	bool Draw3DShape(const iIMDShape *shape, int frame, PIELIGHT teamcolour, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelMatrix, const glm::mat4 &viewMatrix, float stretchDepth);
+	// Queues many instances of a mesh with the same pieFlag (which must not need per-instance handling, see pie_Draw3DParticles)
+	bool Draw3DParticles(const iIMDShape *shape, PIELIGHT teamcolour, int pieFlag, const PIE_PARTICLE *particles, size_t count);
 
 	// Finalizes queued meshes, ready for one or more DrawAll calls
 	// (After this is called, Draw3DShape should not be called until the InstancedMeshRenderer is clear()-ed)
@@ -1067,6 +995,17 @@ private:
 	ShapeVector shapes;
 
 	std::vector<gfx_api::Draw3DShapePerInstanceInterleavedData> instancesData;
+
+	// A chunk of the instances of a mesh, whose instance data is generated by one job
+	struct InstanceRange
+	{
+		const ShapeVector* pInstances;
+		size_t begin;
+		size_t end;
+		size_t firstInstanceDataIdx;
+	};
+	static constexpr size_t instanceDataChunkSize = 256;
+	std::vector<InstanceRange> instanceRanges;
 	std::vector<gfx_api::buffer*> instanceDataBuffers;
 	size_t currInstanceBufferIdx = 0;
 
@@ -1147,32 +1086,18 @@ void InstancedMeshRenderer::reset()
 	instanceDataBuffers.clear();
 }
 
-bool InstancedMeshRenderer::Draw3DShape(const iIMDShape *shape, int frame, PIELIGHT teamcolour, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelMatrix, const glm::mat4 &viewMatrix, float stretchDepth)
+static inline bool shapeUsesLighting(int pieFlag)
 {
-	bool light = true;
-
-	if (pieFlag & pie_ADDITIVE)
+	if (pieFlag & (pie_ECM | pie_FORCELIGHT))
 	{
-		light = false;
-	}
-	else if (pieFlag & pie_TRANSLUCENT)
-	{
-		light = false;
-	}
-	else if (pieFlag & pie_PREMULTIPLIED)
-	{
-		light = false;
-	}
-
-	if (pieFlag & pie_ECM)
-	{
-		light = true;
+		return true;
 	}
+	return !(pieFlag & (pie_ADDITIVE | pie_TRANSLUCENT | pie_PREMULTIPLIED));
+}
 
-	if (pieFlag & pie_FORCELIGHT)
-	{
-		light = true;
-	}
+bool InstancedMeshRenderer::Draw3DShape(const iIMDShape *shape, int frame, PIELIGHT teamcolour, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelMatrix, const glm::mat4 &viewMatrix, float stretchDepth)
+{
+	const bool light = shapeUsesLighting(pieFlag);
 
 	frame %= std::max<int>(1, shape->numFrames);
 
@@ -1277,6 +1202,60 @@ bool InstancedMeshRenderer::Draw3DShape(const iIMDShape *shape, int frame, PIELI
 	return true;
 }
 
+bool InstancedMeshRenderer::Draw3DParticles(const iIMDShape *shape, PIELIGHT teamcolour, int pieFlag, const PIE_PARTICLE *particles, size_t count)
+{
+	if (!useInstancedRendering)
+	{
+		// The old renderer draws each mesh separately anyway (and particles never cast shadows, so the view matrix isn't used)
+		for (size_t i = 0; i < count; ++i)
+		{
+			Draw3DShape(shape, particles[i].frame, teamcolour, particles[i].colour, pieFlag, particles[i].pieFlagData, particles[i].modelMatrix, glm::mat4(1.f), 0.f);
+		}
+		return true;
+	}
+
+	// Look up the instances of the mesh once for the whole batch
+	const templatedState currentState = templatedState(shapeUsesLighting(pieFlag) ? SHADER_COMPONENT_INSTANCED : SHADER_NOLIGHT_INSTANCED, shape, pieFlag);
+	ShapeVector *pInstances = nullptr;
+	if (pieFlag & (pie_ADDITIVE | pie_PREMULTIPLIED))
+	{
+		pInstances = &instanceAdditiveMeshes[currentState];
+		additiveInstancesCount += count;
+	}
+	else if (pieFlag & pie_TRANSLUCENT)
+	{
+		pInstances = (pieFlag & pie_NODEPTHWRITE) ? &instanceTranslucentMeshesNoDepthWrite[currentState] : &instanceTranslucentMeshes[currentState];
+		translucentInstancesCount += count;
+	}
+	else
+	{
+		pInstances = &instanceMeshes.try_emplace(currentState, poolAllocator).first->second;
+		instancesCount += count;
+	}
+
+	if (pInstances->capacity() < pInstances->size() + count)
+	{
+		pInstances->reserve(std::max(pInstances->size() + count, 2 * pInstances->capacity()));
+	}
+	const int numFrames = std::max<int>(1, shape->numFrames);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const PIE_PARTICLE &particle = particles[i];
+		SHAPE tshape;
+		tshape.shape = shape;
+		tshape.frame = particle.frame % numFrames;
+		tshape.colour = particle.colour;
+		tshape.teamcolour = teamcolour;
+		tshape.flag = pieFlag;
+		tshape.flag_data = particle.pieFlagData;
+		tshape.stretch = 0.f;
+		tshape.modelMatrix = particle.modelMatrix;
+		pInstances->push_back(tshape);
+	}
+
+	return true;
+}
+
 static InstancedMeshRenderer instancedMeshRenderer;
 
 void pie_InitializeInstancedRenderer()
@@ -1326,21 +1305,111 @@ bool pie_Draw3DShape(const iIMDShape *shape, int frame, int team, PIELIGHT colou
 	return retVal;
 }
 
+bool pie_Draw3DParticles(const iIMDShape *shape, int pieFlag, const PIE_PARTICLE *particles, size_t count)
+{
+	ASSERT_OR_RETURN(false, !(pieFlag & (pie_SHADOW | pie_STATIC_SHADOW | pie_BUTTON | pie_SHIELD | pie_HEIGHT_SCALED | pie_RAISE)), "Particles can't be drawn with pieFlag 0x%x", pieFlag);
+	if (count == 0)
+	{
+		return true;
+	}
+
+	pieCount += count;
+
+	bool retVal = false;
+	const bool drawAllLevels = (shape->modelLevel == 0);
+	const PIELIGHT teamcolour = shape->getTeamColourForModel(0);
+
+	const iIMDShape *pCurrShape = shape;
+	do
+	{
+		retVal = instancedMeshRenderer.Draw3DParticles(pCurrShape, teamcolour, pieFlag, particles, count);
+		pCurrShape = pCurrShape->next.get();
+	} while (drawAllLevels && pCurrShape && retVal);
+
+	return retVal;
+}
+
+/// A shadow volume that isn't in the shadow cache yet
+struct ShadowVolumeJob
+{
+	const ShadowcastingShape *pShape;
+	ShadowCache::CachedShadowData *pCache;
+	std::vector<EDGE> edges;  // only if the edges of a static shadow must be stored in the shape
+};
+
 static void pie_ShadowDrawLoop(ShadowCache &shadowCache, const glm::mat4& projectionMatrix)
 {
-//	size_t cachedShadowDraws = 0;
-//	size_t uncachedShadowDraws = 0;
-	for (unsigned i = 0; i < scshapes.size(); i++)
+	static std::vector<ShadowVolumeJob> jobs;  // Static, to save allocations.
+	static std::vector<const ShadowCache::CachedShadowData *> shapeShadows;  // Static, to save allocations.
+
+	// Find cached data (if available), and add a (still empty) cache entry for every shadow that must be built,
+	// so shapes with the same parameters only build it once.
+	// Note: The modelViewMatrix is not used for calculating the sorted / filtered vertices, so it's not included
+	jobs.clear();
+	shapeShadows.resize(scshapes.size());
+	for (size_t i = 0; i < scshapes.size(); i++)
 	{
-		/*DrawShadowResult result =*/ pie_DrawShadow(shadowCache, const_cast<iIMDShape*>(scshapes[i].shape), scshapes[i].flag, scshapes[i].flag_data, scshapes[i].light, scshapes[i].modelViewMatrix);
-//		if (result == DRAW_SUCCESS_CACHED)
-//		{
-//			++cachedShadowDraws;
-//		}
-//		else
-//		{
-//			++uncachedShadowDraws;
-//		}
+		const ShadowcastingShape &scshape = scshapes[i];
+		const ShadowCache::CachedShadowData *pCached = shadowCache.findCacheForShadowDraw(scshape.shape, scshape.flag, scshape.flag_data, scshape.light);
+		if (pCached == nullptr)
+		{
+			ShadowCache::CachedShadowData &cache = shadowCache.createCacheForShadowDraw(const_cast<iIMDShape*>(scshape.shape), scshape.flag, scshape.flag_data, scshape.light);
+			jobs.push_back({&scshape, &cache, {}});
+			pCached = &cache;
+		}
+		shapeShadows[i] = pCached;
+	}
+
+	// Build the missing shadow volumes. Every job only writes to its own cache entry (the cache itself is only used on this thread).
+	auto buildShadowVolume = [](size_t jobIdx) {
+		ShadowVolumeJob &job = jobs[jobIdx];
+		const ShadowcastingShape &scshape = *job.pShape;
+		const iIMDShape *shape = scshape.shape;
+		if (scshape.flag & pie_STATIC_SHADOW && shape->shadowEdgeList)
+		{
+			pie_ShadowVolume(shape, scshape.flag, scshape.flag_data, scshape.light, shape->shadowEdgeList, shape->nShadowEdges, job.pCache->vertexes);
+			return;
+		}
+		std::vector<uint8_t> facingLight;
+		std::vector<EDGE> edges;
+		pie_ShadowSilhouetteEdges(shape, scshape.flag, scshape.flag_data, scshape.light, facingLight, edges);
+		pie_ShadowVolume(shape, scshape.flag, scshape.flag_data, scshape.light, edges.data(), edges.size(), job.pCache->vertexes);
+		if (scshape.flag & pie_STATIC_SHADOW)
+		{
+			job.edges = std::move(edges);
+		}
+	};
+	if (parallelFramePreparation)
+	{
+		wzParallelFor(jobs.size(), buildShadowVolume);
+	}
+	else
+	{
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			buildShadowVolume(i);
+		}
+	}
+
+	for (ShadowVolumeJob &job : jobs)
+	{
+		iIMDShape *shape = const_cast<iIMDShape*>(job.pShape->shape);
+		if ((job.pShape->flag & pie_STATIC_SHADOW) && !shape->shadowEdgeList)
+		{
+			// then store it in the imd
+			shape->nShadowEdges = job.edges.size();
+			if (!job.edges.empty())
+			{
+				shape->shadowEdgeList = (EDGE *)realloc(shape->shadowEdgeList, sizeof(EDGE) * shape->nShadowEdges);
+				std::copy(job.edges.begin(), job.edges.end(), shape->shadowEdgeList);
+			}
+		}
+	}
+
+	// Aggregate the vertexes (pre-computed with the modelViewMatrix)
+	for (size_t i = 0; i < scshapes.size(); i++)
+	{
+		shadowCache.addPremultipliedVertexes(*shapeShadows[i], scshapes[i].modelViewMatrix);
 	}
 
 	const auto &premultipliedVertexes = shadowCache.getPremultipliedVertexes();
@@ -1407,6 +1476,16 @@ void pie_UpdateLightmap(gfx_api::texture* lightmapTexture, const glm::mat4& mode
 	instancedMeshRenderer.setLightmap(lightmapTexture, modelUVLightmapMatrix);
 }
 
+void pie_SetParallelFramePreparation(bool enabled)
+{
+	parallelFramePreparation = enabled;
+}
+
+bool pie_GetParallelFramePreparation()
+{
+	return parallelFramePreparation;
+}
+
 void pie_FinalizeMeshes(uint64_t currentGameFrame)
 {
 	instancedMeshRenderer.FinalizeInstances();
@@ -1451,56 +1530,49 @@ bool InstancedMeshRenderer::FinalizeInstances()
 		return true;
 	}
 
-	instancesData.reserve(instancesCount + translucentInstancesCount + additiveInstancesCount);
-
-	for (const auto& mesh : instanceMeshes)
-	{
-		const auto& meshInstances = mesh.second;
-		size_t startingIdxInInstancesBuffer = instancesData.size();
-		for (const auto& instance : meshInstances)
+	// Lay out the instances of all meshes first (split into chunks), so the instance data can be generated in parallel
+	instanceRanges.clear();
+	size_t totalInstances = 0;
+	auto addMeshes = [&](const auto& meshes) {
+		for (const auto& mesh : meshes)
 		{
-			instancesData.push_back(GenerateInstanceData(instance.frame, instance.colour, instance.teamcolour, instance.flag, instance.flag_data, instance.modelMatrix, instance.stretch));
+			const auto& meshInstances = mesh.second;
+			finalizedDrawCalls.emplace_back(mesh.first, meshInstances.size(), totalInstances);
+			for (size_t begin = 0; begin < meshInstances.size(); begin += instanceDataChunkSize)
+			{
+				instanceRanges.push_back(InstanceRange{&meshInstances, begin, std::min(begin + instanceDataChunkSize, meshInstances.size()), totalInstances + begin});
+			}
+			totalInstances += meshInstances.size();
 		}
-		finalizedDrawCalls.emplace_back(mesh.first, meshInstances.size(), startingIdxInInstancesBuffer);
-	}
-
+	};
+	addMeshes(instanceMeshes);
 	startIdxTranslucentDrawCalls = finalizedDrawCalls.size();
-
-	for (const auto& mesh : instanceTranslucentMeshes)
-	{
-		const auto& meshInstances = mesh.second;
-		size_t startingIdxInInstancesBuffer = instancesData.size();
-		for (const auto& instance : meshInstances)
-		{
-			instancesData.push_back(GenerateInstanceData(instance.frame, instance.colour, instance.teamcolour, instance.flag, instance.flag_data, instance.modelMatrix, instance.stretch));
-		}
-		finalizedDrawCalls.emplace_back(mesh.first, meshInstances.size(), startingIdxInInstancesBuffer);
-	}
-
+	addMeshes(instanceTranslucentMeshes);
 	startIdxTranslucentNoDepthWriteDrawCalls = finalizedDrawCalls.size();
+	addMeshes(instanceTranslucentMeshesNoDepthWrite);
+	startIdxAdditiveDrawCalls = finalizedDrawCalls.size();
+	addMeshes(instanceAdditiveMeshes);
 
-	for (const auto& mesh : instanceTranslucentMeshesNoDepthWrite)
-	{
-		const auto& meshInstances = mesh.second;
-		size_t startingIdxInInstancesBuffer = instancesData.size();
-		for (const auto& instance : meshInstances)
+	instancesData.resize(totalInstances);
+	auto generateRange = [this](size_t rangeIdx) {
+		const InstanceRange& range = instanceRanges[rangeIdx];
+		auto pOutput = instancesData.data() + range.firstInstanceDataIdx;
+		for (size_t i = range.begin; i < range.end; ++i)
 		{
-			instancesData.push_back(GenerateInstanceData(instance.frame, instance.colour, instance.teamcolour, instance.flag, instance.flag_data, instance.modelMatrix, instance.stretch));
+			const SHAPE& instance = (*range.pInstances)[i];
+			*pOutput++ = GenerateInstanceData(instance.frame, instance.colour, instance.teamcolour, instance.flag, instance.flag_data, instance.modelMatrix, instance.stretch);
 		}
-		finalizedDrawCalls.emplace_back(mesh.first, meshInstances.size(), startingIdxInInstancesBuffer);
+	};
+	if (parallelFramePreparation)
+	{
+		wzParallelFor(instanceRanges.size(), generateRange);
 	}
-
-	startIdxAdditiveDrawCalls = finalizedDrawCalls.size();
-
-	for (const auto& mesh : instanceAdditiveMeshes)
+	else
 	{
-		const auto& meshInstances = mesh.second;
-		size_t startingIdxInInstancesBuffer = instancesData.size();
-		for (const auto& instance : meshInstances)
+		for (size_t i = 0; i < instanceRanges.size(); ++i)
 		{
-			instancesData.push_back(GenerateInstanceData(instance.frame, instance.colour, instance.teamcolour, instance.flag, instance.flag_data, instance.modelMatrix, instance.stretch));
+			generateRange(i);
 		}
-		finalizedDrawCalls.emplace_back(mesh.first, meshInstances.size(), startingIdxInInstancesBuffer);
 	}
 
 	// Upload buffer
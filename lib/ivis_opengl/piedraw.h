@@ -33,4 +33,9 @@ namespace gfx_api
 void pie_StartMeshes();
 void pie_UpdateLightmap(gfx_api::texture* lightmapTexture, const glm::mat4& modelUVLightmapMatrix);
 void pie_FinalizeMeshes(uint64_t currentGameFrame);
+
+/// Whether the per-frame work that doesn't touch the graphics backend (object culling, instance data generation)
+/// is spread over worker threads
+void pie_SetParallelFramePreparation(bool enabled);
+bool pie_GetParallelFramePreparation();
 void pie_DrawAllMeshes(uint64_t currentGameFrame, const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix, const ShadowCascadesInfo& shadowMVPMatrix, bool depthPass);
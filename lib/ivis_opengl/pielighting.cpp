@@ -23,7 +23,6 @@
 #include <array>
 #include <glm/glm.hpp>
 #include <algorithm>
-#include <functional>
 #include <unordered_map>
 #include "culling.h"
 #include "src/profiling.h"
@@ -143,26 +142,14 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 	const bool yAxisInverted = gfx_api::context::get().isYAxisInverted();
 
 	// Pick the first lights inside the view frustum
-	auto viewFrustum = IntersectionOfHalfSpace{
-		[](const glm::vec3& in) { return in.x >= -1.f; },
-		[](const glm::vec3& in) { return in.x <= 1.f; },
-		[yAxisInverted](const glm::vec3& in) {
-			if (yAxisInverted)
-			{
-				return -in.y >= -1.f;
-			}
-			return in.y >= -1.f;
-		},
-		[yAxisInverted](const glm::vec3& in) {
-			if (yAxisInverted)
-			{
-				return -in.y <= 1.f;
-			}
-			return in.y <= 1.f;
-		},
-		[](const glm::vec3& in) { return in.z >= 0; },
-		[](const glm::vec3& in) { return in.z <= 1; }
-	};
+	const auto viewFrustum = ViewFrustum::fromBox(-1.f, 1.f, -1.f, 1.f, 0.f, 1.f, yAxisInverted);
+	lightClipSpaceBounds.clear();
+	lightClipSpaceBounds.reserve(data.lights.size());
+	for (const auto& light : data.lights)
+	{
+		lightClipSpaceBounds.push_back(transformBoundingBox(worldViewProjectionMatrix, getLightBoundingBox(light)));
+	}
+	cullBoxes(viewFrustum, lightClipSpaceBounds, lightVisible);
 
 	std::unordered_map<std::pair<int32_t, int32_t>, std::vector<size_t>, TileCoordsHasher> tileRangeLights; // map tile coordinates to vector of culledLight indexes
 	constexpr size_t maxRangedLightsPerTile = 16;
@@ -173,17 +160,17 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 	size_t tinyLightsSkipped = 0;
 
 	culledLights.clear();
-	for (const auto& light : data.lights)
+	for (size_t lightIdx = 0; lightIdx < data.lights.size(); ++lightIdx)
 	{
 		if (culledLights.size() >= gfx_api::max_lights)
 		{
 			break;
 		}
-		auto clipSpaceBoundingBox = transformBoundingBox(worldViewProjectionMatrix, getLightBoundingBox(light));
-		if (!isBBoxInClipSpace(viewFrustum, clipSpaceBoundingBox))
+		if (!lightVisible[lightIdx])
 		{
 			continue;
 		}
+		const auto& light = data.lights[lightIdx];
 
 		if (light.range >= minLightRange)
 		{
@@ -216,7 +203,7 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 							calcLight.colour.z += (existingLight.light.colour.z) * weight;
 
 							existingLight.light = calcLight;
-							existingLight.clipSpaceBoundingBox = clipSpaceBoundingBox;
+							existingLight.clipSpaceBoundsIdx = lightIdx;
 						}
 						else
 						{
@@ -258,7 +245,17 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 		calcLight.colour = glm::vec3(light.colour.byte.r / 255.f, light.colour.byte.g / 255.f, light.colour.byte.b / 255.f);
 		calcLight.range = light.range;
 
-		culledLights.push_back({std::move(calcLight), std::move(clipSpaceBoundingBox)});
+		culledLights.push_back({std::move(calcLight), lightIdx});
+	}
+
+	culledLightClipSpaceBounds.clear();
+	culledLightClipSpaceBounds.reserve(culledLights.size());
+	for (const auto& culledLight : culledLights)
+	{
+		const size_t idx = culledLight.clipSpaceBoundsIdx;
+		culledLightClipSpaceBounds.push_back(
+			glm::vec3(lightClipSpaceBounds.minX[idx], lightClipSpaceBounds.minY[idx], lightClipSpaceBounds.minZ[idx]),
+			glm::vec3(lightClipSpaceBounds.maxX[idx], lightClipSpaceBounds.maxY[idx], lightClipSpaceBounds.maxZ[idx]));
 	}
 
 	if (lightsSkipped > 0 || lightsCombined > 0 || tinyLightsSkipped > 0)
@@ -304,22 +301,8 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 				auto bucketFrustumY0 = -1.f + 2 * static_cast<float>(j) / bucketDimension;
 				auto bucketFrustumY1 = -1.f + 2 * static_cast<float>(j + 1) / bucketDimension;
 
-				auto frustum = IntersectionOfHalfSpace{
-					[bucketFrustumX0](const glm::vec3& in) { return in.x >= bucketFrustumX0; },
-					[bucketFrustumX1](const glm::vec3& in) { return in.x <= bucketFrustumX1; },
-					[bucketFrustumY0, yAxisInverted](const glm::vec3& in) {
-						if (yAxisInverted)
-							return -in.y >= bucketFrustumY0;
-						return in.y >= bucketFrustumY0;
-					},
-					[bucketFrustumY1, yAxisInverted](const glm::vec3& in) {
-						if (yAxisInverted)
-							return -in.y <= bucketFrustumY1;
-						return in.y <= bucketFrustumY1;
-					},
-					[](const glm::vec3& in) { return in.z >= 0; },
-					[](const glm::vec3& in) { return in.z <= 1; }
-				};
+				const auto frustum = ViewFrustum::fromBox(bucketFrustumX0, bucketFrustumX1, bucketFrustumY0, bucketFrustumY1, 0.f, 1.f, yAxisInverted);
+				cullBoxes(frustum, culledLightClipSpaceBounds, lightVisible);
 
 				size_t bucketSize = 0;
 				for (size_t lightIndex = 0; lightIndex < culledLights.size(); lightIndex++)
@@ -330,9 +313,7 @@ void renderingNew::LightingManager::ComputeFrameData(const LightingData& data, L
 						reduceNumberOfBucketsNeeded = true;
 						break;
 					}
-					const BoundingBox& clipSpaceBoundingBox = culledLights[lightIndex].clipSpaceBoundingBox;
-
-					if (isBBoxInClipSpace(frustum, clipSpaceBoundingBox))
+					if (lightVisible[lightIndex])
 					{
 						lightList[overallId + bucketSize] = lightIndex;
 
@@ -111,9 +111,12 @@ namespace renderingNew
 		struct CulledLightInfo
 		{
 			CalculatedPointLight light;
-			BoundingBox clipSpaceBoundingBox;
+			size_t clipSpaceBoundsIdx; // index in lightClipSpaceBounds
 		};
 		std::vector<CulledLightInfo> culledLights;
+		BoundingBoxArray lightClipSpaceBounds;
+		BoundingBoxArray culledLightClipSpaceBounds;
+		std::vector<uint8_t> lightVisible;
 	};
 }
 
@@ -0,0 +1,66 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#include "pieparticles.h"
+
+void ParticleBatcher::add(const iIMDShape *shape, int pieFlag, const PIE_PARTICLE &particle)
+{
+	if (lastBatch >= usedBatches || batches[lastBatch].shape != shape || batches[lastBatch].pieFlag != pieFlag)
+	{
+		// There are only a few different particle meshes in use at once, so a linear search is fine
+		lastBatch = 0;
+		while (lastBatch < usedBatches && (batches[lastBatch].shape != shape || batches[lastBatch].pieFlag != pieFlag))
+		{
+			++lastBatch;
+		}
+		if (lastBatch == usedBatches)
+		{
+			if (usedBatches == batches.size())
+			{
+				batches.emplace_back();
+			}
+			batches[usedBatches].shape = shape;
+			batches[usedBatches].pieFlag = pieFlag;
+			++usedBatches;
+		}
+	}
+	batches[lastBatch].particles.push_back(particle);
+	++particles;
+}
+
+void ParticleBatcher::flush()
+{
+	for (size_t i = 0; i < usedBatches; ++i)
+	{
+		const Batch &batch = batches[i];
+		pie_Draw3DParticles(batch.shape, batch.pieFlag, batch.particles.data(), batch.particles.size());
+	}
+	clear();
+}
+
+void ParticleBatcher::clear()
+{
+	for (size_t i = 0; i < usedBatches; ++i)
+	{
+		batches[i].particles.clear();
+	}
+	usedBatches = 0;
+	lastBatch = 0;
+	particles = 0;
+}
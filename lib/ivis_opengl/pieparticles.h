@@ -0,0 +1,68 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+
+#pragma once
+
+#include <glm/mat4x4.hpp>
+#include "pietypes.h"
+
+#include <vector>
+
+struct iIMDShape;
+
+/// One instance of a particle mesh (an effect or weather billboard)
+struct PIE_PARTICLE
+{
+	glm::mat4 modelMatrix;
+	PIELIGHT colour;
+	int frame;
+	int pieFlagData;
+};
+
+/// Queues `count` instances of a mesh that all use the same pieFlag, with a single lookup of the instanced draw they belong to.
+/// Particles have no team colour, and pieFlag must not need per-instance handling (shadows, buttons, shields, raising or height scaling).
+bool pie_Draw3DParticles(const iIMDShape *shape, int pieFlag, const PIE_PARTICLE *particles, size_t count);
+
+/// Collects particles into one batch per mesh and pieFlag (in the order they are first used), so each batch is queued
+/// with one pie_Draw3DParticles call instead of one pie_Draw3DShape call per particle.
+/// Adding particles doesn't touch the graphics backend, only flush() does.
+class ParticleBatcher
+{
+public:
+	void add(const iIMDShape *shape, int pieFlag, const PIE_PARTICLE &particle);
+	/// Queues all batches for drawing, and clears them
+	void flush();
+	void clear();
+
+	size_t batchCount() const { return usedBatches; }
+	size_t particleCount() const { return particles; }
+
+private:
+	struct Batch
+	{
+		const iIMDShape *shape = nullptr;
+		int pieFlag = 0;
+		std::vector<PIE_PARTICLE> particles;
+	};
+
+	std::vector<Batch> batches;  ///< The first usedBatches are in use, the rest are kept to reuse their memory
+	size_t usedBatches = 0;
+	size_t lastBatch = 0;  ///< Consecutive particles usually share a batch
+	size_t particles = 0;
+};
@@ -20,6 +20,8 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/frameresource.h"
+#include "lib/framework/parallel_for.h"
+#include "lib/framework/physfs_ext.h"
 
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/piestate.h"
@@ -31,6 +33,7 @@
 
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #if defined(__clang__)
 #  pragma clang diagnostic push
@@ -226,6 +229,75 @@ optional<size_t> iV_GetTexture(const char *filename, gfx_api::texture_type textu
 	return optional<size_t>(page);
 }
 
+void iV_PreloadTextures(const std::vector<std::pair<std::string, gfx_api::texture_type>>& textures, int maxWidth /*= -1*/, int maxHeight /*= -1*/)
+{
+	struct PreloadJob
+	{
+		std::string filename;
+		gfx_api::texture_type textureType;
+		std::string loadPath;
+		std::unique_ptr<gfx_api::prepared_texture> prepared;
+	};
+	std::vector<PreloadJob> jobs;
+	std::unordered_set<std::string> queued;
+	for (const auto& texture : textures)
+	{
+		if (_NAME_TO_TEX_PAGE_MAP.count(texture.first) == 0 && queued.insert(texture.first).second)
+		{
+			jobs.push_back(PreloadJob{texture.first, texture.second, std::string(), nullptr});
+		}
+	}
+
+	// Does the same as loadTextureHandleGraphicsOverrides(), except for creating the texture.
+	// Anything that can't be prepared this way (such as .ktx2 files) is left to iV_GetTexture().
+	auto prepareJob = [maxWidth, maxHeight](PreloadJob& job) {
+		std::string overridePath = WZ_CURRENT_GRAPHICS_OVERRIDES_PREFIX "/texpages/" + job.filename;
+		job.prepared = gfx_api::prepareTextureFromFile(overridePath.c_str(), job.textureType, maxWidth, maxHeight, true);
+		if (job.prepared)
+		{
+			job.loadPath = overridePath;
+			return;
+		}
+		if (PHYSFS_exists(gfx_api::imageLoadFilenameFromInputFilename(WzString::fromUtf8(overridePath)).toUtf8().c_str()))
+		{
+			return;
+		}
+		job.loadPath = "texpages/" + job.filename;
+		job.prepared = gfx_api::prepareTextureFromFile(job.loadPath.c_str(), job.textureType, maxWidth, maxHeight, true);
+	};
+
+	// Decode a batch at a time, so only a few decoded images are held at once
+	const size_t batchSize = wzParallelForThreadCount();
+	size_t loaded = 0;
+	for (size_t batchStart = 0; batchStart < jobs.size(); batchStart += batchSize)
+	{
+		size_t batchEnd = std::min(batchStart + batchSize, jobs.size());
+		wzParallelFor(batchEnd - batchStart, [&](size_t i) {
+			prepareJob(jobs[batchStart + i]);
+		});
+		for (size_t i = batchStart; i < batchEnd; ++i)
+		{
+			PreloadJob& job = jobs[i];
+			if (!job.prepared)
+			{
+				iV_GetTexture(job.filename.c_str(), job.textureType, maxWidth, maxHeight);
+				continue;
+			}
+			gfx_api::texture *pTexture = gfx_api::context::get().createTextureFromPreparedImage(*job.prepared, job.loadPath);
+			job.prepared.reset();
+			if (!pTexture)
+			{
+				debug(LOG_ERROR, "Failed to load %s", job.filename.c_str());
+				continue;
+			}
+			pie_AddTexPage(pTexture, job.filename.c_str(), job.textureType);
+			++loaded;
+		}
+		resDoResLoadCallback(); // ensure loading screen doesn't freeze when loading large images
+	}
+	debug(LOG_TEXTURE, "Preloaded %zu of %zu textures", loaded, jobs.size());
+}
+
 bool replaceTexture(const WzString &oldfile, const WzString &newfile)
 {
 	// Load new one to replace it
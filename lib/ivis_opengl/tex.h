@@ -26,6 +26,8 @@
 
 #include <functional>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include <nonstd/optional.hpp>
 using nonstd::optional;
 using nonstd::nullopt;
@@ -45,6 +47,9 @@ void pie_AssignTexture(size_t page, gfx_api::texture* texture);
 //*************************************************************************
 
 optional<size_t> iV_GetTexture(const char *filename, gfx_api::texture_type textureType, int maxWidth = -1, int maxHeight = -1);
+/// Load all of the given textures that aren't loaded yet, so iV_GetTexture() finds them.
+/// The files are decoded and compressed on worker threads, and the textures are created afterwards on the calling thread.
+void iV_PreloadTextures(const std::vector<std::pair<std::string, gfx_api::texture_type>>& textures, int maxWidth = -1, int maxHeight = -1);
 void iV_unloadImage(iV_Image *image);
 gfx_api::pixel_format iV_getPixelFormat(const iV_Image *image);
 
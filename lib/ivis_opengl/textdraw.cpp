@@ -375,10 +375,43 @@ namespace std {
 
 }
 
+struct FTGlyphMetricsCacheKey
+{
+	FTFace* face;
+	uint32_t codepoint;
+	Vector2i subpixeloffset64;
+
+	FTGlyphMetricsCacheKey(FTFace& face, uint32_t codepoint, Vector2i subpixeloffset64)
+	: face(&face), codepoint(codepoint), subpixeloffset64(subpixeloffset64)
+	{ }
+
+	bool operator==(const FTGlyphMetricsCacheKey& other) const
+	{
+		return face == other.face && codepoint == other.codepoint && subpixeloffset64 == other.subpixeloffset64;
+	}
+};
+
+namespace std {
+
+	template <>
+	struct hash<FTGlyphMetricsCacheKey>
+	{
+		std::size_t operator()(const FTGlyphMetricsCacheKey& k) const
+		{
+			// the sub-pixel offsets are in [-63, 63]
+			return std::hash<FTFace*>()(k.face)
+				 ^ (std::hash<int>()(k.codepoint) << 1)
+				 ^ (std::hash<int>()((k.subpixeloffset64.x + 64) | ((k.subpixeloffset64.y + 64) << 7)) << 2);
+		}
+	};
+
+}
+
 struct FTCache
 {
 	FTCache()
 	: m_glyphCache(256, 16)
+	, m_glyphMetricsCache(1024, 128)
 	{ }
 
 	RasterizedGlyph get(FTFace& face, uint32_t codePoint, Vector2i subpixeloffset64)
@@ -419,6 +452,13 @@ struct FTCache
 
 	GlyphMetrics getGlyphMetrics(FTFace& face, uint32_t codePoint, Vector2i subpixeloffset64)
 	{
+		// Text is measured far more often than it's drawn, and getting the metrics means rendering the glyph
+		const FTGlyphMetricsCacheKey metricsKey(face, codePoint, subpixeloffset64);
+		if (const GlyphMetrics *pCachedMetrics = m_glyphMetricsCache.tryGetPt(metricsKey))
+		{
+			return *pCachedMetrics;
+		}
+
 		FT_Glyph glyph = getGlyph(face, codePoint);
 		ASSERT_OR_RETURN({}, glyph != nullptr, "Failed to get glyph: %" PRIu32, codePoint);
 
@@ -442,6 +482,7 @@ struct FTCache
 
 		FT_Done_Glyph(glyph);
 
+		m_glyphMetricsCache.insert(metricsKey, result);
 		return result;
 	}
 
@@ -449,6 +490,7 @@ public:
 	void clear()
 	{
 		m_glyphCache.clear();
+		m_glyphMetricsCache.clear();
 	}
 
 private:
@@ -509,6 +551,7 @@ private:
 	};
 
 	lru11::Cache<FTGlyphCacheKey, WZOwnedFTGlyph> m_glyphCache;
+	lru11::Cache<FTGlyphMetricsCacheKey, GlyphMetrics> m_glyphMetricsCache;
 };
 
 static FTCache* glyphCache = nullptr;
@@ -620,6 +663,40 @@ struct DrawTextResult
 	TextLayoutMetrics layoutMetrics;
 };
 
+struct ShapedTextCacheKey
+{
+	iV_fonts fontID;
+	int baseDirection;
+	std::vector<uint32_t> codePoints;
+
+	bool operator==(const ShapedTextCacheKey& other) const
+	{
+		return fontID == other.fontID && baseDirection == other.baseDirection && codePoints == other.codePoints;
+	}
+};
+
+namespace std {
+
+	template <>
+	struct hash<ShapedTextCacheKey>
+	{
+		std::size_t operator()(const ShapedTextCacheKey& k) const
+		{
+			// FNV-1a
+			uint64_t h = 14695981039346656037ULL;
+			auto add = [&h](uint32_t value) { h = (h ^ value) * 1099511628211ULL; };
+			add(static_cast<uint32_t>(k.fontID));
+			add(static_cast<uint32_t>(k.baseDirection));
+			for (uint32_t codePoint : k.codePoints)
+			{
+				add(codePoint);
+			}
+			return static_cast<std::size_t>(h);
+		}
+	};
+
+}
+
 // Note:
 // Technically glyph antialiasing is dependent of text rotation.
 // Rotated text needs to set transform inside freetype2.
@@ -645,6 +722,7 @@ struct TextShaper
 	};
 
 	TextShaper()
+	: m_shapedTextCache(512, 64)
 	{ }
 
 	~TextShaper()
@@ -653,8 +731,8 @@ struct TextShaper
 	// Returns the maximum text run length (in WzString characters) that fits within a max width (supplied *IN PIXELS*)
 	uint32_t getTextMaxLenForWidth(const WzString& text, iV_fonts fontID, uint32_t maxWidthInPixels, bool rightToLeft)
 	{
-		std::vector<uint32_t> codePoints = text.toUtf32();
-		auto shapingResult = shapeText(codePoints, fontID);
+		const auto pShapingResult = shapeText(text, fontID);
+		const ShapingResult& shapingResult = *pShapingResult;
 
 		if (shapingResult.glyphes.empty())
 		{
@@ -722,7 +800,8 @@ struct TextShaper
 	// Returns the text width and height *IN PIXELS*
 	TextLayoutMetrics getTextMetrics(const WzString& text, iV_fonts fontID)
 	{
-		const ShapingResult& shapingResult = shapeText(text, fontID);
+		const auto pShapingResult = shapeText(text, fontID);
+		const ShapingResult& shapingResult = *pShapingResult;
 
 		if (shapingResult.glyphes.empty())
 		{
@@ -775,7 +854,8 @@ struct TextShaper
 	// Draws the text and returns the text buffer, width and height, etc *IN PIXELS*
 	DrawTextResult drawText(const WzString& text, iV_fonts fontID)
 	{
-		ShapingResult shapingResult = shapeText(text, fontID);
+		const auto pShapingResult = shapeText(text, fontID);
+		const ShapingResult& shapingResult = *pShapingResult;
 
 		if (shapingResult.glyphes.empty())
 		{
@@ -1080,13 +1160,34 @@ struct TextShaper
 		return shapingResult;
 	}
 
-	ShapingResult shapeText(const WzString& text, iV_fonts fontID)
+	// Returns the shaped text, which is cached because the same strings are usually measured and drawn over and over
+	std::shared_ptr<const ShapingResult> shapeText(const WzString& text, iV_fonts fontID)
 	{
 		/* Fribidi assumes that the text is encoded in UTF-32, so we have to
 		 convert from UTF-8 to UTF-32, assuming that the string is indeed in UTF-8.*/
-		std::vector<uint32_t> codePoints = text.toUtf32();
+		ShapedTextCacheKey key;
+		key.fontID = fontID;
+#if defined(WZ_FRIBIDI_ENABLED)
+		key.baseDirection = static_cast<int>(getBaseDirection());
+#else
+		key.baseDirection = 0;
+#endif
+		key.codePoints = text.toUtf32();
+
+		if (const auto *pCachedResult = m_shapedTextCache.tryGetPt(key))
+		{
+			return *pCachedResult;
+		}
+
+		auto result = std::make_shared<const ShapingResult>(shapeText(key.codePoints, fontID));
+		m_shapedTextCache.insert(key, result);
+		return result;
+	}
 
-		return shapeText(codePoints, fontID);
+	// Must be called whenever the fonts are unloaded (the cached results refer to them)
+	void clearCache()
+	{
+		m_shapedTextCache.clear();
 	}
 
 	inline void shapeHarfbuzz(TextRun& run, FTFace& face)
@@ -1106,6 +1207,9 @@ struct TextShaper
 		run.glyphInfos = hb_buffer_get_glyph_infos(run.buffer, &run.glyphCount);
 		run.glyphPositions = hb_buffer_get_glyph_positions(run.buffer, &run.glyphCount);
 	}
+
+private:
+	lru11::Cache<ShapedTextCacheKey, std::shared_ptr<const ShapingResult>> m_shapedTextCache;
 };
 
 /***************************************************************************/
@@ -1256,7 +1360,44 @@ static FTFace &getFTFace(iV_fonts FontID, hb_script_t script)
 	}
 }
 
-static gfx_api::texture* textureID = nullptr;
+struct RenderedTextCacheKey
+{
+	iV_fonts fontID;
+	std::string text;
+
+	bool operator==(const RenderedTextCacheKey& other) const
+	{
+		return fontID == other.fontID && text == other.text;
+	}
+};
+
+namespace std {
+
+	template <>
+	struct hash<RenderedTextCacheKey>
+	{
+		std::size_t operator()(const RenderedTextCacheKey& k) const
+		{
+			return std::hash<std::string>()(k.text) ^ (std::hash<int>()(k.fontID) << 1);
+		}
+	};
+
+}
+
+/// A string drawn by iV_DrawTextRotated (the texture is null if there is nothing to draw)
+struct RenderedTextTexture
+{
+	std::unique_ptr<gfx_api::texture> texture;
+	Vector2i offset = Vector2i(0, 0);
+	Vector2i size = Vector2i(0, 0);
+};
+
+// The strings drawn by iV_DrawTextRotated, so drawing the same string again doesn't shape, render and upload it again.
+// NOTE: The shared glyph atlas is not implemented: each cached string (like each WzText) still has a texture of its own.
+// Drawing from an atlas needs a per-glyph draw path, and (because glyphs are rendered with LCD subpixel filtering at their
+// subpixel pen offset, and overlapping glyphs are added together) one that renders the same as the string bitmaps.
+// tests/textlayoutbench.cpp counts the textures created.
+static lru11::Cache<RenderedTextCacheKey, RenderedTextTexture> renderedTextCache(64, 16);
 
 void iV_TextInit(unsigned int horizScalePercentage, unsigned int vertScalePercentage)
 {
@@ -1341,8 +1482,8 @@ void iV_TextShutdown()
 	baseFonts = nullptr;
 	delete cjkFonts;
 	cjkFonts = nullptr;
-	delete textureID;
-	textureID = nullptr;
+	renderedTextCache.clear();
+	getShaper().clearCache();
 	fontToEllipsisMap.clear();
 	clearFontDataCache();
 	bLoadedTextSystem = false;
@@ -1711,15 +1852,27 @@ void iV_DrawTextRotated(const char* string, float XPos, float YPos, float rotati
 	color.byte.b = static_cast<UBYTE>(font_colour[2] * 255.f);
 	color.byte.a = static_cast<UBYTE>(font_colour[3] * 255.f);
 
-	DrawTextResult drawResult = getShaper().drawText(string, fontID);
+	RenderedTextCacheKey key{fontID, string};
+	RenderedTextTexture *pRendered = renderedTextCache.tryGetPt(key);
+	if (pRendered == nullptr)
+	{
+		DrawTextResult drawResult = getShaper().drawText(string, fontID);
+
+		RenderedTextTexture rendered;
+		if (drawResult.text.bitmap && drawResult.text.bitmap->width() > 0 && drawResult.text.bitmap->height() > 0)
+		{
+			rendered.texture.reset(gfx_api::context::get().createTextureForCompatibleImageUploads(1, *(drawResult.text.bitmap.get()), std::string("text::") + string));
+			rendered.texture->upload(0u, *(drawResult.text.bitmap.get()));
+			rendered.offset = Vector2i(drawResult.text.offset_x, drawResult.text.offset_y);
+			rendered.size = Vector2i(drawResult.text.bitmap->width(), drawResult.text.bitmap->height());
+		}
+		renderedTextCache.insert(key, std::move(rendered));
+		pRendered = renderedTextCache.tryGetPt(key);
+	}
 
-	if (drawResult.text.bitmap && drawResult.text.bitmap->width() > 0 && drawResult.text.bitmap->height() > 0)
+	if (pRendered && pRendered->texture)
 	{
-		if (textureID)
-			delete textureID;
-		textureID = gfx_api::context::get().createTextureForCompatibleImageUploads(1, *(drawResult.text.bitmap.get()), std::string("text::") + string);
-		textureID->upload(0u, *(drawResult.text.bitmap.get()));
-		iV_DrawImageText(*textureID, Vector2f(XPos, YPos), Vector2f((float)drawResult.text.offset_x / _horizScaleFactor, (float)drawResult.text.offset_y / _vertScaleFactor), Vector2f((float)drawResult.text.bitmap->width() / _horizScaleFactor, (float)drawResult.text.bitmap->height() / _vertScaleFactor), rotation, color);
+		iV_DrawImageText(*pRendered->texture, Vector2f(XPos, YPos), Vector2f((float)pRendered->offset.x / _horizScaleFactor, (float)pRendered->offset.y / _vertScaleFactor), Vector2f((float)pRendered->size.x / _horizScaleFactor, (float)pRendered->size.y / _vertScaleFactor), rotation, color);
 	}
 }
 
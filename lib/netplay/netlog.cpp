@@ -27,6 +27,7 @@
 #include "lib/framework/wztime.h"
 
 #include "netlog.h"
+#include "nettelemetry.h"
 #include "netplay.h"
 #include "netpermissions.h"
 
@@ -153,6 +154,7 @@ void NETlogPacket(uint8_t type, uint32_t size, bool received)
 	STATIC_ASSERT((1 << (8 * sizeof(type))) == NUM_GAME_PACKETS); // NUM_GAME_PACKETS must be larger than maximum possible type.
 	packetcount[received][type]++;
 	packetsize[received][type] += size;
+	NETtelemetryRecordMessage(type, size, received);
 }
 
 bool NETlogEntry(const char *str, UDWORD a, UDWORD b)
@@ -48,6 +48,7 @@
 
 #include "netplay.h"
 #include "netlog.h"
+#include "nettelemetry.h"
 #include "netreplay.h"
 #include "lib/netplay/byteorder_funcs_wrapper.h"
 #include "lib/netplay/client_connection.h"
@@ -574,7 +575,7 @@ bool NETsetAsyncJoinApprovalResult(const std::string& uniqueJoinID, AsyncJoinApp
 
 // *********** Socket with buffer that read NETMSGs ******************
 
-static size_t NET_fillBuffer(IClientConnection** pSocket, IConnectionPollGroup* pSocketSet, uint8_t *bufstart, int bufsize)
+static size_t NET_fillBuffer(IClientConnection** pSocket, IConnectionPollGroup* pSocketSet, uint8_t player, uint8_t *bufstart, int bufsize)
 {
 	IClientConnection* socket = *pSocket;
 
@@ -593,6 +594,7 @@ static size_t NET_fillBuffer(IClientConnection** pSocket, IConnectionPollGroup*
 		nStats.rawBytes.received          += rawBytes;
 		nStats.uncompressedBytes.received += static_cast<size_t>(size);
 		nStats.packets.received           += 1;
+		NETtelemetryRecordConnectionTraffic(player, rawBytes, static_cast<size_t>(size), true);
 
 		return size;
 	}
@@ -1710,6 +1712,7 @@ int NETshutdown()
 	nStats = nZeroStats;
 	nStatsLastSec = nZeroStats;
 	nStatsSecondLastSec = nZeroStats;
+	NETtelemetryReset();
 
 	return 0;
 }
@@ -1921,6 +1924,7 @@ bool NETsend(NETQUEUE queue, NetMessage const& message)
 					nStats.rawBytes.sent          += compressedRawLen;
 					nStats.uncompressedBytes.sent += rawLen;
 					nStats.packets.sent           += 1;
+					NETtelemetryRecordConnectionTraffic(player, compressedRawLen, rawLen, false);
 				}
 				else if (res == SOCKET_ERROR)
 				{
@@ -1953,6 +1957,7 @@ bool NETsend(NETQUEUE queue, NetMessage const& message)
 				nStats.rawBytes.sent          += compressedRawLen;
 				nStats.uncompressedBytes.sent += rawLen;
 				nStats.packets.sent           += 1;
+				NETtelemetryRecordConnectionTraffic(NetPlay.hostPlayer, compressedRawLen, rawLen, false);
 			}
 			else if (res == SOCKET_ERROR)
 			{
@@ -2061,6 +2066,7 @@ void NETflush()
 					continue;
 				}
 				nStats.rawBytes.sent += compressedRawLen;
+				NETtelemetryRecordConnectionTraffic(player, compressedRawLen, 0, false);
 			}
 		}
 
@@ -2094,6 +2100,7 @@ void NETflush()
 				return;
 			}
 			nStats.rawBytes.sent += compressedRawLen;
+			NETtelemetryRecordConnectionTraffic(NetPlay.hostPlayer, compressedRawLen, 0, false);
 		}
 	}
 }
@@ -3153,7 +3160,7 @@ bool NETrecvNet(NETQUEUE *queue, uint8_t *type)
 			continue;
 		}
 
-		size_t dataLen = NET_fillBuffer(pSocket, pollGroup, buffer, sizeof(buffer));
+		size_t dataLen = NET_fillBuffer(pSocket, pollGroup, static_cast<uint8_t>(current), buffer, sizeof(buffer));
 		if (dataLen > 0)
 		{
 			// we received some data, add to buffer
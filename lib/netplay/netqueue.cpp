@@ -175,46 +175,62 @@ NetMessageBuilder::NetMessageBuilder(NetMsgDataVector&& rawData)
 NetQueue::NetQueue()
 	: canGetMessagesForNet(true)
 	, canGetMessages(true)
+	, dataPos(0)
+	, messagePos(0)
 	, messages(MsgAllocator(defaultMemoryPool()))
 	, pendingGameTimeUpdateMessages(0)
 	, bCurrentMessageWasDecrypted(false)
 {
-	dataPos = messages.end();
-	messagePos = messages.end();
 }
 
-void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
+size_t NetQueue::extractMessages(const uint8_t *data, size_t len)
 {
 	size_t used = 0;
-	std::vector<uint8_t> &buffer = incompleteReceivedMessageData;  // Short alias.
-
-	// Insert the data.
-	buffer.insert(buffer.end(), netData, netData + netLen);
 
-	// Extract the messages.
-	while (buffer.size() - used >= NetMessage::HEADER_LENGTH)
+	while (len - used >= NetMessage::HEADER_LENGTH)
 	{
-		uint8_t type = buffer[used];
-		uint16_t len = 0;
+		uint8_t type = data[used];
+		uint16_t payloadLen = 0;
 		// Load payload length from uint16_t (network byte order) starting at the second byte of the data buffer.
-		wz_ntohs_load_unaligned(len, &buffer[used + 1]);
+		wz_ntohs_load_unaligned(payloadLen, &data[used + 1]);
 
-		if (buffer.size() - used - NetMessage::HEADER_LENGTH < len)
+		if (len - used - NetMessage::HEADER_LENGTH < payloadLen)
 		{
 			break;  // Don't have a whole message ready yet.
 		}
 
-		NetMessageBuilder msg(type, len);
-		msg.append(buffer.data() + used + NetMessage::HEADER_LENGTH, len);
-		messages.emplace_front(msg.build());
+		NetMessageBuilder msg(type, payloadLen);
+		msg.append(data + used + NetMessage::HEADER_LENGTH, payloadLen);
+		messages.emplace_back(msg.build());
 
 		if (type == GAME_GAME_TIME)
 		{
 			++pendingGameTimeUpdateMessages;
 		}
-		used += NetMessage::HEADER_LENGTH + len;
+		used += NetMessage::HEADER_LENGTH + payloadLen;
+	}
+
+	return used;
+}
+
+void NetQueue::writeRawData(const uint8_t *netData, size_t netLen)
+{
+	std::vector<uint8_t> &buffer = incompleteReceivedMessageData;  // Short alias.
+
+	if (buffer.empty())
+	{
+		// Common case: extract the messages straight from the network data, and only keep the trailing partial message (if any).
+		size_t used = extractMessages(netData, netLen);
+		buffer.assign(netData + used, netData + netLen);
+		return;
 	}
 
+	// Insert the data.
+	buffer.insert(buffer.end(), netData, netData + netLen);
+
+	// Extract the messages.
+	size_t used = extractMessages(buffer.data(), buffer.size());
+
 	// Recycle old data.
 	buffer.erase(buffer.begin(), buffer.begin() + used);
 }
@@ -231,33 +247,28 @@ void NetQueue::setWillNeverGetMessagesForNet()
 
 unsigned NetQueue::numMessagesForNet() const
 {
-	unsigned count = 0;
-	if (canGetMessagesForNet)
+	if (!canGetMessagesForNet)
 	{
-		for (List::iterator i = dataPos; i != messages.begin(); --i)
-		{
-			++count;
-		}
+		return 0;
 	}
-
-	return count;
+	return static_cast<unsigned>(messages.size() - dataPos);
 }
 
 const NetMessage &NetQueue::getMessageForNet() const
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for getMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to get!");
+	ASSERT(dataPos < messages.size(), "No message to get!");
 
 	// Return the message.
-	return internal_getMessageForNet();
+	return messages[dataPos];
 }
 
 void NetQueue::popMessageForNet()
 {
 	ASSERT(canGetMessagesForNet, "Wrong NetQueue type for popMessageForNet.");
-	ASSERT(dataPos != messages.begin(), "No message to pop!");
+	ASSERT(dataPos < messages.size(), "No message to pop!");
 
-	if (messagePos != messages.begin() && internal_getMessageForNet().type() == GAME_GAME_TIME)
+	if (messagePos < messages.size() && messages[dataPos].type() == GAME_GAME_TIME)
 	{
 		if (pendingGameTimeUpdateMessages > 0)
 		{
@@ -266,7 +277,7 @@ void NetQueue::popMessageForNet()
 	}
 
 	// Pop the message.
-	--dataPos;
+	++dataPos;
 
 	// Recycle old data.
 	popOldMessages();
@@ -278,7 +289,7 @@ void NetQueue::pushMessage(NetMessage&& message)
 	{
 		++pendingGameTimeUpdateMessages;
 	}
-	messages.emplace_front(std::move(message));
+	messages.emplace_back(std::move(message));
 }
 
 void NetQueue::setWillNeverGetMessages()
@@ -289,16 +300,16 @@ void NetQueue::setWillNeverGetMessages()
 bool NetQueue::haveMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for haveMessage.");
-	return messagePos != messages.begin();
+	return messagePos < messages.size();
 }
 
 const NetMessage &NetQueue::getMessage() const
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for getMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to get!");
+	ASSERT(messagePos < messages.size(), "No message to get!");
 
 	// Return the message.
-	return internal_getConstMessage();
+	return messages[messagePos];
 }
 
 bool NetQueue::currentMessageWasDecrypted() const
@@ -309,9 +320,9 @@ bool NetQueue::currentMessageWasDecrypted() const
 bool NetQueue::replaceCurrentWithDecrypted(NetMessage &&decryptedMessage)
 {
 	ASSERT_OR_RETURN(false, canGetMessages, "Wrong NetQueue type for getMessage.");
-	ASSERT_OR_RETURN(false, messagePos != messages.begin(), "No message to get!");
+	ASSERT_OR_RETURN(false, messagePos < messages.size(), "No message to get!");
 
-	NetMessage& currentMessage = internal_getMessage();
+	NetMessage& currentMessage = messages[messagePos];
 	ASSERT_OR_RETURN(false, currentMessage.type() == NET_SECURED_NET_MESSAGE, "Current message is not a secured message!");
 
 	currentMessage = std::move(decryptedMessage);
@@ -322,9 +333,9 @@ bool NetQueue::replaceCurrentWithDecrypted(NetMessage &&decryptedMessage)
 void NetQueue::popMessage()
 {
 	ASSERT(canGetMessages, "Wrong NetQueue type for popMessage.");
-	ASSERT(messagePos != messages.begin(), "No message to pop!");
+	ASSERT(messagePos < messages.size(), "No message to pop!");
 
-	if (messagePos != messages.begin() && internal_getConstMessage().type() == GAME_GAME_TIME)
+	if (messagePos < messages.size() && messages[messagePos].type() == GAME_GAME_TIME)
 	{
 		if (pendingGameTimeUpdateMessages > 0)
 		{
@@ -333,7 +344,7 @@ void NetQueue::popMessage()
 	}
 
 	// Pop the message.
-	--messagePos;
+	++messagePos;
 	bCurrentMessageWasDecrypted = false;
 
 	// Recycle old data.
@@ -344,27 +355,16 @@ void NetQueue::popOldMessages()
 {
 	if (!canGetMessagesForNet)
 	{
-		dataPos = messages.begin();
+		dataPos = messages.size();
 	}
 	if (!canGetMessages)
 	{
-		messagePos = messages.begin();
-	}
-
-	List::iterator i = messages.end();
-	while (i != dataPos && i != messagePos)
-	{
-		--i;
-	}
-
-	if (i == dataPos)
-	{
-		dataPos = messages.end();  // Old iterator will become invalid.
-	}
-	if (i == messagePos)
-	{
-		messagePos = messages.end();  // Old iterator will become invalid.
+		messagePos = messages.size();
 	}
 
-	messages.erase(i, messages.end());
+	// Messages in front of both positions have been fully consumed.
+	size_t numConsumed = std::min(dataPos, messagePos);
+	messages.erase(messages.begin(), messages.begin() + numConsumed);
+	dataPos -= numConsumed;
+	messagePos -= numConsumed;
 }
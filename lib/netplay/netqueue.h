@@ -28,7 +28,7 @@
 #include "lib/framework/pool_allocator.h"
 #include "lib/netplay/byteorder_funcs_wrapper.h"
 #include <vector>
-#include <list>
+#include <deque>
 
 #include <nonstd/optional.hpp>
 using nonstd::optional;
@@ -293,35 +293,13 @@ private:
 	bool canGetMessagesForNet;                                         ///< True if we will send the messages over the network, false if we don't.
 	bool canGetMessages;                                               ///< True if we will get the messages, false if we don't use them ourselves.
 
-	inline const NetMessage &internal_getMessageForNet() const
-	{
-		// Return the message.
-		List::iterator i = dataPos;
-		--i;
-		return *i;
-	};
-
-	inline const NetMessage &internal_getConstMessage() const
-	{
-		// Return the message.
-		List::iterator i = messagePos;
-		--i;
-		return *i;
-	};
-
-	inline NetMessage &internal_getMessage()
-	{
-		// Return the message.
-		List::iterator i = messagePos;
-		--i;
-		return *i;
-	};
+	size_t extractMessages(const uint8_t *data, size_t len);          ///< Deserialises as many whole messages as possible from data, returns the number of bytes used.
 
 	using MsgAllocator = PoolAllocator<NetMessage, MemoryPool>;
-	using List = std::list<NetMessage, MsgAllocator>;
-	List::iterator                dataPos;                             ///< Last message which was sent over the network.
-	List::iterator                messagePos;                          ///< Last message which was popped.
-	List                          messages;                            ///< List of messages. Messages are added to the front and read from the back.
+	using Queue = std::deque<NetMessage, MsgAllocator>;
+	size_t                        dataPos;                             ///< Index of the next message to be sent over the network.
+	size_t                        messagePos;                          ///< Index of the next message to be popped.
+	Queue                         messages;                            ///< Queue of messages. Messages are added to the back and removed from the front, once both dataPos and messagePos have passed them.
 	std::vector<uint8_t>          incompleteReceivedMessageData;       ///< Data from network which has not yet formed an entire message.
 	size_t                        pendingGameTimeUpdateMessages;       ///< Pending GAME_GAME_TIME messages added to this queue
 	bool						  bCurrentMessageWasDecrypted;
@@ -41,9 +41,12 @@
 #  pragma GCC diagnostic pop
 #endif
 
+#include <algorithm>
 #include <ctime>
 #include <memory>
 
+#include <zlib.h>
+
 #include "netreplay.h"
 #include "netplay.h"
 
@@ -51,8 +54,9 @@ static PHYSFS_file *replaySaveHandle = nullptr;
 static PHYSFS_file *replayLoadHandle = nullptr;
 
 static const uint32_t magicReplayNumber = 0x575A7270;  // "WZrp"
-static const uint32_t currentReplayFormatVer = 3;
+static const uint32_t currentReplayFormatVer = 4;
 static const uint32_t minReplayFormatVerSupported = 3;
+static const uint32_t uncompressedReplayFormatVer = 3;  // v4 is only used for replays with a compressed message stream
 static const size_t DefaultReplayBufferSize = 32768;
 static const size_t MaxReplayBufferSize = 2 * 1024 * 1024;
 
@@ -62,6 +66,41 @@ static nlohmann::json queuedSaveSettings;
 static SerializedNetMessagesBuffer latestWriteBuffer;
 static size_t minBufferSizeToQueue = DefaultReplayBufferSize;
 static WZ_THREAD *saveThread = nullptr;
+static PHYSFS_sint64 loadStreamStartPos = -1;
+
+// v4: Compressed message stream
+// The message stream is written as a series of blocks: [uint32_t uncompressedSize][uint32_t compressedSize][zlib data],
+// terminated by a block header with an uncompressedSize of 0. Every block can be decompressed independently and starts
+// with a whole message, and the end of game info contains a block index, so a reader can start reading at any block.
+struct ReplayStreamBlock
+{
+	uint64_t streamOffset;  // Offset of the first (uncompressed) byte of the block from the start of the message stream
+	uint64_t fileOffset;    // Offset of the block header from the start of the message stream in the file
+};
+static bool saveCompressedStream = false;
+static std::vector<ReplayStreamBlock> saveStreamBlocks;  // Only accessed by the save thread until it has been joined
+static bool loadCompressedStream = false;
+static std::vector<ReplayStreamBlock> loadStreamBlocks;
+static std::vector<uint8_t> loadBlockData;  // The decompressed data of the current block
+static size_t loadBlockPos = 0;             // Read position in loadBlockData
+
+static bool replayWriteCompressedBlock(PHYSFS_file *pSaveHandle, SerializedNetMessagesBuffer const &item, uint64_t &streamOffset, uint64_t &fileOffset, std::vector<uint8_t> &compressBuffer)
+{
+	compressBuffer.resize(compressBound(static_cast<uLong>(item.size())));
+	uLongf compressedSize = static_cast<uLongf>(compressBuffer.size());
+	if (compress2(compressBuffer.data(), &compressedSize, item.data(), static_cast<uLong>(item.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		debug(LOG_ERROR, "Failed to compress replay data");
+		return false;
+	}
+	saveStreamBlocks.push_back({streamOffset, fileOffset});
+	PHYSFS_writeUBE32(pSaveHandle, static_cast<uint32_t>(item.size()));
+	PHYSFS_writeUBE32(pSaveHandle, static_cast<uint32_t>(compressedSize));
+	WZ_PHYSFS_writeBytes(pSaveHandle, compressBuffer.data(), static_cast<uint32_t>(compressedSize));
+	streamOffset += item.size();
+	fileOffset += 2 * sizeof(uint32_t) + compressedSize;
+	return true;
+}
 
 // This function is run in its own thread! Do not call any non-threadsafe functions!
 static int replaySaveThreadFunc(void *data)
@@ -72,6 +111,10 @@ static int replaySaveThreadFunc(void *data)
 		return 1;
 	}
 	SerializedNetMessagesBuffer item;
+	std::vector<uint8_t> compressBuffer;
+	uint64_t streamOffset = 0;
+	uint64_t fileOffset = 0;
+	bool compressionFailed = false;
 	while (true)
 	{
 		serializedBufferWriteQueue.wait_dequeue(item);
@@ -80,7 +123,21 @@ static int replaySaveThreadFunc(void *data)
 			// end chunk - we're done
 			break;
 		}
-		WZ_PHYSFS_writeBytes(pSaveHandle, item.data(), item.size());
+		if (!saveCompressedStream)
+		{
+			WZ_PHYSFS_writeBytes(pSaveHandle, item.data(), item.size());
+		}
+		else if (!compressionFailed)
+		{
+			// Any data after a failed block would be unreadable, so stop writing the stream (the block terminator is still written)
+			compressionFailed = !replayWriteCompressedBlock(pSaveHandle, item, streamOffset, fileOffset, compressBuffer);
+		}
+	}
+	if (saveCompressedStream)
+	{
+		// Block terminator
+		PHYSFS_writeUBE32(pSaveHandle, 0);
+		PHYSFS_writeUBE32(pSaveHandle, 0);
 	}
 	return 0;
 }
@@ -116,7 +173,7 @@ static bool NETreplaySaveWritePreamble(const nlohmann::json& settings, ReplayOpt
 	return true;
 }
 
-std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler const &optionsHandler, int maxReplaysSaved, bool appendPlayerToFilename)
+std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler const &optionsHandler, int maxReplaysSaved, bool appendPlayerToFilename, bool compressStream)
 {
 	if (NETisReplay())
 	{
@@ -169,7 +226,12 @@ std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler c
 	nlohmann::json settings = nlohmann::json::object();
 
 	// Save "replay file format version"
-	settings["replayFormatVer"] = currentReplayFormatVer;
+	// (uncompressed replays are still written as v3, so they remain readable by older versions)
+	settings["replayFormatVer"] = (compressStream) ? currentReplayFormatVer : uncompressedReplayFormatVer;
+	if (compressStream)
+	{
+		settings["streamCompression"] = "zlib";
+	}
 
 	// Save Netcode version
 	settings["major"] = NETGetMajorVersion();
@@ -196,6 +258,9 @@ std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler c
 		minBufferSizeToQueue = desiredBufferSize;
 	}
 
+	saveCompressedStream = compressStream;
+	saveStreamBlocks.clear();
+
 	debug(LOG_INFO, "Started writing replay file \"%s\".", filename.c_str());
 
 	// Create a background thread and hand off all responsibility for writing to the file handle to it
@@ -267,6 +332,19 @@ bool NETreplaySaveStop(ReplayOptionsHandler const &optionsHandler)
 	nlohmann::json endOfGameInfo = nlohmann::json::object();
 	endOfGameInfo["gameTimeElapsed"] = gameTime;
 	// FUTURE TODO: Could save things like the game results / winners + losers
+	optionsHandler.saveEndOfGameInfo(endOfGameInfo);
+
+	if (saveCompressedStream)
+	{
+		// v4: Block index: [offset from the start of the (uncompressed) message stream, offset of the block from the start of the message stream in the file] entries
+		nlohmann::json streamBlocks = nlohmann::json::array();
+		for (const auto& block : saveStreamBlocks)
+		{
+			streamBlocks.push_back(nlohmann::json::array({block.streamOffset, block.fileOffset}));
+		}
+		endOfGameInfo["streamBlocks"] = std::move(streamBlocks);
+		saveStreamBlocks.clear();
+	}
 
 	auto data = endOfGameInfo.dump();
 	PHYSFS_writeUBE32(replaySaveHandle, data.size());
@@ -304,6 +382,9 @@ void NETreplaySaveNetMessage(NetMessage const *message, uint8_t player)
 	}
 }
 
+static bool replayLoadEndOfGameInfo(nlohmann::json& output);
+static void replayLoadStreamBlocks(nlohmann::json const &endOfGameInfo);
+
 bool NETreplayLoadStart(std::string const &filename, ReplayOptionsHandler& optionsHandler, uint32_t& output_replayFormatVer)
 {
 	auto onFail = [&](char const *reason) {
@@ -368,6 +449,21 @@ bool NETreplayLoadStart(std::string const &filename, ReplayOptionsHandler& optio
 			return onFail(failLogStr.c_str());
 		}
 
+		loadCompressedStream = false;
+		if (replayFormatVer >= 4)
+		{
+			auto it = settings.find("streamCompression");
+			if (it != settings.end())
+			{
+				if (it->get<std::string>() != "zlib")
+				{
+					std::string failLogStr = "Unsupported replay stream compression: " + it->get<std::string>();
+					return onFail(failLogStr.c_str());
+				}
+				loadCompressedStream = true;
+			}
+		}
+
 		uint32_t replay_netcodeMajor = settings.at("major").get<uint32_t>();
 		uint32_t replay_netcodeMinor = settings.at("minor").get<uint32_t>();
 		if (!NETisCorrectVersion(replay_netcodeMajor, replay_netcodeMinor))
@@ -424,10 +520,163 @@ bool NETreplayLoadStart(std::string const &filename, ReplayOptionsHandler& optio
 		return onFail(parseError.c_str());
 	}
 
+	loadStreamStartPos = PHYSFS_tell(replayLoadHandle);
+	loadStreamBlocks.clear();
+	loadBlockData.clear();
+	loadBlockPos = 0;
+
+	if (output_replayFormatVer >= 2)
+	{
+		nlohmann::json endOfGameInfo;
+		if (replayLoadEndOfGameInfo(endOfGameInfo))
+		{
+			optionsHandler.restoreEndOfGameInfo(endOfGameInfo);
+			if (loadCompressedStream)
+			{
+				replayLoadStreamBlocks(endOfGameInfo);
+			}
+		}
+	}
+
 	debug(LOG_INFO, "Started reading replay file \"%s\".", filename.c_str());
 	return true;
 }
 
+// Reads the end of game info JSON (v2+) from the end of the loaded replay file, without changing the current read position
+static bool replayLoadEndOfGameInfo(nlohmann::json& output)
+{
+	// The end of game info JSON is both preceded and followed by its size, so it can be read from the end of the file
+	const PHYSFS_sint64 currentPos = PHYSFS_tell(replayLoadHandle);
+	const PHYSFS_sint64 fileLength = PHYSFS_fileLength(replayLoadHandle);
+	if (currentPos < 0 || fileLength < loadStreamStartPos + static_cast<PHYSFS_sint64>(sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	auto restorePosition = [&]() {
+		PHYSFS_seek(replayLoadHandle, static_cast<PHYSFS_uint64>(currentPos));
+	};
+
+	uint32_t dataSize = 0;
+	if (PHYSFS_seek(replayLoadHandle, static_cast<PHYSFS_uint64>(fileLength - sizeof(uint32_t))) == 0
+		|| !PHYSFS_readUBE32(replayLoadHandle, &dataSize)
+		|| static_cast<PHYSFS_sint64>(dataSize) > fileLength - loadStreamStartPos - static_cast<PHYSFS_sint64>(sizeof(uint32_t))
+		|| PHYSFS_seek(replayLoadHandle, static_cast<PHYSFS_uint64>(fileLength - sizeof(uint32_t) - dataSize)) == 0)
+	{
+		restorePosition();
+		return false;
+	}
+
+	std::string data;
+	data.resize(dataSize);
+	size_t dataRead = WZ_PHYSFS_readBytes(replayLoadHandle, &data[0], data.size());
+	restorePosition();
+	if (dataRead != data.size())
+	{
+		return false;
+	}
+
+	try
+	{
+		output = nlohmann::json::parse(data);
+	}
+	catch (const std::exception& e)
+	{
+		debug(LOG_ERROR, "Error parsing replay end of game info JSON: %s", e.what());
+		return false;
+	}
+	return output.is_object();
+}
+
+// v4: Reads the block index from the end of game info (replays from builds that didn't write one have none)
+static void replayLoadStreamBlocks(nlohmann::json const &endOfGameInfo)
+{
+	loadStreamBlocks.clear();
+	auto it = endOfGameInfo.find("streamBlocks");
+	if (it == endOfGameInfo.end())
+	{
+		return;
+	}
+	try
+	{
+		for (const auto& block : *it)
+		{
+			loadStreamBlocks.push_back({block.at(0).get<uint64_t>(), block.at(1).get<uint64_t>()});
+		}
+	}
+	catch (const std::exception& e)
+	{
+		debug(LOG_ERROR, "Ignoring invalid replay block index: %s", e.what());
+		loadStreamBlocks.clear();
+		return;
+	}
+	for (size_t i = 1; i < loadStreamBlocks.size(); ++i)
+	{
+		if (loadStreamBlocks[i].streamOffset <= loadStreamBlocks[i - 1].streamOffset || loadStreamBlocks[i].fileOffset <= loadStreamBlocks[i - 1].fileOffset)
+		{
+			debug(LOG_ERROR, "Ignoring invalid replay block index: offsets are not increasing");
+			loadStreamBlocks.clear();
+			return;
+		}
+	}
+}
+
+// v4: Reads and decompresses the next block of the message stream
+static bool replayLoadNextBlock()
+{
+	loadBlockData.clear();
+	loadBlockPos = 0;
+
+	uint32_t uncompressedSize = 0;
+	uint32_t compressedSize = 0;
+	if (!PHYSFS_readUBE32(replayLoadHandle, &uncompressedSize) || !PHYSFS_readUBE32(replayLoadHandle, &compressedSize) || uncompressedSize == 0)
+	{
+		// End of the message stream
+		return false;
+	}
+	ASSERT_OR_RETURN(false, uncompressedSize <= MaxReplayBufferSize * 2 && compressedSize <= compressBound(uncompressedSize), "Invalid replay block (size: %" PRIu32 ", compressed: %" PRIu32 ")", uncompressedSize, compressedSize);
+
+	std::vector<uint8_t> compressedData(compressedSize);
+	if (WZ_PHYSFS_readBytes(replayLoadHandle, compressedData.data(), compressedSize) != compressedSize)
+	{
+		debug(LOG_ERROR, "Truncated replay block");
+		return false;
+	}
+	loadBlockData.resize(uncompressedSize);
+	uLongf decompressedSize = uncompressedSize;
+	if (uncompress(loadBlockData.data(), &decompressedSize, compressedData.data(), compressedSize) != Z_OK || decompressedSize != uncompressedSize)
+	{
+		debug(LOG_ERROR, "Failed to decompress replay block");
+		loadBlockData.clear();
+		return false;
+	}
+	return true;
+}
+
+// Reads from the message stream of the loaded replay, decompressing it if needed
+static size_t replayLoadReadBytes(void *buffer, size_t len)
+{
+	if (!loadCompressedStream)
+	{
+		return WZ_PHYSFS_readBytes(replayLoadHandle, buffer, static_cast<PHYSFS_uint32>(len));
+	}
+
+	uint8_t *output = static_cast<uint8_t *>(buffer);
+	size_t totalRead = 0;
+	while (totalRead < len)
+	{
+		if (loadBlockPos >= loadBlockData.size() && !replayLoadNextBlock())
+		{
+			break;
+		}
+		const size_t count = std::min(len - totalRead, loadBlockData.size() - loadBlockPos);
+		memcpy(output + totalRead, loadBlockData.data() + loadBlockPos, count);
+		loadBlockPos += count;
+		totalRead += count;
+	}
+	return totalRead;
+}
+
 bool NETreplayLoadNetMessage(std::unique_ptr<NetMessage> &message, uint8_t &player)
 {
 	if (!replayLoadHandle)
@@ -435,13 +684,13 @@ bool NETreplayLoadNetMessage(std::unique_ptr<NetMessage> &message, uint8_t &play
 		return false;
 	}
 
-	WZ_PHYSFS_readBytes(replayLoadHandle, &player, 1);
+	replayLoadReadBytes(&player, 1);
 
 	uint8_t type;
-	WZ_PHYSFS_readBytes(replayLoadHandle, &type, 1);
+	replayLoadReadBytes(&type, 1);
 
 	uint8_t b[2];
-	bool rd = WZ_PHYSFS_readBytes(replayLoadHandle, &b, 2);
+	bool rd = replayLoadReadBytes(&b, 2) == 2;
 	if (!rd)
 	{
 		return false;
@@ -451,7 +700,7 @@ bool NETreplayLoadNetMessage(std::unique_ptr<NetMessage> &message, uint8_t &play
 	wz_ntohs_load_unaligned(len, b);
 
 	std::vector<uint8_t> replayData(len);
-	size_t messageRead = WZ_PHYSFS_readBytes(replayLoadHandle, replayData.data(), len);
+	size_t messageRead = replayLoadReadBytes(replayData.data(), len);
 
 	if (messageRead != len)
 	{
@@ -466,6 +715,27 @@ bool NETreplayLoadNetMessage(std::unique_ptr<NetMessage> &message, uint8_t &play
 	return (message->type() > GAME_MIN_TYPE && message->type() < GAME_MAX_TYPE) || message->type() == REPLAY_ENDED;
 }
 
+size_t NETreplayLoadStreamBlockCount()
+{
+	return loadStreamBlocks.size();
+}
+
+bool NETreplayLoadSeekStreamBlock(size_t blockIndex)
+{
+	ASSERT_OR_RETURN(false, replayLoadHandle != nullptr && loadStreamStartPos >= 0, "No replay loaded");
+	ASSERT_OR_RETURN(false, blockIndex < loadStreamBlocks.size(), "Invalid block index: %zu (blocks: %zu)", blockIndex, loadStreamBlocks.size());
+
+	if (PHYSFS_seek(replayLoadHandle, static_cast<PHYSFS_uint64>(loadStreamStartPos) + loadStreamBlocks[blockIndex].fileOffset) == 0)
+	{
+		debug(LOG_ERROR, "Failed to seek in replay: %s", WZ_PHYSFS_getLastError());
+		return false;
+	}
+	// The next read decompresses the block
+	loadBlockData.clear();
+	loadBlockPos = 0;
+	return true;
+}
+
 bool NETreplayLoadStop()
 {
 	if (!replayLoadHandle)
@@ -479,6 +749,11 @@ bool NETreplayLoadStop()
 		return false;
 	}
 	replayLoadHandle = nullptr;
+	loadStreamStartPos = -1;
+	loadCompressedStream = false;
+	loadStreamBlocks.clear();
+	loadBlockData = std::vector<uint8_t>();
+	loadBlockPos = 0;
 
 	return true;
 }
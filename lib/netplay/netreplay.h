@@ -25,12 +25,19 @@
 #include "netplay.h"
 
 
-std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler const &optionsHandler, int maxReplaysSaved, bool appendPlayerToFilename = false);
+/// If `compressStream` is set, the message stream is saved as zlib-compressed blocks (replay format v4, which older versions can't read).
+/// Otherwise the replay is saved as format v3.
+std::string NETreplaySaveStart(std::string const& subdir, ReplayOptionsHandler const &optionsHandler, int maxReplaysSaved, bool appendPlayerToFilename = false, bool compressStream = false);
 bool NETreplaySaveStop(ReplayOptionsHandler const &optionsHandler);
 void NETreplaySaveNetMessage(NetMessage const *message, uint8_t player);
 
 bool NETreplayLoadStart(std::string const &filename, ReplayOptionsHandler& optionsHandler, uint32_t& output_replayFormatVer);
 bool NETreplayLoadNetMessage(std::unique_ptr<NetMessage> &message, uint8_t &player);
+/// v4: The number of blocks in the block index of the loaded replay (0 if it isn't compressed, or has no index).
+size_t NETreplayLoadStreamBlockCount();
+/// v4: Positions the loaded replay so that the next NETreplayLoadNetMessage() returns the first message of the given block.
+/// Only the message stream is positioned, not the game state, so this is for reading the messages of a replay, not for playing it.
+bool NETreplayLoadSeekStreamBlock(size_t blockIndex);
 bool NETreplayLoadStop();
 
 #endif // _NETREPLAY_H
@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file nettelemetry.cpp
+ *
+ * Always-on network counters and latency histograms.
+ */
+
+#include <nlohmann/json.hpp> // Must come before WZ includes
+
+#include "lib/framework/frame.h"
+#include "lib/gamelib/gtime.h"
+
+#include "nettelemetry.h"
+#include "netplay.h"
+
+#include <array>
+#include <atomic>
+
+namespace
+{
+
+constexpr size_t NUM_MESSAGE_TYPES = 256;
+
+struct TrafficCounter
+{
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> bytes{0};
+
+	void record(uint64_t size)
+	{
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		count.store(0, std::memory_order_relaxed);
+		bytes.store(0, std::memory_order_relaxed);
+	}
+
+	nlohmann::ordered_json toJSON() const
+	{
+		auto j = nlohmann::ordered_json::object();
+		j["count"] = count.load(std::memory_order_relaxed);
+		j["bytes"] = bytes.load(std::memory_order_relaxed);
+		return j;
+	}
+};
+
+struct ConnectionCounter
+{
+	std::atomic<uint64_t> packets{0};
+	std::atomic<uint64_t> rawBytes{0};
+	std::atomic<uint64_t> uncompressedBytes{0};
+
+	void record(size_t raw, size_t uncompressed)
+	{
+		if (uncompressed > 0)
+		{
+			packets.fetch_add(1, std::memory_order_relaxed);
+		}
+		rawBytes.fetch_add(raw, std::memory_order_relaxed);
+		uncompressedBytes.fetch_add(uncompressed, std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		packets.store(0, std::memory_order_relaxed);
+		rawBytes.store(0, std::memory_order_relaxed);
+		uncompressedBytes.store(0, std::memory_order_relaxed);
+	}
+
+	nlohmann::ordered_json toJSON() const
+	{
+		auto j = nlohmann::ordered_json::object();
+		j["packets"] = packets.load(std::memory_order_relaxed);
+		j["raw"] = rawBytes.load(std::memory_order_relaxed);
+		j["uncompressed"] = uncompressedBytes.load(std::memory_order_relaxed);
+		return j;
+	}
+};
+
+/// Histogram with power-of-2 bucket boundaries (in microseconds).
+/// Bucket `i` counts samples `< 2^i` us which did not fit in bucket `i - 1`; the last bucket counts everything else.
+class LatencyHistogram
+{
+public:
+	static constexpr size_t NUM_BUCKETS = 26; // The last bounded bucket is 2^24 us (~16.7 s)
+
+	void record(uint64_t micros)
+	{
+		size_t bucket = 0;
+		while (bucket < NUM_BUCKETS - 1 && (uint64_t(1) << bucket) <= micros)
+		{
+			++bucket;
+		}
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sumMicros.fetch_add(micros, std::memory_order_relaxed);
+		uint64_t prevMax = maxMicros.load(std::memory_order_relaxed);
+		while (prevMax < micros && !maxMicros.compare_exchange_weak(prevMax, micros, std::memory_order_relaxed))
+		{ }
+	}
+
+	void reset()
+	{
+		for (auto& bucket : buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		count.store(0, std::memory_order_relaxed);
+		sumMicros.store(0, std::memory_order_relaxed);
+		maxMicros.store(0, std::memory_order_relaxed);
+	}
+
+	bool empty() const
+	{
+		return count.load(std::memory_order_relaxed) == 0;
+	}
+
+	nlohmann::ordered_json toJSON() const
+	{
+		auto j = nlohmann::ordered_json::object();
+		j["count"] = count.load(std::memory_order_relaxed);
+		j["sum_us"] = sumMicros.load(std::memory_order_relaxed);
+		j["max_us"] = maxMicros.load(std::memory_order_relaxed);
+		// Only output non-empty buckets, as [upper bound in us (or null for the overflow bucket), count] pairs
+		auto jBuckets = nlohmann::ordered_json::array();
+		for (size_t i = 0; i < NUM_BUCKETS; ++i)
+		{
+			uint64_t bucketCount = buckets[i].load(std::memory_order_relaxed);
+			if (bucketCount == 0)
+			{
+				continue;
+			}
+			auto jBucket = nlohmann::ordered_json::array();
+			if (i < NUM_BUCKETS - 1)
+			{
+				jBucket.push_back(uint64_t(1) << i);
+			}
+			else
+			{
+				jBucket.push_back(nullptr);
+			}
+			jBucket.push_back(bucketCount);
+			jBuckets.push_back(std::move(jBucket));
+		}
+		j["buckets"] = std::move(jBuckets);
+		return j;
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets = {};
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> sumMicros{0};
+	std::atomic<uint64_t> maxMicros{0};
+};
+
+struct GameTimeSentRecord
+{
+	uint32_t checkTime = 0;
+	std::chrono::steady_clock::time_point sentAt;
+};
+
+// Enough to cover several seconds of GAME_GAME_TIME messages.
+constexpr size_t NUM_GAME_TIME_SENT_RECORDS = 64;
+
+struct NetTelemetry
+{
+	std::array<TrafficCounter, NUM_MESSAGE_TYPES> messagesSent;
+	std::array<TrafficCounter, NUM_MESSAGE_TYPES> messagesReceived;
+	std::array<ConnectionCounter, MAX_CONNECTED_PLAYERS> connectionsSent;
+	std::array<ConnectionCounter, MAX_CONNECTED_PLAYERS> connectionsReceived;
+	LatencyHistogram pendingWriteWait;
+	std::array<LatencyHistogram, MAX_CONNECTED_PLAYERS> gameTimeLatency;
+
+	// Only accessed from the main thread (sendPlayerGameTime / recvPlayerGameTime).
+	std::array<GameTimeSentRecord, NUM_GAME_TIME_SENT_RECORDS> gameTimeSent;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+NetTelemetry& telemetry()
+{
+	static NetTelemetry instance;
+	return instance;
+}
+
+size_t gameTimeSentSlot(uint32_t checkTime)
+{
+	return (checkTime / GAME_TICKS_PER_UPDATE) % NUM_GAME_TIME_SENT_RECORDS;
+}
+
+} // anonymous namespace
+
+void NETtelemetryReset()
+{
+	auto& t = telemetry();
+	for (size_t i = 0; i < NUM_MESSAGE_TYPES; ++i)
+	{
+		t.messagesSent[i].reset();
+		t.messagesReceived[i].reset();
+	}
+	for (size_t i = 0; i < MAX_CONNECTED_PLAYERS; ++i)
+	{
+		t.connectionsSent[i].reset();
+		t.connectionsReceived[i].reset();
+		t.gameTimeLatency[i].reset();
+	}
+	t.pendingWriteWait.reset();
+	t.gameTimeSent.fill(GameTimeSentRecord());
+	t.startTime = std::chrono::steady_clock::now();
+}
+
+void NETtelemetryRecordMessage(uint8_t type, uint32_t size, bool received)
+{
+	auto& counters = received ? telemetry().messagesReceived : telemetry().messagesSent;
+	counters[type].record(size);
+}
+
+void NETtelemetryRecordConnectionTraffic(uint8_t player, size_t rawBytes, size_t uncompressedBytes, bool received)
+{
+	ASSERT_OR_RETURN(, player < MAX_CONNECTED_PLAYERS, "Invalid player: %u", static_cast<unsigned>(player));
+	auto& counters = received ? telemetry().connectionsReceived : telemetry().connectionsSent;
+	counters[player].record(rawBytes, uncompressedBytes);
+}
+
+void NETtelemetryRecordPendingWriteWait(std::chrono::steady_clock::duration wait)
+{
+	telemetry().pendingWriteWait.record(std::chrono::duration_cast<std::chrono::microseconds>(wait).count());
+}
+
+void NETtelemetryRecordGameTimeSent(uint32_t checkTime)
+{
+	auto& record = telemetry().gameTimeSent[gameTimeSentSlot(checkTime)];
+	record.checkTime = checkTime;
+	record.sentAt = std::chrono::steady_clock::now();
+}
+
+void NETtelemetryRecordGameTimeReceived(uint8_t player, uint32_t checkTime)
+{
+	ASSERT_OR_RETURN(, player < MAX_CONNECTED_PLAYERS, "Invalid player: %u", static_cast<unsigned>(player));
+	const auto& record = telemetry().gameTimeSent[gameTimeSentSlot(checkTime)];
+	if (record.checkTime != checkTime || record.sentAt == std::chrono::steady_clock::time_point())
+	{
+		return; // Too old (or we never sent one for this checkTime).
+	}
+	auto latency = std::chrono::steady_clock::now() - record.sentAt;
+	telemetry().gameTimeLatency[player].record(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+}
+
+nlohmann::ordered_json NETtelemetryToJSON()
+{
+	const auto& t = telemetry();
+
+	auto root = nlohmann::ordered_json::object();
+	root["uptime_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t.startTime).count();
+
+	auto messages = nlohmann::ordered_json::array();
+	for (size_t i = 0; i < NUM_MESSAGE_TYPES; ++i)
+	{
+		const auto& sent = t.messagesSent[i];
+		const auto& received = t.messagesReceived[i];
+		if (sent.count.load(std::memory_order_relaxed) == 0 && received.count.load(std::memory_order_relaxed) == 0)
+		{
+			continue;
+		}
+		auto j = nlohmann::ordered_json::object();
+		j["type"] = messageTypeToString(static_cast<unsigned>(i));
+		j["id"] = i;
+		j["sent"] = sent.toJSON();
+		j["recv"] = received.toJSON();
+		messages.push_back(std::move(j));
+	}
+	root["messages"] = std::move(messages);
+
+	auto connections = nlohmann::ordered_json::array();
+	for (size_t i = 0; i < MAX_CONNECTED_PLAYERS; ++i)
+	{
+		const auto& sent = t.connectionsSent[i];
+		const auto& received = t.connectionsReceived[i];
+		const auto& gameTimeLatency = t.gameTimeLatency[i];
+		if (sent.rawBytes.load(std::memory_order_relaxed) == 0 && sent.uncompressedBytes.load(std::memory_order_relaxed) == 0
+			&& received.rawBytes.load(std::memory_order_relaxed) == 0 && received.uncompressedBytes.load(std::memory_order_relaxed) == 0
+			&& gameTimeLatency.empty())
+		{
+			continue;
+		}
+		auto j = nlohmann::ordered_json::object();
+		j["player"] = i;
+		j["sent"] = sent.toJSON();
+		j["recv"] = received.toJSON();
+		if (!gameTimeLatency.empty())
+		{
+			j["gametime_latency"] = gameTimeLatency.toJSON();
+		}
+		connections.push_back(std::move(j));
+	}
+	root["connections"] = std::move(connections);
+
+	root["pending_write_wait"] = t.pendingWriteWait.toJSON();
+
+	return root;
+}
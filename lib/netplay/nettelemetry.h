@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file nettelemetry.h
+ *
+ * Always-on network counters and latency histograms.
+ *
+ * Unlike the netlog (which is only active while a log file is open), these counters are
+ * always collected. All recording functions only perform relaxed atomic increments, so they
+ * are safe to call from the network threads as well as the main thread.
+ */
+#pragma once
+
+#include <chrono>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <nlohmann/json_fwd.hpp>
+
+/// Reset all counters and histograms.
+void NETtelemetryReset();
+
+/// Record a message of the specified type (uncompressed size, including header).
+void NETtelemetryRecordMessage(uint8_t type, uint32_t size, bool received);
+
+/// Record traffic on the connection to / from the specified player.
+/// `rawBytes` is the amount of data actually transferred (i.e. after compression).
+/// Compressed sockets only report their raw bytes when flushed; pass `uncompressedBytes == 0` for those, so they aren't counted as packets.
+void NETtelemetryRecordConnectionTraffic(uint8_t player, size_t rawBytes, size_t uncompressedBytes, bool received);
+
+/// Record how long data waited in the `PendingWritesManager` submission queue before it was completely written to the socket.
+void NETtelemetryRecordPendingWriteWait(std::chrono::steady_clock::duration wait);
+
+/// Record that we have sent our GAME_GAME_TIME message for `checkTime`.
+void NETtelemetryRecordGameTimeSent(uint32_t checkTime);
+/// Record that we have received the GAME_GAME_TIME message for `checkTime` from `player`.
+/// The recorded latency is the time between sending our own GAME_GAME_TIME for the same `checkTime` and receiving theirs.
+void NETtelemetryRecordGameTimeReceived(uint8_t player, uint32_t checkTime);
+
+/// Returns a snapshot of all non-empty counters and histograms.
+nlohmann::ordered_json NETtelemetryToJSON();
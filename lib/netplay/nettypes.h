@@ -203,6 +203,8 @@ public:
 	virtual bool saveMap(EmbeddedMapData& mapData) const = 0;
 	virtual bool optionsUpdatePlayerInfo(nlohmann::json& object) const = 0;
 	virtual bool restoreOptions(const nlohmann::json& object, EmbeddedMapData&& embeddedMapData, uint32_t replay_netcodeMajor, uint32_t replay_netcodeMinor) = 0;
+	virtual bool saveEndOfGameInfo(nlohmann::json& object) const = 0;
+	virtual bool restoreEndOfGameInfo(const nlohmann::json& object) = 0;
 	virtual size_t desiredBufferSize() const = 0;
 	virtual size_t maximumEmbeddedMapBufferSize() const = 0;
 };
@@ -26,6 +26,7 @@
 #include "lib/netplay/client_connection.h"
 #include "lib/netplay/wz_connection_provider.h"
 #include "lib/netplay/error_categories.h"
+#include "lib/netplay/nettelemetry.h"
 
 #include <system_error>
 
@@ -102,7 +103,7 @@ void PendingWritesManager::populateWritableSet(IDescriptorSet& writableSet)
 	for (auto it = pendingWrites_.begin(); it != pendingWrites_.end();)
 	{
 		const auto& pendingConnWrite = *it;
-		if (!pendingConnWrite.second.empty())
+		if (!pendingConnWrite.second.queue.empty())
 		{
 			writableSet.add(pendingConnWrite.first);
 			++it;
@@ -141,7 +142,7 @@ void PendingWritesManager::threadImplFunction()
 				++connIt;
 
 				IClientConnection* conn = currentIt->first;
-				ConnectionWriteQueue& writeQueue = currentIt->second;
+				ConnectionWriteQueue& writeQueue = currentIt->second.queue;
 				ASSERT(!writeQueue.empty(), "writeQueue[sock] must not be empty.");
 
 				if (!writableSet_->isSet(conn) || writeQueue.empty())
@@ -157,6 +158,7 @@ void PendingWritesManager::threadImplFunction()
 					writeQueue.erase(writeQueue.begin(), writeQueue.begin() + retSent.value());
 					if (writeQueue.empty())
 					{
+						NETtelemetryRecordPendingWriteWait(std::chrono::steady_clock::now() - currentIt->second.queuedSince);
 						pendingWrites_.erase(currentIt);  // Nothing left to write, delete from pending list.
 						if (conn->deleteLaterRequested())
 						{
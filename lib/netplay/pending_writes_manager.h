@@ -110,8 +110,12 @@ public:
 			{
 				wzSemaphorePost(sema_);
 			}
-			ConnectionWriteQueue& writeQueue = pendingWrites_[conn];
-			appendFn(writeQueue);
+			PendingConnectionWrite& pendingWrite = pendingWrites_[conn];
+			if (pendingWrite.queue.empty())
+			{
+				pendingWrite.queuedSince = std::chrono::steady_clock::now();
+			}
+			appendFn(pendingWrite.queue);
 		});
 	}
 
@@ -137,7 +141,14 @@ public:
 
 private:
 
-	using ConnectionThreadWriteMap = std::unordered_map<IClientConnection*, ConnectionWriteQueue>;
+	struct PendingConnectionWrite
+	{
+		ConnectionWriteQueue queue;
+		/// When the queue last became non-empty. Used for the pending write wait time telemetry.
+		std::chrono::steady_clock::time_point queuedSince;
+	};
+
+	using ConnectionThreadWriteMap = std::unordered_map<IClientConnection*, PendingConnectionWrite>;
 
 	friend int pendingWritesThreadFunction(void*);
 
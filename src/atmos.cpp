@@ -26,6 +26,7 @@
 #include "lib/framework/frame.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/piepalette.h"
+#include "lib/ivis_opengl/pieparticles.h"
 
 #include "atmos.h"
 #include "display3d.h"
@@ -318,7 +319,7 @@ void atmosUpdateSystem()
 	}
 }
 
-static inline void renderParticleInternal(ATPART *psPart, const glm::mat4 &viewMatrix, const glm::mat4& rotateScaleMatrix)
+static inline glm::mat4 particleModelMatrix(const ATPART *psPart, const glm::mat4& rotateScaleMatrix)
 {
 	glm::vec3 dv;
 
@@ -328,9 +329,7 @@ static inline void renderParticleInternal(ATPART *psPart, const glm::mat4 &viewM
 	dv.z = -(psPart->position.z);
 	/* Make it face camera */
 	/* Scale it... */
-	const glm::mat4 modelMatrix = glm::translate(dv) * rotateScaleMatrix;
-	pie_Draw3DShape(psPart->imd->displayModel(), 0, 0, WZCOL_WHITE, 0, 0, modelMatrix, viewMatrix);
-	/* Draw it... */
+	return glm::translate(dv) * rotateScaleMatrix;
 }
 
 void atmosDrawParticles(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
@@ -347,6 +346,7 @@ void atmosDrawParticles(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiv
 		glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(0.f, 1.f, 0.f));
 	glm::mat4 rotateScaleMatrix = rotateMatrix;
 	UDWORD last_particle_size = 0;
+	static ParticleBatcher particleBatcher;  // Static, to save allocations.
 
 	/* Traverse the list */
 	for (i = 0; i < MAX_ATMOS_PARTICLES; i++)
@@ -362,10 +362,13 @@ void atmosDrawParticles(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiv
 					rotateScaleMatrix = rotateMatrix * glm::scale(glm::vec3(asAtmosParts[i].size / 100.f));
 					last_particle_size = asAtmosParts[i].size;
 				}
-				renderParticleInternal(&asAtmosParts[i], viewMatrix, rotateScaleMatrix);
+				particleBatcher.add(asAtmosParts[i].imd->displayModel(), 0, PIE_PARTICLE{particleModelMatrix(&asAtmosParts[i], rotateScaleMatrix), WZCOL_WHITE, 0, 0});
 			}
 		}
 	}
+
+	/* Draw them all at once */
+	particleBatcher.flush();
 }
 
 void renderParticle(ATPART *psPart, const glm::mat4 &viewMatrix)
@@ -373,7 +376,7 @@ void renderParticle(ATPART *psPart, const glm::mat4 &viewMatrix)
 	const glm::mat4 rotateScaleMatrix = glm::rotate(UNDEG(-playerPos.r.y), glm::vec3(0.f, 1.f, 0.f)) *
 		glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(0.f, 1.f, 0.f)) *
 		glm::scale(glm::vec3(psPart->size / 100.f));
-	renderParticleInternal(psPart, viewMatrix, rotateScaleMatrix);
+	pie_Draw3DShape(psPart->imd->displayModel(), 0, 0, WZCOL_WHITE, 0, 0, particleModelMatrix(psPart, rotateScaleMatrix), viewMatrix);
 }
 
 void atmosSetWeatherType(WT_CLASS type)
@@ -47,19 +47,86 @@
 // someone needs to take a good look at the radius calculation
 #define SCALE_DEPTH (FP12_MULTIPLIER*7)
 
-struct BUCKET_TAG
+/* Render keys - the objects are drawn in increasing key order:
+ * bits 62-63: pass (opaque objects first, then depth sorted objects, then particles)
+ * bits 30-61: opaque: texture page (so objects using the same texture are drawn together)
+ *             depth sorted: inverted depth (so they are drawn back to front)
+ * bits 22-29: object type (each type has its own render function and shader state)
+ */
+enum RENDER_PASS
 {
-	bool operator <(BUCKET_TAG const &b) const
-	{
-		return actualZ > b.actualZ;    // Sort in reverse z order.
-	}
+	RENDER_PASS_OPAQUE,
+	RENDER_PASS_DEPTH_SORTED,
+	RENDER_PASS_PARTICLES
+};
+
+static inline uint64_t bucketRenderKey(RENDER_PASS pass, uint32_t materialOrDepth, RENDER_TYPE objectType)
+{
+	return (static_cast<uint64_t>(pass) << 62) | (static_cast<uint64_t>(materialOrDepth) << 30) | (static_cast<uint64_t>(objectType) << 22);
+}
+
+static inline uint64_t bucketOpaqueKey(RENDER_TYPE objectType, const iIMDShape *pie)
+{
+	return bucketRenderKey(RENDER_PASS_OPAQUE, static_cast<uint32_t>(pie->getTextures().texpage), objectType);
+}
 
+struct BUCKET_TAG
+{
+	uint64_t        renderKey;
 	RENDER_TYPE     objectType; //type of object held
 	void           *pObject;    //pointer to the object
-	int32_t         actualZ;
 };
 
 static std::vector<BUCKET_TAG> bucketArray;
+static std::vector<BUCKET_TAG> bucketSortBuffer;
+
+/// Sorts the tags by render key (stable), with a radix sort that skips the bytes all keys have in common
+static void bucketSortTags(std::vector<BUCKET_TAG> &tags, std::vector<BUCKET_TAG> &buffer)
+{
+	const size_t count = tags.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	uint32_t histograms[8][256] = {};
+	for (const BUCKET_TAG &tag : tags)
+	{
+		for (unsigned byte = 0; byte < 8; ++byte)
+		{
+			++histograms[byte][(tag.renderKey >> (byte * 8)) & 0xFF];
+		}
+	}
+
+	buffer.resize(count);
+	BUCKET_TAG *src = tags.data();
+	BUCKET_TAG *dst = buffer.data();
+	for (unsigned byte = 0; byte < 8; ++byte)
+	{
+		uint32_t *histogram = histograms[byte];
+		const unsigned shift = byte * 8;
+		if (histogram[(src[0].renderKey >> shift) & 0xFF] == count)
+		{
+			continue; // the same in all keys
+		}
+		uint32_t offset = 0;
+		for (unsigned digit = 0; digit < 256; ++digit)
+		{
+			const uint32_t digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			dst[histogram[(src[i].renderKey >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+	if (src != tags.data())
+	{
+		tags.swap(buffer);
+	}
+}
 
 static SDWORD bucketCalculateZ(RENDER_TYPE objectType, void *pObject, const glm::mat4 &perspectiveViewMatrix)
 {
@@ -337,47 +404,40 @@ void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4
 		case EFFECT_SMOKE:
 		case EFFECT_FIREWORK:
 			// Use calculated Z
-			break;
-
-		case EFFECT_WAYPOINT:
-			pie = ((EFFECT *)pObject)->imd;
-			z = INT32_MAX - pie->getTextures().texpage;
+			newTag.renderKey = bucketRenderKey(RENDER_PASS_DEPTH_SORTED, UINT32_MAX - static_cast<uint32_t>(z), objectType);
 			break;
 
 		default:
-			z = INT32_MAX - 42;
+			pie = ((EFFECT *)pObject)->imd;
+			newTag.renderKey = (pie != nullptr) ? bucketOpaqueKey(objectType, pie) : bucketRenderKey(RENDER_PASS_OPAQUE, 0, objectType);
 			break;
 		}
 		break;
 	case RENDER_DROID:
-		pie = BODY_IMD(((DROID *)pObject), 0)->displayModel();
-		z = INT32_MAX - pie->getTextures().texpage;
+		newTag.renderKey = bucketOpaqueKey(objectType, BODY_IMD(((DROID *)pObject), 0)->displayModel());
 		break;
 	case RENDER_STRUCTURE:
-		pie = ((STRUCTURE *)pObject)->sDisplay.imd->displayModel();
-		z = INT32_MAX - pie->getTextures().texpage;
+		newTag.renderKey = bucketOpaqueKey(objectType, ((STRUCTURE *)pObject)->sDisplay.imd->displayModel());
 		break;
 	case RENDER_FEATURE:
-		pie = ((FEATURE *)pObject)->sDisplay.imd->displayModel();
-		z = INT32_MAX - pie->getTextures().texpage;
+		newTag.renderKey = bucketOpaqueKey(objectType, ((FEATURE *)pObject)->sDisplay.imd->displayModel());
 		break;
 	case RENDER_DELIVPOINT:
-		pie = pAssemblyPointIMDs[((FLAG_POSITION *)pObject)->
-		                         factoryType][((FLAG_POSITION *)pObject)->factoryInc]->displayModel();
-		z = INT32_MAX - pie->getTextures().texpage;
+		newTag.renderKey = bucketOpaqueKey(objectType, pAssemblyPointIMDs[((FLAG_POSITION *)pObject)->
+		                         factoryType][((FLAG_POSITION *)pObject)->factoryInc]->displayModel());
 		break;
 	case RENDER_PARTICLE:
-		z = 0;
+		newTag.renderKey = bucketRenderKey(RENDER_PASS_PARTICLES, 0, objectType);
 		break;
 	default:
 		// Use calculated Z
+		newTag.renderKey = bucketRenderKey(RENDER_PASS_DEPTH_SORTED, UINT32_MAX - static_cast<uint32_t>(z), objectType);
 		break;
 	}
 
 	//put the object data into the tag
 	newTag.objectType = objectType;
 	newTag.pObject = pObject;
-	newTag.actualZ = z;
 
 	//add tag to bucketArray
 	bucketArray.push_back(newTag);
@@ -387,10 +447,16 @@ void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4
 void bucketRenderCurrentList(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
 	WZ_PROFILE_SCOPE(bucketRenderCurrentList);
-	std::sort(bucketArray.begin(), bucketArray.end());
+	bucketSortTags(bucketArray, bucketSortBuffer);
 
 	for (auto thisTag = bucketArray.cbegin(); thisTag != bucketArray.cend(); ++thisTag)
 	{
+		// Effects are batched until the next object that isn't an effect, so they keep their place in the draw order
+		if (thisTag != bucketArray.cbegin() && (thisTag - 1)->objectType == RENDER_EFFECT && thisTag->objectType != RENDER_EFFECT)
+		{
+			renderEffectParticles();
+		}
+
 		switch (thisTag->objectType)
 		{
 		case RENDER_PARTICLE:
@@ -420,6 +486,8 @@ void bucketRenderCurrentList(const glm::mat4 &viewMatrix, const glm::mat4 &persp
 		}
 	}
 
+	renderEffectParticles();
+
 	//reset the bucket array as we go
 	bucketArray.resize(0);
 }
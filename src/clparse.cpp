@@ -30,6 +30,7 @@
 #include "lib/netplay/netplay.h"
 #include "lib/ivis_opengl/pieclip.h"
 #include "lib/ivis_opengl/png_util.h"
+#include "lib/ivis_opengl/gfx_api.h"
 
 #include "levels.h"
 #include "clparse.h"
@@ -47,6 +48,7 @@
 #include "gamehistorylogger.h"
 #include "stdinreader.h"
 #include "seqdisp.h"
+#include "replayverify.h"
 
 #include <cwchar>
 
@@ -315,6 +317,9 @@ typedef enum
 	CLI_LOADSKIRMISH,
 	CLI_LOADCAMPAIGN,
 	CLI_LOADREPLAY,
+	CLI_VERIFYREPLAY,
+	CLI_VERIFYREPLAYS,
+	CLI_VERIFYREPLAYS_JOBS,
 	CLI_WINDOW,
 	CLI_VERSION,
 	CLI_RESOLUTION,
@@ -338,6 +343,7 @@ typedef enum
 	CLI_CONTINUE,
 	CLI_AUTOHOST,
 	CLI_AUTOHEADLESS,
+	CLI_HEADLESSRENDER,
 #if defined(WZ_OS_WIN)
 	CLI_WIN_ENABLE_CONSOLE,
 #endif
@@ -398,6 +404,9 @@ static const struct poptOption *getOptionsTable()
 		{ "loadskirmish", POPT_ARG_STRING, CLI_LOADSKIRMISH, N_("Load a saved skirmish game"),     N_("savegame") },
 		{ "loadcampaign", POPT_ARG_STRING, CLI_LOADCAMPAIGN, N_("Load a saved campaign game"),     N_("savegame") },
 		{ "loadreplay", POPT_ARG_STRING, CLI_LOADREPLAY, N_("Load a replay"),     N_("replay file") },
+		{ "verifyreplay", POPT_ARG_NONE, CLI_VERIFYREPLAY, N_("Play back the replay (--loadreplay) as fast as possible and verify its sync CRCs and final game state"), nullptr },
+		{ "verifyreplays", POPT_ARG_STRING, CLI_VERIFYREPLAYS, N_("Verify all replays in a replay directory using headless child processes"), N_("replay directory") },
+		{ "verifyreplays-jobs", POPT_ARG_STRING, CLI_VERIFYREPLAYS_JOBS, N_("Number of replays to verify at once (default: number of CPU cores)"), N_("jobs") },
 		{ "window", POPT_ARG_NONE, CLI_WINDOW,     N_("Play in windowed mode"),             nullptr },
 		{ "version", POPT_ARG_NONE, CLI_VERSION,    N_("Show version information and exit"), nullptr },
 		{ "resolution", POPT_ARG_STRING, CLI_RESOLUTION, N_("Set the resolution to use"),         N_("WIDTHxHEIGHT") },
@@ -428,6 +437,7 @@ static const struct poptOption *getOptionsTable()
 		},
 		{ "autogame", POPT_ARG_NONE, CLI_AUTOGAME,   N_("Run games automatically for testing"), nullptr },
 		{ "headless", POPT_ARG_NONE, CLI_AUTOHEADLESS,   N_("Headless mode (only supported when also specifying --autogame, --autohost, --skirmish)"), nullptr },
+		{ "headlessrender", POPT_ARG_NONE, CLI_HEADLESSRENDER,   N_("Still prepare the 3D scene in headless mode (to benchmark rendering, e.g. with --verifyreplay)"), nullptr },
 		{ "saveandquit", POPT_ARG_STRING, CLI_SAVEANDQUIT, N_("Immediately save game and quit"), N_("save name") },
 		{ "skirmish", POPT_ARG_STRING, CLI_SKIRMISH,   N_("Start skirmish game with given settings file"), N_("test") },
 		{ "continue", POPT_ARG_NONE, CLI_CONTINUE,   N_("Continue the last saved game"), nullptr },
@@ -961,6 +971,34 @@ bool ParseCommandLine(int argc, const char * const *argv)
 			SetGameMode(GS_SAVEGAMELOAD);
 			break;
 		}
+		case CLI_VERIFYREPLAY:
+			replayVerifySetEnabled(true);
+			// no frame pacing - the null backend otherwise simulates vsync
+			war_SetVsync(to_int(gfx_api::context::swap_interval_mode::immediate));
+			break;
+		case CLI_VERIFYREPLAYS:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr || strlen(token) == 0)
+			{
+				qFatal("Missing replay directory");
+			}
+			replayVerifySetBatchDir(token);
+			break;
+		case CLI_VERIFYREPLAYS_JOBS:
+		{
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Bad verifyreplays-jobs value");
+			}
+			int token_intval = atoi(token);
+			if (token_intval <= 0)
+			{
+				qFatal("Invalid verifyreplays-jobs value");
+			}
+			replayVerifySetBatchJobs(static_cast<unsigned>(token_intval));
+			break;
+		}
 		case CLI_CONTINUE:
 			if (findLastSave())
 			{
@@ -1081,6 +1119,10 @@ bool ParseCommandLine(int argc, const char * const *argv)
 			setHeadlessGameMode(true);
 			break;
 
+		case CLI_HEADLESSRENDER:
+			setHeadlessRender(true);
+			break;
+
 		case CLI_GAMEPORT:
 			token = poptGetOptArg(poptCon);
 			if (token == nullptr)
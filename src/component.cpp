@@ -914,14 +914,11 @@ void displayComponentButtonObject(const DROID *psDroid, const Vector3i *Rotation
 	displayCompObj(psDroid, true, matrix, glm::mat4(1.f));
 }
 
-/* Assumes matrix context is already set */
-// multiple turrets display removed the pointless mountRotation
-void displayComponentObject(DROID *psDroid, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+bool prepareComponentObject(DROID *psDroid, const glm::mat4 &perspectiveViewMatrix, ComponentObjectRenderData &data)
 {
 	Vector3i position, rotation;
-	Spacetime st = interpolateObjectSpacetime(psDroid, graphicsTime);
-
-	leftFirst = angleDelta(playerPos.r.y - st.rot.direction) <= 0;
+	const Spacetime st = interpolateObjectSpacetime(psDroid, graphicsTime);
+	data.st = st;
 
 	/* Get the real position */
 	position.x = st.pos.x;
@@ -940,20 +937,45 @@ void displayComponentObject(DROID *psDroid, const glm::mat4 &viewMatrix, const g
 
 	/* Translate origin */
 	/* Rotate for droid */
-	glm::mat4 modelMatrix = glm::translate(glm::vec3(position)) *
+	data.modelMatrix = glm::translate(glm::vec3(position)) *
 		glm::rotate(UNDEG(rotation.y), glm::vec3(0.f, 1.f, 0.f)) *
 		glm::rotate(UNDEG(rotation.x), glm::vec3(1.f, 0.f, 0.f)) *
 		glm::rotate(UNDEG(rotation.z), glm::vec3(0.f, 0.f, 1.f));
 
-	if (psDroid->timeLastHit - graphicsTime < ELEC_DAMAGE_DURATION && psDroid->lastHitWeapon == WSC_ELECTRONIC)
+	// objectShimmy() uses rand(), so droids that shimmy are clipped by displayComponentObject()
+	data.shimmy = psDroid->timeLastHit - graphicsTime < ELEC_DAMAGE_DURATION && psDroid->lastHitWeapon == WSC_ELECTRONIC;
+
+	// now check if the projected circle is within the screen boundaries
+	return data.shimmy || clipDroidOnScreen(psDroid, perspectiveViewMatrix * data.modelMatrix, (getIsCloseDistance()) ? 150 : 25);
+}
+
+/* Assumes matrix context is already set */
+// multiple turrets display removed the pointless mountRotation
+void displayComponentObject(DROID *psDroid, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+{
+	ComponentObjectRenderData data;
+	if (prepareComponentObject(psDroid, perspectiveViewMatrix, data))
 	{
-		modelMatrix *= objectShimmy((BASE_OBJECT *) psDroid);
+		displayComponentObject(psDroid, data, viewMatrix, perspectiveViewMatrix);
 	}
+}
 
-	// now check if the projected circle is within the screen boundaries
-	if(!clipDroidOnScreen(psDroid, perspectiveViewMatrix * modelMatrix, (getIsCloseDistance()) ? 150 : 25))
+void displayComponentObject(DROID *psDroid, const ComponentObjectRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+{
+	const Spacetime &st = data.st;
+	glm::mat4 modelMatrix = data.modelMatrix;
+
+	leftFirst = angleDelta(playerPos.r.y - st.rot.direction) <= 0;
+
+	if (data.shimmy)
 	{
-		return;
+		modelMatrix *= objectShimmy((BASE_OBJECT *) psDroid);
+
+		// now check if the projected circle is within the screen boundaries
+		if (!clipDroidOnScreen(psDroid, perspectiveViewMatrix * modelMatrix, (getIsCloseDistance()) ? 150 : 25))
+		{
+			return;
+		}
 	}
 
 	if (psDroid->lastHitWeapon == WSC_EMP && graphicsTime - psDroid->timeLastHit < EMP_DISABLE_TIME)
@@ -25,9 +25,18 @@
 #include "droiddef.h"
 #include "structuredef.h"
 #include <glm/fwd.hpp>
+#include <glm/mat4x4.hpp>
 
 struct iIMDShape;
 
+/// What displayComponentObject() needs that can be computed on worker threads, see prepareComponentObject()
+struct ComponentObjectRenderData
+{
+	Spacetime st;            ///< Interpolated to graphicsTime
+	glm::mat4 modelMatrix;   ///< Without the shimmy of droids hit by electronic weapons
+	bool shimmy = false;
+};
+
 /*
 	Header file for component.c
 	Pumpkin Studios, EIDOS Interactive.
@@ -71,6 +80,10 @@ void displayResearchButton(const BASE_STATS *Stat, const Vector3i *Rotation, con
 void displayComponentButtonTemplate(const DROID_TEMPLATE *psTemplate, const Vector3i *Rotation, const Vector3i *Position, int scale);
 void displayComponentButtonObject(const DROID *psDroid, const Vector3i *Rotation, const Vector3i *Position, int scale);
 void displayComponentObject(DROID *psDroid, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
+/// Computes the model matrix of `psDroid`, and returns false if it is known to be off screen.
+/// Only reads shared state, so it can run on worker threads.
+bool prepareComponentObject(DROID *psDroid, const glm::mat4 &perspectiveViewMatrix, ComponentObjectRenderData &data);
+void displayComponentObject(DROID *psDroid, const ComponentObjectRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 
 void compPersonToBits(DROID *psDroid, Vector3f &velocity);
 
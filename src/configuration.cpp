@@ -34,6 +34,8 @@
 #include "lib/ivis_opengl/screen.h"
 #include "lib/ivis_opengl/pieclip.h"
 #include "lib/ivis_opengl/piestate.h" // for fog
+#include "lib/ivis_opengl/imd.h" // for the model cache
+#include "lib/ivis_opengl/piedraw.h" // for parallel frame preparation
 
 #include "ai.h"
 #include "component.h"
@@ -671,6 +673,13 @@ bool loadConfig()
 	war_setAutoNotReadyKickSeconds(iniGetInteger("hostAutoNotReadyKickSeconds", war_getAutoNotReadyKickSeconds()).value());
 	war_setDisableReplayRecording(iniGetBool("disableReplayRecord", war_getDisableReplayRecording()).value());
 	war_setMaxReplaysSaved(iniGetInteger("maxReplaysSaved", war_getMaxReplaysSaved()).value());
+	war_setCompressReplays(iniGetBool("compressReplays", war_getCompressReplays()).value());
+	war_setBinarySaveSnapshots(iniGetBool("binarySaveSnapshots", war_getBinarySaveSnapshots()).value());
+	war_setAsyncAutosave(iniGetBool("asyncAutosave", war_getAsyncAutosave()).value());
+	war_setIncrementalAutosave(iniGetBool("incrementalAutosave", war_getIncrementalAutosave()).value());
+	modelSetBinaryCacheEnabled(iniGetBool("modelBinaryCache", modelGetBinaryCacheEnabled()).value());
+	gfx_api::setCompressedTextureCacheEnabled(iniGetBool("textureCache", gfx_api::getCompressedTextureCacheEnabled()).value());
+	pie_SetParallelFramePreparation(iniGetBool("parallelFramePreparation", pie_GetParallelFramePreparation()).value());
 	war_setOldLogsLimit(iniGetInteger("oldLogsLimit", war_getOldLogsLimit()).value());
 	int openSpecSlotsIntValue = iniGetInteger("openSpectatorSlotsMP", war_getMPopenSpectatorSlots()).value();
 	war_setMPopenSpectatorSlots(static_cast<uint16_t>(std::max<int>(0, std::min<int>(openSpecSlotsIntValue, MAX_SPECTATOR_SLOTS))));
@@ -897,6 +906,13 @@ bool saveConfig()
 	iniSetInteger("hostAutoNotReadyKickSeconds", war_getAutoNotReadyKickSeconds());
 	iniSetBool("disableReplayRecord", war_getDisableReplayRecording());
 	iniSetInteger("maxReplaysSaved", war_getMaxReplaysSaved());
+	iniSetBool("compressReplays", war_getCompressReplays());
+	iniSetBool("binarySaveSnapshots", war_getBinarySaveSnapshots());
+	iniSetBool("asyncAutosave", war_getAsyncAutosave());
+	iniSetBool("incrementalAutosave", war_getIncrementalAutosave());
+	iniSetBool("modelBinaryCache", modelGetBinaryCacheEnabled());
+	iniSetBool("textureCache", gfx_api::getCompressedTextureCacheEnabled());
+	iniSetBool("parallelFramePreparation", pie_GetParallelFramePreparation());
 	iniSetInteger("oldLogsLimit", war_getOldLogsLimit());
 	iniSetInteger("fogEnd", war_getFogEnd());
 	iniSetInteger("fogStart", war_getFogStart());
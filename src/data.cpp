@@ -32,6 +32,7 @@
 #include "lib/framework/strres.h"
 #include "lib/framework/crc.h"
 #include "lib/ivis_opengl/bitimage.h"
+#include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/png_util.h"
 #include "lib/sound/audio.h"
 
@@ -108,6 +109,31 @@ static void calcDataHash(const WzConfig &ini, uint32_t index)
 	calcDataHash(reinterpret_cast<const uint8_t *>(jsonDump.data()), jsonDump.size(), index);
 }
 
+// Loads all models the stats in ini refer to in one go, so they are parsed in parallel instead of one at a time by the stats loader
+static void preloadStatsModels(const WzConfig &ini)
+{
+	std::vector<WzString> modelNames;
+	std::function<void (const nlohmann::json &)> collectModelNames = [&](const nlohmann::json &value) {
+		if (value.is_string())
+		{
+			const std::string &str = value.get_ref<const std::string &>();
+			if (str.size() > 4 && strcasecmp(str.c_str() + str.size() - 4, ".pie") == 0)
+			{
+				modelNames.push_back(WzString::fromUtf8(str));
+			}
+		}
+		else if (value.is_structured())
+		{
+			for (const auto &item : value)
+			{
+				collectModelNames(item);
+			}
+		}
+	};
+	collectModelNames(ini.currentJsonValue());
+	modelPreload(modelNames);
+}
+
 void resetDataHash()
 {
 	UDWORD i;
@@ -135,6 +161,7 @@ static bool bufferSBODYLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SBODY);
+	preloadStatsModels(ini);
 
 	if (!loadBodyStats(ini) || !allocComponentList(COMP_BODY, asBodyStats.size()))
 	{
@@ -157,6 +184,7 @@ static bool bufferSWEAPONLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SWEAPON);
+	preloadStatsModels(ini);
 
 	if (!loadWeaponStats(ini)
 	    || !allocComponentList(COMP_WEAPON, asWeaponStats.size()))
@@ -174,6 +202,7 @@ static bool bufferSCONSTRLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SCONSTR);
+	preloadStatsModels(ini);
 
 	if (!loadConstructStats(ini)
 	    || !allocComponentList(COMP_CONSTRUCT, asConstructStats.size()))
@@ -191,6 +220,7 @@ static bool bufferSECMLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SECM);
+	preloadStatsModels(ini);
 
 	if (!loadECMStats(ini)
 	    || !allocComponentList(COMP_ECM, asECMStats.size()))
@@ -208,6 +238,7 @@ static bool bufferSPROPLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SPROP);
+	preloadStatsModels(ini);
 
 	if (!loadPropulsionStats(ini) || !allocComponentList(COMP_PROPULSION, asPropulsionStats.size()))
 	{
@@ -223,6 +254,7 @@ static bool bufferSSENSORLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SSENSOR);
+	preloadStatsModels(ini);
 
 	if (!loadSensorStats(ini)
 	    || !allocComponentList(COMP_SENSOR, asSensorStats.size()))
@@ -240,6 +272,7 @@ static bool bufferSREPAIRLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SREPAIR);
+	preloadStatsModels(ini);
 
 	if (!loadRepairStats(ini) || !allocComponentList(COMP_REPAIRUNIT, asRepairStats.size()))
 	{
@@ -361,6 +394,7 @@ static bool bufferSSTRUCTLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SSTRUCT);
+	preloadStatsModels(ini);
 
 	if (!loadStructureStats(ini))
 	{
@@ -405,6 +439,7 @@ static bool bufferSFEATLoad(const char *fileName, void **ppData)
 {
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_SFEAT);
+	preloadStatsModels(ini);
 
 	if (!loadFeatureStats(ini))
 	{
@@ -440,6 +475,7 @@ static bool bufferRESCHLoad(const char *fileName, void **ppData)
 
 	WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
 	calcDataHash(ini, DATA_RESCH);
+	preloadStatsModels(ini);
 
 	if (!loadResearch(ini))
 	{
@@ -1210,7 +1210,7 @@ bool CheckScrollLimits()
 /* Do the 3D display */
 void displayWorld()
 {
-	if (headlessGameMode())
+	if (headlessGameMode() && !headlessRenderEnabled())
 	{
 		return;
 	}
@@ -26,6 +26,7 @@
 #include "lib/framework/frame.h"
 #include "lib/framework/math_ext.h"
 #include "lib/framework/stdio_ext.h"
+#include "lib/framework/parallel_for.h"
 
 /* Includes direct access to render library */
 #include "lib/ivis_opengl/pieblitfunc.h"
@@ -51,6 +52,7 @@
 #endif
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/matrix_interpolation.hpp>
+#include <chrono>
 
 #include "loop.h"
 #include "atmos.h"
@@ -94,6 +96,24 @@
 
 /********************  Prototypes  ********************/
 
+/// What renderStructure() needs that can be computed on worker threads, see prepareStructure()
+struct StructureRenderData
+{
+	glm::mat4 modelMatrix;  ///< Without the shimmy of structures hit by electronic weapons
+	PIELIGHT brightness;
+};
+
+/// What renderFeature() needs that can be computed on worker threads, see prepareFeature()
+struct FeatureRenderData
+{
+	const iIMDShape *imd = nullptr;
+	glm::mat4 modelMatrix;  ///< Without the shimmy of skyscrapers
+	bool shimmy = false;
+	PIELIGHT brightness;
+	int pieFlags = 0;
+	float stretchDepth = 0.f;
+};
+
 static void displayDelivPoints(const glm::mat4& viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 static void displayProximityMsgs(const glm::mat4& viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 static void displayDynamicObjects(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
@@ -104,7 +124,11 @@ static void	drawGroupNumber(BASE_OBJECT *psObject);
 static void	trackHeight(int desiredHeight);
 static void	renderSurroundings(const glm::mat4& projectionMatrix, const glm::mat4 &skyboxViewMatrix);
 static void	locateMouse();
-static bool	renderWallSection(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
+static void	prepareStructure(STRUCTURE *psStructure, StructureRenderData &data);
+static void	renderStructure(STRUCTURE *psStructure, const StructureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
+static bool	renderWallSection(STRUCTURE *psStructure, const StructureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
+static bool	prepareFeature(FEATURE *psFeature, const glm::mat4 &perspectiveViewMatrix, FeatureRenderData &data);
+static void	renderFeature(FEATURE *psFeature, const FeatureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 static void	drawDragBox();
 static void	calcFlagPosScreenCoords(SDWORD *pX, SDWORD *pY, SDWORD *pR, const glm::mat4 &perspectiveViewModelMatrix);
 static void	drawTiles(iView *player, LightingData& lightData, LightMap& lightmap, ILightingManager& lightManager);
@@ -295,6 +319,9 @@ static BASE_OBJECT *psSensorObj = nullptr;
 static UDWORD	destTargetX, destTargetY;
 static UDWORD	destTileX = 0, destTileY = 0;
 
+/// CPU time spent preparing the models of each frame (culling, batching, instance data)
+static FramePreparationStats framePreparationStats;
+
 struct Blueprint
 {
 	Blueprint()
@@ -1456,6 +1483,7 @@ static void drawTiles(iView *player, LightingData& lightData, LightMap& lightmap
 	perFrameTerrainUpdates(lightmap);
 
 	// and prepare for rendering the models
+	const auto framePreparationStart = std::chrono::steady_clock::now();
 	wzPerfBegin(PERF_MODEL_INIT, "Draw 3D scene - model init");
 
 	/* ---------------------------------------------------------------- */
@@ -1487,6 +1515,8 @@ static void drawTiles(iView *player, LightingData& lightData, LightMap& lightmap
 
 	pie_UpdateLightmap(getTerrainLightmapTexture(), getModelUVLightmapMatrix());
 	pie_FinalizeMeshes(currentGameFrame);
+	++framePreparationStats.frames;
+	framePreparationStats.totalMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - framePreparationStart).count();
 
 
 	// shadow/depth-mapping passes
@@ -2007,6 +2037,50 @@ void	renderProjectile(PROJECTILE *psCurr, const glm::mat4 &viewMatrix, const glm
 	}
 }
 
+/// Culls `objects` and prepares the visible ones for rendering (on worker threads, if parallel frame preparation is enabled),
+/// then renders them on this thread, in their original order (so the batched instances end up in the same order as before).
+/// prepare returns whether the object is visible, and fills in its Prepared data (model matrices and the like) if it is.
+/// It must only read shared state, and only write to the object it prepares.
+template <typename Prepared, typename ObjectType, typename PrepareFunc, typename RenderFunc>
+static void prepareAndRenderObjects(const std::vector<ObjectType *> &objects, const PrepareFunc &prepare, const RenderFunc &render)
+{
+	constexpr size_t prepareChunkSize = 64;
+	static std::vector<uint8_t> visible;
+	static std::vector<Prepared> prepared;
+	visible.resize(objects.size());
+	if (prepared.size() < objects.size())
+	{
+		prepared.resize(objects.size());
+	}
+	auto prepareChunk = [&](size_t chunk) {
+		const size_t end = std::min(objects.size(), (chunk + 1) * prepareChunkSize);
+		for (size_t i = chunk * prepareChunkSize; i < end; ++i)
+		{
+			visible[i] = prepare(objects[i], prepared[i]) ? 1 : 0;
+		}
+	};
+	const size_t numChunks = (objects.size() + prepareChunkSize - 1) / prepareChunkSize;
+	if (pie_GetParallelFramePreparation() && numChunks > 1)
+	{
+		wzParallelFor(numChunks, prepareChunk);
+	}
+	else
+	{
+		for (size_t chunk = 0; chunk < numChunks; ++chunk)
+		{
+			prepareChunk(chunk);
+		}
+	}
+
+	for (size_t i = 0; i < objects.size(); ++i)
+	{
+		if (visible[i])
+		{
+			render(objects[i], prepared[i]);
+		}
+	}
+}
+
 /// Draw the buildings
 static void displayStaticObjects(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
@@ -2014,49 +2088,40 @@ static void displayStaticObjects(const glm::mat4 &viewMatrix, const glm::mat4 &p
 	// to solve the flickering edges of baseplates
 //	pie_SetDepthOffset(-1.0f);
 
-	/* Go through all the players */
+	/* Go through all the buildings of all players, then through the destroyed objects */
+	static std::vector<STRUCTURE *> structures;
+	structures.clear();
 	for (unsigned aPlayer = 0; aPlayer < MAX_PLAYERS; ++aPlayer)
 	{
-		/* Now go all buildings for that player */
 		for (BASE_OBJECT* obj : apsStructLists[aPlayer])
 		{
-			/* Worth rendering the structure? */
-			if (obj->type != OBJ_STRUCTURE || (obj->died != 0 && obj->died < graphicsTime)
-				|| !quickClipXYToMaximumTilesFromCurrentPosition(obj->pos.x, obj->pos.y))
+			if (obj->type == OBJ_STRUCTURE)
 			{
-				continue;
-			}
-			STRUCTURE *psStructure = castStructure(obj);
-
-			if (!clipStructureOnScreen(psStructure))
-			{
-				continue;
+				structures.push_back(castStructure(obj));
 			}
-
-			renderStructure(psStructure, viewMatrix, perspectiveViewMatrix);
 		}
 	}
-
-	// Walk through destroyed objects.
-
-	/* Now go all buildings for that player */
 	for (BASE_OBJECT* obj : psDestroyedObj)
 	{
-		/* Worth rendering the structure? */
-		if (obj->type != OBJ_STRUCTURE || (obj->died != 0 && obj->died < graphicsTime)
-			|| !quickClipXYToMaximumTilesFromCurrentPosition(obj->pos.x, obj->pos.y))
+		if (obj->type == OBJ_STRUCTURE)
 		{
-			continue;
+			structures.push_back(castStructure(obj));
 		}
-		STRUCTURE* psStructure = castStructure(obj);
+	}
 
-		if (!clipStructureOnScreen(psStructure))
+	prepareAndRenderObjects<StructureRenderData>(structures, [](STRUCTURE *psStructure, StructureRenderData &data) {
+		/* Worth rendering the structure? */
+		if ((psStructure->died == 0 || psStructure->died >= graphicsTime)
+			&& quickClipXYToMaximumTilesFromCurrentPosition(psStructure->pos.x, psStructure->pos.y)
+			&& clipStructureOnScreen(psStructure))
 		{
-			continue;
+			prepareStructure(psStructure, data);
+			return true;
 		}
-
-		renderStructure(psStructure, viewMatrix, perspectiveViewMatrix);
-	}
+		return false;
+	}, [&](STRUCTURE *psStructure, const StructureRenderData &data) {
+		renderStructure(psStructure, data, viewMatrix, perspectiveViewMatrix);
+	});
 
 //	pie_SetDepthOffset(0.0f);
 }
@@ -2321,36 +2386,41 @@ bool clipFeatureOnScreen(FEATURE *psFeature)
 static void displayFeatures(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
 	WZ_PROFILE_SCOPE(displayFeatures);
-	// player can only be 0 for the features.
+	auto render = [&](FEATURE *psFeature, const FeatureRenderData &data) {
+		renderFeature(psFeature, data, viewMatrix, perspectiveViewMatrix);
+	};
 
-	/* Go through all the features */
+	// player can only be 0 for the features.
+	static std::vector<FEATURE *> features;
+	features.clear();
 	for (BASE_OBJECT* obj : apsFeatureLists[0])
 	{
-		if (obj->type == OBJ_FEATURE
-			&& (obj->died == 0 || obj->died > graphicsTime)
-			&& quickClipXYToMaximumTilesFromCurrentPosition(obj->pos.x, obj->pos.y))
+		if (obj->type == OBJ_FEATURE)
 		{
-			FEATURE* psFeature = castFeature(obj);
-			if (clipFeatureOnScreen(psFeature))
-			{
-				renderFeature(psFeature, viewMatrix, perspectiveViewMatrix);
-			}
+			features.push_back(castFeature(obj));
 		}
 	}
+	prepareAndRenderObjects<FeatureRenderData>(features, [&](FEATURE *psFeature, FeatureRenderData &data) {
+		return (psFeature->died == 0 || psFeature->died > graphicsTime)
+			&& quickClipXYToMaximumTilesFromCurrentPosition(psFeature->pos.x, psFeature->pos.y)
+			&& clipFeatureOnScreen(psFeature)
+			&& prepareFeature(psFeature, perspectiveViewMatrix, data);
+	}, render);
 
 	// Walk through destroyed objects.
-
-	/* Go through all the features */
+	features.clear();
 	for (BASE_OBJECT* obj : psDestroyedObj)
 	{
-		if (obj->type == OBJ_FEATURE
-			&& (obj->died == 0 || obj->died > graphicsTime)
-			&& clipXY(obj->pos.x, obj->pos.y))
+		if (obj->type == OBJ_FEATURE)
 		{
-			FEATURE* psFeature = castFeature(obj);
-			renderFeature(psFeature, viewMatrix, perspectiveViewMatrix);
+			features.push_back(castFeature(obj));
 		}
 	}
+	prepareAndRenderObjects<FeatureRenderData>(features, [&](FEATURE *psFeature, FeatureRenderData &data) {
+		return (psFeature->died == 0 || psFeature->died > graphicsTime)
+			&& clipXY(psFeature->pos.x, psFeature->pos.y)
+			&& prepareFeature(psFeature, perspectiveViewMatrix, data);
+	}, render);
 }
 
 /// Draw the Proximity messages for the *SELECTED PLAYER ONLY*
@@ -2400,41 +2470,42 @@ static void displayProximityMsgs(const glm::mat4& viewMatrix, const glm::mat4 &p
 static void displayDynamicObjects(const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
 	WZ_PROFILE_SCOPE(displayDynamicObjects);
-	/* Need to go through all the droid lists */
+	/* Need to go through all the droid lists, then through the destroyed objects */
+	static std::vector<DROID *> droids;
+	droids.clear();
 	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
 	{
 		for (DROID* psDroid : apsDroidLists[player])
 		{
-			if (!psDroid || (psDroid->died != 0 && psDroid->died < graphicsTime)
-			    || !quickClipXYToMaximumTilesFromCurrentPosition(psDroid->pos.x, psDroid->pos.y))
+			if (psDroid)
 			{
-				continue;
-			}
-
-			/* No point in adding it if you can't see it? */
-			if (psDroid->visibleForLocalDisplay())
-			{
-				displayComponentObject(psDroid, viewMatrix, perspectiveViewMatrix);
+				droids.push_back(psDroid);
 			}
 		}
 	}
-
-	// Walk through destroyed objects.
 	for (const auto& obj : psDestroyedObj)
 	{
 		DROID* psDroid = castDroid(obj);
-		if (!psDroid || (obj->died != 0 && obj->died < graphicsTime)
-			|| !quickClipXYToMaximumTilesFromCurrentPosition(obj->pos.x, obj->pos.y))
+		if (psDroid)
 		{
-			continue;
+			droids.push_back(psDroid);
 		}
+	}
 
+	prepareAndRenderObjects<ComponentObjectRenderData>(droids, [&](DROID *psDroid, ComponentObjectRenderData &data) {
 		/* No point in adding it if you can't see it? */
-		if (psDroid->visibleForLocalDisplay())
-		{
-			displayComponentObject(psDroid, viewMatrix, perspectiveViewMatrix);
-		}
-	}
+		return (psDroid->died == 0 || psDroid->died >= graphicsTime)
+			&& quickClipXYToMaximumTilesFromCurrentPosition(psDroid->pos.x, psDroid->pos.y)
+			&& psDroid->visibleForLocalDisplay()
+			&& prepareComponentObject(psDroid, perspectiveViewMatrix, data);
+	}, [&](DROID *psDroid, const ComponentObjectRenderData &data) {
+		displayComponentObject(psDroid, data, viewMatrix, perspectiveViewMatrix);
+	});
+}
+
+FramePreparationStats getFramePreparationStats()
+{
+	return framePreparationStats;
 }
 
 /// Sets the player's position and view angle - defaults player rotations as well
@@ -2491,8 +2562,9 @@ void setViewDistance(float dist)
 	debug(LOG_WZ, _("Setting zoom to %.0f"), distance);
 }
 
-/// Draw a feature (tree/rock/etc.)
-void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+/// Computes the model matrix, brightness and the like of `psFeature`, and returns false if it isn't drawn.
+/// Only writes to psFeature, so it can run on worker threads.
+static bool prepareFeature(FEATURE *psFeature, const glm::mat4 &perspectiveViewMatrix, FeatureRenderData &data)
 {
 	PIELIGHT brightness = pal_SetBrightness(200);
 	bool bForceDraw = (getRevealStatus() && psFeature->psStats->visibleAtStart);
@@ -2500,7 +2572,7 @@ void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::m
 
 	if (!psFeature->visibleForLocalDisplay() && !bForceDraw)
 	{
-		return;
+		return false;
 	}
 
 	/* Mark it as having been drawn */
@@ -2509,7 +2581,7 @@ void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::m
 	/* Daft hack to get around the oil derrick issue */
 	if (!TileHasFeature(mapTile(map_coord(psFeature->pos.xy()))))
 	{
-		return;
+		return false;
 	}
 
 	Vector3i dv = Vector3i(
@@ -2524,14 +2596,16 @@ void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::m
 	rotation.x = psFeature->rot.pitch;
 	rotation.z = psFeature->rot.roll;
 
-	glm::mat4 modelMatrix = glm::translate(glm::vec3(dv)) *
+	data.modelMatrix = glm::translate(glm::vec3(dv)) *
 		glm::rotate(UNDEG(rotation.y), glm::vec3(0.f, 1.f, 0.f)) *
 		glm::rotate(UNDEG(rotation.x), glm::vec3(1.f, 0.f, 0.f)) *
 		glm::rotate(UNDEG(rotation.z), glm::vec3(0.f, 0.f, 1.f));
 
-	if (psFeature->psStats->subType == FEAT_SKYSCRAPER)
+	// objectShimmy() uses rand(), so it is left to renderFeature()
+	data.shimmy = psFeature->psStats->subType == FEAT_SKYSCRAPER;
+	if (!data.shimmy)
 	{
-		modelMatrix *= objectShimmy((BASE_OBJECT *)psFeature);
+		setScreenDispWithPerspective(&psFeature->sDisplay, perspectiveViewMatrix * data.modelMatrix);
 	}
 
 	if (!getRevealStatus())
@@ -2544,6 +2618,7 @@ void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::m
 		brightness.byte.g /= 2;
 		brightness.byte.b /= 2;
 	}
+	data.brightness = brightness;
 
 	if (psFeature->psStats->subType == FEAT_BUILDING
 	    || psFeature->psStats->subType == FEAT_SKYSCRAPER
@@ -2556,27 +2631,55 @@ void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::m
 		/* these cast a shadow */
 		pieFlags = pie_SHADOW;
 	}
+	data.pieFlags = pieFlags;
 
+	data.imd = nullptr;
+	data.stretchDepth = 0.f;
 	iIMDBaseShape *imd = psFeature->sDisplay.imd;
 	if (imd)
 	{
-		const iIMDShape *strImd = imd->displayModel();
+		data.imd = imd->displayModel();
 
-		float stretchDepth = 0.f;
-		if (!(strImd->flags & iV_IMD_NOSTRETCH))
+		if (!(data.imd->flags & iV_IMD_NOSTRETCH))
 		{
 			if (psFeature->psStats->subType == FEAT_TREE) // for now, only do this for trees
 			{
-				stretchDepth = psFeature->pos.z - psFeature->foundationDepth;
+				data.stretchDepth = psFeature->pos.z - psFeature->foundationDepth;
 			}
 		}
+	}
+	return true;
+}
+
+static void renderFeature(FEATURE *psFeature, const FeatureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+{
+	glm::mat4 modelMatrix = data.modelMatrix;
+	if (data.shimmy)
+	{
+		modelMatrix *= objectShimmy((BASE_OBJECT *)psFeature);
+	}
 
+	if (data.imd)
+	{
 		/* Translate the feature  - N.B. We can also do rotations here should we require
 		buildings to face different ways - Don't know if this is necessary - should be IMO */
-		pie_Draw3DShape(strImd, 0, 0, brightness, pieFlags, 0, modelMatrix, viewMatrix, stretchDepth);
+		pie_Draw3DShape(data.imd, 0, 0, data.brightness, data.pieFlags, 0, modelMatrix, viewMatrix, data.stretchDepth);
 	}
 
-	setScreenDispWithPerspective(&psFeature->sDisplay, perspectiveViewMatrix * modelMatrix);
+	if (data.shimmy)
+	{
+		setScreenDispWithPerspective(&psFeature->sDisplay, perspectiveViewMatrix * modelMatrix);
+	}
+}
+
+/// Draw a feature (tree/rock/etc.)
+void	renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+{
+	FeatureRenderData data;
+	if (prepareFeature(psFeature, perspectiveViewMatrix, data))
+	{
+		renderFeature(psFeature, data, viewMatrix, perspectiveViewMatrix);
+	}
 }
 
 void renderProximityMsg(PROXIMITY_DISPLAY *psProxDisp, const glm::mat4& viewMatrix, const glm::mat4 &perspectiveViewMatrix)
@@ -2900,8 +3003,28 @@ static void renderStructureTurrets(STRUCTURE *psStructure, const iIMDShape *strI
 	}
 }
 
+/// Computes the model matrix and brightness of `psStructure`. Only reads shared state, so it can run on worker threads.
+static void prepareStructure(STRUCTURE *psStructure, StructureRenderData &data)
+{
+	Vector3i dv = Vector3i(psStructure->pos.x, psStructure->pos.z, -(psStructure->pos.y));
+	if (psStructure->pStructureType->type == REF_WALL || psStructure->pStructureType->type == REF_WALLCORNER
+	    || psStructure->pStructureType->type == REF_GATE)
+	{
+		dv.y -= gateCurrentOpenHeight(psStructure, graphicsTime, 1);  // Make gate stick out by 1 unit, so that the tops of ┼ gates can safely have heights differing by 1 unit.
+	}
+	data.modelMatrix = glm::translate(glm::vec3(dv)) * glm::rotate(UNDEG(-psStructure->rot.direction), glm::vec3(0.f, 1.f, 0.f));
+	data.brightness = structureBrightness(psStructure);
+}
+
 /// Draw the structures
 void renderStructure(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+{
+	StructureRenderData data;
+	prepareStructure(psStructure, data);
+	renderStructure(psStructure, data, viewMatrix, perspectiveViewMatrix);
+}
+
+static void renderStructure(STRUCTURE *psStructure, const StructureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
 	int colour, pieFlagData, ecmFlag = 0, pieFlag = 0;
 	PIELIGHT buildingBrightness;
@@ -2912,12 +3035,12 @@ void renderStructure(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const
 	const iIMDShape *strImd = getFactionDisplayIMD(faction, psStructure->sDisplay.imd->displayModel());
 	MAPTILE *psTile = worldTile(psStructure->pos.x, psStructure->pos.y);
 
-	glm::mat4 modelMatrix = glm::translate(glm::vec3(dv)) * glm::rotate(UNDEG(-psStructure->rot.direction), glm::vec3(0.f, 1.f, 0.f));
+	glm::mat4 modelMatrix = data.modelMatrix;
 
 	if (psStructure->pStructureType->type == REF_WALL || psStructure->pStructureType->type == REF_WALLCORNER
 	    || psStructure->pStructureType->type == REF_GATE)
 	{
-		renderWallSection(psStructure, viewMatrix, perspectiveViewMatrix);
+		renderWallSection(psStructure, data, viewMatrix, perspectiveViewMatrix);
 		return;
 	}
 	// If the structure is not truly visible, but we know there is something there, we will instead draw a blip
@@ -2957,7 +3080,7 @@ void renderStructure(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const
 		bHitByElectronic = true;
 	}
 
-	buildingBrightness = structureBrightness(psStructure);
+	buildingBrightness = data.brightness;
 
 	if (!defensive)
 	{
@@ -3095,11 +3218,10 @@ void renderDeliveryPoint(FLAG_POSITION *psPosition, bool blueprint, const glm::m
 	psPosition->screenR = r;
 }
 
-static bool renderWallSection(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
+static bool renderWallSection(STRUCTURE *psStructure, const StructureRenderData &data, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix)
 {
 	int ecmFlag = 0;
 	PIELIGHT		brightness;
-	Vector3i			dv;
 	int				pieFlag, pieFlagData;
 	MAPTILE			*psTile = worldTile(psStructure->pos.x, psStructure->pos.y);
 	const FACTION *faction = getPlayerFaction(psStructure->player);
@@ -3116,17 +3238,11 @@ static bool renderWallSection(STRUCTURE *psStructure, const glm::mat4 &viewMatri
 
 	psStructure->sDisplay.frameNumber = currentGameFrame;
 
-	brightness = structureBrightness(psStructure);
+	brightness = data.brightness;
 	float stretch = psStructure->pos.z - psStructure->foundationDepth;
 
-	/* Establish where it is in the world */
-	dv.x = psStructure->pos.x;
-	dv.z = -(psStructure->pos.y);
-	dv.y = psStructure->pos.z;
-
-	dv.y -= gateCurrentOpenHeight(psStructure, graphicsTime, 1);  // Make gate stick out by 1 unit, so that the tops of ┼ gates can safely have heights differing by 1 unit.
-
-	const glm::mat4 modelMatrix = glm::translate(glm::vec3(dv)) * glm::rotate(UNDEG(-psStructure->rot.direction), glm::vec3(0.f, 1.f, 0.f));
+	/* Established by prepareStructure(), including the height of the gate */
+	const glm::mat4 &modelMatrix = data.modelMatrix;
 
 	/* Actually render it */
 	if (psStructure->status == SS_BEING_BUILT)
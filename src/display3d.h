@@ -78,6 +78,14 @@ void disp3d_oldView(); // for save games <= 10
 void disp3d_getView(iView *newView);
 void screenCoordToWorld(const Vector2i, Vector2i&, SDWORD&, SDWORD&);
 void draw3DScene();
+
+struct FramePreparationStats
+{
+	uint64_t frames = 0;
+	uint64_t totalMicroseconds = 0;	///< Time spent culling and batching the models, and generating their instance data
+};
+FramePreparationStats getFramePreparationStats();
+
 void renderStructure(STRUCTURE *psStructure, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 void renderFeature(FEATURE *psFeature, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
 void renderProximityMsg(PROXIMITY_DISPLAY	*psProxDisp, const glm::mat4 &viewMatrix, const glm::mat4 &perspectiveViewMatrix);
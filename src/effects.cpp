@@ -41,7 +41,6 @@
 #include "lib/framework/input.h"
 #include "lib/framework/math_ext.h"
 #include "lib/framework/file.h"
-#include "lib/framework/paged_entity_container.h"
 
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/pietypes.h"
@@ -51,6 +50,7 @@
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/piemode.h"
+#include "lib/ivis_opengl/pieparticles.h"
 #include "lib/ivis_opengl/imd.h"
 
 #include "lib/gamelib/gtime.h"
@@ -77,6 +77,8 @@
 #endif
 #include <glm/gtx/transform.hpp>
 
+#include <array>
+
 #define	GRAVITON_GRAVITY	((float)-800)
 #define	EFFECT_X_FLIP		0x1
 #define	EFFECT_Y_FLIP		0x2
@@ -157,7 +159,22 @@
 #define SHOCKWAVE_SPEED	(GAME_TICKS_PER_SEC)
 #define	MAX_SHOCKWAVE_SIZE				500
 
-static PagedEntityContainer<EFFECT> gActiveEffects;
+/// The states of the effects in the pools, as set by processEffects()
+enum EFFECT_STATE : uint8_t
+{
+	EFFECT_STATE_WAITING,	// not in the world yet (birthTime is in the future)
+	EFFECT_STATE_ACTIVE,
+	EFFECT_STATE_EXPIRED,	// to be removed
+};
+
+/// The effects of each group, stored contiguously so that each group is updated in one batch
+static std::array<std::vector<EFFECT>, EFFECT_FREED> gEffectPools;
+static std::array<std::vector<uint8_t>, EFFECT_FREED> gEffectStates;
+/// Effects added since they were last moved into the pools. The pools only change in processEffects(),
+/// so the effects it puts in the render buckets stay at the same address until the frame is drawn.
+static std::vector<EFFECT> gNewEffects;
+/// The billboard effects passed to renderEffect() since the last renderEffectParticles()
+static ParticleBatcher effectParticles;
 
 /* Tick counts for updates on a particular interval */
 static	UDWORD	lastUpdateStructures[EFFECT_STRUCTURE_DIVISION];
@@ -177,15 +194,15 @@ static bool rejectLandLight(LAND_LIGHT_SPEC type);
 // ---- Update functions - every group type of effect has one of these */
 static bool updateWaypoint(EFFECT *psEffect);
 static bool updateExplosion(EFFECT *psEffect, LightingData& lightData);
-static bool updatePolySmoke(EFFECT *psEffect);
+static void updatePolySmoke(EFFECT *effects, uint8_t *states, size_t count);
 static bool updateGraviton(EFFECT *psEffect, LightingData& lightData);
-static bool updateConstruction(EFFECT *psEffect);
-static bool updateBlood(EFFECT *psEffect);
+static void updateConstruction(EFFECT *effects, uint8_t *states, size_t count);
+static void updateBlood(EFFECT *effects, uint8_t *states, size_t count);
 static bool updateDestruction(EFFECT *psEffect, LightingData& lightData);
 static bool updateFire(EFFECT *psEffect, LightingData& lightData);
 static bool updateSatLaser(EFFECT *psEffect, LightingData& lightData);
 static bool updateFirework(EFFECT *psEffect);
-static bool updateEffect(EFFECT *psEffect, LightingData& lightData);	// MASTER function
+static void updateEffectGroup(EFFECT_GROUP group, EFFECT *effects, uint8_t *states, size_t count, LightingData& lightData);	// MASTER function
 
 // ----------------------------------------------------------------------------------------
 // ---- The render functions - every group type of effect has a distinct one
@@ -220,7 +237,15 @@ static UDWORD effectGetNumFrames(EFFECT *psEffect);
 
 void shutdownEffectsSystem()
 {
-	gActiveEffects.clear();
+	for (auto &pool : gEffectPools)
+	{
+		pool.clear();
+	}
+	for (auto &states : gEffectStates)
+	{
+		states.clear();
+	}
+	gNewEffects.clear();
 }
 
 /*!
@@ -469,7 +494,23 @@ void addEffect(const Vector3i *pos, EFFECT_GROUP group, EFFECT_TYPE type, bool s
 
 	ASSERT(effect.imd != nullptr || group == EFFECT_DESTRUCTION || group == EFFECT_FIRE || group == EFFECT_SAT_LASER, "null effect imd");
 
-	gActiveEffects.emplace(std::move(effect));
+	gNewEffects.push_back(std::move(effect));
+}
+
+/* Moves the effects added since the last call into the pools of their groups */
+static void addNewEffectsToPools()
+{
+	for (EFFECT &effect : gNewEffects)
+	{
+		if (effect.group >= EFFECT_FREED)
+		{
+			ASSERT(false, "Weirdy group type for an effect");
+			continue;
+		}
+		gEffectPools[effect.group].push_back(std::move(effect));
+		gEffectStates[effect.group].push_back(EFFECT_STATE_WAITING);
+	}
+	gNewEffects.clear();
 }
 
 
@@ -477,20 +518,54 @@ void addEffect(const Vector3i *pos, EFFECT_GROUP group, EFFECT_TYPE type, bool s
 void processEffects(const glm::mat4 &perspectiveViewMatrix, LightingData& lightData)
 {
 	WZ_PROFILE_SCOPE(processEffects);
-	for (auto it = gActiveEffects.begin(); it != gActiveEffects.end(); ++it)
+
+	// Effects added by the updates (e.g. the explosion of a graviton hitting the ground) are updated in the same frame
+	std::array<size_t, EFFECT_FREED> updatedCount = {};
+	do
 	{
-		EFFECT& e = *it;
+		addNewEffectsToPools();
+		for (size_t group = 0; group < gEffectPools.size(); ++group)
+		{
+			std::vector<EFFECT> &pool = gEffectPools[group];
+			std::vector<uint8_t> &states = gEffectStates[group];
+			const size_t begin = updatedCount[group];
+			for (size_t i = begin; i < pool.size(); ++i)
+			{
+				// Don't process, if it doesn't exist yet
+				states[i] = (pool[i].birthTime <= graphicsTime) ? EFFECT_STATE_ACTIVE : EFFECT_STATE_WAITING;
+			}
+			updateEffectGroup(static_cast<EFFECT_GROUP>(group), pool.data() + begin, states.data() + begin, pool.size() - begin, lightData);
+			updatedCount[group] = pool.size();
+		}
+	} while (!gNewEffects.empty());
 
-		if (e.birthTime <= graphicsTime)  // Don't process, if it doesn't exist yet
+	for (size_t group = 0; group < gEffectPools.size(); ++group)
+	{
+		std::vector<EFFECT> &pool = gEffectPools[group];
+		std::vector<uint8_t> &states = gEffectStates[group];
+
+		// Remove the expired effects in one pass, keeping the order of the others
+		size_t kept = 0;
+		for (size_t i = 0; i < pool.size(); ++i)
 		{
-			if (!updateEffect(&e, lightData))
+			if (states[i] != EFFECT_STATE_EXPIRED)
 			{
-				gActiveEffects.erase(it);
-				continue;
+				if (kept != i)
+				{
+					pool[kept] = std::move(pool[i]);
+					states[kept] = states[i];
+				}
+				++kept;
 			}
-			if (e.group != EFFECT_FREED && clipXY(static_cast<SDWORD>(e.position.x), static_cast<SDWORD>(e.position.z)))
+		}
+		pool.resize(kept);
+		states.resize(kept);
+
+		for (size_t i = 0; i < pool.size(); ++i)
+		{
+			if (states[i] == EFFECT_STATE_ACTIVE && clipXY(static_cast<SDWORD>(pool[i].position.x), static_cast<SDWORD>(pool[i].position.z)))
 			{
-				bucketAddTypeToList(RENDER_EFFECT, &e, perspectiveViewMatrix);
+				bucketAddTypeToList(RENDER_EFFECT, &pool[i], perspectiveViewMatrix);
 			}
 		}
 	}
@@ -499,75 +574,160 @@ void processEffects(const glm::mat4 &perspectiveViewMatrix, LightingData& lightD
 	effectStructureUpdates();
 }
 
-/* The general update function for all effects - calls a specific one for each. Returns false if effect should be deleted. */
-static bool updateEffect(EFFECT *psEffect, LightingData& lightData)
+/* Runs the update function of each active effect of a batch, and marks the ones it returns false for as expired */
+template <typename UpdateFunc>
+static void updateEachEffect(EFFECT *effects, uint8_t *states, size_t count, UpdateFunc update)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (states[i] == EFFECT_STATE_ACTIVE && !update(&effects[i]))
+		{
+			states[i] = EFFECT_STATE_EXPIRED;
+		}
+	}
+}
+
+/* The general update function for all effects - updates a batch of effects of one group at once. Marks the effects that should be deleted as expired. */
+static void updateEffectGroup(EFFECT_GROUP group, EFFECT *effects, uint8_t *states, size_t count, LightingData& lightData)
 {
 	/* What type of effect are we dealing with? */
-	switch (psEffect->group)
+	switch (group)
 	{
 	case EFFECT_EXPLOSION:
-		return updateExplosion(psEffect, lightData);
+		updateEachEffect(effects, states, count, [&lightData](EFFECT *psEffect) { return updateExplosion(psEffect, lightData); });
+		return;
+	case EFFECT_DROID_ANIMEVENT_DYING:
+		updateEachEffect(effects, states, count, updateDroidDeathAnimationEffect);
+		return;
+	case EFFECT_FREED:
+		debug(LOG_ERROR, "Weirdy class of effect passed to updateEffectGroup");
+		abort();
+	default:
+		break;
+	}
+
+	if (gamePaused())
+	{
+		/* The other effects are frozen while the game is paused */
+		return;
+	}
+
+	switch (group)
+	{
 	case EFFECT_WAYPOINT:
-		if (!gamePaused())
-		{
-			return updateWaypoint(psEffect);
-		}
-		return true;
+		updateEachEffect(effects, states, count, updateWaypoint);
+		break;
 	case EFFECT_CONSTRUCTION:
-		if (!gamePaused())
-		{
-			return updateConstruction(psEffect);
-		}
-		return true;
+		updateConstruction(effects, states, count);
+		break;
 	case EFFECT_SMOKE:
-		if (!gamePaused())
-		{
-			return updatePolySmoke(psEffect);
-		}
-		return true;
+		updatePolySmoke(effects, states, count);
+		break;
 	case EFFECT_GRAVITON:
-		if (!gamePaused())
-		{
-			return updateGraviton(psEffect, lightData);
-		}
-		return true;
+		updateEachEffect(effects, states, count, [&lightData](EFFECT *psEffect) { return updateGraviton(psEffect, lightData); });
+		break;
 	case EFFECT_BLOOD:
-		if (!gamePaused())
-		{
-			return updateBlood(psEffect);
-		}
-		return true;
+		updateBlood(effects, states, count);
+		break;
 	case EFFECT_DESTRUCTION:
-		if (!gamePaused())
+		updateEachEffect(effects, states, count, [&lightData](EFFECT *psEffect) { return updateDestruction(psEffect, lightData); });
+		break;
+	case EFFECT_FIRE:
+		updateEachEffect(effects, states, count, [&lightData](EFFECT *psEffect) { return updateFire(psEffect, lightData); });
+		break;
+	case EFFECT_SAT_LASER:
+		updateEachEffect(effects, states, count, [&lightData](EFFECT *psEffect) { return updateSatLaser(psEffect, lightData); });
+		break;
+	case EFFECT_FIREWORK:
+		updateEachEffect(effects, states, count, updateFirework);
+		break;
+	default:
+		break;
+	}
+}
+
+// ----------------------------------------------------------------------------------------
+// BATCHED UPDATE KERNELS - the steps shared by the groups
+// ----------------------------------------------------------------------------------------
+/// How the animation frames of an effect advance
+enum class FrameStep
+{
+	Once,		///< at most one frame per update, counting the next frame delay from the current time
+	CatchUp,	///< as many frames as the elapsed time covers
+};
+
+/**
+	Advances the animation frame of an effect. When it passes the last frame, wrap(effect) decides whether it
+	starts again from the first frame (and may change the effect). Returns false if the effect should be killed off.
+*/
+template <typename WrapFunc>
+static inline bool advanceEffectFrame(EFFECT &effect, FrameStep step, WrapFunc wrap)
+{
+	while (graphicsTime - effect.lastFrame > effect.frameDelay)
+	{
+		/* Store away last frame change time */
+		effect.lastFrame = (step == FrameStep::CatchUp) ? effect.lastFrame + effect.frameDelay : graphicsTime;
+
+		/* Are we on the last frame? */
+		if (++effect.frameNumber >= effectGetNumFrames(&effect))
 		{
-			return updateDestruction(psEffect, lightData);
+			if (!wrap(effect))
+			{
+				return false;
+			}
+			effect.frameNumber = 0;
 		}
-		return true;
-	case EFFECT_FIRE:
-		if (!gamePaused())
+	}
+	return true;
+}
+
+/** Advances the animation frames of the active effects of a batch, see advanceEffectFrame() */
+template <typename WrapFunc>
+static void advanceEffectFrames(EFFECT *effects, uint8_t *states, size_t count, FrameStep step, WrapFunc wrap)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (states[i] == EFFECT_STATE_ACTIVE && !advanceEffectFrame(effects[i], step, wrap))
 		{
-			return updateFire(psEffect, lightData);
+			states[i] = EFFECT_STATE_EXPIRED;
 		}
-		return true;
-	case EFFECT_SAT_LASER:
-		if (!gamePaused())
+	}
+}
+
+/** Moves the active effects of a batch along their velocity */
+static void moveEffects(EFFECT *effects, const uint8_t *states, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (states[i] == EFFECT_STATE_ACTIVE)
 		{
-			return updateSatLaser(psEffect, lightData);
+			effects[i].position.x += graphicsTimeAdjustedIncrement(effects[i].velocity.x);
+			effects[i].position.y += graphicsTimeAdjustedIncrement(effects[i].velocity.y);
+			effects[i].position.z += graphicsTimeAdjustedIncrement(effects[i].velocity.z);
 		}
-		return true;
-	case EFFECT_FIREWORK:
-		if (!gamePaused())
+	}
+}
+
+/** Kills off the cyclic effects of a batch that have overstayed their welcome */
+static void expireCyclicEffects(EFFECT *effects, uint8_t *states, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (states[i] == EFFECT_STATE_ACTIVE && TEST_CYCLIC((&effects[i])) && graphicsTime - effects[i].birthTime > effects[i].lifeSpan)
 		{
-			return updateFirework(psEffect);
+			states[i] = EFFECT_STATE_EXPIRED;
 		}
-		return true;
-	case EFFECT_DROID_ANIMEVENT_DYING:
-		return updateDroidDeathAnimationEffect(psEffect);
-	case EFFECT_FREED:
-		break;
 	}
-	debug(LOG_ERROR, "Weirdy class of effect passed to updateEffect");
-	abort();
+}
+
+static bool wrapCyclicEffect(const EFFECT &effect)
+{
+	return TEST_CYCLIC((&effect));
+}
+
+static bool neverWrapEffect(const EFFECT &)
+{
+	return false;
 }
 
 // ----------------------------------------------------------------------------------------
@@ -660,25 +820,10 @@ static bool updateFirework(EFFECT *psEffect)
 	}
 	else	// must be a startburst
 	{
-		/* Time to update the frame number on the smoke sprite */
-		if (graphicsTime - psEffect->lastFrame > psEffect->frameDelay)
+		/* Time to update the frame number on the smoke sprite - does the anim wrap around? */
+		if (!advanceEffectFrame(*psEffect, FrameStep::Once, wrapCyclicEffect))
 		{
-			/* Store away last frame change time */
-			psEffect->lastFrame = graphicsTime;
-
-			/* Are we on the last frame? */
-			if (++psEffect->frameNumber >= effectGetNumFrames(psEffect))
-			{
-				/* Does the anim wrap around? */
-				if (TEST_CYCLIC(psEffect))
-				{
-					psEffect->frameNumber = 0;
-				}
-				else
-				{
-					return false; /* Kill it off */
-				}
-			}
+			return false; /* Kill it off */
 		}
 
 		/* If it doesn't get killed by frame number, then by age */
@@ -833,24 +978,11 @@ static bool updateExplosion(EFFECT *psEffect, LightingData& lightData)
 			return false; /* Kill it off */
 		}
 	}
-	/* Time to update the frame number on the explosion */
-	else while (graphicsTime - psEffect->lastFrame > psEffect->frameDelay)
-		{
-			psEffect->lastFrame += psEffect->frameDelay;
-			/* Are we on the last frame? */
-
-			if (++psEffect->frameNumber >= effectGetNumFrames(psEffect))
-			{
-				if (psEffect->type != EXPLOSION_TYPE_LAND_LIGHT)
-				{
-					return false; /* Kill it off */
-				}
-				else
-				{
-					psEffect->frameNumber = 0;
-				}
-			}
-		}
+	/* Time to update the frame number on the explosion - only land lights wrap around */
+	else if (!advanceEffectFrame(*psEffect, FrameStep::CatchUp, [](const EFFECT &effect) { return effect.type == EXPLOSION_TYPE_LAND_LIGHT; }))
+	{
+		return false; /* Kill it off */
+	}
 
 	if (!gamePaused())
 	{
@@ -864,74 +996,39 @@ static bool updateExplosion(EFFECT *psEffect, LightingData& lightData)
 }
 
 /** The update function for blood */
-static bool updateBlood(EFFECT *psEffect)
+static void updateBlood(EFFECT *effects, uint8_t *states, size_t count)
 {
-	/* Time to update the frame number on the blood */
-	if (graphicsTime - psEffect->lastFrame > psEffect->frameDelay)
-	{
-		psEffect->lastFrame = graphicsTime;
-		/* Are we on the last frame? */
-		if (++psEffect->frameNumber >= effectGetNumFrames(psEffect))
-		{
-			return false; /* Kill it off */
-		}
-	}
+	/* Time to update the frame number on the blood - kill it off after the last frame */
+	advanceEffectFrames(effects, states, count, FrameStep::Once, neverWrapEffect);
 	/* Move it about in the world */
-	psEffect->position.x += graphicsTimeAdjustedIncrement(psEffect->velocity.x);
-	psEffect->position.y += graphicsTimeAdjustedIncrement(psEffect->velocity.y);
-	psEffect->position.z += graphicsTimeAdjustedIncrement(psEffect->velocity.z);
-	return true;
+	moveEffects(effects, states, count);
 }
 
 /** Processes all the drifting smoke. Handles the smoke puffing out the factory as well. */
-static bool updatePolySmoke(EFFECT *psEffect)
+static void updatePolySmoke(EFFECT *effects, uint8_t *states, size_t count)
 {
-	/* Time to update the frame number on the smoke sprite */
-	while (graphicsTime - psEffect->lastFrame > psEffect->frameDelay)
-	{
-		/* Store away last frame change time */
-		psEffect->lastFrame += psEffect->frameDelay;
-
-		/* Are we on the last frame? */
-		if (++psEffect->frameNumber >= effectGetNumFrames(psEffect))
+	/* Time to update the frame number on the smoke sprite - does the anim wrap around? */
+	advanceEffectFrames(effects, states, count, FrameStep::CatchUp, [](EFFECT &effect) {
+		if (!TEST_CYCLIC((&effect)))
 		{
-			/* Does the anim wrap around? */
-			if (TEST_CYCLIC(psEffect))
-			{
-				/* Does it change drift direction? */
-				if (psEffect->type == SMOKE_TYPE_DRIFTING)
-				{
-					/* Make it change direction */
-					psEffect->velocity.x = (float)(rand() % 20);
-					psEffect->velocity.z = (float)(10 - rand() % 20);
-					psEffect->velocity.y = (float)(10 + rand() % 20);
-				}
-				/* Reset the frame */
-				psEffect->frameNumber = 0;
-			}
-			else
-			{
-				/* Kill it off */
-				return false;
-			}
+			return false;
 		}
-	}
+		/* Does it change drift direction? */
+		if (effect.type == SMOKE_TYPE_DRIFTING)
+		{
+			/* Make it change direction */
+			effect.velocity.x = (float)(rand() % 20);
+			effect.velocity.z = (float)(10 - rand() % 20);
+			effect.velocity.y = (float)(10 + rand() % 20);
+		}
+		return true;
+	});
 
 	/* Update position */
-	psEffect->position.x += graphicsTimeAdjustedIncrement(psEffect->velocity.x);
-	psEffect->position.y += graphicsTimeAdjustedIncrement(psEffect->velocity.y);
-	psEffect->position.z += graphicsTimeAdjustedIncrement(psEffect->velocity.z);
+	moveEffects(effects, states, count);
 
 	/* If it doesn't get killed by frame number, then by age */
-	if (TEST_CYCLIC(psEffect))
-	{
-		/* Has it overstayed it's welcome? */
-		if (graphicsTime - psEffect->birthTime > psEffect->lifeSpan)
-		{
-			return false; /* Kill it */
-		}
-	}
-	return true;
+	expireCyclicEffects(effects, states, count);
 }
 
 /**
@@ -1249,49 +1346,27 @@ static bool updateDestruction(EFFECT *psEffect, LightingData& lightData)
 }
 
 /** Moves the construction graphic about - dust cloud or whatever.... */
-static bool updateConstruction(EFFECT *psEffect)
+static void updateConstruction(EFFECT *effects, uint8_t *states, size_t count)
 {
-	/* Time to update the frame number on the construction sprite */
-	if (graphicsTime - psEffect->lastFrame > psEffect->frameDelay)
-	{
-		psEffect->lastFrame = graphicsTime;
-		/* Are we on the last frame? */
-		if (++psEffect->frameNumber >= effectGetNumFrames(psEffect))
-		{
-			/* Is it a cyclic sprite? */
-			if (TEST_CYCLIC(psEffect))
-			{
-				psEffect->frameNumber = 0;
-			}
-			else
-			{
-				return false;
-			}
-		}
-	}
+	/* Time to update the frame number on the construction sprite - is it a cyclic sprite? */
+	advanceEffectFrames(effects, states, count, FrameStep::Once, wrapCyclicEffect);
 
 	/* Move it about in the world */
-
-	psEffect->position.x += graphicsTimeAdjustedIncrement(psEffect->velocity.x);
-	psEffect->position.y += graphicsTimeAdjustedIncrement(psEffect->velocity.y);
-	psEffect->position.z += graphicsTimeAdjustedIncrement(psEffect->velocity.z);
-
+	moveEffects(effects, states, count);
 
 	/* If it doesn't get killed by frame number, then by height */
-	if (TEST_CYCLIC(psEffect))
+	for (size_t i = 0; i < count; ++i)
 	{
+		const EFFECT &effect = effects[i];
 		/* Has it hit the ground */
-		if (static_cast<int>(psEffect->position.y) <= map_Height(static_cast<int>(psEffect->position.x), static_cast<int>(psEffect->position.z)))
+		if (states[i] == EFFECT_STATE_ACTIVE && TEST_CYCLIC((&effect))
+			&& static_cast<int>(effect.position.y) <= map_Height(static_cast<int>(effect.position.x), static_cast<int>(effect.position.z)))
 		{
-			return false;
-		}
-
-		if (graphicsTime - psEffect->birthTime > psEffect->lifeSpan)
-		{
-			return false;
+			states[i] = EFFECT_STATE_EXPIRED;
 		}
 	}
-	return true;
+	/* or age */
+	expireCyclicEffects(effects, states, count);
 }
 
 /** Update fire sequences */
@@ -1442,6 +1517,12 @@ void renderEffect(const EFFECT *psEffect, const glm::mat4 &viewMatrix)
 	abort();
 }
 
+/** Queues the billboard effects collected by renderEffect, with one call per mesh and flags */
+void renderEffectParticles()
+{
+	effectParticles.flush();
+}
+
 /** drawing func for wapypoints */
 static void renderWaypointEffect(const EFFECT *psEffect, const glm::mat4 &viewMatrix)
 {
@@ -1460,7 +1541,7 @@ static void renderFirework(const EFFECT *psEffect, const glm::mat4 &viewMatrix)
 	modelMatrix *= glm::rotate(UNDEG(-playerPos.r.y), glm::vec3(0.f, 1.f, 0.f)) * glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(1.f, 0.f, 0.f))
 	               * glm::scale(glm::vec3(psEffect->size / 100.f));
 
-	pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, WZCOL_WHITE, pie_ADDITIVE | pie_NODEPTHWRITE, EFFECT_EXPLOSION_ADDITIVE, modelMatrix, viewMatrix);
+	effectParticles.add(psEffect->imd, pie_ADDITIVE | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, WZCOL_WHITE, psEffect->frameNumber, EFFECT_EXPLOSION_ADDITIVE});
 }
 
 /** drawing func for blood. */
@@ -1470,7 +1551,7 @@ static void renderBloodEffect(const EFFECT *psEffect, const glm::mat4 &viewMatri
 	modelMatrix *= glm::rotate(UNDEG(-playerPos.r.y), glm::vec3(0.f, 1.f, 0.f)) * glm::rotate(UNDEG(-playerPos.r.x), glm::vec3(1.f, 0.f, 0.f))
 	               * glm::scale(glm::vec3(psEffect->size / 100.f));
 
-	pie_Draw3DShape(getDisplayImdFromIndex(MI_BLOOD), psEffect->frameNumber, 0, WZCOL_WHITE, pie_TRANSLUCENT | pie_NODEPTHWRITE, EFFECT_BLOOD_TRANSPARENCY, modelMatrix, viewMatrix);
+	effectParticles.add(getDisplayImdFromIndex(MI_BLOOD), pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, WZCOL_WHITE, psEffect->frameNumber, EFFECT_BLOOD_TRANSPARENCY});
 }
 
 static void renderDestructionEffect(const EFFECT *psEffect, const glm::mat4 &viewMatrix)
@@ -1593,19 +1674,19 @@ static void renderExplosionEffect(const EFFECT *psEffect, const glm::mat4 &viewM
 
 	if (premultiplied)
 	{
-		pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_PREMULTIPLIED | pie_NODEPTHWRITE, 0, modelMatrix, viewMatrix);
+		effectParticles.add(psEffect->imd, pie_PREMULTIPLIED | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, 0});
 	}
 	else if (psEffect->type == EXPLOSION_TYPE_PLASMA)
 	{
-		pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_ADDITIVE | pie_NODEPTHWRITE, EFFECT_PLASMA_ADDITIVE, modelMatrix, viewMatrix);
+		effectParticles.add(psEffect->imd, pie_ADDITIVE | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, EFFECT_PLASMA_ADDITIVE});
 	}
 	else if (psEffect->type == EXPLOSION_TYPE_KICKUP)
 	{
-		pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_TRANSLUCENT | pie_NODEPTHWRITE, 128, modelMatrix, viewMatrix);
+		effectParticles.add(psEffect->imd, pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, 128});
 	}
 	else
 	{
-		pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_ADDITIVE | pie_NODEPTHWRITE, EFFECT_EXPLOSION_ADDITIVE, modelMatrix, viewMatrix);
+		effectParticles.add(psEffect->imd, pie_ADDITIVE | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, EFFECT_EXPLOSION_ADDITIVE});
 	}
 }
 
@@ -1671,7 +1752,7 @@ static void renderConstructionEffect(const EFFECT *psEffect, const glm::mat4 &vi
 	size = MIN(2.f * translucency / 100.f, .90f);
 	modelMatrix *= glm::scale(glm::vec3(size));
 
-	pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, WZCOL_WHITE, pie_TRANSLUCENT | pie_NODEPTHWRITE, translucency, modelMatrix, viewMatrix);
+	effectParticles.add(psEffect->imd, pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, WZCOL_WHITE, psEffect->frameNumber, translucency});
 }
 
 /** Renders the standard smoke effect - it is now scaled in real-time as well */
@@ -1724,17 +1805,17 @@ static void renderSmokeEffect(const EFFECT *psEffect, const glm::mat4 &viewMatri
 	/* Make imds be transparent on 3dfx */
 	if (psEffect->type == SMOKE_TYPE_STEAM)
 	{
-		pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_TRANSLUCENT | pie_NODEPTHWRITE, EFFECT_STEAM_TRANSPARENCY / 2, modelMatrix, viewMatrix);
+		effectParticles.add(psEffect->imd, pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, EFFECT_STEAM_TRANSPARENCY / 2});
 	}
 	else
 	{
 		if (psEffect->type == SMOKE_TYPE_TRAIL)
 		{
-			pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_TRANSLUCENT | pie_NODEPTHWRITE, (2 * transparency) / 3, modelMatrix, viewMatrix);
+			effectParticles.add(psEffect->imd, pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, (2 * transparency) / 3});
 		}
 		else
 		{
-			pie_Draw3DShape(psEffect->imd, psEffect->frameNumber, 0, brightness, pie_TRANSLUCENT | pie_NODEPTHWRITE, transparency / 2, modelMatrix, viewMatrix);
+			effectParticles.add(psEffect->imd, pie_TRANSLUCENT | pie_NODEPTHWRITE, PIE_PARTICLE{modelMatrix, brightness, psEffect->frameNumber, transparency / 2});
 		}
 	}
 }
@@ -2336,9 +2417,8 @@ bool writeFXData(const char *fileName)
 {
 	int i = 0;
 	nlohmann::json mRoot = nlohmann::json::object();
-	for (auto iter = gActiveEffects.begin(); iter != gActiveEffects.end(); ++iter, i++)
+	auto writeEffect = [&mRoot, &i](const EFFECT& e)
 	{
-		const EFFECT& e = *iter;
 
 		nlohmann::json effectObj = nlohmann::json::object();
 		effectObj["control"] = e.control;
@@ -2363,10 +2443,19 @@ bool writeFXData(const char *fileName)
 			effectObj["imd_name"] = modelName(e.imd).toUtf8();
 		}
 
-		auto effectKey = "effect_" + WzString::number(i);
+		auto effectKey = "effect_" + WzString::number(i++);
 		mRoot[effectKey.toUtf8()] = std::move(effectObj);
-
-		// Move on to reading the next effect
+	};
+	for (const auto& pool : gEffectPools)
+	{
+		for (const EFFECT& e : pool)
+		{
+			writeEffect(e);
+		}
+	}
+	for (const EFFECT& e : gNewEffects)
+	{
+		writeEffect(e);
 	}
 
 	std::string jsonString;
@@ -2445,7 +2534,7 @@ bool readFXData(const char *fileName)
 		// Move on to reading the next effect
 		ini.endGroup();
 
-		gActiveEffects.emplace(std::move(curEffect));
+		gNewEffects.push_back(std::move(curEffect));
 	}
 
 	/* Hopefully everything's just fine by now */
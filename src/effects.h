@@ -158,6 +158,7 @@ void    addEffect(const Vector3i *pos, EFFECT_GROUP group, EFFECT_TYPE type, boo
 void    addMultiEffect(const Vector3i *basePos, Vector3i *scatter, EFFECT_GROUP group, EFFECT_TYPE type, bool specified, const iIMDShape *imd, unsigned int number, bool lit, unsigned int size, unsigned effectTime);
 
 void	renderEffect(const EFFECT *psEffect, const glm::mat4 &viewMatrix);
+void	renderEffectParticles();  ///< Must be called after renderEffect(), before anything else is drawn
 void	effectResetUpdates();
 
 void	initPerimeterSmoke(const iIMDShape *pImd, Vector3i base);
@@ -27,6 +27,7 @@
 #include "lib/framework/endian_hack.h"
 #include "lib/framework/math_ext.h"
 #include "lib/framework/wzconfig.h"
+#include "lib/framework/savesnapshot.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/strres.h"
@@ -102,6 +103,7 @@
 #include "loop.h"
 #include "screens/guidescreen.h"
 #include <array>
+#include <functional>
 
 #include "wzphysfszipioprovider.h"
 #include <wzmaplib/map_package.h>
@@ -130,6 +132,12 @@
 
 bool saveJSONToFile(const nlohmann::json& obj, const char* pFileName)
 {
+	if (saveSnapshotCollects(pFileName))
+	{
+		debug(LOG_SAVE, "Saving %s to snapshot", pFileName);
+		saveSnapshotWriteJSON(pFileName, obj);
+		return true;
+	}
 	std::string jsonString;
 	try {
 		jsonString = obj.dump(4);
@@ -142,6 +150,17 @@ bool saveJSONToFile(const nlohmann::json& obj, const char* pFileName)
 	return saveFile(pFileName, jsonString.c_str(), jsonString.size());
 }
 
+bool saveJSONToFile(nlohmann::json&& obj, const char* pFileName)
+{
+	if (saveSnapshotCollects(pFileName))
+	{
+		debug(LOG_SAVE, "Saving %s to snapshot", pFileName);
+		saveSnapshotWriteJSON(pFileName, std::move(obj));
+		return true;
+	}
+	return saveJSONToFile(static_cast<const nlohmann::json&>(obj), pFileName);
+}
+
 void gameScreenSizeDidChange(unsigned int oldWidth, unsigned int oldHeight, unsigned int newWidth, unsigned int newHeight)
 {
 	if (GetGameMode() == GS_NORMAL && !gamePaused()) // if in match / game and not paused (i.e. no in-game menus open, etc)
@@ -2458,14 +2477,43 @@ static void getIniDroidOrder(WzConfig &ini, WzString const &key, DroidOrder &ord
 	getIniStructureStats(ini, key + "/stats", order.psStats);
 }
 
-static void setIniBaseObject(nlohmann::json &json, WzString const &key, BASE_OBJECT const *object)
+/// Plain copy of a reference to a game object, so that save game JSON can be built without the game state
+struct SaveObjectRef
 {
-	if (object != nullptr && object->died <= NOT_CURRENT_LIST)
+	bool valid = false;
+	uint32_t id = 0;
+	uint8_t player = 0;
+	OBJECT_TYPE type = OBJ_DROID;
+};
+
+/// Returns a reference to `object`, which is not valid for nullptr
+static SaveObjectRef saveObjectRef(BASE_OBJECT const *object)
+{
+	SaveObjectRef ref;
+	if (object != nullptr)
+	{
+		ref.valid = true;
+		ref.id = object->id;
+		ref.player = object->player;
+		ref.type = object->type;
+	}
+	return ref;
+}
+
+/// Like saveObjectRef(), but also not valid for objects that have died
+static SaveObjectRef saveTargetRef(BASE_OBJECT const *object)
+{
+	return saveObjectRef(object != nullptr && object->died <= NOT_CURRENT_LIST ? object : nullptr);
+}
+
+static void setIniBaseObject(nlohmann::json &json, WzString const &key, SaveObjectRef const &object)
+{
+	if (object.valid)
 	{
 		const auto& keyStr = key.toStdString();
-		json[keyStr + "/id"] = object->id;
-		json[keyStr + "/player"] = object->player;
-		json[keyStr + "/type"] = object->type;
+		json[keyStr + "/id"] = object.id;
+		json[keyStr + "/player"] = object.player;
+		json[keyStr + "/type"] = object.type;
 #ifdef DEBUG
 		//ini.setValue(key + "/debugfunc", WzString::fromUtf8(psCurr->targetFunc));
 		//ini.setValue(key + "/debugline", psCurr->targetLine);
@@ -2473,25 +2521,44 @@ static void setIniBaseObject(nlohmann::json &json, WzString const &key, BASE_OBJ
 	}
 }
 
-static inline void setIniStructureStats(nlohmann::json &jsonObj, WzString const &key, STRUCTURE_STATS const *stats)
+/// Plain copy of a droid order, see SaveObjectRef
+struct DroidOrderSaveData
+{
+	DroidOrder order;         ///< Without psObj and psStats, which are saved as obj and stats
+	SaveObjectRef obj;
+	bool hasStats = false;
+	WzString stats;
+};
+
+static DroidOrderSaveData droidOrderSaveData(DroidOrder const &order)
 {
-	if (stats != nullptr)
+	DroidOrderSaveData data;
+	data.order = order;
+	data.order.psObj = nullptr;
+	data.order.psStats = nullptr;
+	data.obj = saveTargetRef(order.psObj);
+	if (order.psStats != nullptr)
 	{
-		jsonObj[key.toStdString()] = stats->id;
+		data.hasStats = true;
+		data.stats = order.psStats->id;
 	}
+	return data;
 }
 
-static inline void setIniDroidOrder(nlohmann::json &jsonObj, WzString const &key, DroidOrder const &order)
+static inline void setIniDroidOrder(nlohmann::json &jsonObj, WzString const &key, DroidOrderSaveData const &data)
 {
 	const auto& keyStr = key.toStdString();
-	jsonObj[keyStr + "/type"] = order.type;
-	jsonObj[keyStr + "/pos"] = order.pos;
-	jsonObj[keyStr + "/pos2"] = order.pos2;
-	jsonObj[keyStr + "/direction"] = order.direction;
-	jsonObj[keyStr + "/index"] = order.index;
-	jsonObj[keyStr + "/rtrType"] = order.rtrType;
-	setIniBaseObject(jsonObj, key + "/obj", order.psObj);
-	setIniStructureStats(jsonObj, key + "/stats", order.psStats);
+	jsonObj[keyStr + "/type"] = data.order.type;
+	jsonObj[keyStr + "/pos"] = data.order.pos;
+	jsonObj[keyStr + "/pos2"] = data.order.pos2;
+	jsonObj[keyStr + "/direction"] = data.order.direction;
+	jsonObj[keyStr + "/index"] = data.order.index;
+	jsonObj[keyStr + "/rtrType"] = data.order.rtrType;
+	setIniBaseObject(jsonObj, key + "/obj", data.obj);
+	if (data.hasStats)
+	{
+		jsonObj[keyStr + "/stats"] = data.stats;
+	}
 }
 
 static void allocatePlayers()
@@ -3542,6 +3609,15 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType, bool isAutoSave)
 {
 	size_t			fileExtension;
 	char			CurrentFileName[PATH_MAX] = {'\0'};
+#if defined(__EMSCRIPTEN__)
+	const bool		asyncSnapshot = false;
+#else
+	// autosaves only capture the game state here, and are encoded and written in the background
+	const bool		asyncSnapshot = isAutoSave && war_getAsyncAutosave();
+#endif
+	// autosaves only store what changed since the base snapshot they share
+	const bool		incrementalSnapshot = isAutoSave && war_getIncrementalAutosave();
+	const bool		useSnapshot = asyncSnapshot || incrementalSnapshot || war_getBinarySaveSnapshots();
 
 	executeFnAndProcessScriptQueuedRemovals([]() { triggerEvent(TRIGGER_GAME_SAVING); });
 
@@ -3566,6 +3642,16 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType, bool isAutoSave)
 	//create dir will fail if directory already exists but don't care!
 	(void) PHYSFS_mkdir(CurrentFileName);
 
+	// collect all JSON files in a single binary snapshot, if enabled
+	if (useSnapshot)
+	{
+		saveSnapshotBegin(CurrentFileName, currentGameVersion, asyncSnapshot, incrementalSnapshot);
+	}
+	else
+	{
+		saveSnapshotRemove(CurrentFileName);
+	}
+
 	writeMainFile(std::string(CurrentFileName) + "/main.json", saveType);
 
 	//save the map file
@@ -3829,6 +3915,12 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType, bool isAutoSave)
 		swapMissionPointers();
 	}
 
+	if (useSnapshot && !saveSnapshotEnd())
+	{
+		debug(LOG_ERROR, "saveGame: saveSnapshotEnd(\"%s\") failed", CurrentFileName);
+		goto error;
+	}
+
 	// strip the last filename
 	CurrentFileName[fileExtension - 1] = '\0';
 
@@ -3842,6 +3934,8 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType, bool isAutoSave)
 	return true;
 
 error:
+	saveSnapshotAbort();
+
 	/* Start the game clock */
 	gameTimeStart();
 
@@ -5224,6 +5318,11 @@ nonstd::optional<nlohmann::json> parseJsonFile(const char *filename)
 	debug(LOG_SAVEGAME, "starting deserialize %s", filename);
 	if (!loadFile(filename, &ppFileData, &pFileSize, false))
 	{
+		nlohmann::json snapshotSection;
+		if (saveSnapshotReadJSON(filename, snapshotSection))
+		{
+			return snapshotSection;
+		}
 		debug(LOG_SAVE, "No %s found, sad", filename);
 		return nullopt;
 	}
@@ -5376,18 +5475,6 @@ static int getPlayer(WzConfig &ini)
 	return 0;
 }
 
-static void setPlayer(WzConfig &ini, int player)
-{
-	if (scavengerSlot() == player)
-	{
-		ini.setValue("player", "scavenger");
-	}
-	else
-	{
-		ini.setValue("player", player);
-	}
-}
-
 static inline void setPlayerJSON(nlohmann::json &jsonObj, int player)
 {
 	if (scavengerSlot() == player)
@@ -5520,104 +5607,117 @@ static void loadSaveObject(WzConfig &ini, BASE_OBJECT *psObj)
 	psObj->born = ini.value("born", 2).toInt();
 }
 
-static void writeSaveObject(WzConfig &ini, const BASE_OBJECT *psObj)
+/// Plain copy of what writeSaveObjectJSON() saves of a BASE_OBJECT, taken by copySaveObject()
+struct SaveObjectData
+{
+	uint32_t id = 0;
+	int player = 0;
+	bool scavenger = false;
+	UDWORD body = 0;
+	Position pos = Position(0, 0, 0);
+	Rotation rot;
+	UDWORD timeAnimationStarted = 0;
+	UBYTE animationEvent = 0;
+	UBYTE selected = 0;
+	UDWORD lastEmission = 0;
+	UDWORD periodicalDamageStart = 0;
+	UDWORD periodicalDamage = 0;
+	uint32_t born = 0;
+	uint32_t died = 0;
+	UDWORD timeLastHit = 0;
+	int maxPlayers = 0;
+	UBYTE visible[MAX_PLAYERS] = {};
+};
+
+static void copySaveObject(SaveObjectData &data, const BASE_OBJECT *psObj)
+{
+	data.id = psObj->id;
+	data.player = psObj->player;
+	data.scavenger = scavengerSlot() == psObj->player;
+	data.body = psObj->body;
+	data.pos = psObj->pos;
+	data.rot = psObj->rot;
+	data.timeAnimationStarted = psObj->timeAnimationStarted;
+	data.animationEvent = psObj->animationEvent;
+	data.selected = psObj->selected;
+	data.lastEmission = psObj->lastEmission;
+	data.periodicalDamageStart = psObj->periodicalDamageStart;
+	data.periodicalDamage = psObj->periodicalDamage;
+	data.born = psObj->born;
+	data.died = psObj->died;
+	data.timeLastHit = psObj->timeLastHit;
+	data.maxPlayers = game.maxPlayers;
+	memcpy(data.visible, psObj->visible, sizeof(data.visible));
+}
+
+static void writeSaveObjectJSON(nlohmann::json &jsonObj, const SaveObjectData &data)
 {
-	ini.setValue("id", psObj->id);
-	setPlayer(ini, psObj->player);
-	ini.setValue("health", psObj->body);
-	ini.setVector3i("position", psObj->pos);
-	ini.setVector3i("rotation", toVector(psObj->rot));
-	if (psObj->timeAnimationStarted)
+	jsonObj["id"] = data.id;
+	if (data.scavenger)
+	{
+		jsonObj["player"] = "scavenger";
+	}
+	else
 	{
-		ini.setValue("timeAnimationStarted", psObj->timeAnimationStarted);
+		jsonObj["player"] = data.player;
 	}
-	if (psObj->animationEvent)
+	jsonObj["health"] = data.body;
+	jsonObj["position"] = data.pos;
+	jsonObj["rotation"] = toVector(data.rot);
+	if (data.timeAnimationStarted)
 	{
-		ini.setValue("animationEvent", psObj->animationEvent);
+		jsonObj["timeAnimationStarted"] = data.timeAnimationStarted;
 	}
-	ini.setValue("selected", psObj->selected);	// third kind of group
-	if (psObj->lastEmission)
+	if (data.animationEvent)
 	{
-		ini.setValue("lastEmission", psObj->lastEmission);
+		jsonObj["animationEvent"] = data.animationEvent;
 	}
-	if (psObj->periodicalDamageStart > 0)
+	jsonObj["selected"] = data.selected;	// third kind of group
+	if (data.lastEmission)
 	{
-		ini.setValue("periodicalDamageStart", psObj->periodicalDamageStart);
+		jsonObj["lastEmission"] = data.lastEmission;
 	}
-	if (psObj->periodicalDamage > 0)
+	if (data.periodicalDamageStart > 0)
 	{
-		ini.setValue("periodicalDamage", psObj->periodicalDamage);
+		jsonObj["periodicalDamageStart"] = data.periodicalDamageStart;
 	}
-	ini.setValue("born", psObj->born);
-	if (psObj->died >= NOT_CURRENT_LIST)
+	if (data.periodicalDamage > 0)
 	{
-		ini.setValue("died", psObj->died);
+		jsonObj["periodicalDamage"] = data.periodicalDamage;
 	}
-	if (psObj->timeLastHit != UDWORD_MAX)
+	jsonObj["born"] = data.born;
+	if (data.died >= NOT_CURRENT_LIST)
 	{
-		ini.setValue("timeLastHit", psObj->timeLastHit);
+		jsonObj["died"] = data.died;
 	}
-	if (psObj->selected)
+	if (data.timeLastHit != UDWORD_MAX)
 	{
-		ini.setValue("selected", psObj->selected);
+		jsonObj["timeLastHit"] = data.timeLastHit;
 	}
-	for (int i = 0; i < game.maxPlayers; i++)
+	if (data.selected)
 	{
-		if (psObj->visible[i])
+		jsonObj["selected"] = data.selected;
+	}
+	for (int i = 0; i < data.maxPlayers; i++)
+	{
+		if (data.visible[i])
 		{
-			ini.setValue("visible/" + WzString::number(i), psObj->visible[i]);
+			jsonObj["visible/" + WzString::number(i).toStdString()] = data.visible[i];
 		}
 	}
 }
 
-static void writeSaveObjectJSON(nlohmann::json &jsonObj, const BASE_OBJECT *psObj)
+/// Saves the JSON returned by `build` to `pFileName`. Asynchronous autosaves call `build` on their
+/// background thread, so it must only use the copies of the game state that it holds.
+static bool saveDeferredJSONToFile(std::function<nlohmann::json ()> build, const char *pFileName)
 {
-	jsonObj["id"] = psObj->id;
-	setPlayerJSON(jsonObj, psObj->player);
-	jsonObj["health"] = psObj->body;
-	jsonObj["position"] = psObj->pos;
-	jsonObj["rotation"] = toVector(psObj->rot);
-	if (psObj->timeAnimationStarted)
-	{
-		jsonObj["timeAnimationStarted"] = psObj->timeAnimationStarted;
-	}
-	if (psObj->animationEvent)
-	{
-		jsonObj["animationEvent"] = psObj->animationEvent;
-	}
-	jsonObj["selected"] = psObj->selected;	// third kind of group
-	if (psObj->lastEmission)
-	{
-		jsonObj["lastEmission"] = psObj->lastEmission;
-	}
-	if (psObj->periodicalDamageStart > 0)
+	if (saveSnapshotCollects(pFileName))
 	{
-		jsonObj["periodicalDamageStart"] = psObj->periodicalDamageStart;
-	}
-	if (psObj->periodicalDamage > 0)
-	{
-		jsonObj["periodicalDamage"] = psObj->periodicalDamage;
-	}
-	jsonObj["born"] = psObj->born;
-	if (psObj->died >= NOT_CURRENT_LIST)
-	{
-		jsonObj["died"] = psObj->died;
-	}
-	if (psObj->timeLastHit != UDWORD_MAX)
-	{
-		jsonObj["timeLastHit"] = psObj->timeLastHit;
-	}
-	if (psObj->selected)
-	{
-		jsonObj["selected"] = psObj->selected;
-	}
-	for (int i = 0; i < game.maxPlayers; i++)
-	{
-		if (psObj->visible[i])
-		{
-			jsonObj["visible/" + WzString::number(i).toStdString()] = psObj->visible[i];
-		}
+		debug(LOG_SAVE, "Saving %s to snapshot", pFileName);
+		saveSnapshotWriteDeferredJSON(pFileName, std::move(build));
+		return true;
 	}
+	return saveJSONToFile(build(), pFileName);
 }
 
 template<typename T>
@@ -5629,7 +5729,7 @@ inline T getCompFromName_NullCompOnFail(COMPONENT_TYPE compType, const WzString
 
 static bool loadSaveDroid(const char *pFileName, PerPlayerDroidLists& ppsCurrentDroidLists)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!saveSnapshotFileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;	// try to use fallback method
@@ -5951,163 +6051,275 @@ static bool loadSaveDroid(const char *pFileName, PerPlayerDroidLists& ppsCurrent
 }
 
 // -----------------------------------------------------------------------------------------
+/// Plain copy of what writeDroid() saves of a droid, taken by copyDroid()
+struct DroidSaveData
+{
+	SaveObjectData base;
+	std::string name;
+	UDWORD originalBody = 0;
+	unsigned numWeaps = 0;
+	WEAPON asWeaps[MAX_WEAPONS];
+	SaveObjectRef actionTarget[MAX_WEAPONS];
+	UDWORD lastFrustratedTime = 0;
+	uint32_t experience = 0;
+	uint32_t kills = 0;
+	SDWORD shieldPoints = -1;
+	UDWORD shieldRegenTime = 0;
+	UDWORD shieldInterruptRegenTime = 0;
+	DroidOrderSaveData order;
+	SDWORD listSize = 0;
+	std::vector<DroidOrderSaveData> orderList;
+	UDWORD secondaryOrder = 0;
+	DROID_ACTION action = DACTION_NONE;
+	Vector2i actionPos = Vector2i(0, 0);
+	UDWORD actionStarted = 0;
+	UDWORD actionPoints = 0;
+	SaveObjectRef baseStruct;
+	bool hasGroup = false;
+	int groupId = 0;
+	GROUP_TYPE groupType = GT_NORMAL;
+	UBYTE group = 0;
+	UBYTE repairGroup = UBYTE_MAX;
+	bool hasCommander = false;
+	uint32_t commander = 0;
+	SWORD resistance = 0;
+	DROID_TYPE droidType = DROID_DEFAULT;
+	WzString bodyPart, propulsionPart, brainPart, repairPart, ecmPart, sensorPart, constructPart;
+	WzString weaponParts[MAX_WEAPONS];
+	MOVE_CONTROL sMove;       ///< Without psFormation, which is saved as formation*
+	bool hasFormation = false;
+	uint16_t formationDirection = 0;
+	SDWORD formationX = 0;
+	SDWORD formationY = 0;
+	uint16_t underRepair = 0;
+	bool onMission = false;
+};
+
+static void copyDroid(DroidSaveData &data, const DROID *psCurr, bool onMission)
+{
+	copySaveObject(data.base, psCurr);
+	data.name = psCurr->aName;
+	data.originalBody = psCurr->originalBody;
+	data.numWeaps = psCurr->numWeaps;
+	for (unsigned i = 0; i < MAX_WEAPONS; i++)
+	{
+		data.asWeaps[i] = psCurr->asWeaps[i];
+		data.actionTarget[i] = saveTargetRef(psCurr->psActionTarget[i]);
+	}
+	data.lastFrustratedTime = psCurr->lastFrustratedTime;
+	data.experience = psCurr->experience;
+	data.kills = psCurr->kills;
+	data.shieldPoints = psCurr->shieldPoints;
+	data.shieldRegenTime = psCurr->shieldRegenTime;
+	data.shieldInterruptRegenTime = psCurr->shieldInterruptRegenTime;
+	data.order = droidOrderSaveData(psCurr->order);
+	data.listSize = psCurr->listSize;
+	for (int i = 0; i < psCurr->listSize; ++i)
+	{
+		data.orderList.push_back(droidOrderSaveData(psCurr->asOrderList[i]));
+	}
+	data.secondaryOrder = psCurr->secondaryOrder;
+	data.action = psCurr->action;
+	data.actionPos = psCurr->actionPos;
+	data.actionStarted = psCurr->actionStarted;
+	data.actionPoints = psCurr->actionPoints;
+	data.baseStruct = saveObjectRef(psCurr->psBaseStruct);
+	if (psCurr->psGroup)
+	{
+		data.hasGroup = true;
+		data.groupId = psCurr->psGroup->id;
+		data.groupType = psCurr->psGroup->type;
+	}
+	data.group = psCurr->group;
+	data.repairGroup = psCurr->repairGroup;
+	if (hasCommander(psCurr) && psCurr->psGroup->psCommander->died <= NOT_CURRENT_LIST)
+	{
+		data.hasCommander = true;
+		data.commander = psCurr->psGroup->psCommander->id;
+	}
+	data.resistance = psCurr->resistance;
+	data.droidType = psCurr->droidType;
+	data.bodyPart = psCurr->getBodyStats()->id;
+	data.propulsionPart = psCurr->getPropulsionStats()->id;
+	data.brainPart = psCurr->getBrainStats()->id;
+	data.repairPart = psCurr->getRepairStats()->id;
+	data.ecmPart = psCurr->getECMStats()->id;
+	data.sensorPart = psCurr->getSensorStats()->id;
+	data.constructPart = psCurr->getConstructStats()->id;
+	for (unsigned j = 0; j < psCurr->numWeaps; j++)
+	{
+		data.weaponParts[j] = psCurr->getWeaponStats(j)->id;
+	}
+	data.sMove = psCurr->sMove;
+	data.sMove.psFormation = nullptr;
+	if (psCurr->sMove.psFormation != nullptr)
+	{
+		data.hasFormation = true;
+		data.formationDirection = psCurr->sMove.psFormation->direction;
+		data.formationX = psCurr->sMove.psFormation->x;
+		data.formationY = psCurr->sMove.psFormation->y;
+	}
+	data.underRepair = psCurr->underRepair;
+	data.onMission = onMission;
+}
+
 /*
 Writes the linked list of droids for each player to a file
 */
-static nlohmann::json writeDroid(const DROID *psCurr, bool onMission, int &counter)
+static nlohmann::json writeDroid(const DroidSaveData &data)
 {
 	nlohmann::json droidObj = nlohmann::json::object();
-	droidObj["name"] = psCurr->aName;
-	droidObj["originalBody"] = psCurr->originalBody;
+	droidObj["name"] = data.name;
+	droidObj["originalBody"] = data.originalBody;
 	// write common BASE_OBJECT info
-	writeSaveObjectJSON(droidObj, psCurr);
+	writeSaveObjectJSON(droidObj, data.base);
 
-	for (unsigned i = 0; i < psCurr->numWeaps; i++)
+	for (unsigned i = 0; i < data.numWeaps; i++)
 	{
-		if (psCurr->asWeaps[i].nStat > 0)
+		if (data.asWeaps[i].nStat > 0)
 		{
 			auto numberWzStr = WzString::number(i);
 			const std::string& numStr = numberWzStr.toStdString();
-			droidObj["ammo/" + numStr] = psCurr->asWeaps[i].ammo;
-			droidObj["lastFired/" + numStr] = psCurr->asWeaps[i].lastFired;
-			droidObj["shotsFired/" + numStr] = psCurr->asWeaps[i].shotsFired;
-			droidObj["rotation/" + numStr] = toVector(psCurr->asWeaps[i].rot);
+			droidObj["ammo/" + numStr] = data.asWeaps[i].ammo;
+			droidObj["lastFired/" + numStr] = data.asWeaps[i].lastFired;
+			droidObj["shotsFired/" + numStr] = data.asWeaps[i].shotsFired;
+			droidObj["rotation/" + numStr] = toVector(data.asWeaps[i].rot);
 		}
 	}
 	for (unsigned i = 0; i < MAX_WEAPONS; i++)
 	{
-		setIniBaseObject(droidObj, "actionTarget/" + WzString::number(i), psCurr->psActionTarget[i]);
+		setIniBaseObject(droidObj, "actionTarget/" + WzString::number(i), data.actionTarget[i]);
 	}
-	if (psCurr->lastFrustratedTime > 0)
+	if (data.lastFrustratedTime > 0)
 	{
-		droidObj["lastFrustratedTime"] = psCurr->lastFrustratedTime;
+		droidObj["lastFrustratedTime"] = data.lastFrustratedTime;
 	}
-	if (psCurr->experience > 0)
+	if (data.experience > 0)
 	{
-		droidObj["experience"] = psCurr->experience;
+		droidObj["experience"] = data.experience;
 	}
-	if (psCurr->kills > 0)
+	if (data.kills > 0)
 	{
-		droidObj["kills"] = psCurr->kills;
+		droidObj["kills"] = data.kills;
 	}
 
-	if (psCurr->shieldPoints > -1) // -1 is the default
+	if (data.shieldPoints > -1) // -1 is the default
 	{
-		droidObj["shieldPoints"] = psCurr->shieldPoints;
+		droidObj["shieldPoints"] = data.shieldPoints;
 	}
-	if (psCurr->shieldRegenTime > 0)
+	if (data.shieldRegenTime > 0)
 	{
-		droidObj["shieldRegenTime"] = psCurr->shieldRegenTime;
+		droidObj["shieldRegenTime"] = data.shieldRegenTime;
 	}
-	if (psCurr->shieldInterruptRegenTime > 0)
+	if (data.shieldInterruptRegenTime > 0)
 	{
-		droidObj["shieldInterruptRegenTime"] = psCurr->shieldInterruptRegenTime;
+		droidObj["shieldInterruptRegenTime"] = data.shieldInterruptRegenTime;
 	}
 
-	setIniDroidOrder(droidObj, "order", psCurr->order);
-	droidObj["orderList/size"] = psCurr->listSize;
-	for (int i = 0; i < psCurr->listSize; ++i)
+	setIniDroidOrder(droidObj, "order", data.order);
+	droidObj["orderList/size"] = data.listSize;
+	for (int i = 0; i < data.listSize; ++i)
 	{
-		setIniDroidOrder(droidObj, "orderList/" + WzString::number(i), psCurr->asOrderList[i]);
+		setIniDroidOrder(droidObj, "orderList/" + WzString::number(i), data.orderList[i]);
 	}
-	if (psCurr->timeLastHit != UDWORD_MAX)
+	if (data.base.timeLastHit != UDWORD_MAX)
 	{
-		droidObj["timeLastHit"] = psCurr->timeLastHit;
+		droidObj["timeLastHit"] = data.base.timeLastHit;
 	}
-	droidObj["secondaryOrder"] = psCurr->secondaryOrder;
-	droidObj["action"] = psCurr->action;
-	droidObj["actionString"] = getDroidActionName(psCurr->action); // future-proofing
-	droidObj["action/pos"] = psCurr->actionPos;
-	droidObj["actionStarted"] = psCurr->actionStarted;
-	droidObj["actionPoints"] = psCurr->actionPoints;
-	if (psCurr->psBaseStruct != nullptr)
+	droidObj["secondaryOrder"] = data.secondaryOrder;
+	droidObj["action"] = data.action;
+	droidObj["actionString"] = getDroidActionName(data.action); // future-proofing
+	droidObj["action/pos"] = data.actionPos;
+	droidObj["actionStarted"] = data.actionStarted;
+	droidObj["actionPoints"] = data.actionPoints;
+	if (data.baseStruct.valid)
 	{
-		droidObj["baseStruct/id"] = psCurr->psBaseStruct->id;
-		droidObj["baseStruct/player"] = psCurr->psBaseStruct->player;	// always ours, but for completeness
-		droidObj["baseStruct/type"] = psCurr->psBaseStruct->type;		// always a building, but for completeness
+		droidObj["baseStruct/id"] = data.baseStruct.id;
+		droidObj["baseStruct/player"] = data.baseStruct.player;	// always ours, but for completeness
+		droidObj["baseStruct/type"] = data.baseStruct.type;		// always a building, but for completeness
 	}
-	if (psCurr->psGroup)
+	if (data.hasGroup)
 	{
-		droidObj["aigroup"] = psCurr->psGroup->id;	// AI and commander/transport group
-		droidObj["aigroup/type"] = psCurr->psGroup->type;
+		droidObj["aigroup"] = data.groupId;	// AI and commander/transport group
+		droidObj["aigroup/type"] = data.groupType;
 	}
-	droidObj["group"] = psCurr->group;	// different kind of group. of course.
-	droidObj["repairGroup"] = psCurr->repairGroup;
-	if (hasCommander(psCurr) && psCurr->psGroup->psCommander->died <= NOT_CURRENT_LIST)
+	droidObj["group"] = data.group;	// different kind of group. of course.
+	droidObj["repairGroup"] = data.repairGroup;
+	if (data.hasCommander)
 	{
-		droidObj["commander"] = psCurr->psGroup->psCommander->id;
+		droidObj["commander"] = data.commander;
 	}
-	if (psCurr->resistance > 0)
+	if (data.resistance > 0)
 	{
-		droidObj["resistance"] = psCurr->resistance;
+		droidObj["resistance"] = data.resistance;
 	}
-	droidObj["droidType"] = psCurr->droidType;
-	droidObj["weapons"] = psCurr->numWeaps;
+	droidObj["droidType"] = data.droidType;
+	droidObj["weapons"] = data.numWeaps;
 	nlohmann::json partsObj = nlohmann::json::object();
-	partsObj["body"] = psCurr->getBodyStats()->id;
-	partsObj["propulsion"] = psCurr->getPropulsionStats()->id;
-	partsObj["brain"] = psCurr->getBrainStats()->id;
-	partsObj["repair"] = psCurr->getRepairStats()->id;
-	partsObj["ecm"] = psCurr->getECMStats()->id;
-	partsObj["sensor"] = psCurr->getSensorStats()->id;
-	partsObj["construct"] = psCurr->getConstructStats()->id;
-	for (int j = 0; j < psCurr->numWeaps; j++)
+	partsObj["body"] = data.bodyPart;
+	partsObj["propulsion"] = data.propulsionPart;
+	partsObj["brain"] = data.brainPart;
+	partsObj["repair"] = data.repairPart;
+	partsObj["ecm"] = data.ecmPart;
+	partsObj["sensor"] = data.sensorPart;
+	partsObj["construct"] = data.constructPart;
+	for (int j = 0; j < data.numWeaps; j++)
 	{
-		partsObj["weapon/" + WzString::number(j + 1).toStdString()] = psCurr->getWeaponStats(j)->id;
+		partsObj["weapon/" + WzString::number(j + 1).toStdString()] = data.weaponParts[j];
 	}
 	droidObj["parts"] = partsObj;
-	droidObj["moveStatus"] = psCurr->sMove.Status;
-	droidObj["pathIndex"] = psCurr->sMove.pathIndex;
-	droidObj["pathLength"] = psCurr->sMove.asPath.size();
-	for (unsigned i = 0; i < psCurr->sMove.asPath.size(); i++)
-	{
-		droidObj["pathNode/" + WzString::number(i).toStdString()] = psCurr->sMove.asPath[i];
-	}
-	droidObj["moveDestination"] = psCurr->sMove.destination;
-	droidObj["moveSource"] = psCurr->sMove.src;
-	droidObj["moveTarget"] = psCurr->sMove.target;
-	droidObj["moveSpeed"] = psCurr->sMove.speed;
-	droidObj["moveDirection"] = psCurr->sMove.moveDir;
-	droidObj["bumpDir"] = psCurr->sMove.bumpDir;
-	droidObj["vertSpeed"] = psCurr->sMove.iVertSpeed;
-	droidObj["bumpTime"] = psCurr->sMove.bumpTime;
-	droidObj["shuffleStart"] = psCurr->sMove.shuffleStart;
+	droidObj["moveStatus"] = data.sMove.Status;
+	droidObj["pathIndex"] = data.sMove.pathIndex;
+	droidObj["pathLength"] = data.sMove.asPath.size();
+	for (unsigned i = 0; i < data.sMove.asPath.size(); i++)
+	{
+		droidObj["pathNode/" + WzString::number(i).toStdString()] = data.sMove.asPath[i];
+	}
+	droidObj["moveDestination"] = data.sMove.destination;
+	droidObj["moveSource"] = data.sMove.src;
+	droidObj["moveTarget"] = data.sMove.target;
+	droidObj["moveSpeed"] = data.sMove.speed;
+	droidObj["moveDirection"] = data.sMove.moveDir;
+	droidObj["bumpDir"] = data.sMove.bumpDir;
+	droidObj["vertSpeed"] = data.sMove.iVertSpeed;
+	droidObj["bumpTime"] = data.sMove.bumpTime;
+	droidObj["shuffleStart"] = data.sMove.shuffleStart;
 	for (int i = 0; i < MAX_WEAPONS; ++i)
 	{
-		droidObj["attackRun/" + WzString::number(i).toStdString()] = psCurr->asWeaps[i].usedAmmo;
+		droidObj["attackRun/" + WzString::number(i).toStdString()] = data.asWeaps[i].usedAmmo;
 	}
-	droidObj["lastBump"] = psCurr->sMove.lastBump;
-	droidObj["pauseTime"] = psCurr->sMove.pauseTime;
-	droidObj["bumpPosition"] = psCurr->sMove.bumpPos.xy();
+	droidObj["lastBump"] = data.sMove.lastBump;
+	droidObj["pauseTime"] = data.sMove.pauseTime;
+	droidObj["bumpPosition"] = data.sMove.bumpPos.xy();
 
 	// formation info
-	if (psCurr->sMove.psFormation != nullptr)
+	if (data.hasFormation)
 	{
 		auto formationObj = nlohmann::json::object();
-		formationObj["direction"] = psCurr->sMove.psFormation->direction;
-		formationObj["x"] = psCurr->sMove.psFormation->x;
-		formationObj["y"] = psCurr->sMove.psFormation->y;
+		formationObj["direction"] = data.formationDirection;
+		formationObj["x"] = data.formationX;
+		formationObj["y"] = data.formationY;
 		droidObj["formation"] = std::move(formationObj);
 	}
 
-	droidObj["underRepair"] = psCurr->underRepair;
+	droidObj["underRepair"] = data.underRepair;
 
-	droidObj["onMission"] = onMission;
+	droidObj["onMission"] = data.onMission;
 	return droidObj;
 }
 
 static bool writeDroidFile(const char *pFileName, const PerPlayerDroidLists& ppsCurrentDroidLists)
 {
-	nlohmann::json mRoot = nlohmann::json::object();
-	int counter = 0;
+	// only copy the droids here, asynchronous autosaves build the JSON in the background
+	std::vector<DroidSaveData> droids;
 	bool onMission = (&ppsCurrentDroidLists == &mission.apsDroidLists);
 
 	for (int player = 0; player < MAX_PLAYERS; player++)
 	{
 		for (DROID *psCurr : ppsCurrentDroidLists[player])
 		{
-			auto droidKey = "droid_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10));  // Zero padded so that alphabetical sort works.
-			mRoot[droidKey.toStdString()] = writeDroid(psCurr, onMission, counter);
+			droids.emplace_back();
+			copyDroid(droids.back(), psCurr, onMission);
 			if (psCurr->isTransporter())	// if transporter save any droids in the grp
 			{
 				if (psCurr->psGroup)
@@ -6116,21 +6328,30 @@ static bool writeDroidFile(const char *pFileName, const PerPlayerDroidLists& pps
 					{
 						if (psTrans != psCurr)
 						{
-							droidKey = "droid_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10));  // Zero padded so that alphabetical sort works.
-							mRoot[droidKey.toStdString()] = writeDroid(psTrans, onMission, counter);
+							droids.emplace_back();
+							copyDroid(droids.back(), psTrans, onMission);
 						}
 					}
 				}
 				//always save transporter droids that are in the mission list with an invalid value
 				if (&ppsCurrentDroidLists[player] == &mission.apsDroidLists[player])
 				{
-					mRoot[droidKey.toStdString()]["position"] = Vector3i(INVALID_XY, INVALID_XY, -1); // Must be INVALID_XY or else unit placement could get messed up in missionResetDroids().
+					droids.back().base.pos = Vector3i(INVALID_XY, INVALID_XY, -1); // Must be INVALID_XY or else unit placement could get messed up in missionResetDroids().
 				}
 			}
 		}
 	}
 
-	return saveJSONToFile(mRoot, pFileName);
+	return saveDeferredJSONToFile([droids = std::move(droids)]() {
+		nlohmann::json mRoot = nlohmann::json::object();
+		int counter = 0;
+		for (const DroidSaveData &data : droids)
+		{
+			auto droidKey = "droid_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10));  // Zero padded so that alphabetical sort works.
+			mRoot[droidKey.toStdString()] = writeDroid(data);
+		}
+		return mRoot;
+	}, pFileName);
 }
 
 
@@ -6426,7 +6647,7 @@ static bool loadWzMapStructure(WzMap::Map& wzMap, std::unordered_map<UDWORD, UDW
 /* code for versions after version 20 of a save structure */
 static bool loadSaveStructure2(const char *pFileName)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!saveSnapshotFileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;	// try to use fallback method
@@ -6706,171 +6927,337 @@ bool writeGameInfo(const char *pFileName)
 	return true;
 }
 
-/*
-Writes the linked list of structure for each player to a file
-*/
-bool writeStructFile(const char *pFileName)
+/// Plain copy of a production run entry, see StructureSaveData
+struct ProductionRunSaveData
 {
-	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
-	int counter = 0;
+	int quantity = 0;
+	int built = 0;
+	bool hasTemplate = false;
+	UDWORD templateId = 0;
+};
 
-	for (int player = 0; player < MAX_PLAYERS; player++)
+/// Plain copy of what writeStructure() saves of a structure, taken by copyStructure()
+struct StructureSaveData
+{
+	SaveObjectData base;
+	WzString name;
+	STRUCTURE_TYPE type = REF_HQ;
+	int resistance = 0;
+	STRUCT_STATES status = SS_BUILT;
+	unsigned numWeaps = 0;
+	WzString weaponParts[MAX_WEAPONS];
+	WEAPON asWeaps[MAX_WEAPONS];
+	SaveObjectRef target[MAX_WEAPONS];
+#ifdef DEBUG
+	std::string targetFunc[MAX_WEAPONS];
+	int targetLine[MAX_WEAPONS] = {};
+#endif
+	uint32_t currentBuildPts = 0;
+	bool hasFunctionality = false;
+	uint8_t capacity = 0;
+	UBYTE productToGroup = UBYTE_MAX;
+	// factories
+	uint8_t productionLoops = 0;
+	UDWORD factoryTimeStarted = 0;
+	int buildPointsRemaining = 0;
+	UDWORD factoryTimeStartHold = 0;
+	UBYTE loopsPerformed = 0;
+	uint32_t factorySecondaryOrder = 0;
+	bool hasFactoryTemplate = false;
+	UDWORD factoryTemplate = 0;
+	bool hasAssemblyPoint = false;
+	Vector3i assemblyPointPos = Vector3i(0, 0, 0);
+	UBYTE assemblyPointSelected = 0;
+	UBYTE assemblyPointNumber = 0;
+	SaveObjectRef factoryCommander;
+	std::vector<ProductionRunSaveData> productionRun;  ///< Only saved for productionPlayer
+	// research facilities
+	UDWORD researchTimeStartHold = 0;
+	bool hasResearchTarget = false;
+	WzString researchTarget;
+	// repair facilities
+	SaveObjectRef repairTarget;
+	bool hasDeliveryPoint = false;
+	Vector3i deliveryPointPos = Vector3i(0, 0, 0);
+	UBYTE deliveryPointSelected = 0;
+	// rearm pads
+	UDWORD rearmTimeStarted = 0;
+	UDWORD rearmTimeLastUpdated = 0;
+	SaveObjectRef rearmTarget;
+	// walls and gates
+	unsigned wallType = 0;
+};
+
+static void copyStructure(StructureSaveData &data, const STRUCTURE *psCurr, int player)
+{
+	copySaveObject(data.base, psCurr);
+	data.name = psCurr->pStructureType->id;
+	data.type = psCurr->pStructureType->type;
+	data.resistance = psCurr->resistance;
+	data.status = psCurr->status;
+	data.numWeaps = psCurr->numWeaps;
+	for (unsigned j = 0; j < psCurr->numWeaps; j++)
 	{
-		for (const STRUCTURE *psCurr : apsStructLists[player])
+		data.weaponParts[j] = psCurr->getWeaponStats(j)->id;
+		data.asWeaps[j] = psCurr->asWeaps[j];
+		data.target[j] = saveObjectRef(psCurr->psTarget[j] && !psCurr->psTarget[j]->died ? psCurr->psTarget[j] : nullptr);
+#ifdef DEBUG
+		data.targetFunc[j] = psCurr->targetFunc[j];
+		data.targetLine[j] = psCurr->targetLine[j];
+#endif
+	}
+	data.currentBuildPts = psCurr->currentBuildPts;
+	data.hasFunctionality = psCurr->pFunctionality != nullptr;
+	if (!data.hasFunctionality)
+	{
+		return;
+	}
+	data.capacity = psCurr->capacity;
+	data.productToGroup = psCurr->productToGroup;
+	if (data.type == REF_FACTORY || data.type == REF_CYBORG_FACTORY || data.type == REF_VTOL_FACTORY)
+	{
+		const FACTORY *psFactory = &psCurr->pFunctionality->factory;
+		data.productionLoops = psFactory->productionLoops;
+		data.factoryTimeStarted = psFactory->timeStarted;
+		data.buildPointsRemaining = psFactory->buildPointsRemaining;
+		data.factoryTimeStartHold = psFactory->timeStartHold;
+		data.loopsPerformed = psFactory->loopsPerformed;
+		data.factorySecondaryOrder = psFactory->secondaryOrder;
+		if (psFactory->psSubject != nullptr)
 		{
-			if (!psCurr->pStructureType)
+			data.hasFactoryTemplate = true;
+			data.factoryTemplate = psFactory->psSubject->multiPlayerID;
+		}
+		const FLAG_POSITION *psFlag = psFactory->psAssemblyPoint;
+		if (psFlag != nullptr)
+		{
+			data.hasAssemblyPoint = true;
+			data.assemblyPointPos = psFlag->coords;
+			data.assemblyPointSelected = psFlag->selected;
+			data.assemblyPointNumber = psFlag->factoryInc;
+		}
+		data.factoryCommander = saveObjectRef(psFactory->psCommander);
+		if (player == productionPlayer)
+		{
+			bool haveRun = psFactory->psAssemblyPoint->factoryInc < asProductionRun[psFactory->psAssemblyPoint->factoryType].size();
+			if (haveRun)
 			{
-				ASSERT(psCurr->pStructureType, "Structure has null pStructureType??");
-				continue;
+				for (const ProductionRunEntry &entry : asProductionRun[psFactory->psAssemblyPoint->factoryType][psFactory->psAssemblyPoint->factoryInc])
+				{
+					ProductionRunSaveData run;
+					run.quantity = entry.quantity;
+					run.built = entry.built;
+					run.hasTemplate = entry.psTemplate != nullptr;
+					run.templateId = run.hasTemplate ? entry.psTemplate->multiPlayerID : 0;
+					data.productionRun.push_back(run);
+				}
 			}
-			ini.beginGroup("structure_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10)));  // Zero padded so that alphabetical sort works.
-			ini.setValue("name", psCurr->pStructureType->id);
+		}
+	}
+	else if (data.type == REF_RESEARCH)
+	{
+		const RESEARCH_FACILITY *psResearch = &psCurr->pFunctionality->researchFacility;
+		data.researchTimeStartHold = psResearch->timeStartHold;
+		if (psResearch->psSubject)
+		{
+			data.hasResearchTarget = true;
+			data.researchTarget = psResearch->psSubject->id;
+		}
+	}
+	else if (data.type == REF_REPAIR_FACILITY)
+	{
+		const REPAIR_FACILITY *psRepair = &psCurr->pFunctionality->repairFacility;
+		data.repairTarget = saveObjectRef(psRepair->psObj);
+		const FLAG_POSITION *psFlag = psRepair->psDeliveryPoint;
+		if (psFlag)
+		{
+			data.hasDeliveryPoint = true;
+			data.deliveryPointPos = psFlag->coords;
+			data.deliveryPointSelected = psFlag->selected;
+		}
+	}
+	else if (data.type == REF_REARM_PAD)
+	{
+		const REARM_PAD *psReArmPad = &psCurr->pFunctionality->rearmPad;
+		data.rearmTimeStarted = psReArmPad->timeStarted;
+		data.rearmTimeLastUpdated = psReArmPad->timeLastUpdated;
+		data.rearmTarget = saveObjectRef(psReArmPad->psObj);
+	}
+	else if (data.type == REF_WALL || data.type == REF_GATE)
+	{
+		data.wallType = psCurr->pFunctionality->wall.type;
+	}
+}
 
-			writeSaveObject(ini, psCurr);
+static nlohmann::json writeStructure(const StructureSaveData &data)
+{
+	nlohmann::json structObj = nlohmann::json::object();
+	structObj["name"] = data.name;
 
-			if (psCurr->resistance > 0)
-			{
-				ini.setValue("resistance", psCurr->resistance);
-			}
-			if (psCurr->status != SS_BUILT)
+	writeSaveObjectJSON(structObj, data.base);
+
+	if (data.resistance > 0)
+	{
+		structObj["resistance"] = data.resistance;
+	}
+	if (data.status != SS_BUILT)
+	{
+		structObj["status"] = data.status;
+	}
+	structObj["weapons"] = data.numWeaps;
+	for (unsigned j = 0; j < data.numWeaps; j++)
+	{
+		const std::string numStr = WzString::number(j).toStdString();
+		structObj["parts/weapon/" + WzString::number(j + 1).toStdString()] = data.weaponParts[j];
+		if (data.asWeaps[j].nStat > 0)
+		{
+			structObj["ammo/" + numStr] = data.asWeaps[j].ammo;
+			structObj["lastFired/" + numStr] = data.asWeaps[j].lastFired;
+			structObj["shotsFired/" + numStr] = data.asWeaps[j].shotsFired;
+			structObj["rotation/" + numStr] = toVector(data.asWeaps[j].rot);
+		}
+	}
+	for (unsigned i = 0; i < data.numWeaps; i++)
+	{
+		if (data.target[i].valid)
+		{
+			const std::string key = "target/" + WzString::number(i).toStdString();
+			structObj[key + "/id"] = data.target[i].id;
+			structObj[key + "/player"] = data.target[i].player;
+			structObj[key + "/type"] = data.target[i].type;
+#ifdef DEBUG
+			structObj[key + "/debugfunc"] = data.targetFunc[i];
+			structObj[key + "/debugline"] = data.targetLine[i];
+#endif
+		}
+	}
+	structObj["currentBuildPts"] = data.currentBuildPts;
+	if (data.hasFunctionality)
+	{
+		if (data.type == REF_FACTORY || data.type == REF_CYBORG_FACTORY
+		    || data.type == REF_VTOL_FACTORY)
+		{
+			structObj["modules"] = data.capacity;
+			structObj["Factory/productionLoops"] = data.productionLoops;
+			structObj["Factory/timeStarted"] = data.factoryTimeStarted;
+			structObj["Factory/buildPointsRemaining"] = data.buildPointsRemaining;
+			structObj["Factory/timeStartHold"] = data.factoryTimeStartHold;
+			structObj["Factory/loopsPerformed"] = data.loopsPerformed;
+			// statusPending and pendingCount belong to the GUI, not the game state.
+			structObj["Factory/secondaryOrder"] = data.factorySecondaryOrder;
+
+			if (data.hasFactoryTemplate)
 			{
-				ini.setValue("status", psCurr->status);
+				structObj["Factory/template"] = data.factoryTemplate;
 			}
-			ini.setValue("weapons", psCurr->numWeaps);
-			for (unsigned j = 0; j < psCurr->numWeaps; j++)
+			if (data.hasAssemblyPoint)
 			{
-				ini.setValue("parts/weapon/" + WzString::number(j + 1), psCurr->getWeaponStats(j)->id);
-				if (psCurr->asWeaps[j].nStat > 0)
+				structObj["Factory/assemblyPoint/pos"] = data.assemblyPointPos;
+				if (data.assemblyPointSelected)
 				{
-					ini.setValue("ammo/" + WzString::number(j), psCurr->asWeaps[j].ammo);
-					ini.setValue("lastFired/" + WzString::number(j), psCurr->asWeaps[j].lastFired);
-					ini.setValue("shotsFired/" + WzString::number(j), psCurr->asWeaps[j].shotsFired);
-					ini.setVector3i("rotation/" + WzString::number(j), toVector(psCurr->asWeaps[j].rot));
+					structObj["Factory/assemblyPoint/selected"] = data.assemblyPointSelected;
 				}
+				structObj["Factory/assemblyPoint/number"] = data.assemblyPointNumber;
 			}
-			for (unsigned i = 0; i < psCurr->numWeaps; i++)
+			if (data.factoryCommander.valid)
 			{
-				if (psCurr->psTarget[i] && !psCurr->psTarget[i]->died)
-				{
-					ini.setValue("target/" + WzString::number(i) + "/id", psCurr->psTarget[i]->id);
-					ini.setValue("target/" + WzString::number(i) + "/player", psCurr->psTarget[i]->player);
-					ini.setValue("target/" + WzString::number(i) + "/type", psCurr->psTarget[i]->type);
-#ifdef DEBUG
-					ini.setValue("target/" + WzString::number(i) + "/debugfunc", WzString::fromUtf8(psCurr->targetFunc[i]));
-					ini.setValue("target/" + WzString::number(i) + "/debugline", psCurr->targetLine[i]);
-#endif
-				}
+				structObj["Factory/commander/id"] = data.factoryCommander.id;
+				structObj["Factory/commander/player"] = data.factoryCommander.player;
 			}
-			ini.setValue("currentBuildPts", psCurr->currentBuildPts);
-			if (psCurr->pFunctionality)
+			structObj["Factory/productionRuns"] = (int)data.productionRun.size();
+			for (size_t runNum = 0; runNum < data.productionRun.size(); runNum++)
 			{
-				if (psCurr->pStructureType->type == REF_FACTORY || psCurr->pStructureType->type == REF_CYBORG_FACTORY
-				    || psCurr->pStructureType->type == REF_VTOL_FACTORY)
+				const std::string key = "Factory/Run/" + WzString::number(runNum).toStdString();
+				structObj[key + "/quantity"] = data.productionRun[runNum].quantity;
+				structObj[key + "/built"] = data.productionRun[runNum].built;
+				if (data.productionRun[runNum].hasTemplate)
 				{
-					FACTORY *psFactory = (FACTORY *)psCurr->pFunctionality;
-					ini.setValue("modules", psCurr->capacity);
-					ini.setValue("Factory/productionLoops", psFactory->productionLoops);
-					ini.setValue("Factory/timeStarted", psFactory->timeStarted);
-					ini.setValue("Factory/buildPointsRemaining", psFactory->buildPointsRemaining);
-					ini.setValue("Factory/timeStartHold", psFactory->timeStartHold);
-					ini.setValue("Factory/loopsPerformed", psFactory->loopsPerformed);
-					// statusPending and pendingCount belong to the GUI, not the game state.
-					ini.setValue("Factory/secondaryOrder", psFactory->secondaryOrder);
-
-					if (psFactory->psSubject != nullptr)
-					{
-						ini.setValue("Factory/template", psFactory->psSubject->multiPlayerID);
-					}
-					FLAG_POSITION *psFlag = ((FACTORY *)psCurr->pFunctionality)->psAssemblyPoint;
-					if (psFlag != nullptr)
-					{
-						ini.setVector3i("Factory/assemblyPoint/pos", psFlag->coords);
-						if (psFlag->selected)
-						{
-							ini.setValue("Factory/assemblyPoint/selected", psFlag->selected);
-						}
-						ini.setValue("Factory/assemblyPoint/number", psFlag->factoryInc);
-					}
-					if (psFactory->psCommander)
-					{
-						ini.setValue("Factory/commander/id", psFactory->psCommander->id);
-						ini.setValue("Factory/commander/player", psFactory->psCommander->player);
-					}
-					ini.setValue("Factory/secondaryOrder", psFactory->secondaryOrder);
-					if (player == productionPlayer)
-					{
-						ProductionRun emptyRun;
-						bool haveRun = psFactory->psAssemblyPoint->factoryInc < asProductionRun[psFactory->psAssemblyPoint->factoryType].size();
-						ProductionRun const &productionRun = haveRun ? asProductionRun[psFactory->psAssemblyPoint->factoryType][psFactory->psAssemblyPoint->factoryInc] : emptyRun;
-						ini.setValue("Factory/productionRuns", (int)productionRun.size());
-						for (size_t runNum = 0; runNum < productionRun.size(); runNum++)
-						{
-							ProductionRunEntry psCurrentProd = productionRun.at(runNum);
-							ini.setValue("Factory/Run/" + WzString::number(runNum) + "/quantity", psCurrentProd.quantity);
-							ini.setValue("Factory/Run/" + WzString::number(runNum) + "/built", psCurrentProd.built);
-							if (psCurrentProd.psTemplate) ini.setValue("Factory/Run/" + WzString::number(runNum) + "/template",
-										psCurrentProd.psTemplate->multiPlayerID);
-						}
-					}
-					else
-					{
-						ini.setValue("Factory/productionRuns", 0);
-					}
-					ini.setValue("productToGroup", psCurr->productToGroup);
+					structObj[key + "/template"] = data.productionRun[runNum].templateId;
 				}
-				else if (psCurr->pStructureType->type == REF_RESEARCH)
-				{
-					ini.setValue("modules", psCurr->capacity);
-					ini.setValue("Research/timeStartHold", ((RESEARCH_FACILITY *)psCurr->pFunctionality)->timeStartHold);
-					if (((RESEARCH_FACILITY *)psCurr->pFunctionality)->psSubject)
-					{
-						ini.setValue("Research/target", ((RESEARCH_FACILITY *)psCurr->pFunctionality)->psSubject->id);
-					}
-				}
-				else if (psCurr->pStructureType->type == REF_POWER_GEN)
-				{
-					ini.setValue("modules", psCurr->capacity);
-				}
-				else if (psCurr->pStructureType->type == REF_REPAIR_FACILITY)
-				{
-					REPAIR_FACILITY *psRepair = ((REPAIR_FACILITY *)psCurr->pFunctionality);
-					if (psRepair->psObj)
-					{
-						ini.setValue("Repair/target/id", psRepair->psObj->id);
-						ini.setValue("Repair/target/player", psRepair->psObj->player);
-						ini.setValue("Repair/target/type", psRepair->psObj->type);
-					}
-					FLAG_POSITION *psFlag = psRepair->psDeliveryPoint;
-					if (psFlag)
-					{
-						ini.setVector3i("Repair/deliveryPoint/pos", psFlag->coords);
-						if (psFlag->selected)
-						{
-							ini.setValue("Repair/deliveryPoint/selected", psFlag->selected);
-						}
-					}
-				}
-				else if (psCurr->pStructureType->type == REF_REARM_PAD)
-				{
-					REARM_PAD *psReArmPad = ((REARM_PAD *)psCurr->pFunctionality);
-					ini.setValue("Rearm/timeStarted", psReArmPad->timeStarted);
-					ini.setValue("Rearm/timeLastUpdated", psReArmPad->timeLastUpdated);
-					if (psReArmPad->psObj)
-					{
-						ini.setValue("Rearm/target/id", psReArmPad->psObj->id);
-						ini.setValue("Rearm/target/player", psReArmPad->psObj->player);
-						ini.setValue("Rearm/target/type", psReArmPad->psObj->type);
-					}
-				}
-				else if (psCurr->pStructureType->type == REF_WALL || psCurr->pStructureType->type == REF_GATE)
+			}
+			structObj["productToGroup"] = data.productToGroup;
+		}
+		else if (data.type == REF_RESEARCH)
+		{
+			structObj["modules"] = data.capacity;
+			structObj["Research/timeStartHold"] = data.researchTimeStartHold;
+			if (data.hasResearchTarget)
+			{
+				structObj["Research/target"] = data.researchTarget;
+			}
+		}
+		else if (data.type == REF_POWER_GEN)
+		{
+			structObj["modules"] = data.capacity;
+		}
+		else if (data.type == REF_REPAIR_FACILITY)
+		{
+			if (data.repairTarget.valid)
+			{
+				structObj["Repair/target/id"] = data.repairTarget.id;
+				structObj["Repair/target/player"] = data.repairTarget.player;
+				structObj["Repair/target/type"] = data.repairTarget.type;
+			}
+			if (data.hasDeliveryPoint)
+			{
+				structObj["Repair/deliveryPoint/pos"] = data.deliveryPointPos;
+				if (data.deliveryPointSelected)
 				{
-					ini.setValue("Wall/type", psCurr->pFunctionality->wall.type);
+					structObj["Repair/deliveryPoint/selected"] = data.deliveryPointSelected;
 				}
 			}
-			ini.endGroup();
+		}
+		else if (data.type == REF_REARM_PAD)
+		{
+			structObj["Rearm/timeStarted"] = data.rearmTimeStarted;
+			structObj["Rearm/timeLastUpdated"] = data.rearmTimeLastUpdated;
+			if (data.rearmTarget.valid)
+			{
+				structObj["Rearm/target/id"] = data.rearmTarget.id;
+				structObj["Rearm/target/player"] = data.rearmTarget.player;
+				structObj["Rearm/target/type"] = data.rearmTarget.type;
+			}
+		}
+		else if (data.type == REF_WALL || data.type == REF_GATE)
+		{
+			structObj["Wall/type"] = data.wallType;
 		}
 	}
-	return true;
+	return structObj;
+}
+
+/*
+Writes the linked list of structure for each player to a file
+*/
+bool writeStructFile(const char *pFileName)
+{
+	// only copy the structures here, asynchronous autosaves build the JSON in the background
+	std::vector<StructureSaveData> structures;
+
+	for (int player = 0; player < MAX_PLAYERS; player++)
+	{
+		for (const STRUCTURE *psCurr : apsStructLists[player])
+		{
+			if (!psCurr->pStructureType)
+			{
+				ASSERT(psCurr->pStructureType, "Structure has null pStructureType??");
+				continue;
+			}
+			structures.emplace_back();
+			copyStructure(structures.back(), psCurr, player);
+		}
+	}
+
+	return saveDeferredJSONToFile([structures = std::move(structures)]() {
+		nlohmann::json mRoot = nlohmann::json::object();
+		int counter = 0;
+		for (const StructureSaveData &data : structures)
+		{
+			auto structKey = "structure_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10));  // Zero padded so that alphabetical sort works.
+			mRoot[structKey.toStdString()] = writeStructure(data);
+		}
+		return mRoot;
+	}, pFileName);
 }
 
 // -----------------------------------------------------------------------------------------
@@ -7139,7 +7526,7 @@ static bool loadWzMapFeature(WzMap::Map &wzMap, std::unordered_map<UDWORD, UDWOR
 
 bool loadSaveFeature2(const char *pFileName)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!saveSnapshotFileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;
@@ -7214,17 +7601,34 @@ Writes the linked list of features to a file
 */
 bool writeFeatureFile(const char *pFileName)
 {
-	WzConfig ini(WzString::fromUtf8(pFileName), WzConfig::ReadAndWrite);
-	int counter = 0;
+	// only copy the features here, asynchronous autosaves build the JSON in the background
+	struct FeatureSaveData
+	{
+		SaveObjectData base;
+		WzString name;
+	};
+	std::vector<FeatureSaveData> features;
 
 	for (const FEATURE *psCurr : apsFeatureLists[0])
 	{
-		ini.beginGroup("feature_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10)));  // Zero padded so that alphabetical sort works.
-		ini.setValue("name", psCurr->psStats->id);
-		writeSaveObject(ini, psCurr);
-		ini.endGroup();
+		features.emplace_back();
+		features.back().name = psCurr->psStats->id;
+		copySaveObject(features.back().base, psCurr);
 	}
-	return true;
+
+	return saveDeferredJSONToFile([features = std::move(features)]() {
+		nlohmann::json mRoot = nlohmann::json::object();
+		int counter = 0;
+		for (const FeatureSaveData &data : features)
+		{
+			nlohmann::json featureObj = nlohmann::json::object();
+			featureObj["name"] = data.name;
+			writeSaveObjectJSON(featureObj, data.base);
+			auto featureKey = "feature_" + (WzString::number(counter++).leftPadToMinimumLength(WzUniCodepoint::fromASCII('0'), 10));  // Zero padded so that alphabetical sort works.
+			mRoot[featureKey.toStdString()] = std::move(featureObj);
+		}
+		return mRoot;
+	}, pFileName);
 }
 
 // -----------------------------------------------------------------------------------------
@@ -7327,7 +7731,7 @@ bool writeTemplateFile(const char *pFileName)
 	}
 	mRoot["localTemplates"] = std::move(localtemplates_array);
 
-	return saveJSONToFile(mRoot, pFileName);
+	return saveJSONToFile(std::move(mRoot), pFileName);
 }
 
 // Maps built into the game with custom tile types need to be excluded for overrides.
@@ -7778,7 +8182,7 @@ static bool writeResearchFile(char *pFileName)
 			mRoot[resKey.toStdString()] = std::move(resObj);
 		}
 	}
-	return saveJSONToFile(mRoot, pFileName);
+	return saveJSONToFile(std::move(mRoot), pFileName);
 }
 
 
@@ -8155,12 +8559,12 @@ static bool writeSaveGuideTopics(const char *pFileName)
 	options["disable_topic_popups"] = getGameGuideDisableTopicPopups();
 	mRoot["options"] = std::move(options);
 
-	return saveJSONToFile(mRoot, pFileName);
+	return saveJSONToFile(std::move(mRoot), pFileName);
 }
 
 static bool loadSaveGuideTopics(const char *pFileName)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!saveSnapshotFileExists(pFileName))
 	{
 		return true; // older saves will have this file - expected
 	}
@@ -105,6 +105,7 @@ void gameScreenSizeDidChange(unsigned int oldWidth, unsigned int oldHeight, unsi
 void gameDisplayScaleFactorDidChange(float newDisplayScaleFactor);
 nonstd::optional<nlohmann::json> parseJsonFile(const char *filename);
 bool saveJSONToFile(const nlohmann::json& obj, const char* pFileName);
+bool saveJSONToFile(nlohmann::json&& obj, const char* pFileName);
 
 #if defined(__EMSCRIPTEN__)
 void wz_emscripten_did_finish_render(unsigned int browserRenderDelta);
@@ -30,6 +30,9 @@
 #include "lib/framework/frameresource.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/savesnapshot.h"
+#include "lib/framework/parallel_for.h"
+#include "lib/framework/physfs_fileview.h"
 #include "3rdparty/physfs_memoryio.h"
 #include "lib/framework/wzapp.h"
 #include "lib/ivis_opengl/piemode.h"
@@ -105,10 +108,12 @@
 #include "wzapi.h"
 
 #include "wzphysfszipioprovider.h"
+#include "mapindexcache.h"
 #include <wzmaplib/map_package.h>
 
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <array>
 
 static void initMiscVars();
@@ -626,6 +631,7 @@ bool rebuildSearchPath(searchPathMode mode, bool force)
 			// This should properly remove all paths, but testing is needed to ensure that all supported versions of PhysFS behave as expected
 			// For now, keep the old code above as well as this new method
 			clearAllPhysFSSearchPaths();
+			WZ_PHYSFS_releaseArchiveMappings();
 			searchPathMountErrors.clear();
 			break;
 		case mod_campaign:
@@ -980,6 +986,77 @@ private:
 	bool m_logErrors = false;
 };
 
+struct MapScanResult
+{
+	std::string realFilePathAndName;  ///< Empty if the file could not be found or opened
+	bool opened = false;              ///< Whether the archive had to be opened (because it wasn't in the map index cache)
+	MapIndexEntry entry;
+};
+
+// Called from worker threads: only uses the (thread-safe) PhysFS functions and its own archive.
+static MapScanResult scanMapArchive(const MapFileListPath& realFileName, const MapIndexCache& cache)
+{
+	MapScanResult result;
+	const char * pRealDirStr = PHYSFS_getRealDir(realFileName.platformIndependent.c_str());
+	if (!pRealDirStr)
+	{
+		debug(LOG_ERROR, "Failed to find realdir for: %s", realFileName.platformIndependent.c_str());
+		return result;
+	}
+	std::string realFilePathAndName = pRealDirStr + realFileName.platformDependent;
+
+	auto fingerprint = mapIndexFingerprint(realFileName.platformIndependent);
+	if (!fingerprint.has_value())
+	{
+		debug(LOG_ERROR, "Failed to open: %s", realFileName.platformIndependent.c_str());
+		return result;
+	}
+	result.realFilePathAndName = realFilePathAndName;
+	const MapIndexEntry *cached = cache.find(realFilePathAndName, fingerprint.value());
+	if (cached)
+	{
+		result.entry = *cached;
+		if (!result.entry.valid)
+		{
+			debug(LOG_INFO, "Skipping %s, which failed to load before.\nPlease delete or move the file specified.", realFilePathAndName.c_str());
+		}
+		return result;
+	}
+	result.opened = true;
+	result.entry.fingerprint = fingerprint.value();
+
+	auto zipReadSource = WzZipIOPHYSFSSourceReadProvider::make(realFileName.platformIndependent);
+	if (!zipReadSource)
+	{
+		debug(LOG_ERROR, "Failed to open: %s", realFileName.platformIndependent.c_str());
+		result.realFilePathAndName.clear();
+		return result;
+	}
+
+	auto debugLoggerInstance = std::make_shared<WzMapLoadDebugLogger>();
+	debugLoggerInstance->setLogErrors(true);
+	auto mapZipIO = WzMapZipIO::openZipArchiveReadIOProvider(zipReadSource, debugLoggerInstance.get());
+	if (!mapZipIO)
+	{
+		debug(LOG_INFO, "Failed to open archive: %s.\nPlease delete or move the file specified.", realFilePathAndName.c_str());
+		return result;
+	}
+	debugLoggerInstance->setLogErrors(false);
+	auto mapPackage = WzMap::MapPackage::loadPackage("", debugLoggerInstance, mapZipIO);
+	if (!mapPackage)
+	{
+		debug(LOG_INFO, "Failed to load %s.\nPlease delete or move the file specified.", realFilePathAndName.c_str());
+		return result;
+	}
+
+	result.entry.valid = true;
+	result.entry.details = mapPackage->levelDetails();
+	auto mapInfo = CheckInMap(*mapPackage);
+	result.entry.isMapMod = mapInfo.isMapMod;
+	result.entry.isRandom = mapInfo.isRandom;
+	return result;
+}
+
 bool buildMapList(bool campaignOnly)
 {
 	if (!loadLevFile("gamedesc.lev", mod_campaign, false, nullptr))
@@ -1001,48 +1078,48 @@ bool buildMapList(bool campaignOnly)
 		return true;
 	}
 	MapFileList realFileNames = listMapFiles();
-	auto debugLoggerInstance = std::make_shared<WzMapLoadDebugLogger>();
-	for (auto &realFileName : realFileNames)
-	{
-		const char * pRealDirStr = PHYSFS_getRealDir(realFileName.platformIndependent.c_str());
-		if (!pRealDirStr)
-		{
-			debug(LOG_ERROR, "Failed to find realdir for: %s", realFileName.platformIndependent.c_str());
-			continue; // skip
-		}
-		std::string realFilePathAndName = pRealDirStr + realFileName.platformDependent;
 
-		auto zipReadSource = WzZipIOPHYSFSSourceReadProvider::make(realFileName.platformIndependent);
-		if (!zipReadSource)
+	// Opening every archive is slow with many maps, so only new or modified archives are opened (on all cores),
+	// and the level details of the others come from the map index cache.
+	MapIndexCache &cache = mapIndexCache();
+	cache.load();
+	std::vector<MapScanResult> results(realFileNames.size());
+	wzParallelFor(realFileNames.size(), [&](size_t idx) {
+		results[idx] = scanMapArchive(realFileNames[idx], cache);
+	});
+
+	std::unordered_set<std::string> scannedPaths;
+	size_t numOpened = 0;
+	for (size_t idx = 0; idx < realFileNames.size(); ++idx)
+	{
+		auto &result = results[idx];
+		if (result.realFilePathAndName.empty())
 		{
-			debug(LOG_ERROR, "Failed to open: %s", realFileName.platformIndependent.c_str());
-			continue;
+			continue; // failed to find or open the file
 		}
-
-		debugLoggerInstance->setLogErrors(true);
-		auto mapZipIO = WzMapZipIO::openZipArchiveReadIOProvider(zipReadSource, debugLoggerInstance.get());
-		if (!mapZipIO)
+		scannedPaths.insert(result.realFilePathAndName);
+		if (result.opened)
 		{
-			debug(LOG_INFO, "Failed to open archive: %s.\nPlease delete or move the file specified.", realFilePathAndName.c_str());
-			continue;
+			++numOpened;
+			cache.set(result.realFilePathAndName, result.entry);
 		}
-		debugLoggerInstance->setLogErrors(false);
-		auto mapPackage = WzMap::MapPackage::loadPackage("", debugLoggerInstance, mapZipIO);
-		if (!mapPackage)
+		if (!result.entry.valid)
 		{
-			debug(LOG_INFO, "Failed to load %s.\nPlease delete or move the file specified.", realFilePathAndName.c_str());
 			continue;
 		}
 
-		if (!levAddWzMap(mapPackage->levelDetails(), mod_multiplay, realFileName.platformIndependent.c_str()))
+		const auto& realFileName = realFileNames[idx];
+		if (!levAddWzMap(result.entry.details, mod_multiplay, realFileName.platformIndependent.c_str()))
 		{
-			debug(LOG_ERROR, "Corrupt / invalid map file: %s", realFilePathAndName.c_str());
+			debug(LOG_ERROR, "Corrupt / invalid map file: %s", result.realFilePathAndName.c_str());
 			continue;
 		}
 
-		auto WZmapInfoResult = CheckInMap(*mapPackage);
-		WZ_Maps.insert(WZMapInfo_Map::value_type(realFileName.platformIndependent, WZmapInfoResult));
+		WZ_Maps.insert(WZMapInfo_Map::value_type(realFileName.platformIndependent, WZmapInfo(result.entry.isMapMod, result.entry.isRandom)));
 	}
+	cache.retain(scannedPaths);
+	cache.save();
+	debug(LOG_WZ, "Found %zu maps, opened %zu new or modified map archives", WZ_Maps.size(), numOpened);
 
 	return true;
 }
@@ -1162,6 +1239,7 @@ void systemShutdown()
 	fpathShutdown();
 	mapShutdown();
 	modelShutdown();
+	modelTrimBinaryCache();
 	debug(LOG_MAIN, "shutting down everything else");
 	pal_ShutDown();		// currently unused stub
 	frameShutDown();	// close screen / SDL / resources / cursors / trig
@@ -1169,6 +1247,8 @@ void systemShutdown()
 	shutdownLobbyBrowserFetches();
 	netplayShutDown();	// MUST come after widgShutDown (as widget screens might have connections, etc)
 	gfx_api::context::get().shutdown();
+	gfx_api::trimCompressedTextureCache();
+	saveSnapshotWaitForPendingWrites();	// finish any autosave still being written in the background
 	cleanSearchPath();	// clean PHYSFS search paths
 	debug_exit();		// cleanup debug routines
 	PHYSFS_deinit();	// cleanup PHYSFS (If failure, state of PhysFS is undefined, and probably badly screwed up.)
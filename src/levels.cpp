@@ -55,6 +55,7 @@
 #include <wzmaplib/map_package.h>
 
 #include <unordered_set>
+#include <chrono>
 
 #include "3rdparty/gsl_finally.h"
 
@@ -869,6 +870,36 @@ static GameLoadDetails levConstructGameLoadDetails(LEVEL_DATASET* psNewLevel, SW
 	return GameLoadDetails::makeLevelFileLoad(psNewLevel->apDataFiles[scenarioIndex]);
 }
 
+// Measures how long the stages of levLoadData() take, for the level load timing report
+class LevelLoadTimer
+{
+public:
+	/// Records the time since the previous stage (or since construction) as `name`
+	void stage(const std::string &name)
+	{
+		auto now = std::chrono::steady_clock::now();
+		stages.emplace_back(name, static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count()));
+		last = now;
+	}
+
+	void report(const char *levelName) const
+	{
+		debug(LOG_INFO, "Loaded level %s in %d ms:", levelName, static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(last - start).count()));
+		for (const auto &stage : stages)
+		{
+			debug(LOG_INFO, "  %6d ms  %s", stage.second, stage.first.c_str());
+		}
+		const auto textureCacheStats = gfx_api::getCompressedTextureCacheStats();
+		debug(LOG_INFO, "  Texture cache: %zu hits, %zu misses, %zu stored", textureCacheStats.hits - startTextureCacheStats.hits, textureCacheStats.misses - startTextureCacheStats.misses, textureCacheStats.stores - startTextureCacheStats.stores);
+	}
+
+private:
+	gfx_api::texture_cache_stats startTextureCacheStats = gfx_api::getCompressedTextureCacheStats();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point last = start;
+	std::vector<std::pair<std::string, int>> stages;
+};
+
 // load up the data for a level
 bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYPE saveType)
 {
@@ -886,6 +917,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 	ASSERT(strcmp(setlocale(LC_NUMERIC, NULL), "C") == 0, "The LC_NUMERIC locale is not \"C\" - this may break level-data parsing depending on the user's system locale settings");
 
 	levelLoadType = saveType;
+	LevelLoadTimer levelLoadTimer;
 
 	// find the level dataset
 	LEVEL_DATASET* psNewLevel = levFindDataSet(name, hash);
@@ -996,6 +1028,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 			debug(LOG_ERROR, "Failed stageOneInitialise!");
 			return false;
 		}
+		levelLoadTimer.stage("stageOneInitialise");
 	}
 
 	// load up a base dataset if necessary
@@ -1013,6 +1046,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					debug(LOG_ERROR, "Failed resLoad(%s)!", psBaseData->apDataFiles[i].c_str());
 					return false;
 				}
+				levelLoadTimer.stage(psBaseData->apDataFiles[i]);
 			}
 		}
 	}
@@ -1044,6 +1078,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 				   factionModelInfo.factionModel.toUtf8().c_str(), factionModelInfo.normalModel.toUtf8().c_str());
 		}
 		resDoResLoadCallback();		// do callback.
+		levelLoadTimer.stage("faction models");
 	}
 
 	if (psNewLevel->type == LEVEL_TYPE::LDS_CAMCHANGE)
@@ -1067,6 +1102,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					debug(LOG_ERROR, "Failed stageTwoInitialise()!");
 					return false;
 				}
+				levelLoadTimer.stage("stageTwoInitialise");
 			}
 
 			//set the mission type before the saveGame data is loaded
@@ -1089,6 +1125,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 				debug(LOG_ERROR, "Failed loadGame(%s)!", pSaveName);
 				return false;
 			}
+			levelLoadTimer.stage("loadGame");
 		}
 
 		if (pSaveName == nullptr || saveType == GTYPE_SAVE_START)
@@ -1099,6 +1136,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 				debug(LOG_ERROR, "Failed startMission(%d)!", static_cast<int8_t>(psNewLevel->type));
 				return false;
 			}
+			levelLoadTimer.stage("startMission");
 		}
 	}
 
@@ -1114,6 +1152,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					debug(LOG_ERROR, "Failed stageTwoInitialise() [camchange]!");
 					return false;
 				}
+				levelLoadTimer.stage("stageTwoInitialise");
 			}
 
 			debug(LOG_NEVER, "loading savegame: %s", pSaveName);
@@ -1122,6 +1161,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 				debug(LOG_ERROR, "Failed loadGame(%s)!", pSaveName);
 				return false;
 			}
+			levelLoadTimer.stage("loadGame");
 
 			campaignReset();
 		}
@@ -1142,6 +1182,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					debug(LOG_ERROR, "Failed stageTwoInitialise() [newdata]!");
 					return false;
 				}
+				levelLoadTimer.stage("stageTwoInitialise");
 			}
 
 			// load a savegame if there is one - but not if already done so
@@ -1167,6 +1208,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					debug(LOG_ERROR, "Failed loadGame(%s)!", pSaveName);
 					return false;
 				}
+				levelLoadTimer.stage("loadGame");
 			}
 
 			if (pSaveName == nullptr || saveType == GTYPE_SAVE_START)
@@ -1253,6 +1295,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 					}
 					break;
 				}
+				levelLoadTimer.stage(psNewLevel->apDataFiles[i]);
 			}
 		}
 		else if (!psNewLevel->apDataFiles[i].empty())
@@ -1264,6 +1307,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 				debug(LOG_ERROR, "Failed resLoad(%s, %d) (default)!", psNewLevel->apDataFiles[i].c_str(), i + CURRENT_DATAID);
 				return false;
 			}
+			levelLoadTimer.stage(psNewLevel->apDataFiles[i]);
 		}
 	}
 
@@ -1294,12 +1338,14 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 			return false;
 		}
 	}
+	levelLoadTimer.stage("scripts and mission extras");
 	// this will trigger upgrades
 	if (!stageThreeInitialise())
 	{
 		debug(LOG_ERROR, "Failed stageThreeInitialise()!");
 		return false;
 	}
+	levelLoadTimer.stage("stageThreeInitialise");
 
 	dataClearSaveFlag();
 
@@ -1337,6 +1383,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 
 	ActivityManager::instance().loadedLevel(psCurrLevel->type, mapNameWithoutTechlevel(getLevelName()));
 
+	levelLoadTimer.report(psCurrLevel->pName.c_str());
 	return true;
 }
 
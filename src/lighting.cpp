@@ -50,7 +50,6 @@ static Vector3f theSun(0.f, 0.f, 0.f);
 static Vector3f theSun_ForTileIllumination(0.f, 0.f, 0.f);
 
 /*	Module function Prototypes */
-static UDWORD calcDistToTile(UDWORD tileX, UDWORD tileY, Vector3i *pos);
 static void calcTileIllum(UDWORD tileX, UDWORD tileY);
 
 
@@ -280,19 +279,37 @@ void rendering1999::LightingManager::ComputeFrameData(const LightingData& data,
 		endY = MIN(endY, mapHeight - 1);
 		startY = MIN(startY, endY);
 
-		for (int i = startX; i <= endX; i++)
+		// Go through the tiles a row at a time (the order of the lightmap data): first the squared distances of the
+		// whole row to the light, in a loop without branches that the compiler can vectorise, then only the tiles in range
+		const int64_t range = psLight->range;
+		const int rowLength = endX - startX + 1;
+		lightRowDistances.resize(rowLength);
+		lightRowHeights.resize(rowLength);
+		for (int j = startY; j <= endY; j++)
 		{
-			for (int j = startY; j <= endY; j++)
+			const MAPTILE *psRow = mapTile(startX, j);
+			for (int i = 0; i < rowLength; i++)
+			{
+				lightRowHeights[i] = psRow[i].height;
+			}
+			const int64_t dz = static_cast<int64_t>(j * TILE_UNITS - psLight->position.z);
+			const int64_t dx0 = static_cast<int64_t>(startX * TILE_UNITS - psLight->position.x);
+			for (int i = 0; i < rowLength; i++)
+			{
+				const int64_t dx = dx0 + static_cast<int64_t>(i) * TILE_UNITS;
+				const int64_t dy = lightRowHeights[i] - psLight->position.y;
+				lightRowDistances[i] = dx * dx + dy * dy + dz * dz;
+			}
+			for (int i = 0; i < rowLength; i++)
 			{
-				auto position = psLight->position;
-				int distToCorner = calcDistToTile(i, j, &position);
-
 				/* If we're inside the range of the light */
-				if (distToCorner < (SDWORD)psLight->range)
+				if (lightRowDistances[i] < range * range)
 				{
+					// Rounded down, like iHypot3()
+					const int distToCorner = static_cast<int>(sqrt(static_cast<double>(lightRowDistances[i])));
 					/* Find how close we are to it */
 					double ratio = (100.0 - PERCENT(distToCorner, psLight->range)) / 100.0;
-					colourTile(lightmap, i, j, psLight->colour, ratio);
+					colourTile(lightmap, startX + i, j, psLight->colour, ratio);
 				}
 			}
 		}
@@ -300,18 +317,6 @@ void rendering1999::LightingManager::ComputeFrameData(const LightingData& data,
 }
 
 
-static UDWORD calcDistToTile(UDWORD tileX, UDWORD tileY, Vector3i *pos)
-{
-	int x1, y1, z1;
-
-	/* The coordinates of the tile corner */
-	x1 = tileX * TILE_UNITS;
-	y1 = map_TileHeight(tileX, tileY);
-	z1 = tileY * TILE_UNITS;
-
-	return iHypot3(x1 - pos->x, y1 - pos->y, z1 - pos->z);
-}
-
 /// Sets the begin and end distance for the distance fog (mist)
 /// It should provide maximum visibility and minimum
 /// "popping" tiles
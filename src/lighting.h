@@ -31,6 +31,10 @@ namespace rendering1999
 	struct LightingManager final : ILightingManager {
 
 		void ComputeFrameData(const LightingData& data, LightMap& lightmap, const glm::mat4& worldViewProjectionMatrix) override;
+	private:
+		// cached containers to avoid frequent reallocations
+		std::vector<int32_t> lightRowHeights;
+		std::vector<int64_t> lightRowDistances; // squared
 	};
 }
 
@@ -28,6 +28,7 @@
 #include <physfs.h>
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/savesnapshot.h"
 #include <ctime>
 
 #include "lib/framework/frame.h"
@@ -556,6 +557,9 @@ void deleteSaveGame_classic(const char *gamFileName)
 
 void deleteSaveGame(std::string saveGameFolderPath)
 {
+	// an autosave may still be written to this folder in the background
+	saveSnapshotWaitForPendingWrites();
+
 	// Remove any trailing path separators (/)
 	while (!saveGameFolderPath.empty() && (saveGameFolderPath.rfind("/", std::string::npos) == (saveGameFolderPath.length() - 1)))
 	{
@@ -595,6 +599,13 @@ void deleteSaveGame(std::string saveGameFolderPath)
 	{
 		debug(LOG_ERROR, "Warning directory[%s] could not be deleted because %s", saveGameFolderPath.c_str(), WZ_PHYSFS_getLastError());
 	}
+
+	// incremental autosaves in the parent directory share base snapshots, which may not be used by any other save game now
+	size_t parentDirEnd = saveGameFolderPath.rfind('/');
+	if (parentDirEnd != std::string::npos && parentDirEnd > 0)
+	{
+		saveSnapshotRemoveUnusedBases(saveGameFolderPath.substr(0, parentDirEnd).c_str());
+	}
 }
 
 SaveGamePath_t lastSavePath;
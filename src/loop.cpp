@@ -88,6 +88,7 @@
 #include "gamehistorylogger.h"
 #include "profiling.h"
 #include "wzapi.h"
+#include "replayverify.h"
 
 #include "warzoneconfig.h"
 
@@ -308,7 +309,15 @@ static GAMECODE renderLoop()
 			pie_LoadBackDrop(SCREEN_RANDOMBDROP);
 		}
 	}
-	if (!loop_GetVideoStatus() && !quitting && !headlessGameMode() && !skipDrawing)
+	if (!loop_GetVideoStatus() && !quitting && headlessGameMode() && headlessRenderEnabled() && !skipDrawing)
+	{
+		// no input or interface, just the 3D scene (with the null backend)
+		if (!gameUpdatePaused())
+		{
+			displayWorld();
+		}
+	}
+	else if (!loop_GetVideoStatus() && !quitting && !headlessGameMode() && !skipDrawing)
 	{
 		if (!gameUpdatePaused())
 		{
@@ -688,6 +697,7 @@ GAMECODE gameLoop()
 		gameStateUpdate();
 		syncDebug("End game state update, gameTime = %d", gameTime);
 		unsigned after = wzGetTicks();
+		replayVerifyGameStateUpdated();
 
 		renderBudget -= (after - before) * renderFraction.n;
 		renderBudget = std::max(renderBudget, (-updateFraction * 500).floor());
@@ -697,6 +707,8 @@ GAMECODE gameLoop()
 	}
 	numForcedUpdatesLastCall = numFastForwardTicks;
 
+	replayVerifyUpdate();
+
 	if (realTime - lastFlushTime >= 400u)
 	{
 		lastFlushTime = realTime;
@@ -117,6 +117,7 @@
 #include "wzpropertyproviders.h"
 #include "3rdparty/gsl_finally.h"
 #include "wzapi.h"
+#include "replayverify.h"
 
 #if defined(WZ_OS_UNIX)
 # include <signal.h>
@@ -145,50 +146,7 @@ enum FOCUS_STATE
 	FOCUS_IN,		// Window has got the focus
 };
 
-bool customDebugfile = false;		// Default false: user has NOT specified where to store the stdout/err file.
-
-char datadir[PATH_MAX] = ""; // Global that src/clparse.c:ParseCommandLine can write to, so it can override the default datadir on runtime. Needs to be empty on startup for ParseCommandLine to work!
-char configdir[PATH_MAX] = ""; // specifies custom USER directory. Same rules apply as datadir above.
-char rulesettag[40] = "";
-
-//flag to indicate when initialisation is complete
-const char* SAVEGAME_CAM = "savegames/campaign";
-const char* SAVEGAME_CAM_AUTO = "savegames/campaign/auto";
-const char* SAVEGAME_SKI = "savegames/skirmish";
-const char* SAVEGAME_SKI_AUTO = "savegames/skirmish/auto";
-
-const char *SaveGameLocToPath[] = {
-	SAVEGAME_CAM,
-	SAVEGAME_CAM_AUTO,
-	SAVEGAME_SKI,
-	SAVEGAME_SKI_AUTO,
-};
-
-std::string SaveGamePath_t::toPath(SaveGamePath_t::Extension ext)
-{
-	std::string out;
-	switch (ext)
-	{
-	case SaveGamePath_t::Extension::GAM:
-		out = std::string(SaveGameLocToPath[loc]) + "/" + gameName + ".gam";
-		break;
-	case SaveGamePath_t::Extension::JSON:
-		out = std::string(SaveGameLocToPath[loc]) + "/" + gameName + ".json";
-		break;
-	};
-	return out;
-}
-
-bool	gameInitialised = false;
-char	SaveGamePath[PATH_MAX];
-char    ReplayPath[PATH_MAX];
-char	ScreenDumpPath[PATH_MAX];
-char	MultiCustomMapsPath[PATH_MAX];
-char	MultiPlayersPath[PATH_MAX];
-char	FavoriteStructuresPath[PATH_MAX];
 static uint32_t forcedAutosaveTime = 0;
-// Start game in title mode:
-static GS_GAMEMODE gameStatus = GS_TITLE_SCREEN;
 // Status of the gameloop
 static GAMECODE gameLoopStatus = GAMECODE_CONTINUE;
 static FOCUS_STATE focusState = FOCUS_IN;
@@ -878,7 +836,7 @@ static bool startGameLoop()
 			if (!war_getDisableReplayRecording())
 			{
 				WZGameReplayOptionsHandler replayOptions;
-				auto replayFilename = NETreplaySaveStart((currentGameMode == ActivitySink::GameMode::MULTIPLAYER) ? "multiplay" : "skirmish", replayOptions, war_getMaxReplaysSaved(), (currentGameMode == ActivitySink::GameMode::MULTIPLAYER));
+				auto replayFilename = NETreplaySaveStart((currentGameMode == ActivitySink::GameMode::MULTIPLAYER) ? "multiplay" : "skirmish", replayOptions, war_getMaxReplaysSaved(), (currentGameMode == ActivitySink::GameMode::MULTIPLAYER), war_getCompressReplays());
 				if (!replayFilename.empty()) {
 					wz_command_interface_output("WZEVENT: replaySaveStarted: %s\n", replayFilename.c_str());
 				}
@@ -897,6 +855,11 @@ static bool startGameLoop()
 			// for replays, ensure we don't start off fast-forwarding
 			setMaxFastForwardTicks(0, true);
 		}
+		else if (replayVerifyEnabled())
+		{
+			// when verifying replays, run as fast as possible
+			setMaxFastForwardTicks(1000, false);
+		}
 		else
 		{
 			// when loading replays in headless / autogame mode, set to fast-forward
@@ -1731,7 +1694,10 @@ void mainShutdown()
 		default:
 			break;
 	}
-	saveConfig();
+	if (!replayVerifyEnabled())
+	{
+		saveConfig();
+	}
 	writeFavoriteStructsFile(FavoriteStructuresPath);
 #if defined(ENABLE_DISCORD)
 	discordRPCShutdown();
@@ -1924,8 +1890,18 @@ int realmain(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
+	if (replayVerifyBatchRequested())
+	{
+		// Only drives the child processes that verify the replays
+		return replayVerifyRunBatch(utfargc, utfargv);
+	}
+
 	// Save new (commandline) settings
-	saveConfig();
+	// (not when verifying a replay - several verification processes may be running at once, and the command line changes some settings)
+	if (!replayVerifyEnabled())
+	{
+		saveConfig();
+	}
 
 	// Print out some initial information if in headless mode
 	if (headlessGameMode())
@@ -2096,7 +2072,10 @@ int realmain(int argc, char *argv[])
 		{
 			fprintf(stdout, "Loading savegame ...\n");
 		}
-		initSaveGameLoad();
+		if (!initSaveGameLoad())
+		{
+			replayVerifyLoadFailed();
+		}
 		break;
 	case GS_NORMAL:
 		if (!startGameLoop())
@@ -2138,19 +2117,3 @@ int realmain(int argc, char *argv[])
 	debug(LOG_MAIN, "Completed shutting down Warzone 2100");
 	return exitCode;
 }
-
-/*!
- * Get the mode the game is currently in
- */
-GS_GAMEMODE GetGameMode()
-{
-	return gameStatus;
-}
-
-/*!
- * Set the current mode
- */
-void SetGameMode(GS_GAMEMODE status)
-{
-	gameStatus = status;
-}
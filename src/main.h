@@ -67,6 +67,8 @@ void mainLoop();
 
 extern char SaveGamePath[PATH_MAX];
 extern char ReplayPath[PATH_MAX];
+extern char ScreenDumpPath[PATH_MAX];
+extern char MultiCustomMapsPath[PATH_MAX];
 extern char datadir[PATH_MAX];
 extern char configdir[PATH_MAX];
 extern char MultiPlayersPath[PATH_MAX];
@@ -0,0 +1,87 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 1999-2004  Eidos Interactive
+	Copyright (C) 2005-2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  The global game paths and mode declared in main.h.
+ *  These are kept out of main.cpp, so that programs which provide their own realmain() (like the tests) can link the rest of the game.
+ */
+
+#include "lib/framework/frame.h"
+
+#include "main.h"
+
+bool customDebugfile = false;		// Default false: user has NOT specified where to store the stdout/err file.
+
+char datadir[PATH_MAX] = ""; // Global that src/clparse.c:ParseCommandLine can write to, so it can override the default datadir on runtime. Needs to be empty on startup for ParseCommandLine to work!
+char configdir[PATH_MAX] = ""; // specifies custom USER directory. Same rules apply as datadir above.
+char rulesettag[40] = "";
+
+//flag to indicate when initialisation is complete
+const char* SAVEGAME_CAM = "savegames/campaign";
+const char* SAVEGAME_CAM_AUTO = "savegames/campaign/auto";
+const char* SAVEGAME_SKI = "savegames/skirmish";
+const char* SAVEGAME_SKI_AUTO = "savegames/skirmish/auto";
+
+const char *SaveGameLocToPath[] = {
+	SAVEGAME_CAM,
+	SAVEGAME_CAM_AUTO,
+	SAVEGAME_SKI,
+	SAVEGAME_SKI_AUTO,
+};
+
+std::string SaveGamePath_t::toPath(SaveGamePath_t::Extension ext)
+{
+	std::string out;
+	switch (ext)
+	{
+	case SaveGamePath_t::Extension::GAM:
+		out = std::string(SaveGameLocToPath[loc]) + "/" + gameName + ".gam";
+		break;
+	case SaveGamePath_t::Extension::JSON:
+		out = std::string(SaveGameLocToPath[loc]) + "/" + gameName + ".json";
+		break;
+	};
+	return out;
+}
+
+bool	gameInitialised = false;
+char	SaveGamePath[PATH_MAX];
+char    ReplayPath[PATH_MAX];
+char	ScreenDumpPath[PATH_MAX];
+char	MultiCustomMapsPath[PATH_MAX];
+char	MultiPlayersPath[PATH_MAX];
+char	FavoriteStructuresPath[PATH_MAX];
+// Start game in title mode:
+static GS_GAMEMODE gameStatus = GS_TITLE_SCREEN;
+
+/*!
+ * Get the mode the game is currently in
+ */
+GS_GAMEMODE GetGameMode()
+{
+	return gameStatus;
+}
+
+/*!
+ * Set the current mode
+ */
+void SetGameMode(GS_GAMEMODE status)
+{
+	gameStatus = status;
+}
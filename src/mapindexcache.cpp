@@ -0,0 +1,212 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ * Persistent index of the level details of all map archives.
+ */
+
+#include <nlohmann/json.hpp> // Must come before WZ includes
+
+#include "lib/framework/frame.h"
+#include "lib/framework/file.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/physfs_ext.h"
+
+#include "mapindexcache.h"
+
+#include <wzmaplib/map_version.h>
+
+#include <algorithm>
+#include <vector>
+
+#define MAP_INDEX_CACHE_DIR "cache"
+static const char mapIndexCachePath[] = MAP_INDEX_CACHE_DIR "/mapindex.json";
+static const int mapIndexCacheVersion = 1;
+
+// The zip end of central directory record is at most 22 + 65535 bytes long, but map archives
+// rarely have comments, so this also covers the central directory of all but very large archives.
+static const PHYSFS_uint32 mapIndexTailHashSize = 4096;
+
+nonstd::optional<MapIndexFingerprint> mapIndexFingerprint(const std::string &physfsPath)
+{
+	PHYSFS_file *fileHandle = PHYSFS_openRead(physfsPath.c_str());
+	if (fileHandle == nullptr)
+	{
+		return nonstd::nullopt;
+	}
+	PHYSFS_sint64 length = PHYSFS_fileLength(fileHandle);
+	if (length < 0)
+	{
+		PHYSFS_close(fileHandle);
+		return nonstd::nullopt;
+	}
+
+	MapIndexFingerprint fingerprint;
+	fingerprint.size = static_cast<uint64_t>(length);
+	fingerprint.modTime = WZ_PHYSFS_getLastModTime(physfsPath.c_str());
+
+	PHYSFS_uint32 tailSize = static_cast<PHYSFS_uint32>(std::min<PHYSFS_sint64>(length, mapIndexTailHashSize));
+	std::vector<uint8_t> tail(tailSize);
+	bool success = PHYSFS_seek(fileHandle, static_cast<PHYSFS_uint64>(length - tailSize)) != 0
+		&& WZ_PHYSFS_readBytes(fileHandle, tail.data(), tailSize) == static_cast<PHYSFS_sint64>(tailSize);
+	PHYSFS_close(fileHandle);
+	if (!success)
+	{
+		return nonstd::nullopt;
+	}
+	fingerprint.tailHash = sha256Sum(tail.data(), tail.size()).toString();
+	return fingerprint;
+}
+
+static std::string mapIndexCacheTag()
+{
+	return std::string("wzmaplib ") + WzMap::wzmaplib_version_string();
+}
+
+void MapIndexCache::load()
+{
+	if (loaded)
+	{
+		return;
+	}
+	loaded = true;
+
+	std::vector<char> data;
+	if (!PHYSFS_exists(mapIndexCachePath) || !loadFileToBufferVector(mapIndexCachePath, data, false, false))
+	{
+		return;
+	}
+	try {
+		const auto root = nlohmann::json::parse(data.begin(), data.end());
+		if (root.at("version").get<int>() != mapIndexCacheVersion || root.at("tag").get<std::string>() != mapIndexCacheTag())
+		{
+			debug(LOG_INFO, "Map index cache is outdated, rebuilding");
+			dirty = true;
+			return;
+		}
+		for (const auto &it : root.at("maps").items())
+		{
+			const auto &obj = it.value();
+			MapIndexEntry entry;
+			entry.fingerprint.size = obj.at("size").get<uint64_t>();
+			entry.fingerprint.modTime = obj.at("mtime").get<int64_t>();
+			entry.fingerprint.tailHash = obj.at("hash").get<std::string>();
+			entry.valid = obj.at("valid").get<bool>();
+			if (entry.valid)
+			{
+				entry.details.name = obj.at("name").get<std::string>();
+				entry.details.type = static_cast<WzMap::MapType>(obj.at("type").get<int>());
+				entry.details.players = obj.at("players").get<uint8_t>();
+				entry.details.tileset = static_cast<MAP_TILESET>(obj.at("tileset").get<int>());
+				entry.details.mapFolderPath = obj.at("folder").get<std::string>();
+				entry.isMapMod = obj.at("mapMod").get<bool>();
+				entry.isRandom = obj.at("random").get<bool>();
+			}
+			entries[it.key()] = std::move(entry);
+		}
+	}
+	catch (const std::exception &e) {
+		debug(LOG_WARNING, "Ignoring invalid map index cache: %s", e.what());
+		entries.clear();
+		dirty = true;
+	}
+	debug(LOG_WZ, "Loaded map index cache (%zu maps)", entries.size());
+}
+
+void MapIndexCache::save()
+{
+	if (!dirty)
+	{
+		return;
+	}
+	if (!WZ_PHYSFS_isDirectory(MAP_INDEX_CACHE_DIR) && PHYSFS_mkdir(MAP_INDEX_CACHE_DIR) == 0)
+	{
+		debug(LOG_WARNING, "Could not create %s: %s", MAP_INDEX_CACHE_DIR, WZ_PHYSFS_getLastError());
+		return;
+	}
+
+	auto maps = nlohmann::json::object();
+	for (const auto &it : entries)
+	{
+		const MapIndexEntry &entry = it.second;
+		auto obj = nlohmann::json::object();
+		obj["size"] = entry.fingerprint.size;
+		obj["mtime"] = entry.fingerprint.modTime;
+		obj["hash"] = entry.fingerprint.tailHash;
+		obj["valid"] = entry.valid;
+		if (entry.valid)
+		{
+			obj["name"] = entry.details.name;
+			obj["type"] = static_cast<int>(entry.details.type);
+			obj["players"] = entry.details.players;
+			obj["tileset"] = static_cast<int>(entry.details.tileset);
+			obj["folder"] = entry.details.mapFolderPath;
+			obj["mapMod"] = entry.isMapMod;
+			obj["random"] = entry.isRandom;
+		}
+		maps[it.first] = std::move(obj);
+	}
+	auto root = nlohmann::json::object();
+	root["version"] = mapIndexCacheVersion;
+	root["tag"] = mapIndexCacheTag();
+	root["maps"] = std::move(maps);
+
+	std::string jsonString = root.dump();
+	if (saveFile(mapIndexCachePath, jsonString.c_str(), static_cast<UDWORD>(jsonString.size())))
+	{
+		dirty = false;
+	}
+}
+
+const MapIndexEntry *MapIndexCache::find(const std::string &realPath, const MapIndexFingerprint &fingerprint) const
+{
+	auto it = entries.find(realPath);
+	if (it == entries.end() || !(it->second.fingerprint == fingerprint))
+	{
+		return nullptr;
+	}
+	return &it->second;
+}
+
+void MapIndexCache::set(const std::string &realPath, MapIndexEntry entry)
+{
+	entries[realPath] = std::move(entry);
+	dirty = true;
+}
+
+void MapIndexCache::retain(const std::unordered_set<std::string> &realPaths)
+{
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (realPaths.count(it->first) == 0)
+		{
+			it = entries.erase(it);
+			dirty = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+MapIndexCache &mapIndexCache()
+{
+	static MapIndexCache cache;
+	return cache;
+}
@@ -0,0 +1,82 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ * Persistent index of the level details of all map archives, so buildMapList() only has to open
+ * new or modified archives.
+ */
+
+#ifndef __INCLUDED_SRC_MAPINDEXCACHE_H__
+#define __INCLUDED_SRC_MAPINDEXCACHE_H__
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdint.h>
+
+#include <wzmaplib/map_package.h>
+#include <nonstd/optional.hpp>
+
+/// Identifies the contents of a map archive without reading all of it.
+struct MapIndexFingerprint
+{
+	uint64_t size = 0;
+	int64_t modTime = 0;
+	std::string tailHash;  ///< SHA-256 of the end of the archive, which holds the zip central directory (including the CRC of every member)
+
+	bool operator ==(const MapIndexFingerprint &other) const
+	{
+		return size == other.size && modTime == other.modTime && tailHash == other.tailHash;
+	}
+};
+
+struct MapIndexEntry
+{
+	MapIndexFingerprint fingerprint;
+	bool valid = false;  ///< false if the archive could not be loaded, so it isn't retried until it changes
+	WzMap::LevelDetails details;
+	bool isMapMod = false;
+	bool isRandom = false;
+};
+
+/// Calculates the fingerprint of the archive at `physfsPath`. Safe to call from any thread.
+nonstd::optional<MapIndexFingerprint> mapIndexFingerprint(const std::string &physfsPath);
+
+class MapIndexCache
+{
+public:
+	/// Loads the cache from disk (only the first time it's called).
+	void load();
+	/// Saves the cache to disk, if it changed.
+	void save();
+
+	/// Returns the cached entry for `realPath`, if its fingerprint matches. Safe to call concurrently (but not together with set()).
+	const MapIndexEntry *find(const std::string &realPath, const MapIndexFingerprint &fingerprint) const;
+	void set(const std::string &realPath, MapIndexEntry entry);
+	/// Removes all archives not in `realPaths`.
+	void retain(const std::unordered_set<std::string> &realPaths);
+
+private:
+	std::unordered_map<std::string, MapIndexEntry> entries;
+	bool loaded = false;
+	bool dirty = false;
+};
+
+MapIndexCache &mapIndexCache();
+
+#endif // __INCLUDED_SRC_MAPINDEXCACHE_H__
@@ -131,6 +131,7 @@
 #include "titleui/widgets/advcheckbox.h"
 
 #include "activity.h"
+#include "replayverify.h"
 #include <algorithm>
 #include <set>
 #include "3rdparty/gsl_finally.h"
@@ -8928,3 +8929,16 @@ bool WZGameReplayOptionsHandler::restoreOptions(const nlohmann::json& object, Em
 
 	return true;
 }
+
+bool WZGameReplayOptionsHandler::saveEndOfGameInfo(nlohmann::json& object) const
+{
+	// final game state, so replays can be verified (see replayverify.h)
+	replayVerifySaveEndOfGameInfo(object);
+	return true;
+}
+
+bool WZGameReplayOptionsHandler::restoreEndOfGameInfo(const nlohmann::json& object)
+{
+	replayVerifyRestoreEndOfGameInfo(object);
+	return true;
+}
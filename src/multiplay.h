@@ -420,6 +420,8 @@ class WZGameReplayOptionsHandler : public ReplayOptionsHandler
 	virtual bool optionsUpdatePlayerInfo(nlohmann::json& object) const override;
 	virtual bool saveMap(EmbeddedMapData& mapData) const override;
 	virtual bool restoreOptions(const nlohmann::json& object, EmbeddedMapData&& embeddedMapData, uint32_t replay_netcodeMajor, uint32_t replay_netcodeMinor) override;
+	virtual bool saveEndOfGameInfo(nlohmann::json& object) const override;
+	virtual bool restoreEndOfGameInfo(const nlohmann::json& object) override;
 	virtual size_t desiredBufferSize() const override;
 	virtual size_t maximumEmbeddedMapBufferSize() const override;
 };
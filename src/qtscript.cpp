@@ -41,6 +41,7 @@
 
 #include "lib/framework/wzapp.h"
 #include "lib/framework/wzconfig.h"
+#include "lib/framework/savesnapshot.h"
 #include "lib/framework/wzpaths.h"
 
 #include "qtscript.h"
@@ -2047,7 +2048,7 @@ bool scripting_engine::loadLabels(const char *filename, const std::unordered_map
 {
 	int groupidx = -1;
 
-	if (!PHYSFS_exists(filename))
+	if (!saveSnapshotFileExists(filename))
 	{
 		debug(LOG_SAVE, "No %s found -- not adding any labels", filename);
 		return false;
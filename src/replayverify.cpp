@@ -0,0 +1,455 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ * Headless replay verification
+ */
+
+#include <nlohmann/json.hpp> // Must come before WZ includes
+
+#include "lib/framework/frame.h"
+#include "lib/framework/crc.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/framework/string_ext.h"
+#include "lib/framework/wzapp.h"
+#include "lib/gamelib/gtime.h"
+
+#include "replayverify.h"
+#include "main.h"
+#include "objmem.h"
+#include "power.h"
+#include "droid.h"
+#include "structure.h"
+#include "feature.h"
+#include "display3d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+#if defined(HAVE_POSIX_SPAWNP)
+# include <spawn.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+# include <errno.h>
+# if !defined(HAVE_ENVIRON_DECL)
+  extern char **environ;
+# endif
+#endif
+
+// A replay that doesn't advance its gameTime for this long (in real time) before reaching its final gameTime has stalled.
+#define REPLAY_VERIFY_STALL_TIMEOUT 30000
+
+static bool verifyEnabled = false;
+static std::string batchDir;
+static unsigned batchJobs = 0;
+
+struct ReplayVerifyState
+{
+	optional<uint32_t> finalGameTime;
+	optional<uint32_t> finalStateHash;
+	bool reachedFinalGameTime = false;
+	bool finished = false;
+	uint32_t lastGameTime = 0;
+	uint32_t lastProgressRealTime = 0;
+	optional<std::chrono::steady_clock::time_point> startTime;
+};
+static ReplayVerifyState state;
+
+void replayVerifySetEnabled(bool enabled)
+{
+	verifyEnabled = enabled;
+}
+
+void replayVerifySetBatchDir(const std::string& dir)
+{
+	batchDir = dir;
+}
+
+void replayVerifySetBatchJobs(unsigned jobs)
+{
+	batchJobs = jobs;
+}
+
+bool replayVerifyEnabled()
+{
+	return verifyEnabled;
+}
+
+bool replayVerifyBatchRequested()
+{
+	return !batchDir.empty();
+}
+
+// MARK: - Game state hash
+
+static uint32_t hashInts(uint32_t crc, std::initializer_list<int32_t> values)
+{
+	for (int32_t value : values)
+	{
+		crc = wz::crc_update(crc, &value, sizeof(value));
+	}
+	return crc;
+}
+
+uint32_t gameStateHash()
+{
+	uint32_t crc = wz::crc_init();
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
+	{
+		const int64_t power = getPrecisePower(player);
+		crc = wz::crc_update(crc, &power, sizeof(power));
+		for (const DROID *psDroid : apsDroidLists[player])
+		{
+			crc = hashInts(crc, {
+				(int)psDroid->id, psDroid->player,
+				psDroid->pos.x, psDroid->pos.y, psDroid->pos.z,
+				psDroid->rot.direction, psDroid->rot.pitch, psDroid->rot.roll,
+				(int)psDroid->body, (int)psDroid->experience,
+				(int)psDroid->order.type, (int)psDroid->action,
+			});
+		}
+		for (const STRUCTURE *psStruct : apsStructLists[player])
+		{
+			crc = hashInts(crc, {
+				(int)psStruct->id, psStruct->player,
+				psStruct->pos.x, psStruct->pos.y, psStruct->pos.z,
+				(int)psStruct->body, (int)psStruct->status, (int)psStruct->currentBuildPts,
+			});
+		}
+		for (const FEATURE *psFeature : apsFeatureLists[player])
+		{
+			crc = hashInts(crc, {
+				(int)psFeature->id,
+				psFeature->pos.x, psFeature->pos.y, psFeature->pos.z,
+				(int)psFeature->body,
+			});
+		}
+	}
+	return crc;
+}
+
+// MARK: - Replay end of game info
+
+void replayVerifySaveEndOfGameInfo(nlohmann::json& object)
+{
+	object["finalStateHash"] = gameStateHash();
+}
+
+void replayVerifyRestoreEndOfGameInfo(const nlohmann::json& object)
+{
+	state = ReplayVerifyState();
+	try
+	{
+		state.finalGameTime = object.at("gameTimeElapsed").get<uint32_t>();
+		auto it = object.find("finalStateHash");
+		if (it != object.end())
+		{
+			state.finalStateHash = it->get<uint32_t>();
+		}
+	}
+	catch (const std::exception& e)
+	{
+		debug(LOG_ERROR, "Invalid replay end of game info: %s", e.what());
+		state.finalGameTime.reset();
+		state.finalStateHash.reset();
+	}
+}
+
+// MARK: - Verifying a single replay
+
+static void replayVerifyFinish(const char *result, bool success)
+{
+	state.finished = true;
+
+	const auto stats = getSyncCheckStats();
+	nlohmann::ordered_json j = nlohmann::ordered_json::object();
+	j["result"] = result;
+	j["gameTime"] = gameTime;
+	if (state.finalGameTime.has_value())
+	{
+		j["finalGameTime"] = state.finalGameTime.value();
+	}
+	j["syncChecks"] = stats.checks;
+	j["syncErrors"] = stats.errors;
+	if (stats.errors > 0)
+	{
+		j["firstSyncErrorGameTime"] = stats.firstErrorGameTime;
+	}
+	if (state.reachedFinalGameTime)
+	{
+		j["stateHash"] = gameStateHash();
+		if (state.finalStateHash.has_value())
+		{
+			j["expectedStateHash"] = state.finalStateHash.value();
+		}
+	}
+	if (state.startTime.has_value())
+	{
+		auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - state.startTime.value()).count();
+		j["realTimeMs"] = elapsedMs;
+		if (elapsedMs > 0)
+		{
+			j["gameTimeSpeedup"] = static_cast<double>(gameTime) / static_cast<double>(elapsedMs);
+		}
+	}
+	const FramePreparationStats framePreparation = getFramePreparationStats();
+	if (framePreparation.frames > 0)
+	{
+		// only with --headlessrender
+		j["framePrepFrames"] = framePreparation.frames;
+		j["framePrepAvgUs"] = static_cast<double>(framePreparation.totalMicroseconds) / static_cast<double>(framePreparation.frames);
+	}
+
+	fprintf(stdout, "WZREPLAYVERIFY: %s\n", j.dump().c_str());
+	fflush(stdout);
+	debug((success) ? LOG_INFO : LOG_ERROR, "Replay verification finished: %s", result);
+
+	wzQuit((success) ? 0 : 1);
+}
+
+void replayVerifyGameStateUpdated()
+{
+	if (!verifyEnabled || state.finished || state.reachedFinalGameTime || !state.finalGameTime.has_value())
+	{
+		return;
+	}
+	if (gameTime >= state.finalGameTime.value())
+	{
+		// Don't tick past the gameTime at which the replay was saved, but keep processing messages,
+		// so that the messages the original game processed before it stopped are also processed here.
+		state.reachedFinalGameTime = true;
+		gameTimeStop();
+	}
+}
+
+void replayVerifyUpdate()
+{
+	if (!verifyEnabled || state.finished)
+	{
+		return;
+	}
+	if (!state.startTime.has_value())
+	{
+		state.startTime = std::chrono::steady_clock::now();
+		state.lastGameTime = gameTime;
+		state.lastProgressRealTime = realTime;
+	}
+	if (!state.finalGameTime.has_value())
+	{
+		replayVerifyFinish("no_end_of_game_info", false);
+		return;
+	}
+	if (!state.reachedFinalGameTime)
+	{
+		if (gameTime != state.lastGameTime)
+		{
+			state.lastGameTime = gameTime;
+			state.lastProgressRealTime = realTime;
+		}
+		else if (realTime - state.lastProgressRealTime > REPLAY_VERIFY_STALL_TIMEOUT)
+		{
+			replayVerifyFinish("stalled", false);
+		}
+		return;
+	}
+
+	// The messages queued for the final gameTime have been processed by the gameLoop() that is calling us
+	if (getSyncCheckStats().errors > 0)
+	{
+		replayVerifyFinish("desync", false);
+	}
+	else if (state.finalStateHash.has_value() && gameStateHash() != state.finalStateHash.value())
+	{
+		replayVerifyFinish("state_mismatch", false);
+	}
+	else
+	{
+		replayVerifyFinish("pass", true);
+	}
+}
+
+void replayVerifyLoadFailed()
+{
+	if (!verifyEnabled || state.finished)
+	{
+		return;
+	}
+	replayVerifyFinish("load_failed", false);
+}
+
+// MARK: - Batch verification
+
+#if defined(HAVE_POSIX_SPAWNP)
+
+static bool isBatchOption(const char *arg, bool &takesNextArg)
+{
+	static const char *batchOptions[] = { "--verifyreplays", "--verifyreplays-jobs" };
+	takesNextArg = false;
+	for (const char *option : batchOptions)
+	{
+		size_t len = strlen(option);
+		if (strncmp(arg, option, len) == 0 && (arg[len] == '\0' || arg[len] == '='))
+		{
+			takesNextArg = (arg[len] == '\0');
+			return true;
+		}
+	}
+	return false;
+}
+
+int replayVerifyRunBatch(int argc, const char * const *argv)
+{
+	std::vector<std::string> replays;
+	std::string replayDir = std::string(ReplayPath) + "/" + batchDir;
+	WZ_PHYSFS_enumerateFiles(replayDir.c_str(), [&](const char *file) -> bool {
+		if (strEndsWith(file, ".wzrp"))
+		{
+			replays.push_back(batchDir + "/" + file);
+		}
+		return true; // continue
+	});
+	std::sort(replays.begin(), replays.end());
+	if (replays.empty())
+	{
+		fprintf(stderr, "No replays found in: %s\n", replayDir.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// Child processes get all of our arguments (so they use the same config / data dirs, mods, etc), except for the batch options
+	std::vector<std::string> baseArgs;
+	for (int i = 0; i < argc; ++i)
+	{
+		bool takesNextArg = false;
+		if (i > 0 && isBatchOption(argv[i], takesNextArg))
+		{
+			i += (takesNextArg) ? 1 : 0;
+			continue;
+		}
+		baseArgs.push_back(argv[i]);
+	}
+	baseArgs.push_back("--headless");
+	baseArgs.push_back("--verifyreplay");
+
+	unsigned jobs = (batchJobs > 0) ? batchJobs : std::max(1u, std::thread::hardware_concurrency());
+	fprintf(stdout, "Verifying %zu replays (%u jobs)\n", replays.size(), jobs);
+	fflush(stdout);
+
+	struct RunningJob
+	{
+		std::string replay;
+		std::chrono::steady_clock::time_point startTime;
+	};
+	std::map<pid_t, RunningJob> running;
+	size_t nextReplay = 0;
+	size_t numPassed = 0;
+	std::vector<std::string> failed;
+
+	auto reportResult = [&](const std::string& replay, bool passed, double seconds, const char *details) {
+		fprintf(stdout, "[%s] %s (%.1fs)%s%s\n", (passed) ? "PASS" : "FAIL", replay.c_str(), seconds, (details) ? " - " : "", (details) ? details : "");
+		fflush(stdout);
+		if (passed)
+		{
+			++numPassed;
+		}
+		else
+		{
+			failed.push_back(replay);
+		}
+	};
+
+	while (nextReplay < replays.size() || !running.empty())
+	{
+		while (running.size() < jobs && nextReplay < replays.size())
+		{
+			const std::string& replay = replays[nextReplay++];
+			std::vector<std::string> args = baseArgs;
+			args.push_back("--loadreplay=" + replay);
+			std::vector<char *> childArgv;
+			for (auto& arg : args)
+			{
+				childArgv.push_back(&arg[0]);
+			}
+			childArgv.push_back(nullptr);
+
+			pid_t pid = 0;
+			int spawnResult = posix_spawnp(&pid, childArgv[0], nullptr, nullptr, childArgv.data(), environ);
+			if (spawnResult != 0)
+			{
+				reportResult(replay, false, 0.0, strerror(spawnResult));
+				continue;
+			}
+			running[pid] = RunningJob{replay, std::chrono::steady_clock::now()};
+		}
+		if (running.empty())
+		{
+			continue;
+		}
+
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			debug(LOG_ERROR, "waitpid failed: %s", strerror(errno));
+			break;
+		}
+		auto it = running.find(pid);
+		if (it == running.end())
+		{
+			continue;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - it->second.startTime).count();
+		if (WIFEXITED(status))
+		{
+			int exitCode = WEXITSTATUS(status);
+			std::string details = (exitCode != 0) ? astringf("exit code %d", exitCode) : std::string();
+			reportResult(it->second.replay, exitCode == 0, seconds, (exitCode != 0) ? details.c_str() : nullptr);
+		}
+		else
+		{
+			std::string details = (WIFSIGNALED(status)) ? astringf("terminated by signal %d", WTERMSIG(status)) : std::string("terminated");
+			reportResult(it->second.replay, false, seconds, details.c_str());
+		}
+		running.erase(it);
+	}
+
+	fprintf(stdout, "Verified %zu replays: %zu passed, %zu failed\n", replays.size(), numPassed, failed.size());
+	for (const auto& replay : failed)
+	{
+		fprintf(stdout, " * FAILED: %s\n", replay.c_str());
+	}
+	fflush(stdout);
+	return (failed.empty() && numPassed == replays.size()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+int replayVerifyRunBatch(int, const char * const *)
+{
+	fprintf(stderr, "--verifyreplays is not supported on this platform - use --loadreplay with --headless --verifyreplay for each replay instead\n");
+	return EXIT_FAILURE;
+}
+
+#endif
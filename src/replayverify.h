@@ -0,0 +1,59 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2025  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ * Headless replay verification
+ *
+ * `--verifyreplay` (together with `--loadreplay` and `--headless`) plays a replay back as fast as possible,
+ * checks the syncDebug CRCs recorded in the replay's GAME_GAME_TIME messages, and compares the final game
+ * state hash with the one recorded when the replay was saved.
+ *
+ * `--verifyreplays=<dir>` verifies every replay in a replay subdirectory, by running up to
+ * `--verifyreplays-jobs` child processes with `--verifyreplay` at once.
+ */
+
+#ifndef __INCLUDED_SRC_REPLAYVERIFY_H__
+#define __INCLUDED_SRC_REPLAYVERIFY_H__
+
+#include <string>
+#include <cstdint>
+#include <nlohmann/json_fwd.hpp>
+
+// used from clparse:
+void replayVerifySetEnabled(bool enabled);
+void replayVerifySetBatchDir(const std::string& dir);
+void replayVerifySetBatchJobs(unsigned jobs);
+
+bool replayVerifyEnabled();
+bool replayVerifyBatchRequested();
+
+/// Verifies all replays in the batch directory using child processes. Returns the process exit code.
+int replayVerifyRunBatch(int argc, const char * const *argv);
+
+/// A hash of the synchronised game state (objects and power of all players).
+uint32_t gameStateHash();
+
+// used from WZGameReplayOptionsHandler:
+void replayVerifySaveEndOfGameInfo(nlohmann::json& object);
+void replayVerifyRestoreEndOfGameInfo(const nlohmann::json& object);
+
+void replayVerifyGameStateUpdated();  ///< Called after every game tick.
+void replayVerifyUpdate();            ///< Called once per gameLoop().
+void replayVerifyLoadFailed();        ///< Called if the replay could not be loaded.
+
+#endif // __INCLUDED_SRC_REPLAYVERIFY_H__
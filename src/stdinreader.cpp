@@ -23,6 +23,7 @@
 #include "lib/framework/wzapp.h"
 #include "lib/framework/wzpaths.h"
 #include "lib/netplay/netpermissions.h"
+#include "lib/netplay/nettelemetry.h"
 #include "multiint.h"
 #include "multistat.h"
 #include "multiplay.h"
@@ -94,6 +95,8 @@ wzAsyncExecOnMainThread([]{ \
 static WZ_Command_Interface wz_cmd_interface = WZ_Command_Interface::None;
 static std::string wz_cmd_interface_param;
 static bool hasQueuedRoomStatusJSONOutput = false;
+static std::chrono::seconds netStatsJSONOutputInterval{0}; // 0 = periodic output disabled
+static std::chrono::steady_clock::time_point lastNetStatsJSONOutput;
 
 inline WZ_Command_Interface wz_command_interface()
 {
@@ -1196,6 +1199,29 @@ int cmdInputThreadFunc(void *)
 				wz_command_interface_output_room_status_json();
 			});
 		}
+		else if(!strncmpl(line, "netstats"))
+		{
+			wzAsyncExecOnMainThread([] {
+				wz_command_interface_output_net_stats_json();
+			});
+		}
+		else if(!strncmpl(line, "set netstats interval "))
+		{
+			unsigned intervalSeconds = 0;
+			int r = sscanf(line, "set netstats interval %u", &intervalSeconds);
+			if (r != 1)
+			{
+				wz_command_interface_output_onmainthread("WZCMD error: Failed to get netstats interval value!\n");
+			}
+			else
+			{
+				wzAsyncExecOnMainThread([intervalSeconds] {
+					netStatsJSONOutputInterval = std::chrono::seconds(intervalSeconds);
+					lastNetStatsJSONOutput = std::chrono::steady_clock::now();
+					wz_command_interface_output("WZCMD info: netstats interval set to %u seconds\n", intervalSeconds);
+				});
+			}
+		}
 		else if(!strncmpl(line, "set host ready "))
 		{
 			unsigned hostReadyVal = 0;
@@ -1883,4 +1909,30 @@ void wz_command_interface_process_queued_status_output()
 		wz_command_interface_output_room_status_json(false);
 		hasQueuedRoomStatusJSONOutput = false;
 	}
+
+	if (netStatsJSONOutputInterval.count() > 0)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastNetStatsJSONOutput >= netStatsJSONOutputInterval)
+		{
+			wz_command_interface_output_net_stats_json();
+			lastNetStatsJSONOutput = now;
+		}
+	}
+}
+
+void wz_command_interface_output_net_stats_json()
+{
+	if (!wz_command_interface_enabled())
+	{
+		return;
+	}
+
+	auto root = nlohmann::ordered_json::object();
+	root["ver"] = 1;
+	root["data"] = NETtelemetryToJSON();
+
+	std::string statsJSONStr = std::string("__WZNETSTATS__") + root.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace) + "__ENDWZNETSTATS__";
+	statsJSONStr.append("\n");
+	wz_command_interface_output_str(statsJSONStr.c_str());
 }
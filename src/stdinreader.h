@@ -48,3 +48,5 @@ void wz_command_interface_output_str(const char *str);
 
 void wz_command_interface_output_room_status_json(bool queued = false);
 void wz_command_interface_process_queued_status_output();
+
+void wz_command_interface_output_net_stats_json();
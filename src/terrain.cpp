@@ -33,6 +33,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/frameresource.h"
+#include "lib/framework/parallel_for.h"
 #include "lib/framework/opengl.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/wzapp.h"
@@ -48,6 +49,7 @@
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/piedraw.h"
 #include "lib/ivis_opengl/pielight_convert.h"
+#include "lib/ivis_opengl/culling.h"
 #include <glm/mat4x4.hpp>
 #ifndef GLM_ENABLE_EXPERIMENTAL
 	#define GLM_ENABLE_EXPERIMENTAL
@@ -65,6 +67,7 @@
 
 #include "profiling.h"
 
+#include <algorithm>
 #include <cstdint>
 
 // TODO: Fix and remove after merging terrain rendering changes
@@ -138,6 +141,10 @@ struct LightmapCalculatedValues
 static LightmapCalculatedValues lightmapValues;
 /// Ticks per lightmap refresh
 static const unsigned int LIGHTMAP_REFRESH = 80;
+/// The lightmap texture is compared and uploaded in blocks of this many texels in each direction
+static const int LIGHTMAP_BLOCK_SIZE = 32;
+/// Blocks of the lightmap pixmap that changed since they were last uploaded
+static std::vector<uint8_t> lightmapDirtyBlocks;
 
 /// VBOs
 static gfx_api::buffer *geometryVBO = nullptr, *geometryIndexVBO = nullptr, *textureVBO = nullptr, *textureIndexVBO = nullptr, *decalVBO = nullptr;
@@ -158,12 +165,13 @@ static int sectorSize = 15;
 static int terrainDistance;
 /// How many sectors have we actually got?
 static int xSectors, ySectors;
+/// The centres of the sectors (on the ground plane, in the same order as sectors), for culling them in one batch
+static BoundingSphereArray sectorCentres;
+static std::vector<uint8_t> sectorVisible;
 
 /// Did we initialise the terrain renderer yet?
 static bool terrainInitialised = false;
 
-static std::vector<gfx_api::TerrainDecalVertex> terrainDecalVertexUpdateBuffer;
-
 /// Helper to specify the offset in a VBO
 #define BUFFER_OFFSET(i) (reinterpret_cast<char *>(i))
 
@@ -667,54 +675,115 @@ static void setSectorDecalVertex_SinglePass(int x, int y, gfx_api::TerrainDecalV
 	}
 }
 
-/**
- * Update the sector for when the terrain is changed.
- */
-static void updateSectorGeometry(int x, int y)
-{
-	TerrainVertex *geometry;
-	WaterVertex *water;
-	DecalVertex *decaldata;
-	int geometrySize = 0;
-	int waterSize = 0;
-	int decalSize = 0;
+/// The number of dirty sectors that are rebuilt per frame at most (the others stay dirty until a later frame),
+/// so large terrain changes are spread over a few frames instead of causing a single long one
+static const size_t maxSectorRebuildsPerFrame = 64;
 
-	geometry = new TerrainVertex[sectors[x * ySectors + y].geometrySize];
-	water = (WaterVertex *)malloc(sizeof(WaterVertex) * sectors[x * ySectors + y].waterSize);
+/// Staging data of the sectors being rebuilt. The data of rebuilt sector i is at [*Start[i], *Start[i + 1]).
+struct SectorRebuildStaging
+{
+	std::vector<size_t> geometryStart, waterStart, decalStart, terrainDecalStart;
+	std::vector<TerrainVertex> geometry;
+	std::vector<WaterVertex> water;
+	std::vector<DecalVertex> decals;
+	std::vector<gfx_api::TerrainDecalVertex> terrainDecals;
+};
+static SectorRebuildStaging sectorRebuildStaging; // reused to avoid repeated allocations
 
-	setSectorGeometry(x, y, geometry, water, &geometrySize, &waterSize);
-	ASSERT(geometrySize == sectors[x * ySectors + y].geometrySize, "something went seriously wrong updating the terrain");
-	ASSERT(waterSize    == sectors[x * ySectors + y].waterSize   , "something went seriously wrong updating the terrain");
+/// Fills start with the position of each sector's data in the staging buffer, and returns the total size
+template <typename SizeFunc>
+static size_t layoutSectorStaging(const std::vector<int> &sectorIdxs, std::vector<size_t> &start, SizeFunc sectorSize)
+{
+	start.resize(sectorIdxs.size() + 1);
+	size_t total = 0;
+	for (size_t i = 0; i < sectorIdxs.size(); ++i)
+	{
+		start[i] = total;
+		total += static_cast<size_t>(std::max(sectorSize(sectors[sectorIdxs[i]]), 0));
+	}
+	start[sectorIdxs.size()] = total;
+	return total;
+}
 
-	geometryVBO->update(sizeof(TerrainVertex)*sectors[x * ySectors + y].geometryOffset,
-							sizeof(TerrainVertex)*sectors[x * ySectors + y].geometrySize, geometry,
-							gfx_api::buffer::update_flag::non_overlapping_updates_promise);
-	waterVBO->update(sizeof(WaterVertex)*sectors[x * ySectors + y].waterOffset,
-					 sizeof(WaterVertex)*sectors[x * ySectors + y].waterSize, water,
-					 gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+/// Uploads the staged data of the rebuilt sectors, with a single update for each run of sectors that follow each other in the buffer
+template <typename Vertex, typename OffsetFunc>
+static void uploadSectorStaging(gfx_api::buffer *buffer, const std::vector<int> &sectorIdxs, const std::vector<size_t> &start, const std::vector<Vertex> &staging, OffsetFunc sectorOffset)
+{
+	size_t runBegin = 0;
+	for (size_t i = 1; i <= sectorIdxs.size(); ++i)
+	{
+		if (i < sectorIdxs.size() && static_cast<size_t>(sectorOffset(sectors[sectorIdxs[i]])) == sectorOffset(sectors[sectorIdxs[runBegin]]) + (start[i] - start[runBegin]))
+		{
+			continue; // still the same run
+		}
+		const size_t runSize = start[i] - start[runBegin];
+		if (runSize > 0) // glBufferSubData(GL_ARRAY_BUFFER, 0, 0, *) crashes in some graphics drivers
+		{
+			buffer->update(sizeof(Vertex) * sectorOffset(sectors[sectorIdxs[runBegin]]), sizeof(Vertex) * runSize, &staging[start[runBegin]],
+						   gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+		}
+		runBegin = i;
+	}
+}
 
-	delete[] geometry;
-	free(water);
+/**
+ * Update the sectors for when the terrain is changed.
+ * The geometry of the sectors is generated in parallel, then uploaded in as few buffer updates as possible.
+ * sectorIdxs must be in increasing order (which is also the order of the sectors in the buffers).
+ */
+static void updateSectorGeometry(const std::vector<int> &sectorIdxs)
+{
+	auto &staging = sectorRebuildStaging;
+	const bool fallback = terrainShaderType == TerrainShaderType::FALLBACK;
 
-	if (terrainShaderType == TerrainShaderType::FALLBACK)
+	staging.geometry.resize(layoutSectorStaging(sectorIdxs, staging.geometryStart, [](const Sector &sector) { return sector.geometrySize; }));
+	staging.water.resize(layoutSectorStaging(sectorIdxs, staging.waterStart, [](const Sector &sector) { return sector.waterSize; }));
+	if (fallback)
 	{
-		if (sectors[x * ySectors + y].decalSize <= 0)
+		staging.decals.resize(layoutSectorStaging(sectorIdxs, staging.decalStart, [](const Sector &sector) { return sector.decalSize; }));
+	}
+	else
+	{
+		staging.terrainDecals.resize(layoutSectorStaging(sectorIdxs, staging.terrainDecalStart, [](const Sector &sector) { return sector.terrainAndDecalSize; }));
+	}
+
+	// Only reads the map, and each sector writes its own part of the staging buffers
+	wzParallelFor(sectorIdxs.size(), [&](size_t i) {
+		const int x = sectorIdxs[i] / ySectors;
+		const int y = sectorIdxs[i] % ySectors;
+		const Sector &sector = sectors[sectorIdxs[i]];
+		int geometrySize = 0;
+		int waterSize = 0;
+		setSectorGeometry(x, y, staging.geometry.data() + staging.geometryStart[i], staging.water.data() + staging.waterStart[i], &geometrySize, &waterSize);
+		ASSERT(geometrySize == sector.geometrySize, "something went seriously wrong updating the terrain");
+		ASSERT(waterSize    == sector.waterSize   , "something went seriously wrong updating the terrain");
+
+		if (fallback)
 		{
-			// Nothing to do here, and glBufferSubData(GL_ARRAY_BUFFER, 0, 0, *) crashes in my graphics driver. Probably shouldn't crash...
-			return;
+			if (sector.decalSize > 0)
+			{
+				int decalSize = 0;
+				setSectorDecals(x, y, staging.decals.data() + staging.decalStart[i], &decalSize);
+				ASSERT(decalSize == sector.decalSize   , "the amount of decals has changed");
+			}
 		}
+		else
+		{
+			int terrainDecalSize = 0;
+			setSectorDecalVertex_SinglePass(x, y, staging.terrainDecals.data() + staging.terrainDecalStart[i], &terrainDecalSize);
+			ASSERT(terrainDecalSize == sector.terrainAndDecalSize, "Sizes don't match!");
+		}
+	}, pie_GetParallelFramePreparation() ? 0 : 1);
 
-		decaldata = (DecalVertex *)malloc(sizeof(DecalVertex) * sectors[x * ySectors + y].decalSize);
-		setSectorDecals(x, y, decaldata, &decalSize);
-		ASSERT(decalSize == sectors[x * ySectors + y].decalSize   , "the amount of decals has changed");
-
-		if (decalSize > 0)
+	uploadSectorStaging(geometryVBO, sectorIdxs, staging.geometryStart, staging.geometry, [](const Sector &sector) { return sector.geometryOffset; });
+	uploadSectorStaging(waterVBO, sectorIdxs, staging.waterStart, staging.water, [](const Sector &sector) { return sector.waterOffset; });
+	if (fallback)
+	{
+		if (!staging.decals.empty())
 		{
 			if (decalVBO)
 			{
-				decalVBO->update(sizeof(DecalVertex)*sectors[x * ySectors + y].decalOffset,
-								 sizeof(DecalVertex)*sectors[x * ySectors + y].decalSize, decaldata,
-								 gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+				uploadSectorStaging(decalVBO, sectorIdxs, staging.decalStart, staging.decals, [](const Sector &sector) { return sector.decalOffset; });
 			}
 			else
 			{
@@ -723,18 +792,10 @@ static void updateSectorGeometry(int x, int y)
 				ASSERT(false, "Didn't have decals, but now we do. Unsupported.");
 			}
 		}
-
-		free(decaldata);
 	}
 	else
 	{
-		terrainDecalVertexUpdateBuffer.resize(sectors[x * ySectors + y].terrainAndDecalSize); // reuse a buffer to avoid repeated allocations if possible
-		int terrainDecalSize = 0;
-		setSectorDecalVertex_SinglePass(x, y, terrainDecalVertexUpdateBuffer.data(), &terrainDecalSize);
-		ASSERT(terrainDecalSize == sectors[x * ySectors + y].terrainAndDecalSize, "Sizes don't match!");
-		terrainDecalVBO->update(sizeof(gfx_api::TerrainDecalVertex)*sectors[x * ySectors + y].terrainAndDecalOffset,
-							 sizeof(gfx_api::TerrainDecalVertex)*sectors[x * ySectors + y].terrainAndDecalSize, terrainDecalVertexUpdateBuffer.data(),
-							 gfx_api::buffer::update_flag::non_overlapping_updates_promise);
+		uploadSectorStaging(terrainDecalVBO, sectorIdxs, staging.terrainDecalStart, staging.terrainDecals, [](const Sector &sector) { return sector.terrainAndDecalOffset; });
 	}
 }
 
@@ -805,6 +866,14 @@ void loadTerrainTextures_Fallback(MAP_TILESET mapTileset)
 	int32_t maxGfxTextureSize = gfx_api::context::get().get_context_value(gfx_api::context::context_value::MAX_TEXTURE_SIZE);
 	int maxTerrainTextureSize = std::max(std::min({getTextureSize(), maxGfxTextureSize}), MIN_TERRAIN_TEXTURE_SIZE);
 
+	// decode all of them in parallel
+	std::vector<std::pair<std::string, gfx_api::texture_type>> groundTextures;
+	for (int layer = 0; layer < getNumGroundTypes(); layer++)
+	{
+		groundTextures.emplace_back(getGroundType(layer).textureName, gfx_api::texture_type::game_texture);
+	}
+	iV_PreloadTextures(groundTextures, maxTerrainTextureSize, maxTerrainTextureSize);
+
 	// for each terrain layer
 	for (int layer = 0; layer < getNumGroundTypes(); layer++)
 	{
@@ -1194,6 +1263,15 @@ bool initTerrain()
 	xSectors = (mapWidth + sectorSize - 1) / sectorSize;
 	ySectors = (mapHeight + sectorSize - 1) / sectorSize;
 	sectors = std::unique_ptr<Sector[]> (new Sector[xSectors * ySectors]());
+	sectorCentres.clear();
+	sectorCentres.reserve(xSectors * ySectors);
+	for (int x = 0; x < xSectors; x++)
+	{
+		for (int y = 0; y < ySectors; y++)
+		{
+			sectorCentres.push_back(glm::vec3(world_coord(x * sectorSize + sectorSize / 2), 0.f, world_coord(y * sectorSize + sectorSize / 2)), 0.f);
+		}
+	}
 
 	////////////////////
 	// fill the geometry part of the sectors
@@ -1538,6 +1616,7 @@ bool initTerrain()
 	lightmap_texture = gfx_api::context::get().create_texture(1, lightmapPixmap->width(), lightmapPixmap->height(), lightmapPixmap->pixel_format(), "mem::lightmap");
 
 	lightmap_texture->upload(0, *(lightmapPixmap.get()));
+	lightmapDirtyBlocks.clear();
 	terrainInitialised = true;
 
 	return true;
@@ -1574,6 +1653,7 @@ void shutdownTerrain()
 			}
 		}
 		sectors = nullptr;
+		sectorCentres.clear();
 	}
 	delete lightmap_texture;
 	lightmap_texture = nullptr;
@@ -1596,10 +1676,23 @@ void shutdownTerrain()
 	terrainInitialised = false;
 }
 
+/// Writes the lightmap into lightmapPixmap, and marks the blocks that actually changed in lightmapDirtyBlocks
 static void updateLightMap(const LightMap& lightmap)
 {
-	size_t lightmapChannels = lightmapPixmap->channels(); // should always be 4 now...
+	const size_t lightmapChannels = lightmapPixmap->channels(); // should always be 4 now...
 	unsigned char* lightMapWritePtr = lightmapPixmap->bmp_w();
+	const int blocksPerRow = (mapWidth + LIGHTMAP_BLOCK_SIZE - 1) / LIGHTMAP_BLOCK_SIZE;
+	const int blocksPerColumn = (mapHeight + LIGHTMAP_BLOCK_SIZE - 1) / LIGHTMAP_BLOCK_SIZE;
+	lightmapDirtyBlocks.resize(blocksPerRow * blocksPerColumn, 0);
+
+	// fade to black at the edges of the visible terrain area (when there is no fog)
+	const bool fadeEdges = !pie_GetFogStatus();
+	const float playerX = map_coordf(playerPos.p.x);
+	const float playerY = map_coordf(playerPos.p.z);
+
+	// each row is computed in rowTexels first, then only the blocks that differ are copied into the pixmap
+	static std::vector<unsigned char> rowTexels;
+	rowTexels.resize(mapWidth * lightmapChannels);
 	for (int j = 0; j < mapHeight; ++j)
 	{
 		for (int i = 0; i < mapWidth; ++i)
@@ -1619,87 +1712,142 @@ static void updateLightMap(const LightMap& lightmap)
 				level = std::max<UBYTE>(level, colour.byte.r / 2);
 			}
 
-			lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 0] = colour.byte.r;
-			lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 1] = colour.byte.g;
-			lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 2] = colour.byte.b;
+			rowTexels[i * lightmapChannels + 0] = colour.byte.r;
+			rowTexels[i * lightmapChannels + 1] = colour.byte.g;
+			rowTexels[i * lightmapChannels + 2] = colour.byte.b;
 			// store the "brightness" level in byte.a
 			// NOTE: This differs depending on whether using the single-pass terrain shader or the fallback terrain shaders
 			// (For more, see avUpdateTiles() and getTileIllumination())
-			lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 3] = level;
+			rowTexels[i * lightmapChannels + 3] = level;
+		}
 
-			if (!pie_GetFogStatus())
+		if (fadeEdges)
+		{
+			// the distances to the top and bottom edges of the visible map are the same for the whole row
+			const float distC = j - (playerY - visibleTiles.y / 2);
+			const float distD = (playerY + visibleTiles.y / 2) - j;
+			const float distToRowEdge = std::min(distC, distD);
+			for (int i = 0; i < mapWidth; ++i)
 			{
-				// fade to black at the edges of the visible terrain area
-				const float playerX = map_coordf(playerPos.p.x);
-				const float playerY = map_coordf(playerPos.p.z);
-
 				const float distA = i - (playerX - visibleTiles.x / 2);
 				const float distB = (playerX + visibleTiles.x / 2) - i;
-				const float distC = j - (playerY - visibleTiles.y / 2);
-				const float distD = (playerY + visibleTiles.y / 2) - j;
-				float darken, distToEdge;
 
 				// calculate the distance to the closest edge of the visible map
-				// determine the smallest distance
-				distToEdge = distA;
-				if (distB < distToEdge)
-				{
-					distToEdge = distB;
-				}
-				if (distC < distToEdge)
+				const float distToEdge = std::min(std::min(distA, distB), distToRowEdge);
+				const float darken = (distToEdge) / 2.0f;
+				if (darken <= 0)
 				{
-					distToEdge = distC;
+					memset(&rowTexels[i * lightmapChannels], 0, lightmapChannels);
 				}
-				if (distD < distToEdge)
+				else if (darken < 1)
 				{
-					distToEdge = distD;
+					for (size_t c = 0; c < lightmapChannels; ++c)
+					{
+						rowTexels[i * lightmapChannels + c] *= darken;
+					}
 				}
+			}
+		}
 
-				darken = (distToEdge) / 2.0f;
-				if (darken <= 0)
-				{
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 0] = 0;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 1] = 0;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 2] = 0;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 3] = 0;
-				}
-				else if (darken < 1)
+		unsigned char *rowWritePtr = lightMapWritePtr + j * lightmapWidth * lightmapChannels;
+		for (int block = 0; block < blocksPerRow; ++block)
+		{
+			const size_t blockStart = block * LIGHTMAP_BLOCK_SIZE * lightmapChannels;
+			const size_t blockBytes = std::min(LIGHTMAP_BLOCK_SIZE, mapWidth - block * LIGHTMAP_BLOCK_SIZE) * lightmapChannels;
+			if (memcmp(&rowTexels[blockStart], rowWritePtr + blockStart, blockBytes) != 0)
+			{
+				memcpy(rowWritePtr + blockStart, &rowTexels[blockStart], blockBytes);
+				lightmapDirtyBlocks[(j / LIGHTMAP_BLOCK_SIZE) * blocksPerRow + block] = 1;
+			}
+		}
+	}
+}
+
+/// Uploads the changed blocks of the lightmap, with one upload for each run of changed blocks in a row of blocks
+static void uploadLightMap()
+{
+	const size_t dirtyBlockCount = std::count(lightmapDirtyBlocks.begin(), lightmapDirtyBlocks.end(), 1);
+	if (dirtyBlockCount == 0)
+	{
+		return;
+	}
+	if (dirtyBlockCount * 2 >= lightmapDirtyBlocks.size())
+	{
+		// most of it changed, so it's cheaper to upload it in one go
+		lightmap_texture->upload(0, *(lightmapPixmap.get()));
+		std::fill(lightmapDirtyBlocks.begin(), lightmapDirtyBlocks.end(), 0);
+		return;
+	}
+
+	static iV_Image lightmapUploadImage; // reused to avoid repeated allocations if possible
+	const size_t lightmapChannels = lightmapPixmap->channels();
+	const unsigned char *lightMapReadPtr = lightmapPixmap->bmp();
+	const int blocksPerRow = (mapWidth + LIGHTMAP_BLOCK_SIZE - 1) / LIGHTMAP_BLOCK_SIZE;
+	const int blocksPerColumn = static_cast<int>(lightmapDirtyBlocks.size()) / blocksPerRow;
+	for (int blockY = 0; blockY < blocksPerColumn; ++blockY)
+	{
+		uint8_t *dirtyRow = &lightmapDirtyBlocks[blockY * blocksPerRow];
+		for (int blockX = 0; blockX < blocksPerRow; ++blockX)
+		{
+			if (!dirtyRow[blockX])
+			{
+				continue;
+			}
+			int runEnd = blockX;
+			while (runEnd < blocksPerRow && dirtyRow[runEnd])
+			{
+				dirtyRow[runEnd++] = 0;
+			}
+
+			const int x0 = blockX * LIGHTMAP_BLOCK_SIZE, x1 = std::min(runEnd * LIGHTMAP_BLOCK_SIZE, mapWidth);
+			const int y0 = blockY * LIGHTMAP_BLOCK_SIZE, y1 = std::min(y0 + LIGHTMAP_BLOCK_SIZE, mapHeight);
+			if (lightmapUploadImage.width() != static_cast<unsigned>(x1 - x0) || lightmapUploadImage.height() != static_cast<unsigned>(y1 - y0))
+			{
+				if (!lightmapUploadImage.allocate(x1 - x0, y1 - y0, lightmapChannels))
 				{
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 0] *= darken;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 1] *= darken;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 2] *= darken;
-					lightMapWritePtr[(i + j * lightmapWidth) * lightmapChannels + 3] *= darken;
+					debug(LOG_ERROR, "Failed to allocate lightmap upload buffer");
+					return;
 				}
 			}
+			for (int y = y0; y < y1; ++y)
+			{
+				memcpy(lightmapUploadImage.bmp_w() + (y - y0) * (x1 - x0) * lightmapChannels, lightMapReadPtr + (y * lightmapWidth + x0) * lightmapChannels, (x1 - x0) * lightmapChannels);
+			}
+			lightmap_texture->upload_sub(0, x0, y0, lightmapUploadImage);
+			blockX = runEnd;
 		}
 	}
 }
 
 static void cullTerrain()
 {
+	// Sectors are drawn within terrainDistance of the camera (in all directions, as the shadow map passes also use them)
+	cullSpheresByDistance(glm::vec3(playerPos.p.x, 0.f, playerPos.p.z), static_cast<float>(world_coord(terrainDistance)), sectorCentres, sectorVisible);
+	static std::vector<int> dirtySectors;
+	dirtySectors.clear();
 	for (int x = 0; x < xSectors; x++)
 	{
 		for (int y = 0; y < ySectors; y++)
 		{
-			float xPos = world_coord(x * sectorSize + sectorSize / 2);
-			float yPos = world_coord(y * sectorSize + sectorSize / 2);
-			float distance = pow(playerPos.p.x - xPos, 2) + pow(playerPos.p.z - yPos, 2);
-
-			if (distance > pow((double)world_coord(terrainDistance), 2))
+			if (!sectorVisible[x * ySectors + y])
 			{
 				sectors[x * ySectors + y].draw = false;
 			}
 			else
 			{
 				sectors[x * ySectors + y].draw = true;
-				if (sectors[x * ySectors + y].dirty)
+				if (sectors[x * ySectors + y].dirty && dirtySectors.size() < maxSectorRebuildsPerFrame)
 				{
-					updateSectorGeometry(x, y);
+					dirtySectors.push_back(x * ySectors + y);
 					sectors[x * ySectors + y].dirty = false;
 				}
 			}
 		}
 	}
+	if (!dirtySectors.empty())
+	{
+		updateSectorGeometry(dirtySectors);
+	}
 }
 
 static void drawDepthOnly(const glm::mat4 &ModelViewProjection, const glm::vec4 &paramsXLight, const glm::vec4 &paramsYLight, bool withOffset)
@@ -1974,8 +2122,7 @@ void perFrameTerrainUpdates(const LightMap& lightMap)
 	{
 		lightmapLastUpdate = realTime;
 		updateLightMap(lightMap);
-
-		lightmap_texture->upload(0, *(lightmapPixmap.get()));
+		uploadLightMap();
 	}
 
 	///////////////////////////////////
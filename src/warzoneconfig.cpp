@@ -80,6 +80,10 @@ struct WARZONE_GLOBALS
 	int autoNotReadyKickSeconds = 0;
 	bool disableReplayRecording = false;
 	int maxReplaysSaved = MAX_REPLAY_FILES;
+	bool compressReplays = false; // compressed replays (format v4) can't be read by older versions
+	bool binarySaveSnapshots = false;
+	bool asyncAutosave = false; // autosaves written in the background are always stored as snapshots
+	bool incrementalAutosave = false; // incremental autosaves share base snapshots in the autosave folder
 	int oldLogsLimit = MAX_OLD_LOGS;
 	uint32_t MPinactivityMinutes = 5;
 	uint32_t MPgameTimeLimitMinutes = 0; // default to unlimited
@@ -561,6 +565,46 @@ void war_setMaxReplaysSaved(int maxReplaysSaved)
 	warGlobs.maxReplaysSaved = maxReplaysSaved;
 }
 
+bool war_getCompressReplays()
+{
+	return warGlobs.compressReplays;
+}
+
+void war_setCompressReplays(bool compress)
+{
+	warGlobs.compressReplays = compress;
+}
+
+bool war_getBinarySaveSnapshots()
+{
+	return warGlobs.binarySaveSnapshots;
+}
+
+void war_setBinarySaveSnapshots(bool enabled)
+{
+	warGlobs.binarySaveSnapshots = enabled;
+}
+
+bool war_getAsyncAutosave()
+{
+	return warGlobs.asyncAutosave;
+}
+
+void war_setAsyncAutosave(bool enabled)
+{
+	warGlobs.asyncAutosave = enabled;
+}
+
+bool war_getIncrementalAutosave()
+{
+	return warGlobs.incrementalAutosave;
+}
+
+void war_setIncrementalAutosave(bool enabled)
+{
+	warGlobs.incrementalAutosave = enabled;
+}
+
 int war_getOldLogsLimit()
 {
 	return warGlobs.oldLogsLimit;
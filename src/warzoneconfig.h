@@ -154,6 +154,14 @@ bool war_getDisableReplayRecording();
 void war_setDisableReplayRecording(bool disable);
 int war_getMaxReplaysSaved();
 void war_setMaxReplaysSaved(int maxReplaysSaved);
+bool war_getCompressReplays();
+void war_setCompressReplays(bool compress);
+bool war_getBinarySaveSnapshots();
+void war_setBinarySaveSnapshots(bool enabled);
+bool war_getAsyncAutosave();
+void war_setAsyncAutosave(bool enabled);
+bool war_getIncrementalAutosave();
+void war_setIncrementalAutosave(bool enabled);
 int war_getOldLogsLimit();
 void war_setOldLogsLimit(int oldLogsLimit);
 uint32_t war_getMPInactivityMinutes();
@@ -65,6 +65,7 @@ static UBYTE    scriptWinLoseVideo = PLAY_NONE;
 static HostLaunch hostlaunch = HostLaunch::Normal;  // used to detect if we are hosting a game via command line option.
 static bool bHeadlessAutoGameModeCLIOption = false;
 static bool bActualHeadlessAutoGameMode = false;
+static bool bHeadlessRender = false;
 static bool bHostLaunchStartNotReady = false;
 
 static uint32_t lastTick = 0;
@@ -154,6 +155,16 @@ bool headlessGameMode()
 	return bActualHeadlessAutoGameMode;
 }
 
+void setHeadlessRender(bool enabled)
+{
+	bHeadlessRender = enabled;
+}
+
+bool headlessRenderEnabled()
+{
+	return bHeadlessRender;
+}
+
 void setHostLaunchStartNotReady(bool value)
 {
 	bHostLaunchStartNotReady = value;
@@ -51,6 +51,10 @@ void resetHostLaunch();
 void setHeadlessGameMode(bool enabled);
 bool headlessGameMode();
 
+/// Whether the 3D scene is still prepared (and drawn with the null backend) in headless mode, to benchmark the CPU cost of rendering
+void setHeadlessRender(bool enabled);
+bool headlessRenderEnabled();
+
 void setHostLaunchStartNotReady(bool value);
 bool getHostLaunchStartNotReady();
 
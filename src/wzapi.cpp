@@ -82,6 +82,7 @@
 #include "gamehistorylogger.h"
 #include "hci/quickchat.h"
 #include "screens/guidescreen.h"
+#include "replayverify.h"
 
 #include <list>
 #include <cmath>
@@ -2558,7 +2559,7 @@ bool wzapi::gameOverMessage(WZAPI_PARAMS(bool gameWon, optional<bool> _showBackD
 		}
 		wzQuit(0); // Trigger a *graceful* shutdown
 	}
-	else if (headlessGameMode())
+	else if (headlessGameMode() && !replayVerifyEnabled()) // replay verification continues until the gameTime at which the replay was saved
 	{
 		debug(LOG_WARNING, "Headless game completed successfully!");
 		wzQuit(0); // Trigger a *graceful* shutdown
@@ -0,0 +1,189 @@
+// Compares the batched frustum culling in lib/ivis_opengl/culling.cpp (which uses SSE2 / NEON where available)
+// against testing each bounding volume on its own, as display3d.cpp did before, and reports the time taken by both.
+// cullingbench_scalar is the same, with culling.cpp built without SIMD (WZ_CULLING_NO_SIMD).
+// Usage: cullingbench [rounds]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <vector>
+#include "lib/ivis_opengl/culling.h"
+
+#if defined(WZ_CULLING_NO_SIMD)
+#  define CULLING_VARIANT "scalar"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define CULLING_VARIANT "SSE2"
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#  define CULLING_VARIANT "NEON"
+#else
+#  define CULLING_VARIANT "scalar"
+#endif
+
+static const size_t volumeCount = 100000;
+
+static bool isBoxVisible(const ViewFrustum& frustum, const BoundingBox& corners)
+{
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		bool allOutside = true;
+		for (const glm::vec3& corner : corners)
+		{
+			allOutside = allOutside && plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.f;
+		}
+		if (allOutside)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool isSphereVisible(const ViewFrustum& frustum, const glm::vec3& centre, float radius)
+{
+	for (const glm::vec4& plane : frustum.planes)
+	{
+		if (plane.x * centre.x + plane.y * centre.y + plane.z * centre.z + plane.w + radius < 0.f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool isSphereInRange(const glm::vec3& centre, float maxDistance, const glm::vec3& sphereCentre, float radius)
+{
+	const float dx = sphereCentre.x - centre.x, dy = sphereCentre.y - centre.y, dz = sphereCentre.z - centre.z;
+	const float limit = maxDistance + radius;
+	return !(limit * limit < dx * dx + dy * dy + dz * dz);
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start, int rounds)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+static bool compare(const char *name, const std::vector<uint8_t>& expected, const std::vector<uint8_t>& visible, double scalarTime, double batchedTime)
+{
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		if (expected[i] != visible[i])
+		{
+			fprintf(stderr, "cullingbench: %s: volume %zu is %s, expected %s\n", name, i, visible[i] ? "visible" : "hidden", expected[i] ? "visible" : "hidden");
+			return false;
+		}
+		visibleCount += visible[i];
+	}
+	printf("%-20s %zu of %zu visible, one at a time: %8.3f ms, batched: %8.3f ms (%.1fx)\n", name, visibleCount, expected.size(), scalarTime, batchedTime, scalarTime / batchedTime);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	const int rounds = (argc > 1) ? std::max(1, atoi(argv[1])) : 20;
+	// Positions and sizes are multiples of 1/64 (and the plane coefficients below have few bits too), so all the sums
+	// are exact and both ways of culling have to agree exactly, whatever order they add things up in
+	std::mt19937 rng(2100);
+	std::uniform_int_distribution<int> positionSteps(-192, 192), sizeSteps(0, 32);
+	auto position = [&rng, &positionSteps]() { return positionSteps(rng) / 64.f; };
+	auto size = [&rng, &sizeSteps]() { return sizeSteps(rng) / 64.f; };
+
+	// An odd count, so the elements after the last batch of 4 are tested too
+	std::vector<BoundingBox> boxes(volumeCount + 3);
+	BoundingBoxArray boxArray;
+	boxArray.reserve(boxes.size());
+	for (BoundingBox& box : boxes)
+	{
+		const glm::vec3 min(position(), position(), position());
+		const glm::vec3 max = min + glm::vec3(size(), size(), size());
+		box = {glm::vec3(min.x, min.y, min.z), glm::vec3(max.x, min.y, min.z), glm::vec3(min.x, max.y, min.z), glm::vec3(max.x, max.y, min.z),
+			glm::vec3(min.x, min.y, max.z), glm::vec3(max.x, min.y, max.z), glm::vec3(min.x, max.y, max.z), glm::vec3(max.x, max.y, max.z)};
+		boxArray.push_back(min, max);
+	}
+	std::vector<glm::vec3> centres(volumeCount + 3);
+	std::vector<float> radii(centres.size());
+	BoundingSphereArray sphereArray;
+	sphereArray.reserve(centres.size());
+	for (size_t i = 0; i < centres.size(); ++i)
+	{
+		centres[i] = glm::vec3(position(), position(), position());
+		radii[i] = size();
+		sphereArray.push_back(centres[i], radii[i]);
+	}
+
+	// The clip space box used for terrain and objects, and one with planes that aren't parallel to the axes
+	ViewFrustum clipSpace = ViewFrustum::fromBox(-1.f, 1.f, -1.f, 1.f, 0.f, 1.f, true);
+	ViewFrustum tilted = clipSpace;
+	tilted.planes[0] = glm::vec4(0.75f, 0.f, 0.5f, 1.f);
+	tilted.planes[1] = glm::vec4(-0.75f, 0.f, 0.5f, 1.f);
+	tilted.planes[2] = glm::vec4(0.f, 0.5f, 0.75f, 0.5f);
+
+	printf("Culling %zu volumes, %d rounds, batched culling uses %s\n", boxes.size(), rounds, CULLING_VARIANT);
+	std::vector<uint8_t> expected(boxes.size()), visible;
+	const std::pair<const char *, const ViewFrustum *> frustums[] = {{"boxes (clip space)", &clipSpace}, {"boxes (tilted)", &tilted}};
+	for (const auto& frustum : frustums)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < rounds; ++round)
+		{
+			for (size_t i = 0; i < boxes.size(); ++i)
+			{
+				expected[i] = isBoxVisible(*frustum.second, boxes[i]) ? 1 : 0;
+			}
+		}
+		const double scalarTime = millisecondsSince(start, rounds);
+		start = std::chrono::steady_clock::now();
+		for (int round = 0; round < rounds; ++round)
+		{
+			cullBoxes(*frustum.second, boxArray, visible);
+		}
+		if (!compare(frustum.first, expected, visible, scalarTime, millisecondsSince(start, rounds)))
+		{
+			return -1;
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (size_t i = 0; i < centres.size(); ++i)
+		{
+			expected[i] = isSphereVisible(clipSpace, centres[i], radii[i]) ? 1 : 0;
+		}
+	}
+	double scalarTime = millisecondsSince(start, rounds);
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		cullSpheres(clipSpace, sphereArray, visible);
+	}
+	if (!compare("spheres", expected, visible, scalarTime, millisecondsSince(start, rounds)))
+	{
+		return -1;
+	}
+
+	const glm::vec3 eye(0.5f, 0.f, -1.f);
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (size_t i = 0; i < centres.size(); ++i)
+		{
+			expected[i] = isSphereInRange(eye, 2.f, centres[i], radii[i]) ? 1 : 0;
+		}
+	}
+	scalarTime = millisecondsSince(start, rounds);
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		cullSpheresByDistance(eye, 2.f, sphereArray, visible);
+	}
+	if (!compare("spheres by distance", expected, visible, scalarTime, millisecondsSince(start, rounds)))
+	{
+		return -1;
+	}
+
+	return 0;
+}
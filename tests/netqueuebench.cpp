@@ -0,0 +1,125 @@
+// Measures how many messages per second go through a NetQueuePair: bursts of small order-sized messages are
+// pushed into the send queue, serialised, fed to the receive queue in socket-sized reads, and popped again.
+// The second run also records every message and read in the network telemetry, as netplay does.
+// Usage: netqueuebench [bursts]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "lib/framework/frame.h"
+#include "lib/netplay/netplay.h"
+#include "lib/netplay/netqueue.h"
+#include "lib/netplay/nettelemetry.h"
+#include "src/main.h"
+
+// The main loop isn't used: everything happens in realmain()
+void mainLoop()
+{
+}
+
+static const size_t burstSize = 64;    // messages queued between two socket writes
+static const size_t payloadSize = 12;  // about the size of a droid order
+static const size_t readSize = 1400;   // bytes per socket read
+
+/// Sends `bursts` bursts of messages through `pair`, returns the number of messages received (or 0 if any arrived wrong).
+static size_t sendBursts(NetQueuePair& pair, size_t bursts, bool telemetry)
+{
+	std::vector<uint8_t> wire;
+	size_t received = 0;
+	for (size_t burst = 0; burst < bursts; ++burst)
+	{
+		for (size_t i = 0; i < burstSize; ++i)
+		{
+			NetMessageBuilder builder(GAME_DROIDINFO, NetMessage::HEADER_LENGTH + payloadSize);
+			uint8_t payload[payloadSize] = {static_cast<uint8_t>(i)};
+			builder.append(payload, payloadSize);
+			pair.send.pushMessage(builder.build());
+		}
+
+		wire.clear();
+		while (pair.send.numMessagesForNet() > 0)
+		{
+			const NetMessage &message = pair.send.getMessageForNet();
+			if (telemetry)
+			{
+				NETtelemetryRecordMessage(message.type(), static_cast<uint32_t>(message.rawData().size()), false);
+			}
+			message.rawDataAppendToVector(wire);
+			pair.send.popMessageForNet();
+		}
+		if (telemetry)
+		{
+			NETtelemetryRecordConnectionTraffic(1, wire.size(), wire.size(), false);
+		}
+
+		for (size_t offset = 0; offset < wire.size(); offset += readSize)
+		{
+			const size_t length = std::min(readSize, wire.size() - offset);
+			if (telemetry)
+			{
+				NETtelemetryRecordConnectionTraffic(1, length, length, true);
+			}
+			pair.receive.writeRawData(wire.data() + offset, length);
+		}
+		for (size_t i = 0; pair.receive.haveMessage(); ++i)
+		{
+			const NetMessage &message = pair.receive.getMessage();
+			if (message.type() != GAME_DROIDINFO || message.payloadSize() != payloadSize || message.payload()[0] != static_cast<uint8_t>(i))
+			{
+				fprintf(stderr, "netqueuebench: message %zu of burst %zu arrived wrong\n", i, burst);
+				return 0;
+			}
+			if (telemetry)
+			{
+				NETtelemetryRecordMessage(message.type(), static_cast<uint32_t>(message.rawData().size()), true);
+			}
+			pair.receive.popMessage();
+			++received;
+		}
+	}
+	return received;
+}
+
+static bool run(const char *name, size_t bursts, bool telemetry)
+{
+	NetQueuePair pair;
+	NETtelemetryReset();
+	const auto start = std::chrono::steady_clock::now();
+	const size_t received = sendBursts(pair, bursts, telemetry);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (received != bursts * burstSize)
+	{
+		fprintf(stderr, "netqueuebench: %s: received %zu of %zu messages\n", name, received, bursts * burstSize);
+		return false;
+	}
+	if (pair.receive.currentIncompleteDataBuffered() != 0)
+	{
+		fprintf(stderr, "netqueuebench: %s: %zu bytes left over\n", name, pair.receive.currentIncompleteDataBuffered());
+		return false;
+	}
+	if (telemetry)
+	{
+		const auto json = NETtelemetryToJSON();
+		const auto& messages = json["messages"];
+		if (messages.size() != 1 || messages[0]["sent"]["count"].get<uint64_t>() != received || messages[0]["recv"]["count"].get<uint64_t>() != received)
+		{
+			fprintf(stderr, "netqueuebench: %s: telemetry doesn't match: %s\n", name, json.dump().c_str());
+			return false;
+		}
+	}
+	printf("%-20s %zu messages in %.3f s, %.0f messages/s\n", name, received, seconds, received / seconds);
+	return true;
+}
+
+int realmain(int argc, char **argv)
+{
+	const size_t bursts = (argc > 1) ? std::max(1, atoi(argv[1])) : 20000;
+	if (!run("NetQueuePair", bursts, false) || !run("with telemetry", bursts, true))
+	{
+		return -1;
+	}
+	return 0;
+}
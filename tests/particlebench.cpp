@@ -0,0 +1,213 @@
+// Feeds effect-like particles to a ParticleBatcher, checks how they are batched and that pie_Draw3DParticles
+// submits every particle once, and compares the time taken with submitting each particle with pie_Draw3DShape.
+// Runs against the null backend, which has no instanced rendering, so both ways only queue the shapes.
+// Usage: particlebench [rounds]
+
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/ivis_opengl/gfx_api.h"
+#include "lib/ivis_opengl/gfx_api_null.h"
+#include "lib/ivis_opengl/ivisdef.h"
+#include "lib/ivis_opengl/piedef.h"
+#include "lib/ivis_opengl/piedraw.h"
+#include "lib/ivis_opengl/piepalette.h"
+#include "lib/ivis_opengl/pieparticles.h"
+
+#include "src/main.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// The main loop isn't used: everything happens in realmain()
+void mainLoop()
+{
+}
+
+// A null backend that doesn't need a window
+class test_Null_Impl final : public gfx_api::backend_Null_Impl
+{
+public:
+	void swapWindow() override { }
+	bool setSwapInterval(gfx_api::context::swap_interval_mode mode) override { swapMode = mode; return true; }
+	gfx_api::context::swap_interval_mode getSwapInterval() const override { return swapMode; }
+private:
+	gfx_api::context::swap_interval_mode swapMode = gfx_api::context::swap_interval_mode::vsync;
+};
+
+class test_Impl_Factory final : public gfx_api::backend_Impl_Factory
+{
+public:
+	std::unique_ptr<gfx_api::backend_Null_Impl> createNullBackendImpl() const override { return std::make_unique<test_Null_Impl>(); }
+	std::unique_ptr<gfx_api::backend_OpenGL_Impl> createOpenGLBackendImpl() const override { return nullptr; }
+#if defined(WZ_VULKAN_ENABLED)
+	std::unique_ptr<gfx_api::backend_Vulkan_Impl> createVulkanBackendImpl() const override { return nullptr; }
+#endif
+};
+
+static const size_t meshCount = 3;
+static const int pieFlags[] = {pie_TRANSLUCENT | pie_NODEPTHWRITE, pie_ADDITIVE};
+static const size_t particleCount = 10000;
+
+/// The particles of one frame: smoke, fire and a two-level explosion mesh, in the interleaved order the effects are processed in
+static void addParticles(ParticleBatcher& batcher, const std::unique_ptr<iIMDShape> (&meshes)[meshCount])
+{
+	for (size_t i = 0; i < particleCount; ++i)
+	{
+		PIE_PARTICLE particle;
+		particle.modelMatrix = glm::translate(glm::mat4(1.f), glm::vec3(i % 100 * 128.f, 0.f, i / 100 * 128.f));
+		particle.colour = WZCOL_WHITE;
+		particle.frame = static_cast<int>(i % 8);
+		particle.pieFlagData = static_cast<int>(i % 256);
+		batcher.add(meshes[i % meshCount].get(), pieFlags[i / meshCount % ARRAY_SIZE(pieFlags)], particle);
+	}
+}
+
+static size_t resetPieCount()
+{
+	size_t pieCount = 0, polyCount = 0;
+	pie_GetResetCounts(&pieCount, &polyCount);
+	return pieCount;
+}
+
+static bool checkBatcher(const char *step, const ParticleBatcher& batcher, size_t batches, size_t particles)
+{
+	if (batcher.batchCount() != batches || batcher.particleCount() != particles)
+	{
+		fprintf(stderr, "particlebench: %s: expected %zu batches of %zu particles, got %zu batches of %zu particles\n", step, batches, particles, batcher.batchCount(), batcher.particleCount());
+		return false;
+	}
+	return true;
+}
+
+static bool checkSubmitted(const char *step, size_t particles)
+{
+	const size_t pieCount = resetPieCount();
+	if (pieCount != particles)
+	{
+		fprintf(stderr, "particlebench: %s: expected %zu particles to be submitted, got %zu\n", step, particles, pieCount);
+		return false;
+	}
+	return true;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start, int rounds)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int realmain(int argc, char **argv)
+{
+	const int rounds = (argc > 1) ? std::max(1, atoi(argv[1])) : 50;
+	debug_init();
+	debug_register_callback(debug_callback_stderr, NULL, NULL, NULL);
+
+	test_Impl_Factory factory;
+	if (!gfx_api::context::initialize(factory, 0, gfx_api::context::swap_interval_mode::vsync, nullopt, 0, gfx_api::backend_type::null_backend))
+	{
+		fprintf(stderr, "particlebench: Failed to initialize the null backend\n");
+		return -1;
+	}
+	pie_InitializeInstancedRenderer();
+
+	// Meshes without any geometry are enough, nothing is drawn until pie_DrawAllMeshes
+	std::unique_ptr<iIMDShape> meshes[meshCount];
+	for (auto& mesh : meshes)
+	{
+		mesh = std::make_unique<iIMDShape>();
+		mesh->numFrames = 8;
+	}
+	meshes[2]->next = std::make_unique<iIMDShape>();
+	meshes[2]->next->modelLevel = 1;
+
+	ParticleBatcher batcher;
+	pie_StartMeshes();
+	resetPieCount();
+	batcher.flush();
+	if (!checkBatcher("empty", batcher, 0, 0) || !checkSubmitted("empty", 0))
+	{
+		return -1;
+	}
+
+	// One batch per mesh and pieFlag, however the particles are interleaved; flushing submits every particle once
+	// (also for the mesh with two levels), and empties the batcher
+	const size_t batchCount = meshCount * ARRAY_SIZE(pieFlags);
+	addParticles(batcher, meshes);
+	if (!checkBatcher("added", batcher, batchCount, particleCount))
+	{
+		return -1;
+	}
+	batcher.flush();
+	if (!checkBatcher("flushed", batcher, 0, 0) || !checkSubmitted("flushed", particleCount))
+	{
+		return -1;
+	}
+	// The batches are reused in the next frame
+	addParticles(batcher, meshes);
+	if (!checkBatcher("added again", batcher, batchCount, particleCount))
+	{
+		return -1;
+	}
+	batcher.flush();
+	if (!checkSubmitted("flushed again", particleCount))
+	{
+		return -1;
+	}
+	// Cleared particles are never submitted
+	addParticles(batcher, meshes);
+	batcher.clear();
+	batcher.flush();
+	if (!checkBatcher("cleared", batcher, 0, 0) || !checkSubmitted("cleared", 0))
+	{
+		return -1;
+	}
+
+	// The same particles, one pie_Draw3DShape call each, as the effects were drawn before
+	PIE_PARTICLE particle;
+	particle.colour = WZCOL_WHITE;
+	particle.pieFlagData = 128;
+	pie_StartMeshes();
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (size_t i = 0; i < particleCount; ++i)
+		{
+			particle.modelMatrix = glm::translate(glm::mat4(1.f), glm::vec3(i % 100 * 128.f, 0.f, i / 100 * 128.f));
+			pie_Draw3DShape(meshes[i % meshCount].get(), static_cast<int>(i % 8), 0, particle.colour, pieFlags[i / meshCount % ARRAY_SIZE(pieFlags)], particle.pieFlagData, particle.modelMatrix, glm::mat4(1.f));
+		}
+		pie_StartMeshes();
+	}
+	const double shapeTime = millisecondsSince(start, rounds);
+	if (!checkSubmitted("pie_Draw3DShape", particleCount * rounds))
+	{
+		return -1;
+	}
+
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; ++round)
+	{
+		addParticles(batcher, meshes);
+		batcher.flush();
+		pie_StartMeshes();
+	}
+	const double batchedTime = millisecondsSince(start, rounds);
+	if (!checkSubmitted("ParticleBatcher", particleCount * rounds))
+	{
+		return -1;
+	}
+
+	printf("%zu particles in %zu batches, one at a time: %8.3f ms, batched: %8.3f ms\n", particleCount, batchCount, shapeTime, batchedTime);
+
+	for (auto& mesh : meshes)
+	{
+		mesh.reset();
+	}
+	pie_CleanUp();
+	gfx_api::context::get().shutdown();
+	return 0;
+}
@@ -0,0 +1,274 @@
+// Measures how long it takes to save and load the JSON files of a save game written by saveGame() as JSON files,
+// and as the binary snapshots of lib/framework/savesnapshot.cpp (synchronous, asynchronous and incremental), and
+// checks that everything read back from the snapshots is what was written.
+// Usage: snapshotbench <save game folder>
+// (ctest first saves a skirmish game with "warzone2100 --headless --skirmish=highground.json --saveandquit=...")
+
+#include <nlohmann/json.hpp> // Must come before WZ includes
+
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/file.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/framework/savesnapshot.h"
+#include "lib/framework/wzapp.h"
+
+#include "src/main.h"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The main loop isn't used: everything happens in realmain()
+void mainLoop()
+{
+}
+
+#define BENCH_DIR "snapshotbench.tmp"
+static const uint32_t schemaVersion = 1;
+
+typedef std::vector<std::pair<std::string, nlohmann::json>> SaveFiles;
+
+/// Reads all the JSON files of the save game mounted at `dir`
+static bool loadSaveFiles(const char *dir, SaveFiles& files)
+{
+	bool ok = true;
+	WZ_PHYSFS_enumerateFiles(dir, [dir, &files, &ok](const char *file) -> bool {
+		const std::string name = file;
+		if (name.size() <= 5 || name.compare(name.size() - 5, 5, ".json") != 0)
+		{
+			return true;
+		}
+		const std::string path = std::string(dir) + "/" + name;
+		std::vector<char> contents;
+		if (!loadFileToBufferVector(path.c_str(), contents, false, false))
+		{
+			fprintf(stderr, "snapshotbench: Failed to load %s\n", path.c_str());
+			ok = false;
+			return false;
+		}
+		files.emplace_back(name, nlohmann::json::parse(contents.begin(), contents.end()));
+		return true;
+	});
+	return ok && !files.empty();
+}
+
+/// Moves every tenth object with a position a little, like the game does between two autosaves
+static void moveObjects(SaveFiles& files)
+{
+	size_t objects = 0;
+	for (auto& file : files)
+	{
+		for (auto& object : file.second.items())
+		{
+			nlohmann::json& value = object.value();
+			if (!value.is_object() || !value.contains("position") || !value["position"].is_array() || value["position"].size() != 3)
+			{
+				continue;
+			}
+			if (objects++ % 10 == 0)
+			{
+				value["position"][2] = value["position"][2].get<int>() + 1;
+			}
+		}
+	}
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool saveJSONFiles(const std::string& dir, const SaveFiles& files)
+{
+	for (const auto& file : files)
+	{
+		const std::string contents = file.second.dump(4);
+		if (!saveFile((dir + "/" + file.first).c_str(), contents.c_str(), static_cast<UDWORD>(contents.size())))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool loadJSONFiles(const std::string& dir, const SaveFiles& files, std::vector<nlohmann::json>& loaded)
+{
+	loaded.clear();
+	for (const auto& file : files)
+	{
+		const std::string path = dir + "/" + file.first;
+		std::vector<char> contents;
+		if (!loadFileToBufferVector(path.c_str(), contents, false, false))
+		{
+			fprintf(stderr, "snapshotbench: Failed to load %s\n", path.c_str());
+			return false;
+		}
+		loaded.push_back(nlohmann::json::parse(contents.begin(), contents.end()));
+	}
+	return true;
+}
+
+static void writeSnapshot(const std::string& dir, const SaveFiles& files, bool async, bool incremental)
+{
+	saveSnapshotBegin(dir.c_str(), schemaVersion, async, incremental);
+	for (const auto& file : files)
+	{
+		saveSnapshotWriteJSON((dir + "/" + file.first).c_str(), file.second);
+	}
+	saveSnapshotEnd();
+}
+
+static bool readSnapshot(const std::string& dir, const SaveFiles& files, std::vector<nlohmann::json>& loaded)
+{
+	loaded.clear();
+	for (const auto& file : files)
+	{
+		const std::string path = dir + "/" + file.first;
+		loaded.emplace_back();
+		if (!saveSnapshotReadJSON(path.c_str(), loaded.back()))
+		{
+			fprintf(stderr, "snapshotbench: Failed to read %s from the snapshot\n", path.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool compare(const std::string& dir, const SaveFiles& files, const std::vector<nlohmann::json>& loaded)
+{
+	for (size_t i = 0; i < files.size(); ++i)
+	{
+		if (loaded[i] != files[i].second)
+		{
+			fprintf(stderr, "snapshotbench: %s/%s wasn't read back correctly\n", dir.c_str(), files[i].first.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+static void report(const char *name, const std::string& dir, double saveTime, double loadTime)
+{
+	size_t size = 0;
+	WZ_PHYSFS_enumerateFiles(dir.c_str(), [&dir, &size](const char *file) -> bool {
+		PHYSFS_file *fileHandle = PHYSFS_openRead((dir + "/" + file).c_str());
+		if (fileHandle != nullptr)
+		{
+			size += static_cast<size_t>(std::max<PHYSFS_sint64>(0, PHYSFS_fileLength(fileHandle)));
+			PHYSFS_close(fileHandle);
+		}
+		return true;
+	});
+	printf("%-24s save: %8.2f ms, load: %8.2f ms, %8zu bytes\n", name, saveTime, loadTime, size);
+}
+
+int realmain(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: snapshotbench <save game folder>\n");
+		return -1;
+	}
+	debug_init();
+	debug_register_callback(debug_callback_stderr, NULL, NULL, NULL);
+	// Work in a directory of our own, and start over every time
+	if (!PHYSFS_init(argv[0]) || !PHYSFS_setWriteDir(".") || !PHYSFS_mkdir(BENCH_DIR)
+	    || !PHYSFS_setWriteDir(BENCH_DIR) || !PHYSFS_mount(BENCH_DIR, NULL, 0))
+	{
+		fprintf(stderr, "snapshotbench: Failed to set up " BENCH_DIR ": %s\n", WZ_PHYSFS_getLastError());
+		return -1;
+	}
+	const char *dirs[] = {"json", "snapshot", "async", "autosaves", "autosaves/autosave1", "autosaves/autosave2"};
+	for (const char *dir : dirs)
+	{
+		WZ_PHYSFS_enumerateFiles(dir, [dir](const char *file) -> bool {
+			PHYSFS_delete((std::string(dir) + "/" + file).c_str());
+			return true;
+		});
+		PHYSFS_mkdir(dir);
+	}
+
+	SaveFiles files;
+	if (!PHYSFS_mount(argv[1], "savegame", 1) || !loadSaveFiles("savegame", files))
+	{
+		fprintf(stderr, "snapshotbench: Failed to load the save game in %s\n", argv[1]);
+		return -1;
+	}
+	printf("Saving the %zu JSON files of %s\n", files.size(), argv[1]);
+
+	auto start = std::chrono::steady_clock::now();
+	if (!saveJSONFiles("json", files))
+	{
+		fprintf(stderr, "snapshotbench: Failed to save the JSON files\n");
+		return -1;
+	}
+	double saveTime = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	std::vector<nlohmann::json> loaded;
+	if (!loadJSONFiles("json", files, loaded))
+	{
+		return -1;
+	}
+	report("JSON files", "json", saveTime, millisecondsSince(start));
+	if (!compare("json", files, loaded))
+	{
+		return -1;
+	}
+
+	start = std::chrono::steady_clock::now();
+	writeSnapshot("snapshot", files, false, false);
+	saveTime = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	if (!readSnapshot("snapshot", files, loaded))
+	{
+		return -1;
+	}
+	report("snapshot", "snapshot", saveTime, millisecondsSince(start));
+	if (!compare("snapshot", files, loaded))
+	{
+		return -1;
+	}
+
+	// (the save time is how long the game is blocked; writing the file continues in the background)
+	start = std::chrono::steady_clock::now();
+	writeSnapshot("async", files, true, false);
+	saveTime = millisecondsSince(start);
+	saveSnapshotWaitForPendingWrites();
+	const double writeTime = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	if (!readSnapshot("async", files, loaded))
+	{
+		return -1;
+	}
+	report("async snapshot", "async", saveTime, millisecondsSince(start));
+	if (!compare("async", files, loaded))
+	{
+		return -1;
+	}
+	printf("%-24s (written after %.2f ms)\n", "", writeTime);
+
+	// The first incremental snapshot writes the base, the second one only stores what changed since
+	writeSnapshot("autosaves/autosave1", files, false, true);
+	moveObjects(files);
+	start = std::chrono::steady_clock::now();
+	writeSnapshot("autosaves/autosave2", files, false, true);
+	saveTime = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	if (!readSnapshot("autosaves/autosave2", files, loaded))
+	{
+		return -1;
+	}
+	report("incremental (w/o base)", "autosaves/autosave2", saveTime, millisecondsSince(start));
+	if (!compare("autosaves/autosave2", files, loaded))
+	{
+		return -1;
+	}
+
+	PHYSFS_deinit();
+	return 0;
+}
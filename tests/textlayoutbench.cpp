@@ -0,0 +1,183 @@
+// Lays out console messages and lobby game lists the way console.cpp and the lobby screens do (wrapping
+// with iV_FormatText, measuring with iV_GetTextWidth, and creating a WzText per line or cell), and reports
+// how long the first pass (with empty text caches) and the following passes take.
+// Every WzText still creates its own texture, which is counted as well.
+// Usage: textlayoutbench [passes]
+
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/ivis_opengl/gfx_api.h"
+#include "lib/ivis_opengl/gfx_api_null.h"
+#include "lib/ivis_opengl/textdraw.h"
+
+#include "src/main.h"
+
+#include <physfs.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// The main loop isn't used: everything happens in realmain()
+void mainLoop()
+{
+}
+
+// A null backend that doesn't need a window
+class test_Null_Impl final : public gfx_api::backend_Null_Impl
+{
+public:
+	void swapWindow() override { }
+	bool setSwapInterval(gfx_api::context::swap_interval_mode mode) override { swapMode = mode; return true; }
+	gfx_api::context::swap_interval_mode getSwapInterval() const override { return swapMode; }
+private:
+	gfx_api::context::swap_interval_mode swapMode = gfx_api::context::swap_interval_mode::vsync;
+};
+
+class test_Impl_Factory final : public gfx_api::backend_Impl_Factory
+{
+public:
+	std::unique_ptr<gfx_api::backend_Null_Impl> createNullBackendImpl() const override { return std::make_unique<test_Null_Impl>(); }
+	std::unique_ptr<gfx_api::backend_OpenGL_Impl> createOpenGLBackendImpl() const override { return nullptr; }
+#if defined(WZ_VULKAN_ENABLED)
+	std::unique_ptr<gfx_api::backend_Vulkan_Impl> createVulkanBackendImpl() const override { return nullptr; }
+#endif
+};
+
+static const char *consoleMessages[] = {
+	"Player 2 (Commander): attack the oil derricks to the north-east, I'll hold the base",
+	"Structure completed - Research Facility",
+	"Research completed: Heavy Machinegun Hardpoint",
+	"Player 5: gg",
+	"Unit lost! A Viper Machinegun Wheels was destroyed in the south-west",
+	"Player 3 (Ally): need power, can someone send 500? My generators were destroyed a minute ago and I can't rebuild the derricks",
+	"Spieler 4: Achtung, Luftangriff von Westen!",
+	"Joueur 6 : je prends le centre, couvrez-moi",
+	"The game will be saved in 30 seconds",
+};
+
+static const char *gameNames[] = {"2v2 NTW no bases", "Free for all - everyone welcome", "Rush T1 advanced bases", "Tournament match 4c", "Castle Wars"};
+static const char *mapNames[] = {"Sk-Rush-T1", "Sk-Startup-T1", "NTW", "Sk-HighGround", "Concrete-T1", "Vision"};
+static const char *hostNames[] = {"NoQ", "Berserk Cyborg", "Delta", "Commander Cobra", "Jaguar"};
+
+static const unsigned int consoleWidth = 600;
+static const size_t consoleLines = 200;
+static const size_t lobbyGames = 100;
+
+/// Returns the number of string textures created (one for each WzText that isn't empty)
+static size_t layoutConsole(std::vector<WzText>& lines)
+{
+	lines.clear();
+	size_t textures = 0;
+	for (size_t i = 0; i < consoleLines; ++i)
+	{
+		const WzString message = WzString::fromUtf8(consoleMessages[i % ARRAY_SIZE(consoleMessages)]);
+		for (const TextLine& line : iV_FormatText(message, consoleWidth, FTEXT_LEFTJUSTIFY, font_regular))
+		{
+			lines.emplace_back(WzString::fromUtf8(line.text), font_regular);
+			textures += (lines.back().width() > 0) ? 1 : 0;
+		}
+	}
+	return textures;
+}
+
+static size_t layoutLobby(std::vector<WzText>& cells)
+{
+	cells.clear();
+	size_t textures = 0;
+	const unsigned int nameColumnWidth = 220;
+	for (size_t i = 0; i < lobbyGames; ++i)
+	{
+		WzString name = WzString::fromUtf8(std::string(gameNames[i % ARRAY_SIZE(gameNames)]) + " #" + std::to_string(i % 10));
+		// shorten the name until it fits its column, as the game list does
+		while (name.length() > 1 && iV_GetTextWidth(name, font_regular) > nameColumnWidth)
+		{
+			name.truncate(name.length() - 1);
+		}
+		const WzString cellTexts[] = {
+			name,
+			WzString::fromUtf8(mapNames[i % ARRAY_SIZE(mapNames)]),
+			WzString::fromUtf8(hostNames[i % ARRAY_SIZE(hostNames)]),
+			WzString::fromUtf8(std::to_string(1 + i % 4) + "/" + std::to_string(2 + 2 * (i % 5))),
+		};
+		for (const WzString& text : cellTexts)
+		{
+			cells.emplace_back(text, font_small);
+			textures += (cells.back().width() > 0) ? 1 : 0;
+		}
+	}
+	return textures;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int realmain(int argc, char **argv)
+{
+	const int passes = (argc > 1) ? std::max(2, atoi(argv[1])) : 20;
+	debug_init();
+	debug_register_callback(debug_callback_stderr, NULL, NULL, NULL);
+
+	char datapath[PATH_MAX];
+	const char *srcdir = getenv("srcdir");
+	snprintf(datapath, sizeof(datapath), "%s/../data", (srcdir != nullptr) ? srcdir : ".");
+	PHYSFS_init(argv[0]);
+	PHYSFS_mount(datapath, NULL, 1);
+	if (!PHYSFS_exists("fonts/DejaVuSans.ttf") || !PHYSFS_exists("fonts/NotoSansCJK-VF.otf.ttc"))
+	{
+		fprintf(stderr, "textlayoutbench: The fonts in %s/fonts are missing, skipping\n", datapath);
+		return 0;
+	}
+
+	test_Impl_Factory factory;
+	if (!gfx_api::context::initialize(factory, 0, gfx_api::context::swap_interval_mode::vsync, nullopt, 0, gfx_api::backend_type::null_backend))
+	{
+		fprintf(stderr, "textlayoutbench: Failed to initialize the null backend\n");
+		return -1;
+	}
+	iV_TextInit(100, 100);
+
+	std::vector<WzText> consoleText, lobbyText;
+	auto start = std::chrono::steady_clock::now();
+	const size_t consoleTextures = layoutConsole(consoleText);
+	const double consoleFirst = millisecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	const size_t lobbyTextures = layoutLobby(lobbyText);
+	const double lobbyFirst = millisecondsSince(start);
+
+	double consoleTime = 0, lobbyTime = 0;
+	for (int pass = 1; pass < passes; ++pass)
+	{
+		start = std::chrono::steady_clock::now();
+		if (layoutConsole(consoleText) != consoleTextures)
+		{
+			fprintf(stderr, "textlayoutbench: The console was laid out differently in pass %d\n", pass);
+			return -1;
+		}
+		consoleTime += millisecondsSince(start);
+		start = std::chrono::steady_clock::now();
+		if (layoutLobby(lobbyText) != lobbyTextures)
+		{
+			fprintf(stderr, "textlayoutbench: The lobby list was laid out differently in pass %d\n", pass);
+			return -1;
+		}
+		lobbyTime += millisecondsSince(start);
+	}
+
+	printf("%-28s first pass: %7.2f ms, later passes: %7.2f ms, %zu string textures per pass\n", "console (200 messages)", consoleFirst, consoleTime / (passes - 1), consoleTextures);
+	printf("%-28s first pass: %7.2f ms, later passes: %7.2f ms, %zu string textures per pass\n", "lobby list (100 games)", lobbyFirst, lobbyTime / (passes - 1), lobbyTextures);
+
+	consoleText.clear();
+	lobbyText.clear();
+	iV_TextShutdown();
+	gfx_api::context::get().shutdown();
+	PHYSFS_deinit();
+	return 0;
+}
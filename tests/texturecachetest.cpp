@@ -0,0 +1,158 @@
+#include "lib/framework/wzglobal.h"
+#include "lib/framework/types.h"
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/framework/physfs_ext.h"
+#include "lib/ivis_opengl/gfx_api.h"
+#include "lib/ivis_opengl/gfx_api_null.h"
+#include "lib/ivis_opengl/gfx_api_image_compress_priv.h"
+#include "lib/ivis_opengl/png_util.h"
+#include "lib/ivis_opengl/screen.h"
+
+#include "src/main.h"
+
+#include <physfs.h>
+
+// The main loop isn't used: everything happens in realmain()
+void mainLoop()
+{
+}
+
+// A null backend that doesn't need a window
+class test_Null_Impl final : public gfx_api::backend_Null_Impl
+{
+public:
+	void swapWindow() override { }
+	bool setSwapInterval(gfx_api::context::swap_interval_mode mode) override { swapMode = mode; return true; }
+	gfx_api::context::swap_interval_mode getSwapInterval() const override { return swapMode; }
+private:
+	gfx_api::context::swap_interval_mode swapMode = gfx_api::context::swap_interval_mode::vsync;
+};
+
+class test_Impl_Factory final : public gfx_api::backend_Impl_Factory
+{
+public:
+	std::unique_ptr<gfx_api::backend_Null_Impl> createNullBackendImpl() const override { return std::make_unique<test_Null_Impl>(); }
+	std::unique_ptr<gfx_api::backend_OpenGL_Impl> createOpenGLBackendImpl() const override { return nullptr; }
+#if defined(WZ_VULKAN_ENABLED)
+	std::unique_ptr<gfx_api::backend_Vulkan_Impl> createVulkanBackendImpl() const override { return nullptr; }
+#endif
+};
+
+static bool checkStats(const char *step, size_t hits, size_t misses, size_t stores)
+{
+	gfx_api::texture_cache_stats stats = gfx_api::getCompressedTextureCacheStats();
+	if (stats.hits != hits || stats.misses != misses || stats.stores != stores)
+	{
+		fprintf(stderr, "%s: expected %zu hits, %zu misses, %zu stores, got %zu hits, %zu misses, %zu stores\n", step, hits, misses, stores, stats.hits, stats.misses, stats.stores);
+		return false;
+	}
+	return true;
+}
+
+static bool loadTexture(const char *filename)
+{
+	gfx_api::texture *texture = gfx_api::context::get().loadTextureFromFile(filename, gfx_api::texture_type::game_texture);
+	if (texture == nullptr)
+	{
+		fprintf(stderr, "Failed to load %s\n", filename);
+		return false;
+	}
+	delete texture;
+	return true;
+}
+
+int realmain(int argc, char **argv)
+{
+	(void)argc;
+	debug_init();
+	debug_register_callback(debug_callback_stderr, NULL, NULL, NULL);
+	// Work in a directory of our own, so the cache always starts out empty
+	if (!PHYSFS_init(argv[0]) || !PHYSFS_setWriteDir(".") || !PHYSFS_mkdir("texturecachetest.tmp")
+	    || !PHYSFS_setWriteDir("texturecachetest.tmp") || !PHYSFS_mount("texturecachetest.tmp", NULL, 0))
+	{
+		fprintf(stderr, "Failed to set up texturecachetest.tmp: %s\n", WZ_PHYSFS_getLastError());
+		return EXIT_FAILURE;
+	}
+	WZ_PHYSFS_enumerateFiles("cache/textures", [](const char *file) -> bool {
+		PHYSFS_delete((std::string("cache/textures/") + file).c_str());
+		return true;
+	});
+
+	wz_texture_compression = true;
+	test_Impl_Factory factory;
+	if (!gfx_api::context::initialize(factory, 0, gfx_api::context::swap_interval_mode::vsync, nullopt, 0, gfx_api::backend_type::null_backend))
+	{
+		fprintf(stderr, "Failed to initialize the null backend\n");
+		return EXIT_FAILURE;
+	}
+	if (!gfx_api::bestRealTimeCompressionFormat(gfx_api::pixel_format_target::texture_2d, gfx_api::texture_type::game_texture).has_value())
+	{
+		fprintf(stderr, "No run-time texture compression available, skipping\n");
+		return EXIT_SUCCESS;
+	}
+
+	// A texture with some detail, so the compressors have something to do
+	iV_Image image;
+	image.allocate(64, 64, 4);
+	unsigned char *pixels = image.bmp_w();
+	for (unsigned int i = 0; i < 64 * 64; ++i)
+	{
+		pixels[i * 4 + 0] = static_cast<unsigned char>(i * 7);
+		pixels[i * 4 + 1] = static_cast<unsigned char>(i / 64 * 4);
+		pixels[i * 4 + 2] = static_cast<unsigned char>(i % 64 * 4);
+		pixels[i * 4 + 3] = 255;
+	}
+	if (!iV_saveImage_PNG("texturecachetest.png", &image).noError())
+	{
+		fprintf(stderr, "Failed to write texturecachetest.png\n");
+		return EXIT_FAILURE;
+	}
+
+	// The first load compresses the texture and stores the result
+	gfx_api::resetCompressedTextureCacheStats();
+	if (!loadTexture("texturecachetest.png") || !checkStats("first load", 0, 1, 1))
+	{
+		return EXIT_FAILURE;
+	}
+	// The second load is served from the cache
+	if (!loadTexture("texturecachetest.png") || !checkStats("second load", 1, 1, 1))
+	{
+		return EXIT_FAILURE;
+	}
+	// Loading it at a different size is a different cache entry
+	gfx_api::texture *smaller = gfx_api::context::get().loadTextureFromFile("texturecachetest.png", gfx_api::texture_type::game_texture, 32, 32);
+	if (smaller == nullptr)
+	{
+		fprintf(stderr, "Failed to load texturecachetest.png at 32x32\n");
+		return EXIT_FAILURE;
+	}
+	delete smaller;
+	if (!checkStats("smaller load", 1, 2, 2))
+	{
+		return EXIT_FAILURE;
+	}
+	// A disabled cache is neither read nor written
+	gfx_api::setCompressedTextureCacheEnabled(false);
+	if (!loadTexture("texturecachetest.png") || !checkStats("disabled cache", 1, 2, 2))
+	{
+		return EXIT_FAILURE;
+	}
+	gfx_api::setCompressedTextureCacheEnabled(true);
+	gfx_api::resetCompressedTextureCacheStats();
+	if (!checkStats("reset", 0, 0, 0))
+	{
+		return EXIT_FAILURE;
+	}
+	// Trimming the cache keeps the entries used since the start
+	gfx_api::trimCompressedTextureCache();
+	if (!loadTexture("texturecachetest.png") || !checkStats("after trimming", 1, 0, 0))
+	{
+		return EXIT_FAILURE;
+	}
+
+	gfx_api::context::get().shutdown();
+	PHYSFS_deinit();
+	fprintf(stdout, "Compressed texture cache: OK\n");
+	return EXIT_SUCCESS;
+}